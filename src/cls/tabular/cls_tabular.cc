@@ -14,6 +14,13 @@
 #include <sstream>
 #include <boost/lexical_cast.hpp>
 #include <time.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
 #include "re2/re2.h"
 #include "include/types.h"
 #include "objclass/objclass.h"
@@ -28,6 +35,8 @@ cls_method_handle_t h_exec_query_op;
 cls_method_handle_t h_exec_runstats_op;
 cls_method_handle_t h_build_index;
 cls_method_handle_t h_exec_build_sky_index_op;
+cls_method_handle_t h_append_fb;
+cls_method_handle_t h_compact;
 cls_method_handle_t h_transform_db_op;
 
 
@@ -51,10 +60,9 @@ static inline uint64_t getns()
   return __getns(CLOCK_MONOTONIC);
 }
 
-// extract bytes as string for regex matching
-static std::string string_ncopy(const char* buffer, std::size_t buffer_size) {
-  const char* copyupto = std::find(buffer, buffer + buffer_size, 0);
-  return std::string(buffer, copyupto);
+// length of a nul-padded field, for regex matching
+static std::size_t string_nlen(const char* buffer, std::size_t buffer_size) {
+  return std::find(buffer, buffer + buffer_size, 0) - buffer;
 }
 
 // Get fb_seq_num from xattr, if not present set to min val
@@ -131,6 +139,397 @@ int set_sky_format_type(cls_method_context_t hctx, int format_type) {
     return 0;
 }
 
+// Get the id of an index from its marker key (the index name), the id is
+// the short prefix of all of the index keys.  -ENOENT if not built.
+static
+int get_sky_index_id(cls_method_context_t hctx, const std::string& idx_name,
+                     uint32_t& idx_id) {
+
+    bufferlist bl;
+    int ret = cls_cxx_map_get_val(hctx, idx_name, &bl);
+    if (ret < 0) {
+        return ret;
+    }
+    try {
+        bufferlist::iterator it = bl.begin();
+        ::decode(idx_id, it);
+    } catch (const buffer::error &err) {
+        // indexes built with textual keys have no id, must be rebuilt.
+        CLS_LOG(20, "get_sky_index_id: no id for index %s", idx_name.c_str());
+        return -ENOENT;
+    }
+    return 0;
+}
+
+// Reuse the id of an existing index, else take the next one from xattr
+static
+int alloc_sky_index_id(cls_method_context_t hctx, const std::string& idx_name,
+                       uint32_t& idx_id) {
+
+    int ret = get_sky_index_id(hctx, idx_name, idx_id);
+    if (ret != -ENOENT) {
+        return ret;
+    }
+
+    uint32_t next_id = 0;
+    bufferlist bl;
+    ret = cls_cxx_getxattr(hctx, "sky_idx_next_id", &bl);
+    if (ret >= 0) {
+        try {
+            bufferlist::iterator it = bl.begin();
+            ::decode(next_id, it);
+        } catch (const buffer::error &err) {
+            CLS_ERR("ERROR: cls_tabular:alloc_sky_index_id: decoding next_id");
+            return -EINVAL;
+        }
+    }
+    else if (ret != -ENOENT && ret != -ENODATA) {
+        return ret;
+    }
+
+    idx_id = next_id;
+    bufferlist next_bl;
+    ::encode(next_id + 1, next_bl);
+    ret = cls_cxx_setxattr(hctx, "sky_idx_next_id", &next_bl);
+    if( ret < 0 ) {
+        return ret;
+    }
+    return 0;
+}
+
+/*
+ * A parquet object holds one encoded bl that is a parquet file.  This exposes
+ * the file as an arrow random access file over ranged obj reads, so the
+ * parquet reader only fetches the footer and the col chunks it needs.
+ */
+class ClsObjectFile : public arrow::io::RandomAccessFile
+{
+public:
+    ClsObjectFile(cls_method_context_t hctx, uint64_t base) :
+        hctx(hctx), base(base), size(-1), pos(0), is_closed(false),
+        read_ns(0) {}
+
+    arrow::Status Close() {
+        is_closed = true;
+        return arrow::Status::OK();
+    }
+    bool closed() const {return is_closed;}
+    arrow::Status Tell(int64_t* position) const {
+        *position = pos;
+        return arrow::Status::OK();
+    }
+    arrow::Status Seek(int64_t position) {
+        pos = position;
+        return arrow::Status::OK();
+    }
+    bool supports_zero_copy() const {return false;}
+
+    arrow::Status GetSize(int64_t* out) {
+        if (size < 0) {
+            uint64_t obj_size = 0;
+            int ret = cls_cxx_stat(hctx, &obj_size, NULL);
+            if (ret < 0 or obj_size < base)
+                return arrow::Status::IOError("cls_cxx_stat failed");
+            size = obj_size - base;
+        }
+        *out = size;
+        return arrow::Status::OK();
+    }
+
+    arrow::Status ReadAt(int64_t position, int64_t nbytes,
+                         int64_t* bytes_read, void* out) {
+        bufferlist bl;
+        arrow::Status st = read(position, nbytes, bl);
+        if (!st.ok())
+            return st;
+        bl.copy(0, bl.length(), static_cast<char*>(out));
+        *bytes_read = bl.length();
+        return arrow::Status::OK();
+    }
+
+    arrow::Status ReadAt(int64_t position, int64_t nbytes,
+                         std::shared_ptr<arrow::Buffer>* out) {
+        bufferlist bl;
+        arrow::Status st = read(position, nbytes, bl);
+        if (!st.ok())
+            return st;
+        return arrow::Buffer::FromString(bl.to_str(), out);
+    }
+
+    arrow::Status Read(int64_t nbytes, int64_t* bytes_read, void* out) {
+        arrow::Status st = ReadAt(pos, nbytes, bytes_read, out);
+        if (st.ok())
+            pos += *bytes_read;
+        return st;
+    }
+
+    arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer>* out) {
+        arrow::Status st = ReadAt(pos, nbytes, out);
+        if (st.ok())
+            pos += (*out)->size();
+        return st;
+    }
+
+    uint64_t get_read_ns() const {return read_ns;}
+
+private:
+    arrow::Status read(int64_t position, int64_t nbytes, bufferlist& bl) {
+        uint64_t start = getns();
+        int ret = cls_cxx_read(hctx, base + position, nbytes, &bl);
+        read_ns += getns() - start;
+        if (ret < 0)
+            return arrow::Status::IOError("cls_cxx_read failed");
+        return arrow::Status::OK();
+    }
+
+    cls_method_context_t hctx;
+    const uint64_t base;  // obj offset of the file
+    int64_t size;
+    int64_t pos;
+    bool is_closed;
+    uint64_t read_ns;
+};
+
+// check for an obj holding a parquet file, i.e., a bl len then the magic
+static
+bool is_parquet_obj(cls_method_context_t hctx) {
+
+    bufferlist bl;
+    const int len = sizeof(__u32) + PARQUET_FILE_MAGIC_LEN;
+    int ret = cls_cxx_read(hctx, 0, len, &bl);
+    if (ret < len)
+        return false;
+    return memcmp(bl.c_str() + sizeof(__u32), PARQUET_FILE_MAGIC,
+                  PARQUET_FILE_MAGIC_LEN) == 0;
+}
+
+// Index marker keys hold the index id then the idx_op the index was built
+// with, the op lets appends add entries to the index without a rebuild.
+static
+int decode_sky_index_marker(bufferlist& bl, uint32_t& idx_id, idx_op& op) {
+
+    try {
+        bufferlist::iterator it = bl.begin();
+        ::decode(idx_id, it);
+        if (it.end())
+            return -ENOENT;  // built before markers held their op
+        ::decode(op, it);
+    } catch (const buffer::error &err) {
+        CLS_ERR("ERROR: cls_tabular:decode_sky_index_marker: decoding marker");
+        return -EINVAL;
+    }
+    return 0;
+}
+
+// Get the idx_op an index was built with from its marker key
+static
+int get_sky_index_op(cls_method_context_t hctx, const std::string& idx_name,
+                     idx_op& op) {
+
+    bufferlist bl;
+    int ret = cls_cxx_map_get_val(hctx, idx_name, &bl);
+    if (ret < 0)
+        return ret;
+    uint32_t idx_id = 0;
+    return decode_sky_index_marker(bl, idx_id, op);
+}
+
+/*
+ * Create the IDX_FB entry of one fb: the physical extent of the fb within
+ * the obj, the zone maps of all its cols and the bloom filters of the
+ * bloom_schema cols, keyed by key_prefix and the fb_seq_num.
+ */
+static
+int build_idx_fb_entry(
+    Tables::sky_root& root,
+    Tables::schema_vec& bloom_schema,
+    unsigned int fb_seq_num,
+    uint64_t off,
+    uint64_t len,
+    const std::string& key_prefix,
+    std::map<std::string, bufferlist>& fbs_index)
+{
+    // IDX_FB key data is the fb sequence num
+    std::string key_data;
+    Tables::keyEncodeUInt(key_data, fb_seq_num, sizeof(fb_seq_num));
+
+    // IDX_FB zone maps (min/max/null count per col) used to skip this
+    // fb during scans whose predicates cannot match any of its rows
+    Tables::schema_vec fb_schema = Tables::schemaFromString(root.data_schema);
+    std::vector<col_zone> zones;
+    Tables::buildZoneMaps(root, fb_schema, zones);
+
+    // IDX_FB bloom filters over the requested cols, used to skip this
+    // fb for eq predicates on vals not present in any of its rows
+    std::vector<col_bloom> blooms;
+    if (!bloom_schema.empty()) {
+        int ret = Tables::buildBloomFilters(root, bloom_schema, blooms);
+        if (ret != 0) {
+            CLS_ERR("ERROR: build_idx_fb_entry: bloom filters, "
+                    "TablesErrCodes::%d", ret);
+            return -EINVAL;
+        }
+    }
+
+    // IDX_FB create the entry struct, encode into bufferlist
+    bufferlist fb_bl;
+    struct idx_fb_entry fb_ent(off, len, zones, blooms);
+    ::encode(fb_ent, fb_bl);
+    fbs_index[key_prefix + key_data] = fb_bl;
+    return 0;
+}
+
+/*
+ * Create the IDX_RID/IDX_REC/IDX_TXT entries of each live row of one fb, as
+ * described by op, keyed by key_prefix and the encoded key data of the row.
+ * Deleted rows get no entries, so index lookups never return them.
+ */
+static
+int build_idx_data_entries(
+    Tables::sky_root& root,
+    idx_op& op,
+    Tables::schema_vec& idx_schema,
+    unsigned int fb_seq_num,
+    const std::string& key_prefix,
+    std::map<std::string, bufferlist>& recs_index,
+    std::map<std::string, bufferlist>& txt_index)
+{
+    // DATA CONTENT INDEXES (LOGICAL data reference):
+    // content indexes are only supported for the row layout for now
+    if (!root.offs) {
+        CLS_ERR("build_idx_data_entries: %s", (
+                "Index type not supported for columnar layout. type=" +
+                std::to_string(op.idx_type)).c_str());
+        return -EOPNOTSUPP;
+    }
+
+    std::string key_data;
+    int ret = 0;
+
+    // IDX_REC/IDX_RID/IDX_TXT: create the key data for each row
+    for (uint32_t i = 0; i < root.nrows; i++) {
+        if (root.delete_vec.at(i) == 1)
+            continue;  // skip dead rows
+        Tables::sky_rec rec = Tables::getSkyRec(root.offs->Get(i));
+
+        switch (op.idx_type) {
+
+            case Tables::SIT_IDX_RID: {
+
+                // key_data is just the RID val
+                key_data.clear();
+                Tables::keyEncodeUInt(key_data, rec.RID, sizeof(rec.RID));
+
+                // create the entry, encode into bufferlist, update map
+                bufferlist rec_bl;
+                struct idx_rec_entry rec_ent(fb_seq_num, i, rec.RID);
+                ::encode(rec_ent, rec_bl);
+                recs_index[key_prefix + key_data] = rec_bl;
+                break;
+            }
+            case Tables::SIT_IDX_REC: {
+
+                // key data is built up from the relevant col vals
+                key_data.clear();
+                auto row = rec.data.AsVector();
+                for (unsigned i = 0; i < idx_schema.size(); i++) {
+                    ret = Tables::keyEncodeFlexVal(key_data,
+                                                   idx_schema[i].type,
+                                                   row[idx_schema[i].idx]);
+                    if (ret) {
+                        CLS_ERR("build_idx_data_entries: unsupported "
+                                "index col type=%d", idx_schema[i].type);
+                        return -EOPNOTSUPP;
+                    }
+                }
+
+                // to enforce uniqueness, append RID to key data
+                if (!op.idx_unique) {
+                    Tables::keyEncodeUInt(key_data, rec.RID,
+                                          sizeof(rec.RID));
+                }
+
+                // create the entry, encode into bufferlist, update map
+                bufferlist rec_bl;
+                struct idx_rec_entry rec_ent(fb_seq_num, i, rec.RID);
+                ::encode(rec_ent, rec_bl);
+                recs_index[key_prefix + key_data] = rec_bl;
+                break;
+            }
+            case Tables::SIT_IDX_TXT: {
+
+                // add each word in the row to a words vector, store as
+                // lower case and and preserve word sequence order.
+                std::vector<std::pair<std::string, int>> words;
+                std::string text_delims;
+                if (!op.idx_text_delims.empty())
+                    text_delims = op.idx_text_delims;
+                else
+                    text_delims = " \t\r\f\v\n"; // whitespace chars
+                auto row = rec.data.AsVector();
+                for (unsigned i = 0; i < idx_schema.size(); i++) {
+                    if (i > 0) key_data += Tables::IDX_KEY_DELIM_INNER;
+                    std::string line = \
+                        row[idx_schema[i].idx].AsString().str();
+                    boost::trim(line);
+                    if (line.empty())
+                        continue;
+                    vector<std::string> elems;
+                    boost::split(elems, line, boost::is_any_of(text_delims),
+                                        boost::token_compress_on);
+                    for (uint32_t i = 0; i < elems.size(); i++) {
+                        std::string word = \
+                                boost::algorithm::to_lower_copy(elems[i]);
+                        boost::trim(word);
+
+                        // skip stopwords?
+                        if (op.idx_ignore_stopwords and
+                            Tables::IDX_STOPWORDS.count(word) > 0) {
+                                continue;
+
+                        }
+                        words.push_back(std::make_pair(word, i));
+                    }
+                }
+                // now create a key and val (an entry struct) for each
+                // word extracted from line
+                for (auto it = words.begin(); it != words.end(); ++it) {
+
+                    key_data.clear();
+                    const std::string& word = it->first;
+                    Tables::keyEncodeString(key_data, word.data(),
+                                            word.size());
+
+                    // add the RID for uniqueness,
+                    // in case of repeated words within all rows
+                    Tables::keyEncodeUInt(key_data, rec.RID,
+                                          sizeof(rec.RID));
+
+                    // add the word pos for uniqueness,
+                    // in case of repeated words within same row
+                    int word_pos = it->second;
+                    Tables::keyEncodeUInt(key_data, word_pos,
+                                          sizeof(uint32_t));
+
+                    // create the entry, encode into bufferlist, update map
+                    bufferlist txt_bl;
+                    struct idx_txt_entry txt_ent(fb_seq_num, i,
+                                                 rec.RID, word_pos);
+                    ::encode(txt_ent, txt_bl);
+                    txt_index[key_prefix + key_data] = txt_bl;
+                }
+                break;
+            }
+            default: {
+                CLS_ERR("build_idx_data_entries: %s", (
+                        "Index type unknown. type=" +
+                        std::to_string(op.idx_type)).c_str());
+            }
+        }
+    }  // end foreach row
+    return 0;
+}
+
 /*
  * Build a skyhook index, insert to omap.
  * Index types are
@@ -154,22 +553,20 @@ int exec_build_sky_index_op(cls_method_context_t hctx, bufferlist *in, bufferlis
     // seems to be an int32 currently.
     const int ceph_bl_encoding_len = sizeof(int32_t);
 
-    // fb_seq_num is stored in xattrs and used as a stable counter of the
-    // current number of fbs in the object.
+    // fbs are numbered by their position within the obj, so every index of
+    // the obj agrees on the seq nums.  fb_seq_num is stored in xattrs as a
+    // stable counter of the current number of fbs, appends continue from it.
     unsigned int fb_seq_num = Tables::DATASTRUCT_SEQ_NUM_MIN;
-    int ret = get_fb_seq_num(hctx, fb_seq_num);
-    if (ret < 0) {
-        CLS_ERR("ERROR: exec_build_sky_index_op: fb_seq_num entry from xattr %d", ret);
-        return ret;
-    }
+    int ret = 0;
 
     std::string key_fb_prefix;
     std::string key_data_prefix;
-    std::string key_data;
-    std::string key;
+    std::string fb_idx_name;    // marker keys, hold the index ids
+    std::string data_idx_name;
+    uint32_t fb_idx_id = 0;
+    uint32_t data_idx_id = 0;
     std::map<std::string, bufferlist> fbs_index;
     std::map<std::string, bufferlist> recs_index;
-    std::map<std::string, bufferlist> rids_index;
     std::map<std::string, bufferlist> txt_index;
 
     // extract the index op instructions from the input bl
@@ -181,7 +578,11 @@ int exec_build_sky_index_op(cls_method_context_t hctx, bufferlist *in, bufferlis
         CLS_ERR("ERROR: exec_build_sky_index_op decoding idx_op");
         return -EINVAL;
     }
+    op.idx_live_rows = true;  // deleted rows are not indexed, see markers
     Tables::schema_vec idx_schema = Tables::schemaFromString(op.idx_schema_str);
+    Tables::schema_vec bloom_schema;
+    if (!op.idx_bloom_schema_str.empty())
+        bloom_schema = Tables::schemaFromString(op.idx_bloom_schema_str);
 
     // obj contains one bl that itself wraps a seq of encoded bls of skyhook fb
     bufferlist wrapped_bls;
@@ -208,191 +609,68 @@ int exec_build_sky_index_op(cls_method_context_t hctx, bufferlist *in, bufferlis
         int fb_len = bl.length();
         Tables::sky_root root = Tables::getSkyRoot(fb, fb_len);
 
-        // DATA LOCATION INDEX (PHYSICAL data reference):
-
-        // IDX_FB get the key prefix and key_data (fb sequence num)
-        ++fb_seq_num;
-        key_fb_prefix = buildKeyPrefix(Tables::SIT_IDX_FB, root.db_schema,
-                                       root.table_name);
-        std::string str_seq_num = Tables::u64tostr(fb_seq_num); // key data
-        int len = str_seq_num.length();
-
-        // create string of len min chars per type, int32 here
-        int pos = len - 10;
-        key_data = str_seq_num.substr(pos, len);
-
-        // IDX_FB create the entry struct, encode into bufferlist
-        bufferlist fb_bl;
-        struct idx_fb_entry fb_ent(off, fb_len + ceph_bl_encoding_len);
-        ::encode(fb_ent, fb_bl);
-        key = key_fb_prefix + key_data;
-        fbs_index[key] = fb_bl;
-
-        // DATA CONTENT INDEXES (LOGICAL data reference):
-        // Build the key prefixes for each index type (IDX_RID/IDX_REC/IDX_TXT)
-        if (op.idx_type == Tables::SIT_IDX_RID) {
-            std::vector<std::string> index_cols;
-            index_cols.push_back(Tables::RID_INDEX);
-            key_data_prefix = buildKeyPrefix(Tables::SIT_IDX_RID,
-                                             root.db_schema,
-                                             root.table_name,
-                                             index_cols);
-        }
-        if (op.idx_type == Tables::SIT_IDX_REC or
-            op.idx_type == Tables::SIT_IDX_TXT) {
-
+        // Name the indexes from the first fb and get their ids, keys of
+        // each index start with its short binary prefix (the id).
+        if (fb_idx_name.empty()) {
+            fb_idx_name = Tables::buildKeyPrefix(Tables::SIT_IDX_FB,
+                                                 root.db_schema,
+                                                 root.table_name);
             std::vector<std::string> keycols;
-            for (auto it = idx_schema.begin(); it != idx_schema.end(); ++it) {
-                keycols.push_back(it->name);
+            if (op.idx_type == Tables::SIT_IDX_RID) {
+                keycols.push_back(Tables::RID_INDEX);
+            }
+            else {
+                for (auto it = idx_schema.begin(); it != idx_schema.end(); ++it)
+                    keycols.push_back(it->name);
+            }
+            data_idx_name = Tables::buildKeyPrefix(op.idx_type,
+                                                   root.db_schema,
+                                                   root.table_name,
+                                                   keycols);
+            ret = alloc_sky_index_id(hctx, fb_idx_name, fb_idx_id);
+            if (ret == 0)
+                ret = alloc_sky_index_id(hctx, data_idx_name, data_idx_id);
+            if (ret < 0) {
+                CLS_ERR("ERROR: exec_build_sky_index_op: index id %d", ret);
+                return ret;
             }
-            key_data_prefix = Tables::buildKeyPrefix(op.idx_type,
-                                                     root.db_schema,
-                                                     root.table_name,
-                                                     keycols);
+            key_fb_prefix = Tables::buildIndexKeyPrefix(fb_idx_id);
+            key_data_prefix = Tables::buildIndexKeyPrefix(data_idx_id);
         }
 
-        // IDX_REC/IDX_RID/IDX_TXT: create the key data for each row
-        for (uint32_t i = 0; i < root.nrows; i++) {
-            Tables::sky_rec rec = Tables::getSkyRec(root.offs->Get(i));
-
-            switch (op.idx_type) {
-
-                case Tables::SIT_IDX_RID: {
-
-                    // key_data is just the RID val
-                    key_data = Tables::u64tostr(rec.RID);
-
-                    // create the entry, encode into bufferlist, update map
-                    bufferlist rec_bl;
-                    struct idx_rec_entry rec_ent(fb_seq_num, i, rec.RID);
-                    ::encode(rec_ent, rec_bl);
-                    key = key_data_prefix + key_data;
-                    recs_index[key] = rec_bl;
-                    break;
-                }
-                case Tables::SIT_IDX_REC: {
-
-                    // key data is built up from the relevant col vals
-                    key_data.clear();
-                    auto row = rec.data.AsVector();
-                    for (unsigned i = 0; i < idx_schema.size(); i++) {
-                        if (i > 0) key_data += Tables::IDX_KEY_DELIM_INNER;
-                        key_data += Tables::buildKeyData(
-                                            idx_schema[i].type,
-                                            row[idx_schema[i].idx].AsUInt64());
-                    }
-
-                    // to enforce uniqueness, append RID to key data
-                    if (!op.idx_unique) {
-                        key_data += (Tables::IDX_KEY_DELIM_OUTER +
-                                     Tables::IDX_KEY_DELIM_UNIQUE +
-                                     Tables::IDX_KEY_DELIM_INNER +
-                                     std::to_string(rec.RID));
-                    }
-
-                    // create the entry, encode into bufferlist, update map
-                    bufferlist rec_bl;
-                    struct idx_rec_entry rec_ent(fb_seq_num, i, rec.RID);
-                    ::encode(rec_ent, rec_bl);
-                    key = key_data_prefix + key_data;
-                    recs_index[key] = rec_bl;
-                    break;
-                }
-                case Tables::SIT_IDX_TXT: {
-
-                    // add each word in the row to a words vector, store as
-                    // lower case and and preserve word sequence order.
-                    std::vector<std::pair<std::string, int>> words;
-                    std::string text_delims;
-                    if (!op.idx_text_delims.empty())
-                        text_delims = op.idx_text_delims;
-                    else
-                        text_delims = " \t\r\f\v\n"; // whitespace chars
-                    auto row = rec.data.AsVector();
-                    for (unsigned i = 0; i < idx_schema.size(); i++) {
-                        if (i > 0) key_data += Tables::IDX_KEY_DELIM_INNER;
-                        std::string line = \
-                            row[idx_schema[i].idx].AsString().str();
-                        boost::trim(line);
-                        if (line.empty())
-                            continue;
-                        vector<std::string> elems;
-                        boost::split(elems, line, boost::is_any_of(text_delims),
-                                            boost::token_compress_on);
-                        for (uint32_t i = 0; i < elems.size(); i++) {
-                            std::string word = \
-                                    boost::algorithm::to_lower_copy(elems[i]);
-                            boost::trim(word);
-
-                            // skip stopwords?
-                            if (op.idx_ignore_stopwords and
-                                Tables::IDX_STOPWORDS.count(word) > 0) {
-                                    continue;
+        // DATA LOCATION INDEX (PHYSICAL data reference):
+        ++fb_seq_num;
+        ret = build_idx_fb_entry(root, bloom_schema, fb_seq_num, off,
+                                 fb_len + ceph_bl_encoding_len,
+                                 key_fb_prefix, fbs_index);
+        if (ret < 0)
+            return ret;
 
-                            }
-                            words.push_back(std::make_pair(elems[i], i));
-                        }
-                    }
-                    // now create a key and val (an entry struct) for each
-                    // word extracted from line
-                    for (auto it = words.begin(); it != words.end(); ++it) {
-
-                        key_data.clear();
-                        std::string word = it->first;
-                        key_data += word;
-
-                        // add the RID for uniqueness,
-                        // in case of repeated words within all rows
-                        key_data += (Tables::IDX_KEY_DELIM_OUTER +
-                                     Tables::IDX_KEY_DELIM_UNIQUE +
-                                     Tables::IDX_KEY_DELIM_INNER +
-                                     std::to_string(rec.RID));
-
-                        // add the word pos for uniqueness,
-                        // in case of repeated words within same row
-                        int word_pos = it->second;
-                        key_data += (Tables::IDX_KEY_DELIM_INNER +
-                                     std::to_string(word_pos));
-
-                        // create the entry, encode into bufferlist, update map
-                        bufferlist txt_bl;
-                        struct idx_txt_entry txt_ent(fb_seq_num, i,
-                                                     rec.RID, word_pos);
-                        ::encode(txt_ent, txt_bl);
-                        key = key_data_prefix + key_data;
-                        txt_index[key] = txt_bl;
-                        /*CLS_LOG(20,"kv=%s",
-                                 (key+";"+txt_ent.toString()).c_str());*/
-                    }
-                    break;
-                }
-                default: {
-                    CLS_ERR("exec_build_sky_index_op: %s", (
-                            "Index type unknown. type=" +
-                            std::to_string(op.idx_type)).c_str());
-                }
-            }
+        // DATA CONTENT INDEXES (LOGICAL data reference):
+        ret = build_idx_data_entries(root, op, idx_schema, fb_seq_num,
+                                     key_data_prefix, recs_index, txt_index);
+        if (ret < 0)
+            return ret;
 
-            // IDX_REC/IDX_RID batch insert to omap (minimize IOs)
-            if (recs_index.size() > op.idx_batch_size) {
-                ret = cls_cxx_map_set_vals(hctx, &recs_index);
-                if (ret < 0) {
-                    CLS_ERR("exec_build_sky_index_op: error setting recs index entries %d", ret);
-                    return ret;
-                }
-                recs_index.clear();
+        // IDX_REC/IDX_RID batch insert to omap (minimize IOs)
+        if (recs_index.size() > op.idx_batch_size) {
+            ret = cls_cxx_map_set_vals(hctx, &recs_index);
+            if (ret < 0) {
+                CLS_ERR("exec_build_sky_index_op: error setting recs index entries %d", ret);
+                return ret;
             }
+            recs_index.clear();
+        }
 
-            // IDX_TXT batch insert to omap (minimize IOs)
-            if (txt_index.size() > op.idx_batch_size) {
-                ret = cls_cxx_map_set_vals(hctx, &txt_index);
-                if (ret < 0) {
-                    CLS_ERR("exec_build_sky_index_op: error setting recs index entries %d", ret);
-                    return ret;
-                }
-                txt_index.clear();
+        // IDX_TXT batch insert to omap (minimize IOs)
+        if (txt_index.size() > op.idx_batch_size) {
+            ret = cls_cxx_map_set_vals(hctx, &txt_index);
+            if (ret < 0) {
+                CLS_ERR("exec_build_sky_index_op: error setting recs index entries %d", ret);
+                return ret;
             }
-        }  // end foreach row
+            txt_index.clear();
+        }
 
         // IDX_FB batch insert to omap (minimize IOs)
         if (fbs_index.size() > op.idx_batch_size) {
@@ -432,26 +710,500 @@ int exec_build_sky_index_op(cls_method_context_t hctx, bufferlist *in, bufferlis
         }
     }
 
-    // Update counter and Insert fb_seq_num to xattr
-    ret = set_fb_seq_num(hctx, fb_seq_num);
-    if(ret < 0) {
-        CLS_ERR("exec_build_sky_index_op: error setting fb_seq_num entry to xattr %d", ret);
+    // Update counter and Insert fb_seq_num to xattr
+    ret = set_fb_seq_num(hctx, fb_seq_num);
+    if(ret < 0) {
+        CLS_ERR("exec_build_sky_index_op: error setting fb_seq_num entry to xattr %d", ret);
+        return ret;
+    }
+
+    // no fbs, no index
+    if (fb_idx_name.empty())
+        return 0;
+
+    // LASTLY insert a marker key to indicate each index exists, keyed by
+    // the index name and holding the index id used as its key prefix and
+    // the op to maintain the index with on appends.
+    bufferlist fb_id_bl;
+    bufferlist data_id_bl;
+    ::encode(fb_idx_id, fb_id_bl);
+    ::encode(op, fb_id_bl);
+    ::encode(data_idx_id, data_id_bl);
+    ::encode(op, data_id_bl);
+    std::map<std::string, bufferlist> index_exists_marker;
+    index_exists_marker[fb_idx_name] = fb_id_bl;
+    index_exists_marker[data_idx_name] = data_id_bl;
+    ret = cls_cxx_map_set_vals(hctx, &index_exists_marker);
+    if (ret < 0) {
+        CLS_ERR("exec_build_sky_index_op: error setting index_exists_marker %d", ret);
+        return ret;
+    }
+
+    return 0;
+}
+
+// An index of the obj, as described by its marker key
+struct sky_index_def {
+    bool fb_index;           // the IDX_FB, else a data index
+    std::string key_prefix;  // of all of the index keys
+    idx_op op;
+    Tables::schema_vec idx_schema;
+    Tables::schema_vec bloom_schema;
+};
+
+/*
+ * Get the indexes of the table from their marker keys, i.e., its fb index
+ * and each of its data indexes.  Marker names of an index type share the
+ * prefix up to the index key cols.
+ */
+static
+int get_sky_index_defs(
+    cls_method_context_t hctx,
+    const std::string& db_schema,
+    const std::string& table_name,
+    std::vector<sky_index_def>& defs)
+{
+    const int idx_types[] = {Tables::SIT_IDX_FB,
+                             Tables::SIT_IDX_RID,
+                             Tables::SIT_IDX_REC,
+                             Tables::SIT_IDX_TXT};
+    for (int idx_type : idx_types) {
+        std::string name_prefix = Tables::buildKeyPrefix(idx_type, db_schema,
+                                                         table_name);
+        name_prefix.erase(name_prefix.size() -
+                          Tables::IDX_KEY_COLS_DEFAULT.size() -
+                          Tables::IDX_KEY_DELIM_OUTER.size());
+        std::string start_after;
+        bool more = true;
+        while (more) {
+            std::map<std::string, bufferlist> markers;
+            int ret = cls_cxx_map_get_vals(hctx, start_after, name_prefix,
+                                           1024, &markers, &more);
+            if (ret < 0 && ret != -ENOENT) {
+                CLS_ERR("ERROR: get_sky_index_defs: reading markers %d", ret);
+                return ret;
+            }
+            if (markers.empty())
+                break;
+            for (auto it = markers.begin(); it != markers.end(); ++it) {
+                sky_index_def def;
+                uint32_t idx_id = 0;
+                ret = decode_sky_index_marker(it->second, idx_id, def.op);
+                if (ret < 0) {
+                    CLS_ERR("ERROR: get_sky_index_defs: index %s must be "
+                            "rebuilt %d", it->first.c_str(), ret);
+                    return ret;
+                }
+                def.fb_index = (idx_type == Tables::SIT_IDX_FB);
+                def.key_prefix = Tables::buildIndexKeyPrefix(idx_id);
+                defs.push_back(def);
+                sky_index_def& d = defs.back();
+                if (d.fb_index and !d.op.idx_bloom_schema_str.empty()) {
+                    d.bloom_schema = \
+                        Tables::schemaFromString(d.op.idx_bloom_schema_str);
+                }
+                if (!d.fb_index) {
+                    d.idx_schema = \
+                        Tables::schemaFromString(d.op.idx_schema_str);
+                }
+            }
+            start_after = markers.rbegin()->first;
+        }
+    }
+    return 0;
+}
+
+// Create the entries of one fb, at off within the obj, for each index
+static
+int build_sky_index_entries(
+    std::vector<sky_index_def>& defs,
+    Tables::sky_root& root,
+    unsigned int fb_seq_num,
+    uint64_t off,
+    uint64_t len,
+    std::map<std::string, bufferlist>& entries)
+{
+    for (auto it = defs.begin(); it != defs.end(); ++it) {
+        int ret = 0;
+        if (it->fb_index) {
+            ret = build_idx_fb_entry(root, it->bloom_schema, fb_seq_num, off,
+                                     len, it->key_prefix, entries);
+        }
+        else {
+            ret = build_idx_data_entries(root, it->op, it->idx_schema,
+                                         fb_seq_num, it->key_prefix,
+                                         entries, entries);
+        }
+        if (ret < 0)
+            return ret;
+    }
+    return 0;
+}
+
+/*
+ * Append one fb to the obj and add only its entries to each index of the
+ * obj, all within this op, so a growing table does not rebuild its indexes.
+ * The input is the fb as one encoded bl, i.e., exactly as stored in the obj.
+ * Returns the fb_seq_num given to the fb.
+ */
+static
+int append_fb(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+    const int ceph_bl_encoding_len = sizeof(int32_t);
+    int ret = 0;
+
+    bufferlist bl;
+    try {
+        bufferlist::iterator it = in->begin();
+        ::decode(bl, it);
+        if (!it.end()) {
+            CLS_ERR("ERROR: append_fb: input holds more than one fb");
+            return -EINVAL;
+        }
+    } catch (const buffer::error &err) {
+        CLS_ERR("ERROR: append_fb decoding fb");
+        return -EINVAL;
+    }
+    const char* fb = bl.c_str();
+    int fb_len = bl.length();
+    if (!Tables::verifySkyFb(fb, fb_len)) {
+        CLS_ERR("ERROR: append_fb: input is not a valid flatbuf");
+        return -EINVAL;
+    }
+    Tables::sky_root root = Tables::getSkyRoot(fb, fb_len);
+
+    uint64_t obj_size = 0;
+    ret = cls_cxx_stat(hctx, &obj_size, NULL);
+    if (ret == -ENOENT) {
+        obj_size = 0;
+    }
+    else if (ret < 0) {
+        CLS_ERR("ERROR: append_fb: stat obj %d", ret);
+        return ret;
+    }
+
+
+    // fbs can only be appended to objs holding a seq of flatbufs
+    int format_type = 0;
+    ret = get_sky_format_type(hctx, format_type);
+    if (ret == -ENOENT || ret == -ENODATA) {
+        if (obj_size > 0 and is_parquet_obj(hctx))
+            format_type = SFT_PARQUET;
+        else if (obj_size == 0 and Tables::isSkyFbCol(fb))
+            format_type = SFT_FLATBUF_UNION_COL;
+        else
+            format_type = SFT_FLATBUF_FLEX_ROW;
+        ret = set_sky_format_type(hctx, format_type);
+        if (ret < 0) {
+            CLS_ERR("append_fb: error setting sky_format_type entry to xattr %d", ret);
+            return ret;
+        }
+    }
+    else if (ret < 0) {
+        CLS_ERR("ERROR: append_fb: sky_format_type entry from xattr %d", ret);
+        return ret;
+    }
+    if (format_type != SFT_FLATBUF_FLEX_ROW and
+        format_type != SFT_FLATBUF_UNION_COL) {
+        CLS_ERR("ERROR: append_fb: obj format type=%d", format_type);
+        return -EOPNOTSUPP;
+    }
+
+    unsigned int fb_seq_num = Tables::DATASTRUCT_SEQ_NUM_MIN;
+    ret = get_fb_seq_num(hctx, fb_seq_num);
+    if (ret < 0) {
+        CLS_ERR("ERROR: append_fb: fb_seq_num entry from xattr %d", ret);
+        return ret;
+    }
+    ++fb_seq_num;
+    if (fb_seq_num > Tables::DATASTRUCT_SEQ_NUM_MAX)
+        CLS_LOG(1, "append_fb: obj holds %u fbs, compact it", fb_seq_num);
+
+    // entries of the fb for each index of the table, if any
+    std::vector<sky_index_def> defs;
+    ret = get_sky_index_defs(hctx, root.db_schema, root.table_name, defs);
+    if (ret < 0)
+        return ret;
+
+    // an obj indexed under another schema/table would not index this fb,
+    // its markers are the only omap keys starting with the index type name
+    if (defs.empty()) {
+        std::map<std::string, bufferlist> markers;
+        bool more = false;
+        ret = cls_cxx_map_get_vals(hctx, "", "IDX_", 1, &markers, &more);
+        if (ret < 0 && ret != -ENOENT) {
+            CLS_ERR("ERROR: append_fb: reading index markers %d", ret);
+            return ret;
+        }
+        if (!markers.empty()) {
+            CLS_ERR("ERROR: append_fb: fb of %s.%s, obj is indexed as %s",
+                    root.db_schema.c_str(), root.table_name.c_str(),
+                    markers.begin()->first.c_str());
+            return -EINVAL;
+        }
+    }
+    std::map<std::string, bufferlist> idx_entries;
+    ret = build_sky_index_entries(defs, root, fb_seq_num, obj_size,
+                                  fb_len + ceph_bl_encoding_len, idx_entries);
+    if (ret < 0)
+        return ret;
+
+    // the fb goes at the end of the obj, as is
+    ret = cls_cxx_write(hctx, obj_size, in->length(), in);
+    if (ret < 0) {
+        CLS_ERR("ERROR: append_fb: writing fb %d", ret);
+        return ret;
+    }
+
+    ret = set_fb_seq_num(hctx, fb_seq_num);
+    if (ret < 0) {
+        CLS_ERR("append_fb: error setting fb_seq_num entry to xattr %d", ret);
+        return ret;
+    }
+
+    if (!idx_entries.empty()) {
+        ret = cls_cxx_map_set_vals(hctx, &idx_entries);
+        if (ret < 0) {
+            CLS_ERR("append_fb: error setting index entries %d", ret);
+            return ret;
+        }
+    }
+
+    ::encode(fb_seq_num, *out);
+    return 0;
+}
+
+/*
+ * Compact the obj: rewrite its fbs into fbs of about target_rows rows or
+ * target_bytes bytes, dropping the rows marked deleted and, if given,
+ * ordering the rows by the clustering col so its zone maps are tight.
+ * Every index of the table is rebuilt for the new fbs within this op, so
+ * readers see either the old or the new fbs with their own indexes.
+ * Only objs of row layout flatbufs are supported.
+ */
+static
+int compact(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+    const int ceph_bl_encoding_len = sizeof(int32_t);
+
+    compact_op op;
+    try {
+        bufferlist::iterator it = in->begin();
+        ::decode(op, it);
+    } catch (const buffer::error &err) {
+        CLS_ERR("ERROR: compact decoding compact_op");
+        return -EINVAL;
+    }
+    CLS_LOG(20, "compact: %s", op.toString().c_str());
+
+    int format_type = SFT_FLATBUF_FLEX_ROW;
+    int ret = get_sky_format_type(hctx, format_type);
+    if (ret == -ENOENT || ret == -ENODATA) {
+        format_type = is_parquet_obj(hctx) ? SFT_PARQUET :
+                                             SFT_FLATBUF_FLEX_ROW;
+    }
+    else if (ret < 0) {
+        CLS_ERR("ERROR: compact: sky_format_type entry from xattr %d", ret);
+        return ret;
+    }
+    if (format_type != SFT_FLATBUF_FLEX_ROW) {
+        CLS_ERR("ERROR: compact: obj format type=%d", format_type);
+        return -EOPNOTSUPP;
+    }
+
+    bufferlist wrapped_bls;
+    ret = cls_cxx_read(hctx, 0, 0, &wrapped_bls);
+    if (ret < 0) {
+        CLS_ERR("ERROR: compact: reading obj %d", ret);
+        return ret;
+    }
+
+    // unpack the fbs, their bls must outlive the rows referring to them
+    std::vector<bufferlist> bls;
+    ceph::bufferlist::iterator it = wrapped_bls.begin();
+    while (it.get_remaining() > 0) {
+        ceph::bufferlist bl;
+        try {
+            ::decode(bl, it);
+        } catch (ceph::buffer::error&) {
+            CLS_ERR("ERROR: compact: decoding fb %lu", bls.size());
+            return -EINVAL;
+        }
+        bls.push_back(bl);
+    }
+    if (bls.empty())
+        return 0;
+
+    Tables::schema_vec cluster_schema;
+    if (!op.cluster_schema.empty())
+        cluster_schema = Tables::schemaFromString(op.cluster_schema);
+
+    // the live rows of all fbs, keyed by their clustering col val if any
+    std::vector<const char*> fbs;
+    std::vector<Tables::topk_entry> rows;
+    std::string data_schema;
+    std::string db_schema;
+    std::string table_name;
+    int cluster_pos = -1;
+    uint64_t ndead = 0;
+    for (unsigned f = 0; f < bls.size(); f++) {
+        const char* fb = bls[f].c_str();
+        Tables::sky_root root = Tables::getSkyRoot(fb, bls[f].length());
+        if (!root.offs) {
+            CLS_ERR("ERROR: compact: columnar layout not supported");
+            return -EOPNOTSUPP;
+        }
+        if (f == 0) {
+            data_schema = root.data_schema;
+            db_schema = root.db_schema;
+            table_name = root.table_name;
+            Tables::schema_vec schema = \
+                    Tables::schemaFromString(data_schema);
+            for (unsigned i = 0; i < schema.size() and
+                                 !cluster_schema.empty(); i++) {
+                if (schema[i].idx == cluster_schema[0].idx)
+                    cluster_pos = i;
+            }
+            if (!cluster_schema.empty() and cluster_pos < 0) {
+                CLS_ERR("ERROR: compact: cluster col idx=%d not present",
+                        cluster_schema[0].idx);
+                return -EINVAL;
+            }
+        }
+        else if (root.data_schema != data_schema or
+                 root.db_schema != db_schema or
+                 root.table_name != table_name) {
+            // records are copied as is, so they must share a schema
+            CLS_ERR("ERROR: compact: fbs of differing schemas");
+            return -EINVAL;
+        }
+        fbs.push_back(fb);
+
+        for (uint32_t i = 0; i < root.nrows; i++) {
+            if (root.delete_vec[i] == 1) {
+                ndead++;
+                continue;
+            }
+            Tables::topk_entry e;
+            e.fb = f;
+            e.row = i;
+            if (cluster_pos >= 0) {
+                Tables::sky_rec rec = Tables::getSkyRec(root.offs->Get(i));
+                auto row = rec.data.AsVector();
+                ret = Tables::keyEncodeFlexVal(e.key, cluster_schema[0].type,
+                                               row[cluster_pos]);
+                if (ret) {
+                    CLS_ERR("ERROR: compact: unsupported cluster col type=%d",
+                            cluster_schema[0].type);
+                    return -EOPNOTSUPP;
+                }
+            }
+            rows.push_back(e);
+        }
+    }
+
+    // col vals are compared by their order preserving key encoding
+    if (cluster_pos >= 0) {
+        std::stable_sort(rows.begin(), rows.end(),
+                         [](const Tables::topk_entry& a,
+                            const Tables::topk_entry& b) {
+                             return a.key < b.key;
+                         });
+    }
+
+    std::vector<sky_index_def> defs;
+    ret = get_sky_index_defs(hctx, db_schema, table_name, defs);
+    if (ret < 0)
+        return ret;
+
+    // cut the rows into fbs once either target is reached, row sizes are
+    // estimated from their data and nullbits
+    bufferlist new_bls;
+    std::map<std::string, bufferlist> idx_entries;
+    unsigned int fb_seq_num = Tables::DATASTRUCT_SEQ_NUM_MIN;
+    auto start = rows.begin();
+    uint64_t nbytes = 0;
+    for (auto r = rows.begin(); r != rows.end(); ) {
+        const Tables::Record* rec = \
+                Tables::GetTable(fbs[r->fb])->rows()->Get(r->row);
+        nbytes += rec->data()->size() +
+                  rec->nullbits()->size() * sizeof(uint64_t);
+        ++r;
+        if (r != rows.end() and
+            (op.target_rows == 0 or
+             static_cast<uint32_t>(r - start) < op.target_rows) and
+            (op.target_bytes == 0 or nbytes < op.target_bytes))
+            continue;
+
+        flatbuffers::FlatBufferBuilder flatbldr(1024);
+        Tables::buildFbFromRows(flatbldr, fbs, start, r);
+        bufferlist fb_bl;
+        fb_bl.append(reinterpret_cast<const char*>(flatbldr.GetBufferPointer()),
+                     flatbldr.GetSize());
+        uint64_t off = new_bls.length();
+        ++fb_seq_num;
+        Tables::sky_root root = Tables::getSkyRoot(fb_bl.c_str(),
+                                                   fb_bl.length());
+        ret = build_sky_index_entries(defs, root, fb_seq_num, off,
+                                      fb_bl.length() + ceph_bl_encoding_len,
+                                      idx_entries);
+        if (ret < 0)
+            return ret;
+        ::encode(fb_bl, new_bls);
+        start = r;
+        nbytes = 0;
+    }
+
+    // drop the entries of the old fbs, index keys start with the index id
+    for (auto d = defs.begin(); d != defs.end(); ++d) {
+        std::string start_after = d->key_prefix;
+        bool more = true;
+        while (more) {
+            std::set<std::string> keys;
+            ret = cls_cxx_map_get_keys(hctx, start_after, 1024, &keys, &more);
+            if (ret < 0) {
+                CLS_ERR("ERROR: compact: reading index keys %d", ret);
+                return ret;
+            }
+            for (auto k = keys.begin(); k != keys.end(); ++k) {
+                if (k->compare(0, d->key_prefix.size(), d->key_prefix) != 0) {
+                    more = false;
+                    break;
+                }
+                ret = cls_cxx_map_remove_key(hctx, *k);
+                if (ret < 0) {
+                    CLS_ERR("ERROR: compact: removing index key %d", ret);
+                    return ret;
+                }
+            }
+            if (keys.empty())
+                break;
+            start_after = *keys.rbegin();
+        }
+    }
+
+    ret = cls_cxx_write_full(hctx, &new_bls);
+    if (ret < 0) {
+        CLS_ERR("ERROR: compact: writing obj %d", ret);
         return ret;
     }
 
-    // LASTLY insert a marker key to indicate this index exists,
-    // here we are using the key prefix with no data vals
-    // TODO: make this a valid entry (not empty_bl), but with empty vals.
-    bufferlist empty_bl;
-    empty_bl.append("");
-    std::map<std::string, bufferlist> index_exists_marker;
-    index_exists_marker[key_data_prefix] = empty_bl;
-    ret = cls_cxx_map_set_vals(hctx, &index_exists_marker);
+    ret = set_fb_seq_num(hctx, fb_seq_num);
     if (ret < 0) {
-        CLS_ERR("exec_build_sky_index_op: error setting index_exists_marker %d", ret);
+        CLS_ERR("compact: error setting fb_seq_num entry to xattr %d", ret);
         return ret;
     }
 
+    if (!idx_entries.empty()) {
+        ret = cls_cxx_map_set_vals(hctx, &idx_entries);
+        if (ret < 0) {
+            CLS_ERR("compact: error setting index entries %d", ret);
+            return ret;
+        }
+    }
+
+    CLS_LOG(20, "compact: %lu fbs into %u, %lu rows kept, %lu dropped",
+            bls.size(), fb_seq_num, rows.size(), ndead);
     return 0;
 }
 
@@ -543,17 +1295,116 @@ static void add_extra_row_cost(uint64_t cost)
   }
 }
 
+/*
+ * The IDX_FB entries of an obj, loaded with one omap range read the first
+ * time a query op needs them, instead of one omap read per fb lookup.
+ */
+struct fbs_index_cache {
+    std::string key_prefix;  // empty if there is no fb index
+    bool loaded;
+    std::map<int, struct idx_fb_entry> entries;  // by fb seq num
+
+    explicit fbs_index_cache(const std::string& prefix) :
+        key_prefix(prefix), loaded(false) {}
+};
+
+static
+int
+load_fbs_index(
+    cls_method_context_t hctx,
+    fbs_index_cache& fbs)
+{
+    if (fbs.loaded or fbs.key_prefix.empty()) {
+        fbs.loaded = true;
+        return 0;
+    }
+
+    // fb keys are the prefix then the big endian fb seq num
+    const size_t seq_off = fbs.key_prefix.size();
+    const int max_to_get = 1024;
+    std::string start_after;
+    bool more = true;
+    while (more) {
+        std::map<std::string, bufferlist> key_val_map;
+        int ret = cls_cxx_map_get_vals(hctx, start_after, fbs.key_prefix,
+                                       max_to_get, &key_val_map, &more);
+        if (ret < 0 && ret != -ENOENT) {
+            CLS_ERR("Cannot read fbs index entries, errorcode=%d", ret);
+            return ret;
+        }
+        if (key_val_map.empty())
+            break;
+
+        for (auto it = key_val_map.begin(); it != key_val_map.end(); ++it) {
+            const std::string& key = it->first;
+            if (key.size() != seq_off + sizeof(uint32_t))
+                continue;
+            uint32_t seq = 0;
+            for (size_t i = seq_off; i < key.size(); i++)
+                seq = (seq << 8) | static_cast<unsigned char>(key[i]);
+
+            struct idx_fb_entry fb_ent;
+            try {
+                bufferlist::iterator bit = it->second.begin();
+                ::decode(fb_ent, bit);
+            } catch (const buffer::error &err) {
+                CLS_ERR("ERROR: decoding idx_fb_ent for fb=%u", seq);
+                return -EINVAL;
+            }
+            fbs.entries[seq] = fb_ent;
+        }
+        start_after = key_val_map.rbegin()->first;
+    }
+    fbs.loaded = true;
+    CLS_LOG(20, "load_fbs_index: loaded %lu fb entries", fbs.entries.size());
+    return 0;
+}
+
+static
+int
+add_idx_read(
+    cls_method_context_t hctx,
+    std::map<int, struct Tables::read_info>& idx_reads,
+    uint32_t fb_num,
+    uint32_t row_num,
+    fbs_index_cache& fbs) {
+
+    // our reads are indexed by fb_num, if this fb already has a read
+    // just add the specified row num for this record.
+    auto it = idx_reads.find(fb_num);
+    if (it != idx_reads.end()) {
+        it->second.rnums.push_back(row_num);
+        return 0;
+    }
+
+    // else lookup the corresponding flatbuf entry
+    int ret = load_fbs_index(hctx, fbs);
+    if (ret < 0)
+        return ret;
+    auto fb = fbs.entries.find(fb_num);
+    if (fb == fbs.entries.end()) {
+        CLS_LOG(20,"WARN: NO FB key ENTRY FOUND!! fb_num=%u", fb_num);
+        return 0;
+    }
+    std::vector<unsigned int> row_nums;
+    row_nums.push_back(row_num);
+    idx_reads[fb_num] = \
+        Tables::read_info(fb_num,
+                          fb->second.off,
+                          fb->second.len,
+                          row_nums);
+    return 0;
+}
+
 static
 int
 update_idx_reads(
     cls_method_context_t hctx,
     std::map<int, struct Tables::read_info>& idx_reads,
     bufferlist bl,
-    std::string key_fb_prefix,
-    std::string key_data_prefix) {
+    fbs_index_cache& fbs) {
 
     struct idx_rec_entry rec_ent;
-    int ret = 0;
     try {
         bufferlist::iterator it = bl.begin();
         ::decode(rec_ent, it);
@@ -562,118 +1413,28 @@ update_idx_reads(
         return -EINVAL;
     }
 
-    // keep track of the specified row num for this record
-    std::vector<unsigned int> row_nums;
-    row_nums.push_back(rec_ent.row_num);
-
-    // now build the key to lookup the corresponding flatbuf entry
-    std::string key_data = Tables::buildKeyData(Tables::SDT_INT32, rec_ent.fb_num);
-    std::string key = key_fb_prefix + key_data;
-    struct idx_fb_entry fb_ent;
-    bufferlist bl1;
-    ret = cls_cxx_map_get_val(hctx, key, &bl1);
-
-    if (ret < 0) {
-        if (ret == -ENOENT) {
-            CLS_LOG(20,"WARN: NO FB key ENTRY FOUND!! ret=%d", ret);
-        }
-        else {
-            CLS_ERR("cant read map val index for idx_fb_key, %d", ret);
-            return ret;
-        }
-    }
-
-    if (ret >= 0) {
-        try {
-            bufferlist::iterator it = bl1.begin();
-            ::decode(fb_ent, it);
-        } catch (const buffer::error &err) {
-            CLS_ERR("ERROR: decoding query idx_fb_ent");
-            return -EINVAL;
-        }
-
-        // our reads are indexed by fb_num
-        // either add these row nums to the existing read_info
-        // struct for the given fb_num, or create a new one
-        auto it = idx_reads.find(rec_ent.fb_num);
-        if (it != idx_reads.end()) {
-            it->second.rnums.insert(it->second.rnums.end(),
-                                    row_nums.begin(),
-                                    row_nums.end());
-        }
-        else {
-            idx_reads[rec_ent.fb_num] = \
-            Tables::read_info(rec_ent.fb_num,
-                              fb_ent.off,
-                              fb_ent.len,
-                              row_nums);
-        }
-    }
-    return 0;
+    return add_idx_read(hctx, idx_reads, rec_ent.fb_num, rec_ent.row_num, fbs);
 }
 
 /*
- * Lookup matching records in omap, based on the index specified and the
- * index predicates.  Set the idx_reads info vector with the corresponding
- * flatbuf off/len and row numbers for each matching record.
+ * Set the reads info vector with the flatbuf off/len for each fb in the
+ * obj, from the fb index.
  */
 static
 int
 read_fbs_index(
     cls_method_context_t hctx,
-    std::string key_fb_prefix,
+    fbs_index_cache& fbs,
     std::map<int, struct Tables::read_info>& reads)
 {
-
-    using namespace Tables;
-    int ret = 0;
-
-    unsigned int seq_min = Tables::DATASTRUCT_SEQ_NUM_MIN;
-    unsigned int seq_max = Tables::DATASTRUCT_SEQ_NUM_MIN;
-
-    // get the actual max fb seq number
-    ret = get_fb_seq_num(hctx, seq_max);
-    if (ret < 0) {
-        CLS_ERR("error getting fb_seq_num entry from xattr %d", ret);
+    int ret = load_fbs_index(hctx, fbs);
+    if (ret < 0)
         return ret;
-    }
-
-    // fb seq num grow monotically, so try to read each key
-    for (unsigned int i = seq_min; i <= seq_max; i++) {
-
-        // create key for this seq num.
-        std::string key_data = Tables::buildKeyData(Tables::SDT_INT32, i);
-        std::string key = key_fb_prefix + key_data;
-
-        bufferlist bl;
-        ret = cls_cxx_map_get_val(hctx, key, &bl);
-
-        // a seq_num may not be present due to fb deleted/compaction
-        // if key not found, just continue (this is not an error)
-        if (ret < 0 ) {
-            if (ret == -ENOENT) {
-                // CLS_LOG(20, "omap entry NOT found for key=%s", key.c_str());
-                continue;
-            }
-            else {
-                CLS_ERR("Cannot read omap entry for key=%s", key.c_str());
-                return ret;
-            }
-        }
 
-        // key found so decode the entry and set the read vals.
-        if (ret >= 0) {
-            // CLS_LOG(20, "omap entry found for key=%s", key.c_str());
-            struct idx_fb_entry fb_ent;
-            try {
-                bufferlist::iterator it = bl.begin();
-                ::decode(fb_ent, it);
-            } catch (const buffer::error &err) {
-                CLS_ERR("ERROR: decoding idx_fb_ent for key=%s", key.c_str());
-                return -EINVAL;
-            }
-            reads[i] = Tables::read_info(i, fb_ent.off, fb_ent.len, {});
-        }
+    // a seq_num may not be present due to fb deleted/compaction
+    for (auto it = fbs.entries.begin(); it != fbs.entries.end(); ++it) {
+        const int i = it->first;
+        reads[i] = Tables::read_info(i, it->second.off, it->second.len, {});
     }
     return 0;
 }
@@ -683,18 +1444,17 @@ read_fbs_index(
 
 /*
     Check for index existence, always used before trying to perform index reads
-    We check omap for the presence of the base key (prefix only), which is used
-    to indicate the index exists.
-    Note that even if key does exists, key_val_map will be empty since there is
-    no associated record data for this key.
+    We check omap for the presence of the marker key (the index name), which is
+    used to indicate the index exists and holds the index id, from which the
+    caller builds the prefix of the index keys.
 */
 static
 bool
-sky_index_exists (cls_method_context_t hctx, std::string key_prefix)
+sky_index_exists (cls_method_context_t hctx, std::string idx_name,
+                  std::string* key_prefix = nullptr)
 {
-    std::map<std::string, bufferlist> key_val_map;
-    bufferlist dummy_bl;
-    int ret = cls_cxx_map_get_val(hctx, key_prefix, &dummy_bl);
+    uint32_t idx_id = 0;
+    int ret = get_sky_index_id(hctx, idx_name, idx_id);
     if (ret < 0 && ret != -ENOENT ) {
         CLS_ERR("Cannot read idx_rec entry for key, errorcode=%d", ret);
         return false;
@@ -704,6 +1464,8 @@ sky_index_exists (cls_method_context_t hctx, std::string key_prefix)
     if (ret == -ENOENT)
         return false;
 
+    if (key_prefix)
+        *key_prefix = Tables::buildIndexKeyPrefix(idx_id);
     return true;
 }
 
@@ -720,7 +1482,10 @@ bool
 use_sky_index(
         cls_method_context_t hctx,
         std::string index_prefix,
-        Tables::predicate_vec index_preds)
+        Tables::predicate_vec index_preds,
+        std::string db_schema,
+        std::string table_name,
+        Tables::schema_vec& data_schema)
 {
     // we assume to use by default, since the planner requested it.
     bool use_index = true;
@@ -736,23 +1501,325 @@ use_sky_index(
     // each predicate to see if it is expected to be highly selective.
     if (ret != -ENOENT) {
 
-        // TODO: this should be based on a cost model, not a fixed value.
+        // beyond this fraction of matching rows the index entry lookups and
+        // per fb reads cost more than a table scan.
         const float SELECTIVITY_HIGH_VAL = 0.10;
 
-        // for each pred, check the bl idx_stats struct and decide selectivity
+        // index preds are conjunctive, so assuming independent cols the
+        // expected selectivity is the product over each pred's estimate.
+        double expected_selectivity = 1.0;
+        bool have_estimate = false;
         for (auto it = index_preds.begin(); it != index_preds.end(); ++it) {
 
-            // TODO: compute this from the predicate value and stats struct
-            float expected_selectivity = 0.10;
-            if (expected_selectivity <= SELECTIVITY_HIGH_VAL)
-                use_index &= true;
-            else
-                use_index &= false;
+            // find the col stats computed by runstats, if any
+            std::string colname;
+            for (auto c = data_schema.begin(); c != data_schema.end(); ++c) {
+                if (c->idx == (*it)->colIdx())
+                    colname = c->name;
+            }
+            if (colname.empty())
+                continue;
+
+            bufferlist stats_bl;
+            std::string key = Tables::buildStatsKey(db_schema, table_name,
+                                                    colname);
+            if (cls_cxx_map_get_val(hctx, key, &stats_bl) < 0)
+                continue;
+
+            struct col_stats cs;
+            try {
+                bufferlist::iterator sit = stats_bl.begin();
+                ::decode(cs, sit);
+            } catch (const buffer::error &err) {
+                CLS_ERR("ERROR: decoding col_stats for key=%s", key.c_str());
+                continue;
+            }
+
+            double sel = Tables::estimateSelectivity(cs, *it);
+            if (sel < 0)
+                continue;
+            expected_selectivity *= sel;
+            have_estimate = true;
+        }
+
+        // without any stats we trust the planner's request
+        if (have_estimate) {
+            use_index = (expected_selectivity <= SELECTIVITY_HIGH_VAL);
+            CLS_LOG(20, "use_sky_index: expected_selectivity=%f use_index=%d",
+                    expected_selectivity, use_index);
         }
     }
     return use_index;
 }
 
+// called with each index entry found by an index scan
+typedef std::function<int(const std::string&, bufferlist&)> index_entry_fn;
+
+/*
+ * Scan the index entries with keys between lo and hi (empty for unbounded),
+ * keys that extend an inclusive bound (with more cols or the RID) are
+ * included.  Since keys are memcmp ordered, we start at lo and stop at the
+ * first key beyond hi or without key_prefix, so only matching entries are
+ * read.
+ */
+static
+int
+scan_sky_index(
+    cls_method_context_t hctx,
+    const std::string& key_prefix,
+    const std::string& lo,
+    bool lo_incl,
+    const std::string& hi,
+    bool hi_incl,
+    int idx_batch_size,
+    const index_entry_fn& visit) {
+
+    using namespace Tables;
+
+    // first the keys extending lo (if any), then all keys after them.
+    bool in_lo = !lo.empty();
+    std::string filter_prefix = in_lo ? lo : key_prefix;
+    std::string start_after;
+    while (true) {
+        std::map<std::string, bufferlist> key_val_map;
+        bool more = false;
+        int ret = cls_cxx_map_get_vals(hctx, start_after, filter_prefix,
+                                       idx_batch_size, &key_val_map, &more);
+        if (ret < 0 && ret != -ENOENT) {
+            CLS_ERR("cant read map val index rec for idx_rec key %d", ret);
+            return ret;
+        }
+
+        for (auto it = key_val_map.cbegin(); it != key_val_map.cend(); ++it) {
+            const std::string& key = it->first;
+            start_after = key;
+
+            if (!hi.empty() and key >= hi and
+                !(hi_incl and keyHasPrefix(key, hi)))
+                return 0;
+
+            // skip equality entries in gt query
+            if (in_lo and !lo_incl)
+                continue;
+
+            bufferlist val = it->second;
+            ret = visit(key, val);
+            if (ret < 0)
+                return ret;
+        }
+        if (more and !key_val_map.empty())
+            continue;
+
+        // equality query or no more keys in the range
+        if (!in_lo or lo == key_prefix or (lo_incl and hi_incl and lo == hi))
+            break;
+        in_lo = false;
+        filter_prefix = key_prefix;
+        if (start_after.empty())
+            start_after = lo;
+    }
+    return 0;
+}
+
+typedef std::pair<uint32_t, uint32_t> txt_row;  // fb_num, row_num
+
+/*
+ * Collect the word positions within each row containing the word, from the
+ * text index entries keyed by the word.
+ */
+static
+int
+read_txt_postings(
+    cls_method_context_t hctx,
+    const std::string& key_data_prefix,
+    const std::string& word,
+    int idx_batch_size,
+    std::map<txt_row, std::vector<uint32_t>>& postings) {
+
+    std::string word_prefix = key_data_prefix;
+    Tables::keyEncodeString(word_prefix, word.data(), word.size());
+    std::string start_after;
+    bool more = true;
+    while (more) {
+        std::map<std::string, bufferlist> key_val_map;
+        int ret = cls_cxx_map_get_vals(hctx, start_after, word_prefix,
+                                       idx_batch_size, &key_val_map, &more);
+        if (ret < 0 && ret != -ENOENT) {
+            CLS_ERR("cant read map val index txt for word key %d", ret);
+            return ret;
+        }
+        if (key_val_map.empty())
+            break;
+        for (auto it = key_val_map.begin(); it != key_val_map.end(); ++it) {
+            struct idx_txt_entry txt_ent;
+            try {
+                bufferlist::iterator bit = it->second.begin();
+                ::decode(txt_ent, bit);
+            } catch (const buffer::error &err) {
+                CLS_ERR("ERROR: decoding query idx_txt_ent");
+                return -EINVAL;
+            }
+            postings[std::make_pair(txt_ent.fb_num, txt_ent.row_num)].
+                push_back(txt_ent.wpos);
+        }
+        start_after = key_val_map.rbegin()->first;
+    }
+    return 0;
+}
+
+/*
+ * Find the rows matching one text search term, a single word or a phrase
+ * of words that must appear at consecutive positions within the row.
+ * Stopwords in a phrase only count for the word positions, since they may
+ * not be indexed.
+ */
+static
+int
+match_txt_phrase(
+    cls_method_context_t hctx,
+    const std::string& key_data_prefix,
+    const std::vector<std::string>& words,
+    int idx_batch_size,
+    std::set<txt_row>& rows) {
+
+    // candidate rows, with the positions where the phrase may start
+    std::map<txt_row, std::vector<uint32_t>> starts;
+    bool first = true;
+    for (unsigned i = 0; i < words.size(); i++) {
+        if (words.size() > 1 and Tables::IDX_STOPWORDS.count(words[i]) > 0)
+            continue;
+
+        std::map<txt_row, std::vector<uint32_t>> postings;
+        int ret = read_txt_postings(hctx, key_data_prefix, words[i],
+                                    idx_batch_size, postings);
+        if (ret < 0)
+            return ret;
+
+        if (first) {
+            for (auto it = postings.begin(); it != postings.end(); ++it) {
+                std::vector<uint32_t>& s = starts[it->first];
+                for (auto p = it->second.begin(); p != it->second.end(); ++p)
+                    if (*p >= i) s.push_back(*p - i);
+            }
+            first = false;
+        }
+        else {
+            for (auto it = starts.begin(); it != starts.end();) {
+                auto post = postings.find(it->first);
+                std::vector<uint32_t> keep;
+                if (post != postings.end()) {
+                    std::sort(post->second.begin(), post->second.end());
+                    for (auto p = it->second.begin(); p != it->second.end(); ++p)
+                        if (std::binary_search(post->second.begin(),
+                                               post->second.end(), *p + i))
+                            keep.push_back(*p);
+                }
+                if (keep.empty()) {
+                    it = starts.erase(it);
+                }
+                else {
+                    it->second.swap(keep);
+                    ++it;
+                }
+            }
+        }
+        if (starts.empty())
+            break;
+    }
+    for (auto it = starts.begin(); it != starts.end(); ++it) {
+        if (!it->second.empty())
+            rows.insert(it->first);
+    }
+    return 0;
+}
+
+/*
+ * Lookup matching rows in the text index.  Each index pred is an equality
+ * pred on the text col whose val is a search expr: terms separated by '|'
+ * match if any term matches (OR), and a term of several words is a phrase.
+ * Index preds are conjunctive (AND).  Words are matched in lower case, as
+ * they are indexed, and split into words by the delims the index was built
+ * with.
+ */
+static
+int
+read_txt_index(
+    cls_method_context_t hctx,
+    Tables::predicate_vec& index_preds,
+    fbs_index_cache& fbs,
+    const std::string& idx_name,
+    const std::string& key_data_prefix,
+    int idx_batch_size,
+    std::map<int, struct Tables::read_info>& idx_reads) {
+
+    using namespace Tables;
+    std::string text_delims = " \t\r\f\v\n";  // whitespace chars
+    idx_op txt_op;
+    int ret = get_sky_index_op(hctx, idx_name, txt_op);
+    if (ret == 0) {
+        if (!txt_op.idx_text_delims.empty())
+            text_delims = txt_op.idx_text_delims;
+    }
+    else if (ret != -ENOENT) {
+        CLS_ERR("read_txt_index: reading index op %s ret=%d",
+                idx_name.c_str(), ret);
+        return ret;
+    }
+
+    std::set<txt_row> rows;
+    bool first = true;
+    for (auto p = index_preds.begin(); p != index_preds.end(); ++p) {
+        if ((*p)->opType() != SOT_eq or (*p)->colType() != SDT_STRING) {
+            CLS_ERR("read_txt_index: unsupported text pred op=%d",
+                    (*p)->opType());
+            return -EOPNOTSUPP;
+        }
+        std::string expr = \
+            dynamic_cast<TypedPredicate<std::string>*>(*p)->Val();
+        boost::algorithm::to_lower(expr);
+
+        // OR over the terms of this pred
+        std::set<txt_row> pred_rows;
+        std::vector<std::string> terms;
+        boost::split(terms, expr, boost::is_any_of("|"));
+        for (auto t = terms.begin(); t != terms.end(); ++t) {
+            boost::trim(*t);
+            if (t->empty())
+                continue;
+            std::vector<std::string> words;
+            boost::split(words, *t, boost::is_any_of(text_delims),
+                         boost::token_compress_on);
+            ret = match_txt_phrase(hctx, key_data_prefix, words,
+                                   idx_batch_size, pred_rows);
+            if (ret < 0)
+                return ret;
+        }
+
+        // AND over the preds
+        if (first) {
+            rows.swap(pred_rows);
+            first = false;
+        }
+        else {
+            std::set<txt_row> both;
+            std::set_intersection(rows.begin(), rows.end(),
+                                  pred_rows.begin(), pred_rows.end(),
+                                  std::inserter(both, both.begin()));
+            rows.swap(both);
+        }
+        if (rows.empty())
+            break;
+    }
+
+    // rows are in fb order then row order
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        ret = add_idx_read(hctx, idx_reads, it->first, it->second, fbs);
+        if (ret < 0)
+            return ret;
+    }
+    return 0;
+}
+
 /*
  * Lookup matching records in omap, based on the index specified and the
  * index predicates.  Set the idx_reads info vector with the corresponding
@@ -764,188 +1831,223 @@ int
 read_sky_index(
     cls_method_context_t hctx,
     Tables::predicate_vec index_preds,
-    std::string key_fb_prefix,
+    Tables::schema_vec& index_schema,
+    fbs_index_cache& fbs,
+    const std::string& idx_name,
     std::string key_data_prefix,
     int index_type,
     int idx_batch_size,
-    std::map<int, struct Tables::read_info>& idx_reads) {
+    std::map<int, struct Tables::read_info>& idx_reads,
+    Tables::predicate_vec& residual_preds,
+    const index_entry_fn* visit = nullptr) {
 
     using namespace Tables;
-    int ret = 0, ret2 = 0;
-    std::vector<std::string> keys;   // to contain all keys found after lookups
+    int ret = 0;
+
+    if (index_type == SIT_IDX_TXT)
+        return read_txt_index(hctx, index_preds, fbs, idx_name,
+                              key_data_prefix, idx_batch_size, idx_reads);
 
     // for each fb_seq_num, a corresponding read_info struct to
     // indicate the relevant rows within a given fb.
     // fb_seq_num is used as key, so that subsequent reads will always be from
     // a higher byte offset, if that matters.
 
-    // build up the key data portion from the idx pred vals.
-    // assumes all indexes here are integers, we extract the predicate vals
-    // as ints and use our uint to padded string method to build the keys
-    std::string key_data;
-    for (unsigned i = 0; i < index_preds.size(); i++) {
-        uint64_t val = 0;
-
-        switch (index_preds[i]->colType()) {
-            case SDT_INT8:
-            case SDT_INT16:
-            case SDT_INT32:
-            case SDT_INT64: {  // TODO: support signed ints in index ranges
-                int64_t v = 0;
-                extract_typedpred_val(index_preds[i], v);
-                val = static_cast<uint64_t>(v);  // force to unsigned for now.
-                break;
-            }
-            case SDT_UINT8:
-            case SDT_UINT16:
-            case SDT_UINT32:
-            case SDT_UINT64: {
-                extract_typedpred_val(index_preds[i], val);
-                break;
+    // build the key bounds from the idx pred vals, encoded the same as the
+    // col vals of the index keys.  As for any composite key, the bounds
+    // can use an equality pred on each leading index col and then the range
+    // preds on the next col, the remaining preds are returned as residual
+    // preds to be applied to the matching rows.
+    std::string prefix = key_data_prefix;
+    std::vector<bool> used(index_preds.size(), false);
+    std::string lo, hi;
+    bool lo_incl = true, hi_incl = true;
+    for (auto c = index_schema.begin(); c != index_schema.end(); ++c) {
+
+        // extend the prefix with an equality pred on this col
+        int eq = -1;
+        for (unsigned i = 0; i < index_preds.size() and eq < 0; i++) {
+            if (index_preds[i]->colIdx() == c->idx and
+                index_preds[i]->opType() == SOT_eq)
+                eq = i;
+        }
+        if (eq >= 0) {
+            ret = keyEncodePredVal(prefix, index_preds[eq]);
+            if (ret) {
+                CLS_ERR("read_sky_index: unsupported pred col type=%d",
+                        index_preds[eq]->colType());
+                return -EOPNOTSUPP;
             }
-            default:
-                assert (BuildSkyIndexUnsupportedColType==0);
+            used[eq] = true;
+            continue;
         }
 
-        if (i > 0)  // add delim for multicol index vals
-            key_data += IDX_KEY_DELIM_INNER;
-        key_data += buildKeyData(index_preds[i]->colType(), val);
-    }
-    std::string key = key_data_prefix + key_data;
-
-    // Add base key when all index predicates include equality
-    if (check_predicate_ops_all_include_equality(index_preds)) {
-        keys.push_back(key);
-    }
-
-    // Find the starting key for range query keys:
-    // 1. Greater than predicates we start after the base key,
-    // 2. Less than predicates we start after the prefix of the base key.
-    std::string start_after = "";
-    if (check_predicate_ops(index_preds, SOT_geq) or
-        check_predicate_ops(index_preds, SOT_gt)) {
-
-        start_after = key;
-    }
-    else if (check_predicate_ops(index_preds, SOT_lt) or
-             check_predicate_ops(index_preds, SOT_leq)) {
-
-        start_after = key_data_prefix;
-    }
-
-    // Get keys in batches at a time and print row number/ offset detail
-    // Equality query does not loop  TODO: this is not true for non-unique idx!
-    bool stop = false;
-    if (start_after.empty()) stop = true;
+        // else keep the tightest range bounds on this col, and stop
+        for (unsigned i = 0; i < index_preds.size(); i++) {
+            const int op = index_preds[i]->opType();
+            if (index_preds[i]->colIdx() != c->idx or
+                !(op == SOT_gt or op == SOT_geq or
+                  op == SOT_lt or op == SOT_leq))
+                continue;
 
-    // Retrieve keys for range queries in batches of "max_to_get"
-    // until no more keys
-    bool more = true;
-    int max_to_get = idx_batch_size;
-    std::map<std::string, bufferlist> key_val_map;
-    while(!stop) {
-        ret2 = cls_cxx_map_get_vals(hctx, start_after, string(),
-                                    max_to_get, &key_val_map, &more);
-
-        if (ret2 < 0 && ret2 != -ENOENT ) {
-            CLS_ERR("cant read map val index rec for idx_rec key %d", ret2);
-            return ret2;
+            std::string key = prefix;
+            ret = keyEncodePredVal(key, index_preds[i]);
+            if (ret) {
+                CLS_ERR("read_sky_index: unsupported pred col type=%d",
+                        index_preds[i]->colType());
+                return -EOPNOTSUPP;
+            }
+            used[i] = true;
+            const bool incl = (op == SOT_geq or op == SOT_leq);
+            if (op == SOT_gt or op == SOT_geq) {
+                if (lo.empty() or key > lo or (key == lo and !incl)) {
+                    lo = key;
+                    lo_incl = incl;
+                }
+            }
+            else {
+                if (hi.empty() or key < hi or (key == hi and !incl)) {
+                    hi = key;
+                    hi_incl = incl;
+                }
+            }
         }
+        break;
+    }
 
-        // If no more entries found break out of the loop
-        if (ret2 == -ENOENT || key_val_map.size() == 0) {
-            break;
-        }
+    // an open range is bounded by the equality prefix
+    if (lo.empty()) {
+        lo = prefix;
+        lo_incl = true;
+    }
+    if (hi.empty()) {
+        hi = prefix;
+        hi_incl = true;
+    }
 
-        if (ret2 >= 0) {
-            try {
-                for (auto it = key_val_map.cbegin();
-                          it != key_val_map.cend(); it++) {
-                    const std::string& key1 = it->first;
-                    bufferlist record_bl_entry = it->second;
-
-                    // Break if keyprefix in fetched key does not match that
-                    // passed by user, means we have gone too far, possibly
-                    // into keys for another index.
-                    if (key1.find(key_data_prefix) == std::string::npos) {
-                        stop = true;
-                        break;
-                    }
+    for (unsigned i = 0; i < index_preds.size(); i++) {
+        if (!used[i])
+            residual_preds.push_back(index_preds[i]);
+    }
 
-                    // If this is the last key, update start_after value
-                    if (std::next(it, 1) == key_val_map.cend()) {
-                        start_after = key1;
-                    }
+    // by default, set the idx_reads info vector with the corresponding
+    // flatbuf off/len and row numbers for each matching record
+    index_entry_fn add_reads = [&](const std::string& key, bufferlist& val) {
+        return update_idx_reads(hctx, idx_reads, val, fbs);
+    };
+    return scan_sky_index(hctx, prefix,
+                          lo, lo_incl, hi, hi_incl,
+                          idx_batch_size, visit ? *visit : add_reads);
+}
 
-                    // break if key matches or exceeds key passed by the user
-                    // prevents going into the next index (next key prefix)
-                    if (check_predicate_ops(index_preds, SOT_lt) or
-                        check_predicate_ops(index_preds, SOT_leq)) {
-                        //~ if(key_val_map.find(key) != key_val_map.end()) {
-                            //~ stop = true;
-                            //~ break;
-                        //~ }
-                        if (key1 == key) {   /// TODO: is this  extra check needed?
-                            stop = true;
-                            break;
-                        }
-                        else if (key1 > key) {  // Special handling for leq
-                            if (check_predicate_ops(index_preds, SOT_leq) and
-                                compare_keys(key, key1)) {
-                                stop = false;
-                            }
-                            else {
-                                stop = true;
-                                break;
-                            }
-                        }
-                    }
+/*
+ * Check if an index holds all of the cols a query needs, i.e., its projected,
+ * pred and group by cols are all index key cols, so the query can be answered
+ * from the index keys without reading any fbs.  Count aggs need no col vals.
+ * Nullable key cols are not covered, since nulls are not in the keys.
+ */
+static
+bool
+index_covers_query(
+    Tables::schema_vec& index_schema,
+    Tables::schema_vec& query_schema,
+    Tables::predicate_vec& query_preds,
+    Tables::schema_vec& groupby_schema)
+{
+    using namespace Tables;
+    auto is_key_col = [&](int idx) {
+        for (auto it = index_schema.begin(); it != index_schema.end(); ++it)
+            if (it->idx == idx) return true;
+        return false;
+    };
+    // a null key col is indexed as its placeholder val
+    for (auto it = index_schema.begin(); it != index_schema.end(); ++it) {
+        if (it->nullable)
+            return false;
+    }
+    for (auto it = query_schema.begin(); it != query_schema.end(); ++it) {
+        bool agg_col = it->idx >= AGG_COL_LAST and it->idx <= AGG_COL_FIRST;
+        if (!agg_col and !is_key_col(it->idx))
+            return false;
+    }
+    for (auto it = query_preds.begin(); it != query_preds.end(); ++it) {
+        if ((*it)->isGlobalAgg() and (*it)->opType() == SOT_cnt)
+            continue;
+        if ((*it)->colIdx() != RID_COL_INDEX and !is_key_col((*it)->colIdx()))
+            return false;
+    }
+    for (auto it = groupby_schema.begin(); it != groupby_schema.end(); ++it) {
+        if (!is_key_col(it->idx))
+            return false;
+    }
+    return true;
+}
 
-                    // Skip equality entries in geq query
-                    if (check_predicate_ops(index_preds, SOT_gt) and
-                        compare_keys(key, key1)) {
-                        continue;
-                    }
+/*
+ * Process-wide pool of MAX_QUERY_THREADS workers shared by all query ops,
+ * started on first use, so concurrent ops never add threads to the OSD.
+ * A query op runs the fbs of a batch itself and submits helper jobs that
+ * claim fbs of the same batch, so it makes progress even if the pool is
+ * busy with other ops.  The pool is never destroyed, its threads live as
+ * long as the OSD.
+ */
+class QueryWorkerPool
+{
+public:
+    static QueryWorkerPool& instance() {
+        static QueryWorkerPool* pool = new QueryWorkerPool();
+        return *pool;
+    }
 
-                    // Set the idx_reads info vector with the corresponding
-                    // flatbuf off/len and row numbers for each matching record
-                    ret2 = update_idx_reads(hctx, idx_reads, record_bl_entry,
-                                            key_fb_prefix, key_data_prefix);
-                    if(ret2 < 0)
-                        return ret2;
-                }
-            } catch (const buffer::error &err) {
-                    CLS_ERR("ERROR: decoding query idx_rec_ent");
-                    return -EINVAL;
-            }
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> l(lock);
+            jobs.push_back(std::move(job));
         }
+        cond.notify_one();
     }
 
+private:
+    QueryWorkerPool() {
+        for (int i = 0; i < MAX_QUERY_THREADS; i++)
+            std::thread(&QueryWorkerPool::run, this).detach();
+    }
 
-    // lookup key in omap to get the row offset
-    if (!keys.empty()) {
-        for (unsigned i = 0; i < keys.size(); i++) {
-            bufferlist record_bl_entry;
-            ret = cls_cxx_map_get_val(hctx, keys[i], &record_bl_entry);
-            if (ret < 0 && ret != -ENOENT) {
-                CLS_ERR("cant read map val index rec for idx_rec key %d", ret);
-                return ret;
-            }
-            if (ret >= 0) {
-                ret2 = update_idx_reads(hctx,
-                                        idx_reads,
-                                        record_bl_entry,
-                                        key_fb_prefix,
-                                        key_data_prefix);
-                if (ret2 < 0)
-                    return ret2;
-            } else  {
-                // no rec found for key
+    void run() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> l(lock);
+                cond.wait(l, [this] { return !jobs.empty(); });
+                job = std::move(jobs.front());
+                jobs.pop_front();
             }
+            job();
         }
     }
-    return 0;
-}
+
+    std::mutex lock;
+    std::condition_variable cond;
+    std::deque<std::function<void()>> jobs;
+};
+
+// A batch of fbs of one query op, processed by the op thread and any pool
+// workers.  Helper jobs hold a ref, since they may only start once the op
+// has moved on, in which case there is nothing left for them to claim.
+struct fb_batch {
+    std::vector<bufferlist> fbs;
+    std::vector<std::vector<unsigned int>> rnums;
+    std::vector<bufferlist> results;
+    std::vector<uint64_t> nrows;
+    std::vector<int> rets;
+    uint64_t nbytes;
+    std::atomic<size_t> next;
+    size_t done;
+    std::mutex lock;
+    std::condition_variable cond;
+
+    fb_batch() : nbytes(0), next(0), done(0) {}
+};
 
 /*
  * Primary method to process queries (new:flatbufs, old:q_a thru q_f)
@@ -981,9 +2083,16 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
         bool use_index1 = false;
         bool use_index2 = false;
         std::map<int, struct read_info> reads;
+        bool stream_scan = false;
         std::map<int, struct read_info> idx1_reads;
         std::map<int, struct read_info> idx2_reads;
 
+        // index only plan, the matching keys of index1 replace the fb reads
+        bool index_only = false;
+        index_key_vec idx_keys;
+        size_t idx_key_prefix_len = 0;
+        schema_vec idx_key_schema;
+
         // fastpath means we skip processing rows and just return all rows,
         // i.e., the entire obj
         // NOTE: fastpath will not increment rows_processed since we do nothing
@@ -1008,16 +2117,33 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
             schema_vec query_schema = schemaFromString(op.query_schema);
 
             // predicates to be applied, if any
-            predicate_vec query_preds = predsFromString(data_schema,
-                                                        op.query_preds);
+            predicate_vec query_preds;
+            ret = predsFromString(data_schema, op.query_preds, query_preds);
+            if (ret != 0) {
+                CLS_ERR("ERROR: exec_query_op: invalid query preds %s",
+                        op.query_preds.c_str());
+                return -EINVAL;
+            }
+
+            // group by cols, if any, partial aggs per group are accumulated
+            // over all fbs and returned as a single fb for the client to merge
+            schema_vec groupby_schema = schemaFromString(op.groupby_schema);
+            const bool group_by = useGroupBy(groupby_schema, query_preds);
+            agg_groups groups;
 
             // required for index plan or scan plan if index plan not chosen.
             predicate_vec index_preds;
             predicate_vec index2_preds;
 
-            std::string key_fb_prefix = buildKeyPrefix(SIT_IDX_FB,
-                                                       op.db_schema,
-                                                       op.table_name);
+            // the fb index keys prefix, empty if there is no fb index,
+            // its entries are loaded once when first needed.
+            std::string key_fb_prefix;
+            sky_index_exists(hctx,
+                             buildKeyPrefix(SIT_IDX_FB,
+                                            op.db_schema,
+                                            op.table_name),
+                             &key_fb_prefix);
+            fbs_index_cache fbs(key_fb_prefix);
             // lookup correct flatbuf and potentially set specific row nums
             // to be processed next in processFb()
             if (op.index_read) {
@@ -1026,79 +2152,136 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
                 schema_vec index_schema = \
                         schemaFromString(op.index_schema);
 
-                index_preds = \
-                        predsFromString(data_schema, op.index_preds);
+                ret = predsFromString(data_schema, op.index_preds,
+                                      index_preds);
+                if (ret != 0) {
+                    CLS_ERR("ERROR: exec_query_op: invalid index preds %s",
+                            op.index_preds.c_str());
+                    return -EINVAL;
+                }
 
                 std::vector<std::string> index_cols = \
                         colnamesFromSchema(index_schema);
 
-                std::string key_data_prefix = \
+                std::string idx_name = \
                         buildKeyPrefix(op.index_type,
                                        op.db_schema,
                                        op.table_name,
                                        index_cols);
+                std::string key_data_prefix;
 
                 // get info for index2
                 schema_vec index2_schema = \
                         schemaFromString(op.index2_schema);
-                index2_preds = \
-                        predsFromString(data_schema, op.index2_preds);
+                ret = predsFromString(data_schema, op.index2_preds,
+                                      index2_preds);
+                if (ret != 0) {
+                    CLS_ERR("ERROR: exec_query_op: invalid index2 preds %s",
+                            op.index2_preds.c_str());
+                    return -EINVAL;
+                }
 
                 std::vector<std::string> index2_cols = \
                         colnamesFromSchema(index2_schema);
 
-                std::string key2_data_prefix = \
+                std::string idx2_name = \
                         buildKeyPrefix(op.index2_type,
                                        op.db_schema,
                                        op.table_name,
                                        index2_cols);
+                std::string key2_data_prefix;
 
                 // verify if index1 is present in omap
                 index1_exists = sky_index_exists(hctx,
-                                                 key_data_prefix);
+                                                 idx_name,
+                                                 &key_data_prefix);
+
+                // text search preds are only defined over the text index
+                if (op.index_type == SIT_IDX_TXT and !index1_exists) {
+                    CLS_ERR("ERROR: exec_query_op: no text index %s",
+                            idx_name.c_str());
+                    return -ENOENT;
+                }
 
                 // check local statistics, decide to use or not.
-                if (index1_exists)
+                // col stats do not apply to text search terms.
+                if (op.index_type == SIT_IDX_TXT)
+                    use_index1 = index1_exists;
+                else if (index1_exists)
                     use_index1 = use_sky_index(hctx,
-                                               key_data_prefix,
-                                               index_preds);
+                                               idx_name,
+                                               index_preds,
+                                               op.db_schema,
+                                               op.table_name,
+                                               data_schema);
 
                 if (use_index1) {
 
-                    // check for case of multicol index but not all equality.
-                    if (index_cols.size() > 1 and
-                        !check_predicate_ops_all_equality(index_preds)) {
-
-                        // NOTE: mutlicol indexes only support range queries
-                        // over first col (but all cols for equality queries)
-                        // so to preserve correctness, here we (redundantly)
-                        // add all of the index preds to the query preds
-                        // to preserve correctness but we do not remove the
-                        // extra non-equality preds from the index preds
-                        // since in the future index queries will support
-                        // ranges on multicols.
-
-                        query_preds.reserve(query_preds.size() +
-                                            index_preds.size());
-                        for (unsigned i = 0; i < index_preds.size(); i++) {
-                            query_preds.push_back(index_preds[i]);
+                    // index lookup to set the read requests, if any rows match
+                    // index preds not covered by the key bounds (i.e., after
+                    // the first range col of a multicol index) are returned
+                    // as residual preds and applied as query preds.
+                    predicate_vec residual_preds;
+
+                    // if the index keys hold every col the query needs, we
+                    // answer it from the keys (an index only plan) instead
+                    // of reading the fbs.  the keys are in the row layout
+                    // the index was built from.  the keys carry neither
+                    // deleted flags nor nulls, so the index must hold only
+                    // live rows and its key cols cannot be nullable.
+                    int fmt = SFT_FLATBUF_FLEX_ROW;
+                    int fmt_ret = get_sky_format_type(hctx, fmt);
+                    idx_op idx1_op;
+                    bool idx1_live_rows = \
+                        (get_sky_index_op(hctx, idx_name, idx1_op) == 0 and
+                         idx1_op.idx_live_rows);
+                    index_only = (op.index_type == SIT_IDX_REC and
+                                  idx1_live_rows and
+                                  op.index_plan_type == SIP_IDX_STANDARD and
+                                  (fmt_ret >= 0 or fmt_ret == -ENOENT or
+                                   fmt_ret == -ENODATA) and
+                                  fmt == SFT_FLATBUF_FLEX_ROW and
+                                  index_covers_query(index_schema,
+                                                     query_schema,
+                                                     query_preds,
+                                                     groupby_schema));
+                    index_entry_fn add_key = [&](const std::string& key,
+                                                 bufferlist& val) {
+                        struct idx_rec_entry rec_ent;
+                        try {
+                            bufferlist::iterator it = val.begin();
+                            ::decode(rec_ent, it);
+                        } catch (const buffer::error &err) {
+                            CLS_ERR("ERROR: decoding query idx_rec_ent");
+                            return -EINVAL;
                         }
+                        idx_keys.push_back(std::make_pair(key, rec_ent.rid));
+                        return 0;
+                    };
+                    if (index_only) {
+                        idx_key_prefix_len = key_data_prefix.size();
+                        for (auto it = index_schema.begin();
+                                  it != index_schema.end(); ++it)
+                            idx_key_schema.push_back(*it);
                     }
 
-                    // index lookup to set the read requests, if any rows match
                     ret = read_sky_index(hctx,
                                          index_preds,
-                                         key_fb_prefix,
+                                         index_schema,
+                                         fbs,
+                                         idx_name,
                                          key_data_prefix,
                                          op.index_type,
                                          op.index_batch_size,
-                                         idx1_reads);
+                                         idx1_reads,
+                                         residual_preds,
+                                         index_only ? &add_key : nullptr);
                     if (ret < 0) {
                         CLS_ERR("ERROR: do_index_lookup failed. %d", ret);
                         return ret;
                     }
                     CLS_LOG(20, "exec_query_op: index1 found %lu entries",
-                            idx1_reads.size());
+                            index_only ? idx_keys.size() : idx1_reads.size());
 
                     reads = idx1_reads;  // populate with reads from index1
 
@@ -1114,35 +2297,31 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
 
                         // verify if index2 is present in omap
                         index2_exists = sky_index_exists(hctx,
-                                                         key2_data_prefix);
+                                                         idx2_name,
+                                                         &key2_data_prefix);
 
                         // check local statistics, decide to use or not.
                         if (index2_exists)
                             use_index2 &= use_sky_index(hctx,
-                                                        key2_data_prefix,
-                                                        index2_preds);
+                                                        idx2_name,
+                                                        index2_preds,
+                                                        op.db_schema,
+                                                        op.table_name,
+                                                        data_schema);
 
                         if (use_index2) {
 
-                            // check for case of multicol index but not all equality.
-                            if (index2_cols.size() > 1 and
-                                !check_predicate_ops_all_equality(index2_preds)) {
-
-                                // NOTE: same reasoning as above for index1_preds
-                                query_preds.reserve(query_preds.size() +
-                                                    index2_preds.size());
-                                for (unsigned i = 0; i < index2_preds.size(); i++) {
-                                    query_preds.push_back(index2_preds[i]);
-                                }
-                            }
-
+                            // NOTE: same residual preds as above for index1
                             ret = read_sky_index(hctx,
                                                  index2_preds,
-                                                 key_fb_prefix,
+                                                 index2_schema,
+                                                 fbs,
+                                                 idx2_name,
                                                  key2_data_prefix,
                                                  op.index2_type,
                                                  op.index_batch_size,
-                                                 idx2_reads);
+                                                 idx2_reads,
+                                                 residual_preds);
                             if (ret < 0) {
                                 CLS_ERR("ERROR: do_index2_lookup failed. %d",
                                         ret);
@@ -1239,6 +2418,12 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
                         use_index1 = false;  // no index plan type specified.
                         use_index2 = false;  // no index plan type specified.
                     }
+
+                    if (use_index1) {
+                        query_preds.insert(query_preds.end(),
+                                           residual_preds.begin(),
+                                           residual_preds.end());
+                    }
                 }  // end if (use_index1)
             }
 
@@ -1300,24 +2485,79 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
                 // default, assume we have plenty of mem avail.
                 bool read_full_object = true;
 
-                if (op.mem_constrain) {
+                // the fb index entries also hold per fb zone maps and
+                // optional bloom filters, which can rule out fbs that have
+                // no rows matching query_preds.
+                bool zone_prune = zoneMapsApplicable(query_preds);
+
+                // a limit may be met before the last fb, so read per fb.
+                bool fb_reads = op.mem_constrain or
+                                (op.limit > 0 and op.orderby_schema.empty());
+
+                if (fb_reads or zone_prune) {
 
                     // try to set the reads[] with the fb sequence
-                    int ret = read_fbs_index(hctx, key_fb_prefix, reads);
+                    int ret = read_fbs_index(hctx, fbs, reads);
 
                     if (reads.empty())
                         CLS_LOG(20,
                             "exec_query_op: WARN: No FBs index entries found.");
 
+                    // fbs appended after the index was built have no entry,
+                    // so only trust the fb sequence if it covers the object.
+                    uint64_t obj_size = 0;
+                    uint64_t fbs_end = 0;
+                    for (auto it = reads.begin(); it != reads.end(); ++it) {
+                        fbs_end = std::max(fbs_end,
+                            static_cast<uint64_t>(it->second.off) +
+                            it->second.len);
+                    }
+                    if (ret >= 0 and !reads.empty()) {
+                        ret = cls_cxx_stat(hctx, &obj_size, NULL);
+                        if (ret < 0 or fbs_end < obj_size) {
+                            CLS_LOG(20, "exec_query_op: WARN: FBs index "
+                                        "does not cover the object.");
+                            reads.clear();
+                        }
+                    }
+
                     // if we found the fb sequence of offsets, then we
                     // no longer need to read the full object.
-                    if (ret >= 0 and !reads.empty())
-                        read_full_object = false;
+                    if (ret >= 0 and !reads.empty()) {
+                        size_t nfbs = reads.size();
+                        if (zone_prune) {
+                            for (auto it = reads.begin(); it != reads.end();) {
+                                auto e = fbs.entries.find(it->first);
+                                if (e != fbs.entries.end() and
+                                    (!zoneMapsMayMatch(e->second.zones,
+                                                       query_preds) or
+                                     !bloomFiltersMayMatch(e->second.blooms,
+                                                           query_preds)))
+                                    it = reads.erase(it);
+                                else
+                                    ++it;
+                            }
+                            CLS_LOG(20, "exec_query_op: zone maps and bloom "
+                                        "filters pruned %lu of %lu fbs",
+                                    nfbs - reads.size(), nfbs);
+                        }
+
+                        // without mem constraints or a limit, fb reads only
+                        // pay off if some fbs were skipped.
+                        if (fb_reads or reads.size() < nfbs)
+                            read_full_object = false;
+                        else
+                            reads.clear();
+                    }
                 }
 
-                // if we must read the full object, we set the reads[] to
-                // contain a single read, indicating the entire object.
-                if (read_full_object) {
+                // if we must read the full object, either stream it in
+                // bounded chunks if a mem cap was given, or set the reads[]
+                // to contain a single read, indicating the entire object.
+                if (read_full_object and op.scan_mem_cap > 0) {
+                    stream_scan = true;
+                }
+                else if (read_full_object) {
                     int fb_seq_num = Tables::DATASTRUCT_SEQ_NUM_MIN;
                     int off = 0;
                     int len = 0;
@@ -1327,12 +2567,423 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
                 }
             }
 
+            int format_type = 0;
+            ret = get_sky_format_type(hctx, format_type);
+            if (ret == -ENOENT || ret == -ENODATA) {
+                // If sky_format_type is not present then insert it in xattr.
+                // Default value is set as a Flatbuffer, unless the obj is a
+                // parquet file (e.g., as written by fbwriter)
+                format_type = is_parquet_obj(hctx) ? SFT_PARQUET :
+                                                     SFT_FLATBUF_FLEX_ROW;
+                ret = set_sky_format_type(hctx, format_type);
+                if(ret < 0) {
+                    CLS_ERR("exec_query_op: error setting sky_format_type entry to xattr %d", ret);
+                    return ret;
+                }
+            }
+            else if (ret < 0) {
+                CLS_ERR("ERROR: exec_query_op: sky_format_type entry from xattr %d", ret);
+                return ret;
+            }
+
+            // a limit without order by stops the scan once enough result
+            // rows are produced, with order by only the local top-k rows
+            // are returned for the client to merge.  neither applies to aggs.
+            schema_vec orderby_schema = schemaFromString(op.orderby_schema);
+            const bool row_results = !group_by and
+                                     !hasAggPreds(query_preds);
+            const bool top_k = row_results and op.limit > 0 and
+                               !orderby_schema.empty();
+            const bool early_stop = row_results and op.limit > 0 and
+                                    orderby_schema.empty() and
+                                    format_type != SFT_ARROW and
+                                    format_type != SFT_PARQUET;
+            uint64_t rows_out = 0;
+            auto limit_reached = [&]() {
+                return early_stop and rows_out >= op.limit;
+            };
+            topk_rows topk;
+            if (top_k) {
+                if (format_type != SFT_FLATBUF_FLEX_ROW) {
+                    CLS_ERR("ERROR: order by requires flatbuf row format");
+                    return -EINVAL;
+                }
+                topk = topk_rows(op.limit, orderby_schema[0].idx,
+                                 orderby_schema[0].type, op.orderby_desc);
+            }
+
+            // process a single decoded bl (1 bl contains exactly 1 flatbuf
+            // or arrow table) into ans, counting the rows processed.
+            // NOTE: only touches its args and read-only query state, so it
+            // may run concurrently for different bls unless preds have aggs.
+            auto process_fb = [&](bufferlist& bl,
+                                  std::vector<unsigned int>& row_nums,
+                                  bufferlist& ans,
+                                  uint64_t& nrows) -> int {
+                int ret = 0;
+
+                // get our data as contiguous bytes before accessing as flatbuf
+                const char* data = bl.c_str();
+                size_t data_size = bl.length();
+                std::string errmsg;
+
+                if (format_type == SFT_ARROW) {
+                    std::shared_ptr<arrow::Table> table;
+                    uint64_t in_rows = 0;
+                    ret = processArrow(&table,
+                                       data_schema,
+                                       query_schema,
+                                       query_preds,
+                                       data,
+                                       data_size,
+                                       errmsg,
+                                       row_nums,
+                                       &in_rows);
+                    if (ret != 0) {
+                        CLS_ERR("ERROR: processing arrow, %s", errmsg.c_str());
+                        CLS_ERR("ERROR: TablesErrCodes::%d", ret);
+                        return -1;
+                    }
+                    nrows += op.index_read ? row_nums.size() : in_rows;
+
+                    // return the processed table as an arrow ipc stream
+                    std::shared_ptr<arrow::Buffer> buffer;
+                    ret = convert_arrow_to_buffer(table, &buffer);
+                    if (ret != 0) {
+                        CLS_ERR("ERROR: converting arrow table to buffer");
+                        CLS_ERR("ERROR: TablesErrCodes::%d", ret);
+                        return -1;
+                    }
+                    ans.append(reinterpret_cast<const char*>(buffer->data()),
+                               buffer->size());
+                }
+                else if (format_type == SFT_FLATBUF_FLEX_ROW or
+                         format_type == SFT_FLATBUF_UNION_COL) {
+                    // NOTE: processSkyFb handles both flatbuf layouts
+                    sky_root root = Tables::getSkyRoot(data, data_size);
+                    flatbuffers::FlatBufferBuilder flatbldr(1024);  // pre-alloc sz
+                    ret = processSkyFb(flatbldr,
+                                   data_schema,
+                                   query_schema,
+                                   query_preds,
+                                   data,
+                                   data_size,
+                                   errmsg,
+                                   row_nums);
+
+                    if (ret != 0) {
+                        CLS_ERR("ERROR: processing flatbuf, %s", errmsg.c_str());
+                        CLS_ERR("ERROR: TablesErrCodes::%d", ret);
+                        return -1;
+                    }
+                    if (op.index_read)
+                        nrows += row_nums.size();
+                    else
+                        nrows += root.nrows;
+                    const char *processed_fb =                      \
+                        reinterpret_cast<char*>(flatbldr.GetBufferPointer());
+                    int bufsz = flatbldr.GetSize();
+                    ans.append(processed_fb, bufsz);
+                }
+                return 0;
+            };
+
+            // process a bl and append its result to our sequence of bls,
+            // or accumulate its rows into the groups.
+            auto process_bl = [&](bufferlist& bl,
+                                  std::vector<unsigned int>& row_nums) -> int {
+                if (group_by) {
+                    if (format_type != SFT_FLATBUF_FLEX_ROW) {
+                        CLS_ERR("ERROR: group by requires flatbuf row format");
+                        return -EINVAL;
+                    }
+                    std::string errmsg;
+                    sky_root root = Tables::getSkyRoot(bl.c_str(),
+                                                       bl.length());
+                    int ret = groupbyAccumulate(data_schema,
+                                                query_preds,
+                                                groupby_schema,
+                                                bl.c_str(),
+                                                bl.length(),
+                                                errmsg,
+                                                row_nums,
+                                                groups);
+                    if (ret != 0) {
+                        CLS_ERR("ERROR: group by, %s", errmsg.c_str());
+                        CLS_ERR("ERROR: TablesErrCodes::%d", ret);
+                        return -1;
+                    }
+                    if (op.index_read)
+                        rows_processed += row_nums.size();
+                    else
+                        rows_processed += root.nrows;
+                    return 0;
+                }
+                bufferlist ans;
+                int ret = process_fb(bl, row_nums, ans, rows_processed);
+                if (ret != 0)
+                    return ret;
+                if (top_k) {
+                    std::string errmsg;
+                    ret = topkAccumulate(topk, ans.c_str(), ans.length(),
+                                         errmsg);
+                    if (ret != 0) {
+                        CLS_ERR("ERROR: order by, %s", errmsg.c_str());
+                        CLS_ERR("ERROR: TablesErrCodes::%d", ret);
+                        return -1;
+                    }
+                    return 0;
+                }
+                if (early_stop)
+                    rows_out += getSkyRoot(ans.c_str(), ans.length()).nrows;
+                ::encode(ans, result_bl);
+                return 0;
+            };
+
+            // a parquet obj is scanned by row group instead of by bl, using
+            // the row group stats in place of the fb index and zone maps.
+            if (format_type == SFT_PARQUET) {
+                if (group_by) {
+                    CLS_ERR("ERROR: group by requires flatbuf row format");
+                    return -EINVAL;
+                }
+                if (op.index_read) {
+                    if (use_index1)
+                        query_preds.insert(query_preds.end(),
+                                           index_preds.begin(),
+                                           index_preds.end());
+                    if (use_index2)
+                        query_preds.insert(query_preds.end(),
+                                           index2_preds.begin(),
+                                           index2_preds.end());
+                }
+                reads.clear();
+                stream_scan = false;
+
+                uint64_t start = getns();
+                auto file = std::make_shared<ClsObjectFile>(hctx,
+                                                            sizeof(__u32));
+                std::vector<std::shared_ptr<arrow::Table>> tables;
+                std::string errmsg;
+                int rgs_skipped = 0;
+                ret = processParquet(tables,
+                                     data_schema,
+                                     query_schema,
+                                     query_preds,
+                                     file,
+                                     errmsg,
+                                     rows_processed,
+                                     rgs_skipped);
+                if (ret != 0) {
+                    CLS_ERR("ERROR: processing parquet, %s", errmsg.c_str());
+                    CLS_ERR("ERROR: TablesErrCodes::%d", ret);
+                    return -1;
+                }
+                CLS_LOG(20, "exec_query_op: row group stats skipped %d",
+                        rgs_skipped);
+
+                // return each processed row group as an arrow ipc stream
+                for (auto it = tables.begin(); it != tables.end(); ++it) {
+                    std::shared_ptr<arrow::Buffer> buffer;
+                    ret = convert_arrow_to_buffer(*it, &buffer);
+                    if (ret != 0) {
+                        CLS_ERR("ERROR: converting arrow table to buffer");
+                        CLS_ERR("ERROR: TablesErrCodes::%d", ret);
+                        return -1;
+                    }
+                    bufferlist ans;
+                    ans.append(reinterpret_cast<const char*>(buffer->data()),
+                               buffer->size());
+                    ::encode(ans, result_bl);
+                }
+                read_ns += file->get_read_ns();
+                eval_ns += getns() - start - file->get_read_ns();
+            }
+
+            // index only plan: process the matching keys as row layout fbs.
+            // a count over the index preds alone is just the key count.
+            if (index_only) {
+                uint64_t start = getns();
+                bool count_only = !group_by and !query_preds.empty();
+                for (auto it = query_preds.begin(); it != query_preds.end();
+                     ++it) {
+                    count_only &= ((*it)->isGlobalAgg() and
+                                   (*it)->opType() == SOT_cnt);
+                }
+                if (count_only) {
+                    for (auto it = query_preds.begin();
+                         it != query_preds.end(); ++it) {
+                        aggAddCount(*it, idx_keys.size());
+                    }
+                    rows_processed += idx_keys.size();
+                    idx_keys.clear();
+                }
+
+                // aggs are returned once, from a single fb
+                const size_t fb_rows = hasAggPreds(query_preds) ?
+                        std::max<size_t>(idx_keys.size(), 1) :
+                        INDEX_ONLY_FB_ROWS;
+                size_t i = 0;
+                do {
+                    size_t end = std::min(idx_keys.size(), i + fb_rows);
+                    index_key_vec chunk(idx_keys.begin() + i,
+                                        idx_keys.begin() + end);
+                    flatbuffers::FlatBufferBuilder flatbldr(1024);
+                    std::string errmsg;
+                    ret = indexKeysBuildFb(flatbldr,
+                                           data_schema,
+                                           idx_key_schema,
+                                           chunk,
+                                           idx_key_prefix_len,
+                                           op.db_schema,
+                                           op.table_name,
+                                           errmsg);
+                    if (ret != 0) {
+                        CLS_ERR("ERROR: index only plan, %s", errmsg.c_str());
+                        CLS_ERR("ERROR: TablesErrCodes::%d", ret);
+                        return -1;
+                    }
+                    bufferlist bl;
+                    bl.append(reinterpret_cast<char*>(
+                                flatbldr.GetBufferPointer()),
+                              flatbldr.GetSize());
+                    std::vector<unsigned int> row_nums(chunk.size());
+                    std::iota(row_nums.begin(), row_nums.end(), 0);
+                    ret = process_bl(bl, row_nums);
+                    if (ret != 0)
+                        return ret;
+                    i = end;
+                } while (i < idx_keys.size() and !limit_reached());
+                eval_ns += getns() - start;
+            }
+
+            // stream the full object through a bounded window rather than
+            // reading it all at once, processing each bl as soon as it is
+            // complete.  the window holds at most scan_mem_cap bytes, or one
+            // bl if that is larger.
+            if (stream_scan) {
+                uint64_t obj_size = 0;
+                ret = cls_cxx_stat(hctx, &obj_size, NULL);
+                if (ret < 0) {
+                    CLS_ERR("ERROR: exec_query_op: stat obj %d", ret);
+                    return ret;
+                }
+
+                const uint64_t chunk = op.scan_mem_cap;
+                uint64_t pos = 0;  // obj offset of the window start
+                bufferlist window;
+                std::vector<unsigned int> row_nums;
+                while (pos < obj_size and !limit_reached()) {
+
+                    // the bl len prefix, then the bl itself must be present
+                    __u32 bl_len = 0;
+                    uint64_t need = sizeof(bl_len);
+                    for (int i = 0; i < 2; i++) {
+                        while (window.length() < need) {
+                            bufferlist more;
+                            uint64_t start = getns();
+                            ret = cls_cxx_read(hctx, pos + window.length(),
+                                    std::max(chunk, need - window.length()),
+                                    &more);
+                            read_ns += getns() - start;
+                            if (ret < 0) {
+                                CLS_ERR("ERROR: reading flatbuf obj %d", ret);
+                                return ret;
+                            }
+                            if (more.length() == 0) {
+                                CLS_ERR("ERROR: truncated bl at off=%lu", pos);
+                                return -EINVAL;
+                            }
+                            window.claim_append(more);
+                        }
+                        if (i == 0) {
+                            bufferlist::iterator wit = window.begin();
+                            ::decode(bl_len, wit);
+                            need += bl_len;
+                        }
+                    }
+
+                    uint64_t start = getns();
+                    bufferlist bl;
+                    bl.substr_of(window, sizeof(bl_len), bl_len);
+                    ret = process_bl(bl, row_nums);
+                    if (ret != 0)
+                        return ret;
+                    eval_ns += getns() - start;
+
+                    // drop the processed bl from the window
+                    bufferlist rest;
+                    rest.substr_of(window, need, window.length() - need);
+                    window.swap(rest);
+                    pos += need;
+                }
+            }
+
+            // the fbs of an obj are independent, so if requested they can be
+            // processed by the shared pool of workers.  not for global aggs,
+            // since those accumulate into the shared query preds.  fbs are
+            // processed in batches as they are read, bounding the fbs held
+            // at once, and results are returned in fb order.
+            const bool parallel = (op.nthreads > 1 and
+                                   row_results and
+                                   !top_k and
+                                   !early_stop);
+            const size_t batch_fbs = 4 * std::min<size_t>(op.nthreads,
+                                                          MAX_QUERY_THREADS);
+            std::shared_ptr<fb_batch> batch;
+
+            auto run_batch = [&]() -> int {
+                const size_t n = batch->fbs.size();
+                batch->results.resize(n);
+                batch->nrows.assign(n, 0);
+                batch->rets.assign(n, 0);
+
+                // claim the next unprocessed fb until none remain, an
+                // exception must not escape a pool thread.
+                std::shared_ptr<fb_batch> b = batch;
+                auto claim = [b, n, &process_fb]() {
+                    for (size_t i = b->next++; i < n; i = b->next++) {
+                        try {
+                            b->rets[i] = process_fb(b->fbs[i], b->rnums[i],
+                                                    b->results[i],
+                                                    b->nrows[i]);
+                        } catch (const std::exception& e) {
+                            CLS_ERR("ERROR: processing fb: %s", e.what());
+                            b->rets[i] = -EINVAL;
+                        } catch (...) {
+                            CLS_ERR("ERROR: processing fb");
+                            b->rets[i] = -EINVAL;
+                        }
+                        std::lock_guard<std::mutex> l(b->lock);
+                        if (++b->done == n)
+                            b->cond.notify_all();
+                    }
+                };
+                size_t nworkers = std::min<size_t>(
+                        {op.nthreads, n, MAX_QUERY_THREADS});
+                for (size_t i = 1; i < nworkers; i++)
+                    QueryWorkerPool::instance().submit(claim);
+                claim();  // the op thread also takes part
+                {
+                    std::unique_lock<std::mutex> l(b->lock);
+                    b->cond.wait(l, [&] { return b->done == n; });
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    if (b->rets[i] != 0)
+                        return b->rets[i];
+                    rows_processed += b->nrows[i];
+                    ::encode(b->results[i], result_bl);
+                }
+                batch.reset();
+                return 0;
+            };
+
             // now we can decode and process each bl in the obj, specified
             // by each read request.
-            // NOTE: 1 bl contains exactly 1 flatbuf.
             // weak ordering in map will iterate over fb nums in sequence
-            for (auto it = reads.begin(); it != reads.end(); ++it) {
-                int format_type = 0;
+            for (auto it = reads.begin();
+                 it != reads.end() and !limit_reached(); ++it) {
                 bufferlist b;
                 size_t off = it->second.off;
                 size_t len = it->second.len;
@@ -1342,22 +2993,6 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
                 CLS_LOG(20, "exec_query_op: READING %s", msg.c_str());
                 uint64_t start = getns();
 
-                ret = get_sky_format_type(hctx, format_type);
-                if (ret == -ENOENT || ret == -ENODATA) {
-                    // If sky_format_type is not present then insert it in xattr.
-                    // Default value is set as a Flatbuffer
-                    ret = set_sky_format_type(hctx, SFT_FLATBUF_FLEX_ROW);
-                    if(ret < 0) {
-                        CLS_ERR("exec_query_op: error setting sky_format_type entry to xattr %d", ret);
-                        return ret;
-                    }
-                    format_type = SFT_FLATBUF_FLEX_ROW;
-                }
-                else if (ret < 0) {
-                    CLS_ERR("ERROR: exec_query_op: sky_format_type entry from xattr %d", ret);
-                    return ret;
-                }
-
                 ret = cls_cxx_read(hctx, off, len, &b);
                 if (ret < 0) {
                   CLS_ERR("ERROR: reading flatbuf obj %d", ret);
@@ -1366,7 +3001,7 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
                 read_ns += getns() - start;
                 start = getns();
                 ceph::bufferlist::iterator it2 = b.begin();
-                while (it2.get_remaining() > 0) {
+                while (it2.get_remaining() > 0 and !limit_reached()) {
                     bufferlist bl;
                     try {
                         ::decode(bl, it2);  // unpack the next bl (flatbuf)
@@ -1374,62 +3009,60 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
                         CLS_ERR("ERROR: decoding flatbuf from BL");
                         return -EINVAL;
                     }
-
-                    // get our data as contiguous bytes before accessing as flatbuf
-                    const char* data = bl.c_str();
-                    size_t data_size = bl.length();
-                    std::string errmsg;
-
-                    // add processed fb to our sequence of bls
-                    bufferlist ans;
-
-                    if (format_type == SFT_ARROW) {
-                        std::shared_ptr<arrow::Table> table;
-                        ret = processArrow(&table,
-                                           data_schema,
-                                           query_schema,
-                                           query_preds,
-                                           data,
-                                           data_size,
-                                           errmsg,
-                                           row_nums);
-                        if (ret != 0) {
-                            CLS_ERR("ERROR: processing flatbuf, %s", errmsg.c_str());
-                            CLS_ERR("ERROR: TablesErrCodes::%d", ret);
-                            return -1;
-                        }
-                        // TODO: Add the output to result fb
-                    }
-                    else if(format_type == SFT_FLATBUF_FLEX_ROW) {
-                        sky_root root = Tables::getSkyRoot(data, data_size);
-                        flatbuffers::FlatBufferBuilder flatbldr(1024);  // pre-alloc sz
-                        ret = processSkyFb(flatbldr,
-                                       data_schema,
-                                       query_schema,
-                                       query_preds,
-                                       data,
-                                       data_size,
-                                       errmsg,
-                                       row_nums);
-
-                        if (ret != 0) {
-                            CLS_ERR("ERROR: processing flatbuf, %s", errmsg.c_str());
-                            CLS_ERR("ERROR: TablesErrCodes::%d", ret);
-                            return -1;
+                    if (parallel) {
+                        if (!batch)
+                            batch = std::make_shared<fb_batch>();
+                        batch->nbytes += bl.length();
+                        batch->fbs.push_back(bl);
+                        batch->rnums.push_back(row_nums);
+                        if (batch->fbs.size() >= batch_fbs or
+                            (op.scan_mem_cap > 0 and
+                             batch->nbytes >= op.scan_mem_cap)) {
+                            ret = run_batch();
+                            if (ret != 0)
+                                return ret;
                         }
-                        if (op.index_read)
-                            rows_processed += row_nums.size();
-                        else
-                            rows_processed += root.nrows;
-                        const char *processed_fb =                      \
-                            reinterpret_cast<char*>(flatbldr.GetBufferPointer());
-                        int bufsz = flatbldr.GetSize();
-                        ans.append(processed_fb, bufsz);
+                        continue;
                     }
-                    ::encode(ans, result_bl);
+                    ret = process_bl(bl, row_nums);
+                    if (ret != 0)
+                        return ret;
                 }
                 eval_ns += getns() - start;
             }
+            if (batch) {
+                uint64_t start = getns();
+                ret = run_batch();
+                if (ret != 0)
+                    return ret;
+                eval_ns += getns() - start;
+            }
+
+            // return 1 fb holding the partial aggs of each group in this obj
+            if (group_by) {
+                uint64_t start = getns();
+                flatbuffers::FlatBufferBuilder flatbldr(1024);
+                groupbyBuildFb(flatbldr, data_schema, groupby_schema,
+                               query_preds, groups, false,
+                               op.db_schema, op.table_name);
+                bufferlist ans;
+                ans.append(reinterpret_cast<char*>(flatbldr.GetBufferPointer()),
+                           flatbldr.GetSize());
+                ::encode(ans, result_bl);
+                eval_ns += getns() - start;
+            }
+
+            // return 1 fb holding the top-k rows of this obj, in order
+            if (top_k and !topk.heap.empty()) {
+                uint64_t start = getns();
+                flatbuffers::FlatBufferBuilder flatbldr(1024);
+                topkBuildFb(flatbldr, topk);
+                bufferlist ans;
+                ans.append(reinterpret_cast<char*>(flatbldr.GetBufferPointer()),
+                           flatbldr.GetSize());
+                ::encode(ans, result_bl);
+                eval_ns += getns() - start;
+            }
         }
     } else {
       // older processing here.
@@ -1671,12 +3304,11 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
       } else if (op.query == "f") {  // regex query on comment cols
         if (op.projection) {  // look for matching row(s) and extract key cols.
           RE2 re(op.comment_regex);
+          Tables::LikeMatcher like(op.comment_regex, &re);
           for (size_t rid = 0; rid < num_rows; rid++) {
             const char *row = rows + rid * row_size;
             const char *cptr = row + comment_field_offset;
-            const std::string comment_val = string_ncopy(cptr,
-                comment_field_length);
-            if (RE2::PartialMatch(comment_val, re)) {
+            if (like.match(cptr, string_nlen(cptr, comment_field_length))) {
               result_bl.append(row + order_key_field_offset, 4);
               result_bl.append(row + line_number_field_offset, 4);
               add_extra_row_cost(op.extra_row_cost);
@@ -1684,12 +3316,11 @@ int exec_query_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
           }
         } else { // look for matching row(s) and extract all cols.
           RE2 re(op.comment_regex);
+          Tables::LikeMatcher like(op.comment_regex, &re);
           for (size_t rid = 0; rid < num_rows; rid++) {
             const char *row = rows + rid * row_size;
             const char *cptr = row + comment_field_offset;
-            const std::string comment_val = string_ncopy(cptr,
-                comment_field_length);
-            if (RE2::PartialMatch(comment_val, re)) {
+            if (like.match(cptr, string_nlen(cptr, comment_field_length))) {
               result_bl.append(row, row_size);
               add_extra_row_cost(op.extra_row_cost);
             }
@@ -1733,7 +3364,74 @@ int exec_runstats_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
     std::string table_name = op.table_name;
     schema_vec data_schema = schemaFromString(op.data_schema);
 
+    // stats are collected from flatbufs only
+    int format_type = SFT_FLATBUF_FLEX_ROW;
+    int ret = get_sky_format_type(hctx, format_type);
+    if (ret == -ENOENT || ret == -ENODATA) {
+        format_type = is_parquet_obj(hctx) ? SFT_PARQUET :
+                                             SFT_FLATBUF_FLEX_ROW;
+    }
+    else if (ret < 0) {
+        CLS_ERR("ERROR: exec_runstats_op: sky_format_type entry from xattr %d", ret);
+        return ret;
+    }
+    if (format_type != SFT_FLATBUF_FLEX_ROW) {
+        CLS_ERR("ERROR: exec_runstats_op: obj format type=%d", format_type);
+        return -EOPNOTSUPP;
+    }
+
+    // obj contains one bl that itself wraps a seq of encoded bls of skyhook fb
+    bufferlist wrapped_bls;
+    ret = cls_cxx_read(hctx, 0, 0, &wrapped_bls);
+    if (ret < 0) {
+        CLS_ERR("ERROR: exec_runstats_op: reading obj. %d", ret);
+        return ret;
+    }
+
+    // collect the vals of each col over all fbs in the object
+    std::vector<std::vector<double>> vals(data_schema.size());
+    ceph::bufferlist::iterator it = wrapped_bls.begin();
+    while (it.get_remaining() > 0) {
+        ceph::bufferlist bl;
+        try {
+            ::decode(bl, it);  // unpack the next bl
+        } catch (const buffer::error &err) {
+            CLS_ERR("ERROR: exec_runstats_op: decoding flatbuf from BL");
+            return -EINVAL;
+        }
+
+        const char* fb = bl.c_str();   // get fb as contiguous bytes
+        int fb_len = bl.length();
+        sky_root root = getSkyRoot(fb, fb_len);
+
+        // stats are only supported for the row layout for now
+        if (!root.offs) {
+            CLS_ERR("exec_runstats_op: stats not supported for columnar layout");
+            return -EOPNOTSUPP;
+        }
+        collectStatsVals(root, data_schema, vals);
+    }
+
+    // build and store the histogram of each col
+    std::map<std::string, bufferlist> stats;
+    for (unsigned i = 0; i < data_schema.size(); i++) {
+        col_info col = data_schema[i];
+        col_stats cs(col.idx, col.type, 0, StatsLevel::HIGH, 0, table_name,
+                     col.toString(), "", "", 0, {});
+        buildColStats(vals[i], op.nbins, cs);
+        std::vector<double>().swap(vals[i]);  // release col vals
 
+        bufferlist bl;
+        ::encode(cs, bl);
+        stats[buildStatsKey(dbschema, table_name, col.name)] = bl;
+        CLS_LOG(20, "exec_runstats_op: %s", cs.toString().c_str());
+    }
+
+    ret = cls_cxx_map_set_vals(hctx, &stats);
+    if (ret < 0) {
+        CLS_ERR("exec_runstats_op: error setting col stats entries %d", ret);
+        return ret;
+    }
 
     return 0;
 }
@@ -1769,13 +3467,14 @@ int transform_db_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
     int ret = get_sky_format_type(hctx, format_type);
     if (ret == -ENOENT || ret == -ENODATA) {
         // If sky_format_type is not present then insert it in xattr.
-        // Default value is set as a Flatbuffer
-        ret = set_sky_format_type(hctx, SFT_FLATBUF_FLEX_ROW);
+        // Default value is a Flatbuffer, unless the obj is a parquet file
+        format_type = is_parquet_obj(hctx) ? SFT_PARQUET :
+                                             SFT_FLATBUF_FLEX_ROW;
+        ret = set_sky_format_type(hctx, format_type);
         if(ret < 0) {
             CLS_ERR("transform_db_op: error setting sky_format_type entry to xattr %d", ret);
             return ret;
         }
-        format_type = SFT_FLATBUF_FLEX_ROW;
     }
     else if (ret < 0) {
         CLS_ERR("ERROR: transform_db_op: sky_format_type entry from xattr %d", ret);
@@ -1790,6 +3489,16 @@ int transform_db_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
         return 0;
     }
 
+    // only flex row fbs can be transformed to other formats, and only arrow
+    // can be transformed back to flex row fbs
+    const int src_type = (op.required_type == SFT_FLATBUF_FLEX_ROW) ?
+                         SFT_ARROW : SFT_FLATBUF_FLEX_ROW;
+    if (format_type != src_type) {
+        CLS_ERR("ERROR: transform_db_op: transform from format %d to %d "
+                "not supported", format_type, op.required_type);
+        return -EOPNOTSUPP;
+    }
+
     // Object contains one bl that itself wraps a seq of encoded bls of skyhook fb/arrow
     bufferlist wrapped_bls;
     bufferlist trans_wrapped_bls;
@@ -1800,6 +3509,7 @@ int transform_db_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
     }
 
     using namespace Tables;
+    std::vector<std::shared_ptr<arrow::Table>> parquet_tables;
     ceph::bufferlist::iterator it = wrapped_bls.begin();
     while (it.get_remaining() > 0) {
         bufferlist bl;
@@ -1816,7 +3526,17 @@ int transform_db_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
         size_t data_size = bl.length();
         std::string errmsg;
 
-        if (op.required_type == SFT_ARROW) {
+        if (op.required_type == SFT_PARQUET) {
+            // collected into a single parquet file below
+            std::shared_ptr<arrow::Table> table;
+            ret = transform_fb_to_arrow(data, data_size, errmsg, &table);
+            if (ret != 0) {
+                CLS_ERR("ERROR: transforming object from flatbuffer to arrow, %s", errmsg.c_str());
+                return ret;
+            }
+            parquet_tables.push_back(table);
+
+        } else if (op.required_type == SFT_ARROW) {
             std::shared_ptr<arrow::Table> table;
             ret = transform_fb_to_arrow(data, data_size, errmsg, &table);
             if (ret != 0) {
@@ -1830,6 +3550,19 @@ int transform_db_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
             trans_bl.append(buffer->ToString().c_str(), buffer->size());
             ::encode(trans_bl, trans_wrapped_bls);
 
+        } else if (op.required_type == SFT_FLATBUF_UNION_COL) {
+            flatbuffers::FlatBufferBuilder flatbldr(1024);  // pre-alloc sz
+
+            ret = transform_fb_to_col(data, data_size, errmsg, flatbldr);
+            if (ret != 0) {
+                CLS_ERR("ERROR: transforming object from flatbuffer to columnar flatbuffer, %s", errmsg.c_str());
+                return ret;
+            }
+            trans_bl.append(reinterpret_cast<const char*>(
+                                flatbldr.GetBufferPointer()),
+                            flatbldr.GetSize());
+            ::encode(trans_bl, trans_wrapped_bls);
+
         } else if (op.required_type == SFT_FLATBUF_FLEX_ROW) {
             flatbuffers::FlatBufferBuilder flatbldr(1024);  // pre-alloc sz
 
@@ -1841,6 +3574,20 @@ int transform_db_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
         }
     }
 
+    // a parquet obj is one bl holding the file, with a row group per fb
+    if (op.required_type == SFT_PARQUET) {
+        std::shared_ptr<arrow::Buffer> buffer;
+        ret = convert_arrow_to_parquet(parquet_tables, &buffer);
+        if (ret != 0) {
+            CLS_ERR("ERROR: transforming object from arrow to parquet, TablesErrCodes::%d", ret);
+            return -EINVAL;
+        }
+        bufferlist trans_bl;
+        trans_bl.append(reinterpret_cast<const char*>(buffer->data()),
+                        buffer->size());
+        ::encode(trans_bl, trans_wrapped_bls);
+    }
+
     // Write the object back to Ceph
     ret = cls_cxx_write_full(hctx, &trans_wrapped_bls);
     if (ret < 0) {
@@ -1876,6 +3623,12 @@ void __cls_init()
   cls_register_cxx_method(h_class, "exec_build_sky_index_op",
       CLS_METHOD_RD | CLS_METHOD_WR, exec_build_sky_index_op, &h_exec_build_sky_index_op);
 
+  cls_register_cxx_method(h_class, "append_fb",
+      CLS_METHOD_RD | CLS_METHOD_WR, append_fb, &h_append_fb);
+
+  cls_register_cxx_method(h_class, "compact",
+      CLS_METHOD_RD | CLS_METHOD_WR, compact, &h_compact);
+
   cls_register_cxx_method(h_class, "transform_db_op",
       CLS_METHOD_RD | CLS_METHOD_WR, transform_db_op, &h_transform_db_op);
 
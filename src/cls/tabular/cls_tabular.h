@@ -13,12 +13,19 @@
 #define CLS_TABULAR_H
 
 #include "include/types.h"
+#include "common/bloom_filter.hpp"
 
 void cls_log_message(std::string msg, bool is_err, int log_level);
 
 #define STREAM_CAPACITY 1024
+#define STATS_DEFAULT_NBINS 10
+#define MAX_QUERY_THREADS 16
+#define INDEX_ONLY_FB_ROWS 4096  // rows per fb built from index keys
+#define BLOOM_FALSE_POSITIVE_PROB 0.01  // per fb col bloom filters
 #define ARROW_RID_INDEX(cols) (cols)
 #define ARROW_DELVEC_INDEX(cols) (cols + 1)
+#define PARQUET_FILE_MAGIC "PAR1"  // at both the start and end of a file
+#define PARQUET_FILE_MAGIC_LEN 4
 
 enum arrow_metadata_t {
     METADATA_SKYHOOK_VERSION,
@@ -54,7 +61,13 @@ enum SkyFormatType {
     SFT_FLATBUF_UNION_COL,
     SFT_ARROW,
     SFT_POSTGRESQL,
-    SFT_CSV
+    SFT_CSV,
+    SFT_PARQUET
+};
+
+// refers to how the rows of a table are placed into objects
+enum SkyPartitionType {
+    SPT_JUMP_HASH_KEY   // jump consistent hash of the key cols, see fbwriter
 };
 
 /*
@@ -95,12 +108,18 @@ struct query_op {
   std::string query_preds;
   std::string index_preds;
   std::string index2_preds;
+  uint64_t scan_mem_cap;  // max bytes buffered by a full scan, 0 = no cap
+  uint32_t nthreads;  // workers processing the fbs of an obj, see cls
+  std::string groupby_schema;  // group cols, empty = no group by
+  uint64_t limit;  // max result rows needed from this obj, 0 = no limit
+  std::string orderby_schema;  // order col for the limit, empty = none
+  bool orderby_desc;
 
-  query_op() {}
+  query_op() : scan_mem_cap(0), nthreads(1), limit(0), orderby_desc(false) {}
 
   // serialize the fields into bufferlist to be sent over the wire
   void encode(bufferlist& bl) const {
-    ENCODE_START(1, 1, bl);
+    ENCODE_START(5, 1, bl);
     ::encode(query, bl);
     ::encode(extended_price, bl);
     ::encode(order_key, bl);
@@ -131,12 +150,18 @@ struct query_op {
     ::encode(query_preds, bl);
     ::encode(index_preds, bl);
     ::encode(index2_preds, bl);
+    ::encode(scan_mem_cap, bl);
+    ::encode(nthreads, bl);
+    ::encode(groupby_schema, bl);
+    ::encode(limit, bl);
+    ::encode(orderby_schema, bl);
+    ::encode(orderby_desc, bl);
     ENCODE_FINISH(bl);
   }
 
   // deserialize the fields from the bufferlist into this struct
   void decode(bufferlist::iterator& bl) {
-    DECODE_START(1, bl);
+    DECODE_START(5, bl);
     ::decode(query, bl);
     ::decode(extended_price, bl);
     ::decode(order_key, bl);
@@ -167,6 +192,27 @@ struct query_op {
     ::decode(query_preds, bl);
     ::decode(index_preds, bl);
     ::decode(index2_preds, bl);
+    if (struct_v >= 2)
+      ::decode(scan_mem_cap, bl);
+    else
+      scan_mem_cap = 0;
+    if (struct_v >= 3)
+      ::decode(nthreads, bl);
+    else
+      nthreads = 1;
+    if (struct_v >= 4)
+      ::decode(groupby_schema, bl);
+    else
+      groupby_schema.clear();
+    if (struct_v >= 5) {
+      ::decode(limit, bl);
+      ::decode(orderby_schema, bl);
+      ::decode(orderby_desc, bl);
+    } else {
+      limit = 0;
+      orderby_schema.clear();
+      orderby_desc = false;
+    }
     DECODE_FINISH(bl);
   }
 
@@ -187,6 +233,12 @@ struct query_op {
     s.append(" .query_preds=" + query_preds);
     s.append(" .index_preds=" + index_preds);
     s.append(" .index2_preds=" + index2_preds);
+    s.append(" .scan_mem_cap=" + std::to_string(scan_mem_cap));
+    s.append(" .nthreads=" + std::to_string(nthreads));
+    s.append(" .groupby_schema=" + groupby_schema);
+    s.append(" .limit=" + std::to_string(limit));
+    s.append(" .orderby_schema=" + orderby_schema);
+    s.append(" .orderby_desc=" + std::to_string(orderby_desc));
     return s;
   }
 };
@@ -198,26 +250,34 @@ struct stats_op {
   std::string db_schema;
   std::string table_name;
   std::string data_schema;
+  uint32_t nbins;  // num histogram bins per col
 
-  stats_op() {}
-  stats_op(std::string dbscma, std::string tname, std::string dtscma) :
-           db_schema(dbscma), table_name(tname), data_schema(dtscma) { }
+  stats_op() : nbins(STATS_DEFAULT_NBINS) {}
+  stats_op(std::string dbscma, std::string tname, std::string dtscma,
+           uint32_t bins = STATS_DEFAULT_NBINS) :
+           db_schema(dbscma), table_name(tname), data_schema(dtscma),
+           nbins(bins) { }
 
   // serialize the fields into bufferlist to be sent over the wire
   void encode(bufferlist& bl) const {
-    ENCODE_START(1, 1, bl);
+    ENCODE_START(2, 1, bl);
     ::encode(db_schema, bl);
     ::encode(table_name, bl);
     ::encode(data_schema, bl);
+    ::encode(nbins, bl);
     ENCODE_FINISH(bl);
   }
 
   // deserialize the fields from the bufferlist into this struct
   void decode(bufferlist::iterator& bl) {
-    DECODE_START(1, bl);
+    DECODE_START(2, bl);
     ::decode(db_schema, bl);
     ::decode(table_name, bl);
     ::decode(data_schema, bl);
+    if (struct_v >= 2)
+      ::decode(nbins, bl);
+    else
+      nbins = STATS_DEFAULT_NBINS;
     DECODE_FINISH(bl);
   }
 
@@ -227,6 +287,7 @@ struct stats_op {
     s.append(" .db_schema=" + db_schema);
     s.append(" .table_name=" + table_name);
     s.append(" .data_schema=" + data_schema);
+    s.append(" .nbins=" + std::to_string(nbins));
     return s;
   }
 };
@@ -271,29 +332,256 @@ struct transform_op {
 };
 WRITE_CLASS_ENCODER(transform_op)
 
+// Rewrites the fbs of an obj into fbs of about target_rows rows or
+// target_bytes bytes (0 for no limit), dropping deleted rows and optionally
+// clustering the rows by a col, see compact() in cls_tabular.cc.
+struct compact_op {
+
+  uint32_t target_rows;
+  uint64_t target_bytes;
+  std::string cluster_schema;  // the clustering col, empty for none
+
+  compact_op() : target_rows(0), target_bytes(0) {}
+  compact_op(uint32_t rows, uint64_t bytes, std::string cluster) :
+    target_rows(rows), target_bytes(bytes), cluster_schema(cluster) { }
+
+  // serialize the fields into bufferlist to be sent over the wire
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    ::encode(target_rows, bl);
+    ::encode(target_bytes, bl);
+    ::encode(cluster_schema, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  // deserialize the fields from the bufferlist into this struct
+  void decode(bufferlist::iterator& bl) {
+    DECODE_START(1, bl);
+    ::decode(target_rows, bl);
+    ::decode(target_bytes, bl);
+    ::decode(cluster_schema, bl);
+    DECODE_FINISH(bl);
+  }
+
+  std::string toString() {
+    std::string s;
+    s.append("compact_op:");
+    s.append(" .target_rows=" + std::to_string(target_rows));
+    s.append(" .target_bytes=" + std::to_string(target_bytes));
+    s.append(" .cluster_schema=" + cluster_schema);
+    return s;
+  }
+};
+WRITE_CLASS_ENCODER(compact_op)
+
+// How the rows of a table are placed into its objs.  This is written by the
+// loader to the table's partitioning obj (Tables::PARTITION_OID_PREFIX and
+// the table name), clients use it to target only the objs that may hold the
+// rows of a query, see Tables::partitionTargetObj().
+struct partition_info {
+
+  int part_type;  // SkyPartitionType
+  std::string table_name;
+  std::string key_schema;  // the hashed key cols, in key order
+  uint64_t num_objs;
+  std::string obj_prefix;  // objs are named obj_prefix + obj num
+
+  partition_info() : part_type(SPT_JUMP_HASH_KEY), num_objs(0) {}
+  partition_info(int ptype, std::string tname, std::string kschema,
+                 uint64_t nobjs, std::string oprefix) :
+    part_type(ptype), table_name(tname), key_schema(kschema),
+    num_objs(nobjs), obj_prefix(oprefix) { }
+
+  // serialize the fields into bufferlist to be sent over the wire
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    ::encode(part_type, bl);
+    ::encode(table_name, bl);
+    ::encode(key_schema, bl);
+    ::encode(num_objs, bl);
+    ::encode(obj_prefix, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  // deserialize the fields from the bufferlist into this struct
+  void decode(bufferlist::iterator& bl) {
+    DECODE_START(1, bl);
+    ::decode(part_type, bl);
+    ::decode(table_name, bl);
+    ::decode(key_schema, bl);
+    ::decode(num_objs, bl);
+    ::decode(obj_prefix, bl);
+    DECODE_FINISH(bl);
+  }
+
+  std::string toString() {
+    std::string s;
+    s.append("partition_info:");
+    s.append(" .part_type=" + std::to_string(part_type));
+    s.append(" .table_name=" + table_name);
+    s.append(" .key_schema=" + key_schema);
+    s.append(" .num_objs=" + std::to_string(num_objs));
+    s.append(" .obj_prefix=" + obj_prefix);
+    return s;
+  }
+};
+WRITE_CLASS_ENCODER(partition_info)
+
+// zone map of a single column within one flatbuffer, i.e., the range of
+// values stored in that col. numeric bounds are kept as int64 (signed ints,
+// char, bool), uint64 (unsigned ints, uchar) and double (float types),
+// dates and strings keep their string bounds.
+// has_bounds is false if the bounds are unusable (e.g., NaN vals seen).
+// note: bounds cover every stored val, including the placeholder vals of null
+// cols, so they agree with what the scan operator compares against.
+struct col_zone {
+    int32_t col_idx;
+    int32_t col_type;
+    uint32_t null_count;
+    bool has_bounds;
+    int64_t imin;
+    int64_t imax;
+    uint64_t umin;
+    uint64_t umax;
+    double dmin;
+    double dmax;
+    std::string smin;
+    std::string smax;
+
+    col_zone() :
+        col_idx(0), col_type(0), null_count(0), has_bounds(false),
+        imin(0), imax(0), umin(0), umax(0), dmin(0), dmax(0) {}
+    col_zone(int32_t idx, int32_t type) :
+        col_idx(idx), col_type(type), null_count(0), has_bounds(false),
+        imin(0), imax(0), umin(0), umax(0), dmin(0), dmax(0) {}
+
+    void encode(bufferlist& bl) const {
+        ENCODE_START(1, 1, bl);
+        ::encode(col_idx, bl);
+        ::encode(col_type, bl);
+        ::encode(null_count, bl);
+        ::encode(has_bounds, bl);
+        ::encode(imin, bl);
+        ::encode(imax, bl);
+        ::encode(umin, bl);
+        ::encode(umax, bl);
+        ::encode(dmin, bl);
+        ::encode(dmax, bl);
+        ::encode(smin, bl);
+        ::encode(smax, bl);
+        ENCODE_FINISH(bl);
+    }
+
+    void decode(bufferlist::iterator& bl) {
+        DECODE_START(1, bl);
+        ::decode(col_idx, bl);
+        ::decode(col_type, bl);
+        ::decode(null_count, bl);
+        ::decode(has_bounds, bl);
+        ::decode(imin, bl);
+        ::decode(imax, bl);
+        ::decode(umin, bl);
+        ::decode(umax, bl);
+        ::decode(dmin, bl);
+        ::decode(dmax, bl);
+        ::decode(smin, bl);
+        ::decode(smax, bl);
+        DECODE_FINISH(bl);
+    }
+
+    std::string toString() {
+        std::string s;
+        s.append("col_zone.col_idx=" + std::to_string(col_idx));
+        s.append("; col_zone.col_type=" + std::to_string(col_type));
+        s.append("; col_zone.null_count=" + std::to_string(null_count));
+        s.append("; col_zone.has_bounds=" + std::to_string(has_bounds));
+        s.append("; col_zone.imin=" + std::to_string(imin));
+        s.append("; col_zone.imax=" + std::to_string(imax));
+        s.append("; col_zone.umin=" + std::to_string(umin));
+        s.append("; col_zone.umax=" + std::to_string(umax));
+        s.append("; col_zone.dmin=" + std::to_string(dmin));
+        s.append("; col_zone.dmax=" + std::to_string(dmax));
+        s.append("; col_zone.smin=" + smin);
+        s.append("; col_zone.smax=" + smax);
+        return s;
+    }
+};
+WRITE_CLASS_ENCODER(col_zone)
+
+// bloom filter over the vals of one col within one fb, for eq preds
+struct col_bloom {
+    int32_t col_idx;
+    int32_t col_type;
+    bloom_filter bloom;
+
+    col_bloom() : col_idx(0), col_type(0) {}
+    col_bloom(int32_t idx, int32_t type, size_t nvals) :
+        col_idx(idx), col_type(type),
+        bloom(std::max<size_t>(nvals, 1), BLOOM_FALSE_POSITIVE_PROB, 0) {}
+
+    void encode(bufferlist& bl) const {
+        ENCODE_START(1, 1, bl);
+        ::encode(col_idx, bl);
+        ::encode(col_type, bl);
+        ::encode(bloom, bl);
+        ENCODE_FINISH(bl);
+    }
+
+    void decode(bufferlist::iterator& bl) {
+        DECODE_START(1, bl);
+        ::decode(col_idx, bl);
+        ::decode(col_type, bl);
+        ::decode(bloom, bl);
+        DECODE_FINISH(bl);
+    }
+
+    std::string toString() {
+        std::string s;
+        s.append("col_bloom.col_idx=" + std::to_string(col_idx));
+        s.append("; col_bloom.col_type=" + std::to_string(col_type));
+        s.append("; col_bloom.size=" + std::to_string(bloom.size()));
+        return s;
+    }
+};
+WRITE_CLASS_ENCODER(col_bloom)
+
 // holds an omap entry containing flatbuffer location
 // this entry type contains physical location info
 // idx_key = idx_prefix + fb sequence number (int)
 // val = this struct containing to PHYSICAL location of fb within obj
 // note: objs contain a sequence of fbs, hence the off/len is needed
+// zones holds the per col zone maps of the fb, used to skip fbs during scans
 struct idx_fb_entry {
     uint32_t off;
     uint32_t len;
+    std::vector<col_zone> zones;
+    std::vector<col_bloom> blooms;  // only for the requested cols
 
     idx_fb_entry() {}
     idx_fb_entry(uint32_t o, uint32_t l) : off(o), len(l) { }
+    idx_fb_entry(uint32_t o, uint32_t l, std::vector<col_zone> z) :
+        off(o), len(l), zones(z) { }
+    idx_fb_entry(uint32_t o, uint32_t l, std::vector<col_zone> z,
+                 std::vector<col_bloom> b) :
+        off(o), len(l), zones(z), blooms(b) { }
 
     void encode(bufferlist& bl) const {
-        ENCODE_START(1, 1, bl);
+        ENCODE_START(3, 1, bl);
         ::encode(off, bl);
         ::encode(len, bl);
+        ::encode(zones, bl);
+        ::encode(blooms, bl);
         ENCODE_FINISH(bl);
     }
 
     void decode(bufferlist::iterator& bl) {
-        DECODE_START(1, bl);
+        DECODE_START(3, bl);
         ::decode(off, bl);
         ::decode(len, bl);
+        if (struct_v >= 2)
+            ::decode(zones, bl);
+        if (struct_v >= 3)
+            ::decode(blooms, bl);
         DECODE_FINISH(bl);
     }
 
@@ -301,6 +589,8 @@ struct idx_fb_entry {
         std::string s;
         s.append("idx_fb_entry.off=" + std::to_string(off));
         s.append("; idx_fb_entry.len=" + std::to_string(len));
+        s.append("; idx_fb_entry.zones=" + std::to_string(zones.size()));
+        s.append("; idx_fb_entry.blooms=" + std::to_string(blooms.size()));
         return s;
     }
 };
@@ -401,37 +691,49 @@ struct idx_op {
     int idx_type;
     std::string idx_schema_str;
     std::string idx_text_delims; // for text indexing
+    std::string idx_bloom_schema_str;  // cols to build fb bloom filters for
+    bool idx_live_rows;  // set by the build, entries only for live rows
 
-    idx_op() {}
+    idx_op() : idx_live_rows(false) {}
     idx_op(bool unq, bool ign, int batsz, int index_type,
-           std::string schema_str, std::string delimiters) :
+           std::string schema_str, std::string delimiters,
+           std::string bloom_schema_str = "") :
         idx_unique(unq),
         idx_ignore_stopwords(ign),
         idx_batch_size(batsz),
         idx_type(index_type),
         idx_schema_str(schema_str),
-        idx_text_delims(delimiters) {}
+        idx_text_delims(delimiters),
+        idx_bloom_schema_str(bloom_schema_str),
+        idx_live_rows(false) {}
 
     void encode(bufferlist& bl) const {
-        ENCODE_START(1, 1, bl);
+        ENCODE_START(3, 1, bl);
         ::encode(idx_unique, bl);
         ::encode(idx_ignore_stopwords, bl);
         ::encode(idx_batch_size, bl);
         ::encode(idx_type, bl);
         ::encode(idx_schema_str, bl);
         ::encode(idx_text_delims, bl);
+        ::encode(idx_bloom_schema_str, bl);
+        ::encode(idx_live_rows, bl);
         ENCODE_FINISH(bl);
     }
 
     void decode(bufferlist::iterator& bl) {
         std::string s;
-        DECODE_START(1, bl);
+        DECODE_START(3, bl);
         ::decode(idx_unique, bl);
         ::decode(idx_ignore_stopwords, bl);
         ::decode(idx_batch_size, bl);
         ::decode(idx_type, bl);
         ::decode(idx_schema_str, bl);
         ::decode(idx_text_delims, bl);
+        if (struct_v >= 2)
+            ::decode(idx_bloom_schema_str, bl);
+        idx_live_rows = false;
+        if (struct_v >= 3)
+            ::decode(idx_live_rows, bl);
         DECODE_FINISH(bl);
     }
 
@@ -444,6 +746,8 @@ struct idx_op {
         s.append("; idx_op.idx_type=" + std::to_string(idx_type));
         s.append("; idx_op.idx_schema_str=\n" + idx_schema_str);
         s.append("; idx_op.text_delims=\n" + idx_text_delims);
+        s.append("; idx_op.idx_bloom_schema_str=\n" + idx_bloom_schema_str);
+        s.append("; idx_op.idx_live_rows=" + std::to_string(idx_live_rows));
         return s;
     }
 };
@@ -464,7 +768,14 @@ struct col_stats {
     unsigned int nbins;
     std::vector<int> hist;  // TODO: should support uint type also
 
-    col_stats() {}
+    // equi-depth histogram: bin i holds hist[i] vals in [bounds[i],
+    // bounds[i+1]), the last bin also includes bounds[nbins].  bounds are
+    // numeric (dates as day numbers), see Tables::buildColStats()
+    uint64_t nrows;
+    uint64_t ndistinct;
+    std::vector<double> bounds;
+
+    col_stats() : nbins(0), nrows(0), ndistinct(0) {}
     col_stats(int cid, int type, int tid, int level, int64_t cur_time,
               std::string tname, std::string cinfo, std::string min,
               std::string max, unsigned num_bins, std::vector<int> h) :
@@ -477,7 +788,9 @@ struct col_stats {
         col_info_str(cinfo),
         min_val(min),
         max_val(max),
-        nbins(num_bins) {
+        nbins(num_bins),
+        nrows(0),
+        ndistinct(0) {
             assert (nbins <= h.size());
             for (unsigned int i=0; i<nbins; i++) {
                 hist.push_back(h[i]);
@@ -489,7 +802,7 @@ struct col_stats {
         }
 
     void encode(bufferlist& bl) const {
-        ENCODE_START(1, 1, bl);
+        ENCODE_START(2, 1, bl);
         ::encode(col_id, bl);
         ::encode(col_type, bl);
         ::encode(table_id, bl);
@@ -503,12 +816,15 @@ struct col_stats {
         for (unsigned int i=0; i<nbins; i++) {
             ::encode(hist[i], bl);
         }
+        ::encode(nrows, bl);
+        ::encode(ndistinct, bl);
+        ::encode(bounds, bl);
         ENCODE_FINISH(bl);
     }
 
     void decode(bufferlist::iterator& bl) {
         std::string s;
-        DECODE_START(1, bl);
+        DECODE_START(2, bl);
         ::decode(col_id, bl);
         ::decode(col_type, bl);
         ::decode(table_id, bl);
@@ -524,6 +840,11 @@ struct col_stats {
             ::decode(tmp, bl);
             hist.push_back(tmp);
         }
+        if (struct_v >= 2) {
+            ::decode(nrows, bl);
+            ::decode(ndistinct, bl);
+            ::decode(bounds, bl);
+        }
         DECODE_FINISH(bl);
     }
 
@@ -544,6 +865,13 @@ struct col_stats {
             s.append(std::to_string(hist[i]) + ",");
         }
         s.append(">");
+        s.append("col_stats.nrows=" + std::to_string(nrows));
+        s.append("col_stats.ndistinct=" + std::to_string(ndistinct));
+        s.append("col_stats.bounds<");
+        for (unsigned int i=0; i<bounds.size(); i++) {
+            s.append(std::to_string(bounds[i]) + ",");
+        }
+        s.append(">");
         return s;
     }
 };
@@ -10,49 +10,608 @@
 
 
 #include "cls_tabular_utils.h"
+#include <parquet/arrow/reader.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/exception.h>
 
 
 namespace Tables {
 
-int processArrow(
+#define RETURN_ON_FAILURE(expr)                                 \
+    do {                                                        \
+        arrow::Status status_ = (expr);                         \
+        if (!status_.ok()) {                                    \
+            return TablesErrCodes::ArrowStatusErr;              \
+        }                                                       \
+    } while (0);
+
+/*
+ * Columnar comparison kernel: evaluates one predicate over a contiguous
+ * array of col values, writing one byte per row (1=pass) into out.  The op
+ * switch is hoisted out of the loops so each loop body is a branch-free
+ * compare over the raw values, which the compiler auto-vectorizes.
+ * Used for both arrow arrays and columnar flatbuf vectors.
+ */
+template <typename V, typename T>
+static int compareKernel(const V* vals,
+                         const int64_t n,
+                         const T predval,
+                         const int op,
+                         uint8_t* out)
+{
+    switch (op) {
+        case SOT_lt:
+            for (int64_t i = 0; i < n; i++) out[i] = vals[i] < predval;
+            break;
+        case SOT_gt:
+            for (int64_t i = 0; i < n; i++) out[i] = vals[i] > predval;
+            break;
+        case SOT_eq:
+            for (int64_t i = 0; i < n; i++) out[i] = vals[i] == predval;
+            break;
+        case SOT_ne:
+            for (int64_t i = 0; i < n; i++) out[i] = vals[i] != predval;
+            break;
+        case SOT_leq:
+            for (int64_t i = 0; i < n; i++) out[i] = vals[i] <= predval;
+            break;
+        case SOT_geq:
+            for (int64_t i = 0; i < n; i++) out[i] = vals[i] >= predval;
+            break;
+        default:
+            return TablesErrCodes::PredicateComparisonNotDefined;
+    }
+    return 0;
+}
+
+// bitwise ops are only defined for unsigned integral cols.
+template <typename V, typename T>
+static typename std::enable_if<!std::is_unsigned<T>::value, int>::type
+bitwiseKernel(const V* vals,
+              const int64_t n,
+              const T predval,
+              const int op,
+              uint8_t* out)
+{
+    return TablesErrCodes::PredicateComparisonNotDefined;
+}
+
+template <typename V, typename T>
+static typename std::enable_if<std::is_unsigned<T>::value, int>::type
+bitwiseKernel(const V* vals,
+              const int64_t n,
+              const T predval,
+              const int op,
+              uint8_t* out)
+{
+    switch (op) {
+        case SOT_bitwise_and:
+            for (int64_t i = 0; i < n; i++) out[i] = (vals[i] & predval) != 0;
+            break;
+        case SOT_bitwise_or:
+            for (int64_t i = 0; i < n; i++) out[i] = (vals[i] | predval) != 0;
+            break;
+        default:
+            return TablesErrCodes::PredicateComparisonNotDefined;
+    }
+    return 0;
+}
+
+template <typename V, typename T>
+static int predicateKernel(const V* vals,
+                           const int64_t n,
+                           const T predval,
+                           const int op,
+                           uint8_t* out)
+{
+    if (op == SOT_bitwise_and or op == SOT_bitwise_or)
+        return bitwiseKernel(vals, n, predval, op, out);
+    return compareKernel(vals, n, predval, op, out);
+}
+
+// apply the typed kernel to each chunk of a column, out spans all rows.
+template <typename ArrayType, typename T>
+static int arrowPredicateColumn(const std::shared_ptr<arrow::Column>& col,
+                                TypedPredicate<T>* p,
+                                uint8_t* out)
+{
+    int errcode = 0;
+    int64_t off = 0;
+    auto chunks = col->data()->chunks();
+    for (auto it = chunks.begin(); it != chunks.end() && !errcode; ++it) {
+        const ArrayType& arr = static_cast<const ArrayType&>(**it);
+        const int64_t n = arr.length();
+        errcode = predicateKernel(arr.raw_values(), n, p->Val(),
+                                  p->opType(), out + off);
+
+        // null values never pass a predicate
+        if (arr.null_count() > 0) {
+            for (int64_t i = 0; i < n; i++)
+                if (arr.IsNull(i)) out[off + i] = 0;
+        }
+        off += n;
+    }
+    return errcode;
+}
+
+// date cols are date32 arrays, or utf8 arrays in older arrow data.
+static int arrowPredicateDateColumn(
+        const std::shared_ptr<arrow::Column>& col,
+        TypedPredicate<std::string>* p,
+        uint8_t* out)
+{
+    int errcode = 0;
+    int64_t off = 0;
+    const int32_t predval = p->DateVal();
+    const int op = dateCompareOp(p->opType());
+    auto chunks = col->data()->chunks();
+    for (auto it = chunks.begin(); it != chunks.end() && !errcode; ++it) {
+        const int64_t n = (*it)->length();
+        if ((*it)->type_id() == arrow::Type::DATE32) {
+            const arrow::Date32Array& arr = \
+                    static_cast<const arrow::Date32Array&>(**it);
+            errcode = predicateKernel(arr.raw_values(), n, predval, op,
+                                      out + off);
+        } else {
+            const arrow::StringArray& arr = \
+                    static_cast<const arrow::StringArray&>(**it);
+            for (int64_t i = 0; i < n; i++) {
+                if (arr.IsNull(i)) continue;
+                int32_t len = 0;
+                const uint8_t* v = arr.GetValue(i, &len);
+                const int64_t colval = dateToDays(
+                        reinterpret_cast<const char*>(v), len);
+                out[off + i] = compare(colval, static_cast<int64_t>(predval),
+                                       op);
+            }
+        }
+
+        // null values never pass a predicate
+        if ((*it)->null_count() > 0) {
+            for (int64_t i = 0; i < n; i++)
+                if ((*it)->IsNull(i)) out[off + i] = 0;
+        }
+        off += n;
+    }
+    return errcode;
+}
+
+// the RID col is an int64 array after the data cols, RID preds are int64 or
+// uint64 (as RID_INDEX in a schema), RIDs are never negative.
+static int arrowPredicateRidColumn(const std::shared_ptr<arrow::Column>& col,
+                                   PredicateBase* pb,
+                                   uint8_t* out)
+{
+    if (pb->colType() == SDT_INT64)
+        return arrowPredicateColumn<arrow::Int64Array>(col,
+                dynamic_cast<TypedPredicate<int64_t>*>(pb), out);
+    if (pb->colType() != SDT_UINT64)
+        return TablesErrCodes::PredicateComparisonNotDefined;
+
+    TypedPredicate<uint64_t>* p = dynamic_cast<TypedPredicate<uint64_t>*>(pb);
+    int errcode = 0;
+    int64_t off = 0;
+    auto chunks = col->data()->chunks();
+    for (auto it = chunks.begin(); it != chunks.end() && !errcode; ++it) {
+        const arrow::Int64Array& arr = \
+                static_cast<const arrow::Int64Array&>(**it);
+        const int64_t n = arr.length();
+        errcode = predicateKernel(
+                reinterpret_cast<const uint64_t*>(arr.raw_values()), n,
+                p->Val(), p->opType(), out + off);
+        off += n;
+    }
+    return errcode;
+}
+
+// string cols are stored as utf8 arrays in our arrow format.
+static int arrowPredicateStringColumn(
+        const std::shared_ptr<arrow::Column>& col,
+        TypedPredicate<std::string>* p,
+        uint8_t* out)
+{
+    int64_t off = 0;
+    const std::string predval = p->Val();
+    auto chunks = col->data()->chunks();
+    for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+        const arrow::StringArray& arr = \
+                static_cast<const arrow::StringArray&>(**it);
+        const int64_t n = arr.length();
+        for (int64_t i = 0; i < n; i++) {
+            if (arr.IsNull(i)) {
+                out[off + i] = 0;
+                continue;
+            }
+            if (p->opType() == SOT_like) {
+                int32_t len = 0;
+                const uint8_t* v = arr.GetValue(i, &len);
+                out[off + i] = p->getLike()->match(
+                                reinterpret_cast<const char*>(v), len);
+            } else {
+                out[off + i] = compare(arr.GetString(i), predval,
+                                       p->opType(), p->colType());
+            }
+        }
+        off += n;
+    }
+    return 0;
+}
+
+/*
+ * Evaluate all (non-agg) predicates over whole arrow columns into a
+ * selection vector of one byte per row, combining each predicate's result
+ * per its chainOpType().  Mirrors the row-at-a-time semantics of
+ * applyPredicates(): once a row fails under a logical_and chain, later
+ * predicates (incl. logical_or) can no longer pass that row.
+ */
+int applyPredicatesArrow(predicate_vec& pv,
+                         std::shared_ptr<arrow::Table>& table,
+                         int num_cols,
+                         std::vector<uint8_t>& sel,
+                         std::string& errmsg)
+{
+    const int64_t nrows = table->num_rows();
+    std::vector<uint8_t> pass(nrows, 1);
+    std::vector<uint8_t> done(nrows, 0);
+    std::vector<uint8_t> colpass(nrows, 0);
+    bool init_pass = false;
+
+    for (auto it = pv.begin(); it != pv.end(); ++it) {
+        PredicateBase* pb = *it;
+        int chain_optype = pb->chainOpType();
+        int errcode = 0;
+
+        if (pb->isGlobalAgg()) {
+            errmsg.append("ERROR applyPredicatesArrow(): global aggregates"
+                          " not supported for arrow format.");
+            return TablesErrCodes::OpNotImplemented;
+        }
+
+        if (!init_pass) {
+            if (chain_optype == SOT_logical_or)
+                std::fill(pass.begin(), pass.end(), 0);
+            init_pass = true;
+        }
+
+        // RID is stored after the data cols
+        const bool rid = (pb->colIdx() == RID_COL_INDEX);
+        const int idx = rid ? ARROW_RID_INDEX(num_cols) : pb->colIdx();
+        if (idx < 0 or idx >= table->num_columns()) {
+            errmsg.append("ERROR applyPredicatesArrow(): col.idx=" +
+                          std::to_string(pb->colIdx()) + " OOB.");
+            return TablesErrCodes::RequestedColIndexOOB;
+        }
+        auto col = table->column(idx);
+        uint8_t* out = colpass.data();
+
+        if (rid) {
+            errcode = arrowPredicateRidColumn(col, pb, out);
+        } else {
+            switch (pb->colType()) {
+                case SDT_BOOL: {
+                    TypedPredicate<bool>* p = \
+                            dynamic_cast<TypedPredicate<bool>*>(pb);
+                    int64_t off = 0;
+                    auto chunks = col->data()->chunks();
+                    for (auto c = chunks.begin(); c != chunks.end(); ++c) {
+                        const arrow::BooleanArray& arr = \
+                                static_cast<const arrow::BooleanArray&>(**c);
+                        for (int64_t i = 0; i < arr.length(); i++)
+                            out[off + i] = !arr.IsNull(i) and
+                                           compare(arr.Value(i), p->Val(),
+                                                   p->opType());
+                        off += arr.length();
+                    }
+                    break;
+                }
+                case SDT_INT8:
+                    errcode = arrowPredicateColumn<arrow::Int8Array>(col,
+                            dynamic_cast<TypedPredicate<int8_t>*>(pb), out);
+                    break;
+                case SDT_INT16:
+                    errcode = arrowPredicateColumn<arrow::Int16Array>(col,
+                            dynamic_cast<TypedPredicate<int16_t>*>(pb), out);
+                    break;
+                case SDT_INT32:
+                    errcode = arrowPredicateColumn<arrow::Int32Array>(col,
+                            dynamic_cast<TypedPredicate<int32_t>*>(pb), out);
+                    break;
+                case SDT_INT64:
+                    errcode = arrowPredicateColumn<arrow::Int64Array>(col,
+                            dynamic_cast<TypedPredicate<int64_t>*>(pb), out);
+                    break;
+                case SDT_UINT8:
+                    errcode = arrowPredicateColumn<arrow::UInt8Array>(col,
+                            dynamic_cast<TypedPredicate<uint8_t>*>(pb), out);
+                    break;
+                case SDT_UINT16:
+                    errcode = arrowPredicateColumn<arrow::UInt16Array>(col,
+                            dynamic_cast<TypedPredicate<uint16_t>*>(pb), out);
+                    break;
+                case SDT_UINT32:
+                    errcode = arrowPredicateColumn<arrow::UInt32Array>(col,
+                            dynamic_cast<TypedPredicate<uint32_t>*>(pb), out);
+                    break;
+                case SDT_UINT64:
+                    errcode = arrowPredicateColumn<arrow::UInt64Array>(col,
+                            dynamic_cast<TypedPredicate<uint64_t>*>(pb), out);
+                    break;
+                case SDT_FLOAT:
+                    errcode = arrowPredicateColumn<arrow::FloatArray>(col,
+                            dynamic_cast<TypedPredicate<float>*>(pb), out);
+                    break;
+                case SDT_DOUBLE:
+                    errcode = arrowPredicateColumn<arrow::DoubleArray>(col,
+                            dynamic_cast<TypedPredicate<double>*>(pb), out);
+                    break;
+                case SDT_CHAR:
+                    errcode = arrowPredicateColumn<arrow::Int8Array>(col,
+                            dynamic_cast<TypedPredicate<char>*>(pb), out);
+                    break;
+                case SDT_UCHAR:
+                    errcode = arrowPredicateColumn<arrow::UInt8Array>(col,
+                            dynamic_cast<TypedPredicate<unsigned char>*>(pb),
+                            out);
+                    break;
+                case SDT_DATE:
+                    errcode = arrowPredicateDateColumn(col,
+                            dynamic_cast<TypedPredicate<std::string>*>(pb),
+                            out);
+                    break;
+                case SDT_STRING:
+                    errcode = arrowPredicateStringColumn(col,
+                            dynamic_cast<TypedPredicate<std::string>*>(pb),
+                            out);
+                    break;
+                default:
+                    errcode = TablesErrCodes::PredicateComparisonNotDefined;
+            }
+        }
+        if (errcode) {
+            errmsg.append("ERROR applyPredicatesArrow(): col.idx=" +
+                          std::to_string(pb->colIdx()) + " op=" +
+                          skyOpTypeToString(pb->opType()) +
+                          " not supported.");
+            return errcode;
+        }
+
+        // incorporate this col's selection into the row selection.
+        if (chain_optype == SOT_logical_or) {
+            for (int64_t i = 0; i < nrows; i++)
+                pass[i] |= (out[i] & !done[i]);
+        } else {  // default to logical AND
+            for (int64_t i = 0; i < nrows; i++) {
+                done[i] |= !pass[i];
+                pass[i] &= out[i];
+            }
+        }
+    }
+
+    for (int64_t i = 0; i < nrows; i++)
+        sel[i] &= pass[i];
+    return 0;
+}
+
+// append the selected values of one chunk to the given builder.
+template <typename ArrayType, typename BuilderType>
+static int arrowTakeChunk(const arrow::Array& chunk,
+                          const uint8_t* sel,
+                          arrow::ArrayBuilder* bldr)
+{
+    const ArrayType& arr = static_cast<const ArrayType&>(chunk);
+    BuilderType* b = static_cast<BuilderType*>(bldr);
+    for (int64_t i = 0; i < arr.length(); i++) {
+        if (!sel[i]) continue;
+        if (arr.IsNull(i))
+            RETURN_ON_FAILURE(b->AppendNull())
+        else
+            RETURN_ON_FAILURE(b->Append(arr.Value(i)))
+    }
+    return 0;
+}
+
+static int arrowTakeStringChunk(const arrow::Array& chunk,
+                                const uint8_t* sel,
+                                arrow::ArrayBuilder* bldr)
+{
+    const arrow::StringArray& arr = \
+            static_cast<const arrow::StringArray&>(chunk);
+    arrow::StringBuilder* b = static_cast<arrow::StringBuilder*>(bldr);
+    for (int64_t i = 0; i < arr.length(); i++) {
+        if (!sel[i]) continue;
+        if (arr.IsNull(i)) {
+            RETURN_ON_FAILURE(b->AppendNull())
+        } else {
+            int32_t len = 0;
+            const uint8_t* v = arr.GetValue(i, &len);
+            RETURN_ON_FAILURE(b->Append(v, len))
+        }
+    }
+    return 0;
+}
+
+/*
+ * Compact a column to only its selected rows, dispatching on the physical
+ * arrow type so it also applies to our RID and delete vector columns.
+ */
+int takeArrowColumn(const std::shared_ptr<arrow::Column>& col,
+                    const std::vector<uint8_t>& sel,
+                    std::shared_ptr<arrow::Array>* out)
+{
+    auto pool = arrow::default_memory_pool();
+    std::unique_ptr<arrow::ArrayBuilder> bldr;
+    int (*take)(const arrow::Array&, const uint8_t*, arrow::ArrayBuilder*);
+
+    switch (col->type()->id()) {
+        case arrow::Type::BOOL:
+            bldr.reset(new arrow::BooleanBuilder(pool));
+            take = arrowTakeChunk<arrow::BooleanArray, arrow::BooleanBuilder>;
+            break;
+        case arrow::Type::INT8:
+            bldr.reset(new arrow::Int8Builder(pool));
+            take = arrowTakeChunk<arrow::Int8Array, arrow::Int8Builder>;
+            break;
+        case arrow::Type::INT16:
+            bldr.reset(new arrow::Int16Builder(pool));
+            take = arrowTakeChunk<arrow::Int16Array, arrow::Int16Builder>;
+            break;
+        case arrow::Type::INT32:
+            bldr.reset(new arrow::Int32Builder(pool));
+            take = arrowTakeChunk<arrow::Int32Array, arrow::Int32Builder>;
+            break;
+        case arrow::Type::INT64:
+            bldr.reset(new arrow::Int64Builder(pool));
+            take = arrowTakeChunk<arrow::Int64Array, arrow::Int64Builder>;
+            break;
+        case arrow::Type::UINT8:
+            bldr.reset(new arrow::UInt8Builder(pool));
+            take = arrowTakeChunk<arrow::UInt8Array, arrow::UInt8Builder>;
+            break;
+        case arrow::Type::UINT16:
+            bldr.reset(new arrow::UInt16Builder(pool));
+            take = arrowTakeChunk<arrow::UInt16Array, arrow::UInt16Builder>;
+            break;
+        case arrow::Type::UINT32:
+            bldr.reset(new arrow::UInt32Builder(pool));
+            take = arrowTakeChunk<arrow::UInt32Array, arrow::UInt32Builder>;
+            break;
+        case arrow::Type::UINT64:
+            bldr.reset(new arrow::UInt64Builder(pool));
+            take = arrowTakeChunk<arrow::UInt64Array, arrow::UInt64Builder>;
+            break;
+        case arrow::Type::FLOAT:
+            bldr.reset(new arrow::FloatBuilder(pool));
+            take = arrowTakeChunk<arrow::FloatArray, arrow::FloatBuilder>;
+            break;
+        case arrow::Type::DOUBLE:
+            bldr.reset(new arrow::DoubleBuilder(pool));
+            take = arrowTakeChunk<arrow::DoubleArray, arrow::DoubleBuilder>;
+            break;
+        case arrow::Type::DATE32:
+            bldr.reset(new arrow::Date32Builder(pool));
+            take = arrowTakeChunk<arrow::Date32Array, arrow::Date32Builder>;
+            break;
+        case arrow::Type::STRING:
+            bldr.reset(new arrow::StringBuilder(pool));
+            take = arrowTakeStringChunk;
+            break;
+        default:
+            return TablesErrCodes::UnsupportedSkyDataType;
+    }
+
+    int64_t off = 0;
+    auto chunks = col->data()->chunks();
+    for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+        int errcode = take(**it, sel.data() + off, bldr.get());
+        if (errcode)
+            return errcode;
+        off += (*it)->length();
+    }
+    RETURN_ON_FAILURE(bldr->Finish(out));
+    return 0;
+}
+
+// as processArrow, over an already decoded table
+static int processArrowTable(
     std::shared_ptr<arrow::Table>* table,
     schema_vec& tbl_schema,
     schema_vec& query_schema,
     predicate_vec& preds,
-    const char* dataptr,
-    const size_t datasz,
+    std::shared_ptr<arrow::Table>& input_table,
     std::string& errmsg,
     const std::vector<uint32_t>& row_nums)
 {
-    std::shared_ptr<arrow::Buffer> buffer;
-    std::shared_ptr<arrow::Table> proj_table, temp_table;
-    std::string str_data(dataptr, datasz);
-    arrow::Buffer::FromString(str_data, &buffer);
-    extract_arrow_from_buffer(&proj_table, buffer);
-
-    auto schema = proj_table->schema();
+    int errcode = 0;
+    auto schema = input_table->schema();
     auto metadata = schema->metadata();
+    const int64_t nrows = input_table->num_rows();
+    const int num_cols = std::distance(tbl_schema.begin(), tbl_schema.end());
 
-    // identify the max col idx, to prevent flexbuf vector oob error
+    // identify the max col idx, to prevent arrow col index oob error
     int col_idx_max = -1;
     for (auto it = tbl_schema.begin(); it != tbl_schema.end(); ++it) {
         if (it->idx > col_idx_max)
             col_idx_max = it->idx;
     }
 
-    bool project_all = std::equal (tbl_schema.begin(), tbl_schema.end(),
-                                   query_schema.begin(), compareColInfo);
+    // 1. initialize the row selection: specified row numbers or all rows
+    std::vector<uint8_t> sel(nrows, 0);
+    if (row_nums.empty()) {
+        std::fill(sel.begin(), sel.end(), 1);
+    } else {
+        for (auto it = row_nums.begin(); it != row_nums.end(); ++it) {
+            if (*it >= nrows) {
+                errmsg += "ERROR: rnum(" + std::to_string(*it) +
+                          ") > nrows(" + std::to_string(nrows) + ")";
+                return RowIndexOOB;
+            }
+            sel[*it] = 1;
+        }
+    }
 
-    //    proj_table = std::make_shared<arrow::Table>(proj_table);
-    if (!project_all) {
-        for (auto it = query_schema.begin(); it != query_schema.end(); ++it) {
-            for (auto it2 = tbl_schema.begin(); it2 != tbl_schema.end(); ++it2) {
-                if (!it2->compareName((*it).name))
-                    proj_table->RemoveColumn((*it2).idx, &temp_table);
+    // 2. skip dead rows.
+    if (ARROW_DELVEC_INDEX(num_cols) < input_table->num_columns()) {
+        auto delcol = input_table->column(ARROW_DELVEC_INDEX(num_cols));
+        int64_t off = 0;
+        auto chunks = delcol->data()->chunks();
+        for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+            auto arr = *it;
+            if (arr->type_id() == arrow::Type::BOOL) {
+                auto dv = std::static_pointer_cast<arrow::BooleanArray>(arr);
+                for (int64_t i = 0; i < dv->length(); i++)
+                    sel[off + i] &= !dv->Value(i);
+            } else {
+                auto dv = std::static_pointer_cast<arrow::UInt8Array>(arr);
+                const uint8_t* vals = dv->raw_values();
+                for (int64_t i = 0; i < dv->length(); i++)
+                    sel[off + i] &= (vals[i] != 1);
             }
+            off += arr->length();
+        }
+    }
+
+    // 3. apply predicates over whole columns into the selection vector
+    if (!preds.empty()) {
+        errcode = applyPredicatesArrow(preds, input_table, num_cols, sel,
+                                       errmsg);
+        if (errcode)
+            return errcode;
+    }
+    int64_t nselected = 0;
+    for (int64_t i = 0; i < nrows; i++)
+        nselected += sel[i];
+
+    // 4. compact the projected cols (plus RID and delete vector) to the
+    //    selected rows.
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    std::vector<int> out_cols;
+    for (auto it = query_schema.begin(); it != query_schema.end(); ++it) {
+        if (it->idx < 0 or it->idx > col_idx_max or
+            it->idx >= input_table->num_columns()) {
+            errmsg.append("ERROR processArrow(): col.idx=" +
+                          std::to_string(it->idx) + " OOB.");
+            return TablesErrCodes::RequestedColIndexOOB;
+        }
+        out_cols.push_back(it->idx);
+    }
+    if (ARROW_DELVEC_INDEX(num_cols) < input_table->num_columns()) {
+        out_cols.push_back(ARROW_RID_INDEX(num_cols));
+        out_cols.push_back(ARROW_DELVEC_INDEX(num_cols));
+    }
+    for (auto it = out_cols.begin(); it != out_cols.end(); ++it) {
+        auto col = input_table->column(*it);
+        std::shared_ptr<arrow::Array> array;
+        errcode = takeArrowColumn(col, sel, &array);
+        if (errcode) {
+            errmsg.append("ERROR processArrow(): col=" + col->name() +
+                          " UnsupportedSkyDataType.");
+            return errcode;
         }
+        fields.push_back(col->field());
+        arrays.push_back(array);
     }
-    proj_table = temp_table;
+
     std::shared_ptr<arrow::KeyValueMetadata> proj_metadata (new arrow::KeyValueMetadata);
     // Add skyhook metadata to arrow metadata.
     proj_metadata->Append(ToString(METADATA_SKYHOOK_VERSION),
@@ -70,181 +629,450 @@ int processArrow(
     proj_metadata->Append(ToString(METADATA_TABLE_NAME),
                           metadata->value(METADATA_TABLE_NAME));
     proj_metadata->Append(ToString(METADATA_NUM_ROWS),
-                          metadata->value(METADATA_NUM_ROWS));
+                          std::to_string(nselected));
 
-    *table = proj_table->ReplaceSchemaMetadata(proj_metadata);
+    auto proj_schema = std::make_shared<arrow::Schema>(fields, proj_metadata);
+    *table = arrow::Table::Make(proj_schema, arrays);
     return 0;
 }
 
-int processSkyFb(
-    flatbuffers::FlatBufferBuilder& flatbldr,
+int processArrow(
+    std::shared_ptr<arrow::Table>* table,
     schema_vec& tbl_schema,
     schema_vec& query_schema,
     predicate_vec& preds,
-    const char* fb,
-    const size_t fb_size,
+    const char* dataptr,
+    const size_t datasz,
     std::string& errmsg,
-    const std::vector<uint32_t>& row_nums)
+    const std::vector<uint32_t>& row_nums,
+    uint64_t* nrows)
 {
-    int errcode = 0;
-    delete_vector dead_rows;
-    std::vector<flatbuffers::Offset<Tables::Record>> offs;
-    sky_root root = getSkyRoot(fb, fb_size);
+    std::shared_ptr<arrow::Buffer> buffer;
+    std::shared_ptr<arrow::Table> input_table;
+    std::string str_data(dataptr, datasz);
+    arrow::Buffer::FromString(str_data, &buffer);
+    extract_arrow_from_buffer(&input_table, buffer);
+    if (nrows)
+        *nrows = input_table->num_rows();
+    return processArrowTable(table, tbl_schema, query_schema, preds,
+                             input_table, errmsg, row_nums);
+}
 
-    // identify the max col idx, to prevent flexbuf vector oob error
-    int col_idx_max = -1;
-    for (auto it=tbl_schema.begin(); it!=tbl_schema.end(); ++it) {
-        if (it->idx > col_idx_max)
-            col_idx_max = it->idx;
+// the skyhook metadata of md, with num_rows set to nrows
+static std::shared_ptr<arrow::KeyValueMetadata> arrowMetadataWithRows(
+        const std::shared_ptr<const arrow::KeyValueMetadata>& md,
+        int64_t nrows)
+{
+    std::shared_ptr<arrow::KeyValueMetadata> out(new arrow::KeyValueMetadata);
+    for (int64_t i = 0; i < md->size(); i++) {
+        if (i == METADATA_NUM_ROWS)
+            out->Append(md->key(i), std::to_string(nrows));
+        else
+            out->Append(md->key(i), md->value(i));
     }
+    return out;
+}
 
-    bool project_all = std::equal (tbl_schema.begin(), tbl_schema.end(),
-                                   query_schema.begin(), compareColInfo);
-
-    // build the flexbuf with computed aggregates, aggs are computed for
-    // each row that passes, and added to flexbuf after loop below.
-    bool encode_aggs = false;
-    if (hasAggPreds(preds)) encode_aggs = true;
-    bool encode_rows = !encode_aggs;
+/*
+ * The min/max stats of a parquet row group as zone maps over its data cols.
+ * Only types whose parquet sort order matches ours get bounds, unsigned 32
+ * and 64 bit cols and strings are left unbounded.
+ */
+static void parquetRowGroupZones(const parquet::RowGroupMetaData& rg,
+                                 schema_vec& tbl_schema,
+                                 std::vector<col_zone>& zones)
+{
+    for (auto it = tbl_schema.begin(); it != tbl_schema.end(); ++it) {
+        if (it->idx < 0 or it->idx >= rg.num_columns())
+            continue;
+        auto chunk = rg.ColumnChunk(it->idx);
+        if (!chunk->is_stats_set())
+            continue;
+        std::shared_ptr<parquet::RowGroupStatistics> stats = \
+                chunk->statistics();
+        if (!stats or !stats->HasMinMax())
+            continue;
 
-    // determines if we process specific rows or all rows, since
-    // row_nums vector is optional parameter - default process all rows.
-    bool process_all_rows = true;
-    uint32_t nrows = root.nrows;
-    if (!row_nums.empty()) {
-        process_all_rows = false;  // process specified row numbers only
-        nrows = row_nums.size();
+        col_zone z(it->idx, it->type);
+        z.null_count = stats->null_count();
+        switch (it->type) {
+            case SDT_BOOL: {
+                auto st = std::static_pointer_cast<
+                                parquet::BoolStatistics>(stats);
+                z.imin = st->min();
+                z.imax = st->max();
+                z.has_bounds = true;
+                break;
+            }
+            case SDT_CHAR:
+            case SDT_INT8:
+            case SDT_INT16:
+            case SDT_INT32:
+            case SDT_DATE: {  // date32 days
+                auto st = std::static_pointer_cast<
+                                parquet::Int32Statistics>(stats);
+                z.imin = st->min();
+                z.imax = st->max();
+                z.has_bounds = true;
+                break;
+            }
+            case SDT_INT64: {
+                auto st = std::static_pointer_cast<
+                                parquet::Int64Statistics>(stats);
+                z.imin = st->min();
+                z.imax = st->max();
+                z.has_bounds = true;
+                break;
+            }
+            case SDT_UCHAR:
+            case SDT_UINT8:
+            case SDT_UINT16: {  // stored as int32, order is the same
+                auto st = std::static_pointer_cast<
+                                parquet::Int32Statistics>(stats);
+                z.umin = st->min();
+                z.umax = st->max();
+                z.has_bounds = true;
+                break;
+            }
+            case SDT_FLOAT: {
+                auto st = std::static_pointer_cast<
+                                parquet::FloatStatistics>(stats);
+                z.dmin = st->min();
+                z.dmax = st->max();
+                z.has_bounds = !std::isnan(z.dmin) and !std::isnan(z.dmax);
+                break;
+            }
+            case SDT_DOUBLE: {
+                auto st = std::static_pointer_cast<
+                                parquet::DoubleStatistics>(stats);
+                z.dmin = st->min();
+                z.dmax = st->max();
+                z.has_bounds = !std::isnan(z.dmin) and !std::isnan(z.dmax);
+                break;
+            }
+            default:
+                break;
+        }
+        zones.push_back(z);
     }
+}
 
-    // 1. check the preds for passing
-    // 2a. accumulate agg preds (return flexbuf built after all rows) or
-    // 2b. build the return flatbuf inline below from each row's projection
-    for (uint32_t i = 0; i < nrows; i++) {
+int processParquet(
+    std::vector<std::shared_ptr<arrow::Table>>& tables,
+    schema_vec& tbl_schema,
+    schema_vec& query_schema,
+    predicate_vec& preds,
+    const std::shared_ptr<arrow::io::RandomAccessFile>& file,
+    std::string& errmsg,
+    uint64_t& nrows,
+    int& rgs_skipped)
+{
+    int errcode = 0;
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    std::shared_ptr<parquet::FileMetaData> md;
+    try {
+        std::unique_ptr<parquet::ParquetFileReader> pq = \
+                parquet::ParquetFileReader::Open(file);
+        md = pq->metadata();
+        reader.reset(new parquet::arrow::FileReader(
+                            arrow::default_memory_pool(), std::move(pq)));
+    } catch (const parquet::ParquetException& e) {
+        errmsg.append("ERROR processParquet(): ");
+        errmsg.append(e.what());
+        return TablesErrCodes::ParquetErr;
+    }
+    auto skyhook_md = md->key_value_metadata();
+    if (!skyhook_md or skyhook_md->size() <= METADATA_NUM_ROWS) {
+        errmsg.append("ERROR processParquet(): no skyhook metadata");
+        return TablesErrCodes::ParquetErr;
+    }
 
-        // process row i or the specified row number
-        uint32_t rnum = 0;
-        if (process_all_rows) rnum = i;
-        else rnum = row_nums[i];
-        if (rnum > root.nrows) {
-            errmsg += "ERROR: rnum(" + std::to_string(rnum) +
-                      ") > root.nrows(" + to_string(root.nrows) + ")";
-            return RowIndexOOB;
+    // only the col chunks of projected and predicate cols (plus the RID and
+    // delete vector) are read, any others become null placeholders so that
+    // the table cols keep their schema idx.
+    const int num_cols = std::distance(tbl_schema.begin(), tbl_schema.end());
+    const int file_cols = md->num_columns();
+    std::vector<bool> needed(file_cols, false);
+    for (auto it = query_schema.begin(); it != query_schema.end(); ++it) {
+        if (it->idx >= 0 and it->idx < file_cols)
+            needed[it->idx] = true;
+    }
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if ((*it)->colIdx() >= 0 and (*it)->colIdx() < file_cols)
+            needed[(*it)->colIdx()] = true;
+    }
+    if (ARROW_DELVEC_INDEX(num_cols) < file_cols) {
+        needed[ARROW_RID_INDEX(num_cols)] = true;
+        needed[ARROW_DELVEC_INDEX(num_cols)] = true;
+    }
+    std::vector<int> col_indices;
+    for (int i = 0; i < file_cols; i++) {
+        if (needed[i])
+            col_indices.push_back(i);
+    }
+
+    const bool zone_prune = zoneMapsApplicable(preds);
+    for (int rg = 0; rg < md->num_row_groups(); rg++) {
+        auto rg_md = md->RowGroup(rg);
+        if (zone_prune) {
+            std::vector<col_zone> zones;
+            parquetRowGroupZones(*rg_md, tbl_schema, zones);
+            if (!zoneMapsMayMatch(zones, preds)) {
+                rgs_skipped++;
+                continue;
+            }
         }
 
-         // skip dead rows.
-        if (root.delete_vec[rnum] == 1) continue;
+        std::shared_ptr<arrow::Table> rg_table;
+        try {
+            RETURN_ON_FAILURE(reader->ReadRowGroup(rg, col_indices,
+                                                   &rg_table));
+        } catch (const parquet::ParquetException& e) {
+            errmsg.append("ERROR processParquet(): ");
+            errmsg.append(e.what());
+            return TablesErrCodes::ParquetErr;
+        }
+        const int64_t rg_rows = rg_table->num_rows();
+
+        std::vector<std::shared_ptr<arrow::Field>> fields;
+        std::vector<std::shared_ptr<arrow::Column>> cols;
+        for (int i = 0, k = 0; i < file_cols; i++) {
+            if (needed[i]) {
+                auto col = rg_table->column(k++);
+                fields.push_back(col->field());
+                cols.push_back(col);
+            } else {
+                auto field = arrow::field(md->schema()->Column(i)->name(),
+                                          arrow::null());
+                fields.push_back(field);
+                cols.push_back(std::make_shared<arrow::Column>(field,
+                        std::make_shared<arrow::NullArray>(rg_rows)));
+            }
+        }
+        auto schema = std::make_shared<arrow::Schema>(fields,
+                arrowMetadataWithRows(skyhook_md, rg_rows));
+        std::shared_ptr<arrow::Table> input_table = \
+                arrow::Table::Make(schema, cols);
+
+        std::shared_ptr<arrow::Table> out;
+        errcode = processArrowTable(&out, tbl_schema, query_schema, preds,
+                                    input_table, errmsg,
+                                    std::vector<uint32_t>());
+        if (errcode)
+            return errcode;
+        nrows += rg_rows;
+        tables.push_back(out);
+    }
+    return 0;
+}
 
-        // get a skyhook record struct
-        sky_rec rec = getSkyRec(root.offs->Get(rnum));
+int processSkyFb(
+    flatbuffers::FlatBufferBuilder& flatbldr,
+    schema_vec& tbl_schema,
+    schema_vec& query_schema,
+    predicate_vec& preds,
+    const char* fb,
+    const size_t fb_size,
+    std::string& errmsg,
+    const std::vector<uint32_t>& row_nums)
+{
+    if (isSkyFbCol(fb))
+        return processSkyFbCol(flatbldr, tbl_schema, query_schema, preds,
+                               fb, fb_size, errmsg, row_nums);
 
-        // apply predicates to this record
-        if (!preds.empty()) {
-            bool pass = applyPredicates(preds, rec);
-            if (!pass) continue;  // skip non matching rows.
-        }
+    int errcode = 0;
+    delete_vector dead_rows;
+    std::vector<flatbuffers::Offset<Tables::Record>> offs;
+    sky_root root = getSkyRoot(fb, fb_size);
 
-        if (!encode_rows) continue;  // just continue accumulating agg preds.
+    // identify the max col idx, to prevent flexbuf vector oob error
+    int col_idx_max = -1;
+    for (auto it=tbl_schema.begin(); it!=tbl_schema.end(); ++it) {
+        if (it->idx > col_idx_max)
+            col_idx_max = it->idx;
+    }
 
-        if (project_all) {
-            // TODO:  just pass through row table offset to root.offs, do not
-            // rebuild row table and flexbuf
-        }
+    bool project_all = tbl_schema.size() == query_schema.size() and
+                       std::equal (tbl_schema.begin(), tbl_schema.end(),
+                                   query_schema.begin(), compareColInfo);
 
-        // build the return projection for this row.
-        auto row = rec.data.AsVector();
-        flexbuffers::Builder *flexbldr = new flexbuffers::Builder();
-        flatbuffers::Offset<flatbuffers::Vector<unsigned char>> datavec;
+    // build the flexbuf with computed aggregates, aggs are computed for
+    // each row that passes, and added to flexbuf after loop below.
+    bool encode_aggs = false;
+    if (hasAggPreds(preds)) encode_aggs = true;
+    bool encode_rows = !encode_aggs;
 
-	flexbldr->Vector([&]() {
+    // determines if we process specific rows or all rows, since
+    // row_nums vector is optional parameter - default process all rows.
+    bool process_all_rows = true;
+    uint32_t nrows = root.nrows;
+    if (!row_nums.empty()) {
+        process_all_rows = false;  // process specified row numbers only
+        nrows = row_nums.size();
+    }
 
-            // iter over the query schema, locating it within the data schema
-            for (auto it=query_schema.begin();
-                      it!=query_schema.end() && !errcode; ++it) {
-                col_info col = *it;
-                if (col.idx < AGG_COL_LAST or col.idx > col_idx_max) {
-                    errcode = TablesErrCodes::RequestedColIndexOOB;
-                    errmsg.append("ERROR processSkyFb(): table=" +
-                            root.table_name + "; rid=" +
-                            std::to_string(rec.RID) + " col.idx=" +
-                            std::to_string(col.idx) + " OOB.");
+    // compile the predicates once for all rows
+    pred_plan plan = compilePredicates(preds);
+    std::vector<const Tables::Record*> recs;
+    std::vector<flexbuffers::Vector> rows;
+    std::vector<int64_t> rids;
+    std::vector<uint8_t> pass;
 
-                } else {
+    // 1. check the preds for passing, over a block of rows at a time
+    // 2a. accumulate agg preds (return flexbuf built after all rows) or
+    // 2b. build the return flatbuf inline below from each row's projection
+    for (uint32_t blk = 0; blk < nrows; blk += PRED_EVAL_BLOCK_SIZE) {
+        uint32_t blk_end = std::min(nrows, blk + PRED_EVAL_BLOCK_SIZE);
+        recs.clear();
+        rows.clear();
+        rids.clear();
+
+        for (uint32_t i = blk; i < blk_end; i++) {
+
+            // process row i or the specified row number
+            uint32_t rnum = 0;
+            if (process_all_rows) rnum = i;
+            else rnum = row_nums[i];
+            if (rnum > root.nrows) {
+                errmsg += "ERROR: rnum(" + std::to_string(rnum) +
+                          ") > root.nrows(" + to_string(root.nrows) + ")";
+                return RowIndexOOB;
+            }
+
+            // skip dead rows.
+            if (root.delete_vec[rnum] == 1) continue;
+
+            // refer to the record in place, nothing is copied here
+            const Tables::Record* rec = root.offs->Get(rnum);
+            recs.push_back(rec);
+            rows.push_back(rec->data_flexbuffer_root().AsVector());
+            rids.push_back(rec->RID());
+        }
+
+        // apply predicates to this block of records
+        applyPredicatesBlock(plan, rows, rids, pass);
+
+        if (!encode_rows) continue;  // just continue accumulating agg preds.
+
+        for (size_t j = 0; j < recs.size(); j++) {
+            if (!pass[j]) continue;  // skip non matching rows.
+            const Tables::Record* rec = recs[j];
+            const flexbuffers::Vector& row = rows[j];
+
+            if (project_all) {
+                // pass through the row's encoded flexbuf and nullbits
+                // byte-for-byte, only the enclosing record is rebuilt.
+                auto row_data = flatbldr.CreateVector(rec->data()->data(),
+                                                      rec->data()->size());
+                auto nullbits = flatbldr.CreateVector(
+                        rec->nullbits()->data(), rec->nullbits()->size());
+                flatbuffers::Offset<Tables::Record> row_off = \
+                        Tables::CreateRecord(flatbldr, rec->RID(), nullbits,
+                                             row_data);
+                dead_rows.push_back(0);
+                offs.push_back(row_off);
+                continue;
+            }
 
-                    switch(col.type) {  // encode data val into flexbuf
-
-                        case SDT_INT8:
-                            flexbldr->Add(row[col.idx].AsInt8());
-			    break;
-                        case SDT_INT16:
-                            flexbldr->Add(row[col.idx].AsInt16());
-			    break;
-                        case SDT_INT32:
-                            flexbldr->Add(row[col.idx].AsInt32());
-			    break;
-                        case SDT_INT64:
-                            flexbldr->Add(row[col.idx].AsInt64());
-                            break;
-                        case SDT_UINT8:
-                            flexbldr->Add(row[col.idx].AsUInt8());
-                            break;
-                        case SDT_UINT16:
-                            flexbldr->Add(row[col.idx].AsUInt16());
-                            break;
-                        case SDT_UINT32:
-                            flexbldr->Add(row[col.idx].AsUInt32());
-                            break;
-                        case SDT_UINT64:
-                            flexbldr->Add(row[col.idx].AsUInt64());
-                            break;
-                        case SDT_CHAR:
-                            flexbldr->Add(row[col.idx].AsInt8());
-                            break;
-                        case SDT_UCHAR:
-                            flexbldr->Add(row[col.idx].AsUInt8());
-                            break;
-			case SDT_BOOL:
-                            flexbldr->Add(row[col.idx].AsBool());
-                            break;
-			case SDT_FLOAT:
-                            flexbldr->Add(row[col.idx].AsFloat());
-                            break;
-                        case SDT_DOUBLE:
-                            flexbldr->Add(row[col.idx].AsDouble());
-                            break;
-			case SDT_DATE:
-                            flexbldr->Add(row[col.idx].AsString().str());
-                            break;
-                        case SDT_STRING:
-                            flexbldr->Add(row[col.idx].AsString().str());
-                            break;
-                        default: {
-                            errcode = TablesErrCodes::UnsupportedSkyDataType;
-                            errmsg.append("ERROR processSkyFb(): table=" +
-                                    root.table_name + "; rid=" +
-                                    std::to_string(rec.RID) + " col.type=" +
-                                    std::to_string(col.type) +
-                                    " UnsupportedSkyDataType.");
+            // build the return projection for this row.
+            flexbuffers::Builder *flexbldr = new flexbuffers::Builder();
+            flatbuffers::Offset<flatbuffers::Vector<unsigned char>> datavec;
+
+            flexbldr->Vector([&]() {
+
+                // iter over the query schema, locating it within the data schema
+                for (auto it=query_schema.begin();
+                          it!=query_schema.end() && !errcode; ++it) {
+                    col_info col = *it;
+                    if (col.idx < AGG_COL_LAST or col.idx > col_idx_max) {
+                        errcode = TablesErrCodes::RequestedColIndexOOB;
+                        errmsg.append("ERROR processSkyFb(): table=" +
+                                root.table_name + "; rid=" +
+                                std::to_string(rec->RID()) + " col.idx=" +
+                                std::to_string(col.idx) + " OOB.");
+
+                    } else {
+
+                        switch(col.type) {  // encode data val into flexbuf
+
+                            case SDT_INT8:
+                                flexbldr->Add(row[col.idx].AsInt8());
+                                break;
+                            case SDT_INT16:
+                                flexbldr->Add(row[col.idx].AsInt16());
+                                break;
+                            case SDT_INT32:
+                                flexbldr->Add(row[col.idx].AsInt32());
+                                break;
+                            case SDT_INT64:
+                                flexbldr->Add(row[col.idx].AsInt64());
+                                break;
+                            case SDT_UINT8:
+                                flexbldr->Add(row[col.idx].AsUInt8());
+                                break;
+                            case SDT_UINT16:
+                                flexbldr->Add(row[col.idx].AsUInt16());
+                                break;
+                            case SDT_UINT32:
+                                flexbldr->Add(row[col.idx].AsUInt32());
+                                break;
+                            case SDT_UINT64:
+                                flexbldr->Add(row[col.idx].AsUInt64());
+                                break;
+                            case SDT_CHAR:
+                                flexbldr->Add(row[col.idx].AsInt8());
+                                break;
+                            case SDT_UCHAR:
+                                flexbldr->Add(row[col.idx].AsUInt8());
+                                break;
+                            case SDT_BOOL:
+                                flexbldr->Add(row[col.idx].AsBool());
+                                break;
+                            case SDT_FLOAT:
+                                flexbldr->Add(row[col.idx].AsFloat());
+                                break;
+                            case SDT_DOUBLE:
+                                flexbldr->Add(row[col.idx].AsDouble());
+                                break;
+                            case SDT_DATE:  // keep the stored encoding
+                                if (row[col.idx].IsString())
+                                    flexbldr->Add(row[col.idx].AsString().str());
+                                else
+                                    flexbldr->Add(row[col.idx].AsInt32());
+                                break;
+                            case SDT_STRING:
+                                flexbldr->Add(row[col.idx].AsString().str());
+                                break;
+                            default: {
+                                errcode = TablesErrCodes::UnsupportedSkyDataType;
+                                errmsg.append("ERROR processSkyFb(): table=" +
+                                        root.table_name + "; rid=" +
+                                        std::to_string(rec->RID()) + " col.type=" +
+                                        std::to_string(col.type) +
+                                        " UnsupportedSkyDataType.");
+                            }
                         }
                     }
                 }
-            }
-        });
+            });
 
-        // finalize the row's projected data within our flexbuf
-        flexbldr->Finish();
+            // finalize the row's projected data within our flexbuf
+            flexbldr->Finish();
 
-        // build the return ROW flatbuf that contains the flexbuf data
-        auto row_data = flatbldr.CreateVector(flexbldr->GetBuffer());
-        delete flexbldr;
+            // build the return ROW flatbuf that contains the flexbuf data
+            auto row_data = flatbldr.CreateVector(flexbldr->GetBuffer());
+            delete flexbldr;
 
-        // TODO: update nullbits
-        auto nullbits = flatbldr.CreateVector(rec.nullbits);
-        flatbuffers::Offset<Tables::Record> row_off = \
-                Tables::CreateRecord(flatbldr, rec.RID, nullbits, row_data);
+            // TODO: update nullbits
+            auto nullbits = flatbldr.CreateVector(rec->nullbits()->data(),
+                                                  rec->nullbits()->size());
+            flatbuffers::Offset<Tables::Record> row_off = \
+                    Tables::CreateRecord(flatbldr, rec->RID(), nullbits, row_data);
 
-        // Continue building the ROOT flatbuf's dead vector and rowOffsets vec
-        dead_rows.push_back(0);
-        offs.push_back(row_off);
+            // Continue building the ROOT flatbuf's dead vector and rowOffsets vec
+            dead_rows.push_back(0);
+            offs.push_back(row_off);
+        }
     }
 
     if (encode_aggs) { //  encode each pred agg into return flexbuf.
@@ -424,14 +1252,36 @@ schema_vec schemaFromString(std::string schema_string) {
 }
 
 predicate_vec predsFromString(schema_vec &schema, std::string preds_string) {
+    predicate_vec preds;
+    int ret = predsFromString(schema, preds_string, preds);
+    if (ret != 0) {
+        cerr << "Error: invalid predicate value in " << preds_string
+             << std::endl;
+        assert (TablesErrCodes::PredicateValueInvalid == 0);
+    }
+    return preds;
+}
+
+static void deletePreds(predicate_vec& preds) {
+    for (auto it = preds.begin(); it != preds.end(); ++it)
+        delete *it;
+    preds.clear();
+}
+
+/*
+ * As above, but returns TablesErrCodes::PredicateValueInvalid for a val
+ * that does not convert to its col type rather than throwing, for callers
+ * decoding preds from a request, i.e., within cls methods.
+ */
+int predsFromString(schema_vec &schema, std::string preds_string,
+                    predicate_vec &preds) {
     // format:  ;colname,opname,value;colname,opname,value;...
     // e.g., ;orderkey,eq,5;comment,like,hello world;..
 
-    predicate_vec preds;
     boost::trim(preds_string);  // whitespace
     boost::trim_if(preds_string, boost::is_any_of(PRED_DELIM_OUTER));
 
-    if (preds_string.empty() || preds_string== SELECT_DEFAULT) return preds;
+    if (preds_string.empty() || preds_string== SELECT_DEFAULT) return 0;
 
     vector<std::string> pred_items;
     boost::split(pred_items, preds_string, boost::is_any_of(PRED_DELIM_OUTER),
@@ -461,135 +1311,152 @@ predicate_vec predsFromString(schema_vec &schema, std::string preds_string) {
         col_info ci = sv.at(0);
         int op_type = skyOpTypeFromString(opname);
 
-        switch (ci.type) {
+        // vals are converted to the col type, a date val must be a valid
+        // date unless the op is an agg, which ignores its val.
+        int32_t days = 0;
+        if (ci.type == SDT_DATE and
+            !(op_type == SOT_min || op_type == SOT_max || op_type == SOT_sum ||
+              op_type == SOT_cnt || op_type == SOT_avg) and
+            !parseDate(val.data(), val.size(), days)) {
+            deletePreds(preds);
+            deletePreds(agg_preds);
+            return TablesErrCodes::PredicateValueInvalid;
+        }
+        try {
+            switch (ci.type) {
 
-            case SDT_BOOL: {
-                TypedPredicate<bool>* p = \
-                        new TypedPredicate<bool> \
-                        (ci.idx, ci.type, op_type, std::stol(val));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_INT8: {
-                TypedPredicate<int8_t>* p = \
-                        new TypedPredicate<int8_t> \
-                        (ci.idx, ci.type, op_type, \
-                        static_cast<int8_t>(std::stol(val)));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_INT16: {
-                TypedPredicate<int16_t>* p = \
-                        new TypedPredicate<int16_t> \
-                        (ci.idx, ci.type, op_type, \
-                        static_cast<int16_t>(std::stol(val)));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_INT32: {
-                TypedPredicate<int32_t>* p = \
-                        new TypedPredicate<int32_t> \
-                        (ci.idx, ci.type, op_type, \
-                        static_cast<int32_t>(std::stol(val)));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_INT64: {
-                TypedPredicate<int64_t>* p = \
-                        new TypedPredicate<int64_t> \
-                        (ci.idx, ci.type, op_type, \
-                        static_cast<int64_t>(std::stoll(val)));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_UINT8: {
-                TypedPredicate<uint8_t>* p = \
-                        new TypedPredicate<uint8_t> \
-                        (ci.idx, ci.type, op_type, \
-                        static_cast<uint8_t>(std::stoul(val)));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_UINT16: {
-                TypedPredicate<uint16_t>* p = \
-                        new TypedPredicate<uint16_t> \
-                        (ci.idx, ci.type, op_type,
-                        static_cast<uint16_t>(std::stoul(val)));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_UINT32: {
-                TypedPredicate<uint32_t>* p = \
-                        new TypedPredicate<uint32_t> \
-                        (ci.idx, ci.type, op_type,
-                        static_cast<uint32_t>(std::stoul(val)));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_UINT64: {
-                TypedPredicate<uint64_t>* p = \
-                        new TypedPredicate<uint64_t> \
-                        (ci.idx, ci.type, op_type, \
-                        static_cast<uint64_t>(std::stoull(val)));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_FLOAT: {
-                TypedPredicate<float>* p = \
-                        new TypedPredicate<float> \
-                        (ci.idx, ci.type, op_type, std::stof(val));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_DOUBLE: {
-                TypedPredicate<double>* p = \
-                        new TypedPredicate<double> \
-                        (ci.idx, ci.type, op_type, std::stod(val));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_CHAR: {
-                TypedPredicate<char>* p = \
-                        new TypedPredicate<char> \
-                        (ci.idx, ci.type, op_type, std::stol(val));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_UCHAR: {
-                TypedPredicate<unsigned char>* p = \
-                        new TypedPredicate<unsigned char> \
-                        (ci.idx, ci.type, op_type, std::stoul(val));
-                if (p->isGlobalAgg()) agg_preds.push_back(p);
-                else preds.push_back(p);
-                break;
-            }
-            case SDT_STRING: {
-                TypedPredicate<std::string>* p = \
-                        new TypedPredicate<std::string> \
-                        (ci.idx, ci.type, op_type, val);
-                preds.push_back(p);
-                break;
-            }
-            case SDT_DATE: {
-                TypedPredicate<std::string>* p = \
-                        new TypedPredicate<std::string> \
-                        (ci.idx, ci.type, op_type, val);
-                preds.push_back(p);
-                break;
+                case SDT_BOOL: {
+                    TypedPredicate<bool>* p = \
+                            new TypedPredicate<bool> \
+                            (ci.idx, ci.type, op_type, std::stol(val));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_INT8: {
+                    TypedPredicate<int8_t>* p = \
+                            new TypedPredicate<int8_t> \
+                            (ci.idx, ci.type, op_type, \
+                            static_cast<int8_t>(std::stol(val)));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_INT16: {
+                    TypedPredicate<int16_t>* p = \
+                            new TypedPredicate<int16_t> \
+                            (ci.idx, ci.type, op_type, \
+                            static_cast<int16_t>(std::stol(val)));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_INT32: {
+                    TypedPredicate<int32_t>* p = \
+                            new TypedPredicate<int32_t> \
+                            (ci.idx, ci.type, op_type, \
+                            static_cast<int32_t>(std::stol(val)));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_INT64: {
+                    TypedPredicate<int64_t>* p = \
+                            new TypedPredicate<int64_t> \
+                            (ci.idx, ci.type, op_type, \
+                            static_cast<int64_t>(std::stoll(val)));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_UINT8: {
+                    TypedPredicate<uint8_t>* p = \
+                            new TypedPredicate<uint8_t> \
+                            (ci.idx, ci.type, op_type, \
+                            static_cast<uint8_t>(std::stoul(val)));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_UINT16: {
+                    TypedPredicate<uint16_t>* p = \
+                            new TypedPredicate<uint16_t> \
+                            (ci.idx, ci.type, op_type,
+                            static_cast<uint16_t>(std::stoul(val)));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_UINT32: {
+                    TypedPredicate<uint32_t>* p = \
+                            new TypedPredicate<uint32_t> \
+                            (ci.idx, ci.type, op_type,
+                            static_cast<uint32_t>(std::stoul(val)));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_UINT64: {
+                    TypedPredicate<uint64_t>* p = \
+                            new TypedPredicate<uint64_t> \
+                            (ci.idx, ci.type, op_type, \
+                            static_cast<uint64_t>(std::stoull(val)));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_FLOAT: {
+                    TypedPredicate<float>* p = \
+                            new TypedPredicate<float> \
+                            (ci.idx, ci.type, op_type, std::stof(val));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_DOUBLE: {
+                    TypedPredicate<double>* p = \
+                            new TypedPredicate<double> \
+                            (ci.idx, ci.type, op_type, std::stod(val));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_CHAR: {
+                    TypedPredicate<char>* p = \
+                            new TypedPredicate<char> \
+                            (ci.idx, ci.type, op_type, std::stol(val));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_UCHAR: {
+                    TypedPredicate<unsigned char>* p = \
+                            new TypedPredicate<unsigned char> \
+                            (ci.idx, ci.type, op_type, std::stoul(val));
+                    if (p->isGlobalAgg()) agg_preds.push_back(p);
+                    else preds.push_back(p);
+                    break;
+                }
+                case SDT_STRING: {
+                    TypedPredicate<std::string>* p = \
+                            new TypedPredicate<std::string> \
+                            (ci.idx, ci.type, op_type, val);
+                    preds.push_back(p);
+                    break;
+                }
+                case SDT_DATE: {
+                    TypedPredicate<std::string>* p = \
+                            new TypedPredicate<std::string> \
+                            (ci.idx, ci.type, op_type, val);
+                    preds.push_back(p);
+                    break;
+                }
+                default: assert (TablesErrCodes::UnknownSkyDataType==0);
             }
-            default: assert (TablesErrCodes::UnknownSkyDataType==0);
+        } catch (const std::exception&) {
+            deletePreds(preds);
+            deletePreds(agg_preds);
+            return TablesErrCodes::PredicateValueInvalid;
         }
     }
 
@@ -602,7 +1469,7 @@ predicate_vec predsFromString(schema_vec &schema, std::string preds_string) {
         agg_preds.clear();
         agg_preds.shrink_to_fit();
     }
-    return preds;
+    return 0;
 }
 
 std::vector<std::string> colnamesFromPreds(predicate_vec &preds,
@@ -772,6 +1639,7 @@ int skyOpTypeFromString(std::string op) {
     else if (op=="max") op_type = SOT_max;
     else if (op=="sum") op_type = SOT_sum;
     else if (op=="cnt") op_type = SOT_cnt;
+    else if (op=="avg") op_type = SOT_avg;
     else if (op=="like") op_type = SOT_like;
     else if (op=="in") op_type = SOT_in;
     else if (op=="not_in") op_type = SOT_not_in;
@@ -806,6 +1674,7 @@ std::string skyOpTypeToString(int op) {
     else if (op==SOT_max) op_str = "max";
     else if (op==SOT_sum) op_str = "sum";
     else if (op==SOT_cnt) op_str = "cnt";
+    else if (op==SOT_avg) op_str = "avg";
     else if (op==SOT_like) op_str = "like";
     else if (op==SOT_in) op_str = "in";
     else if (op==SOT_not_in) op_str = "not_in";
@@ -824,29 +1693,29 @@ std::string skyOpTypeToString(int op) {
     return op_str;
 }
 
-void printSkyRootHeader(sky_root &r) {
-    std::cout << "\n\n\n[SKYHOOKDB ROOT HEADER (flatbuf)]"<< std::endl;
-    std::cout << "data_format_type: "<< r.data_format_type << std::endl;
-    std::cout << "schema version: "<< r.data_structure_version << std::endl;
-    std::cout << "db_schema: "<< r.db_schema << std::endl;
-    std::cout << "table name: "<< r.table_name << std::endl;
-    std::cout << "data_schema: \n"<< r.data_schema << std::endl;
+void printSkyRootHeader(sky_root &r, std::ostream& out = std::cout) {
+    out << "\n\n\n[SKYHOOKDB ROOT HEADER (flatbuf)]"<< std::endl;
+    out << "data_format_type: "<< r.data_format_type << std::endl;
+    out << "schema version: "<< r.data_structure_version << std::endl;
+    out << "db_schema: "<< r.db_schema << std::endl;
+    out << "table name: "<< r.table_name << std::endl;
+    out << "data_schema: \n"<< r.data_schema << std::endl;
 
-    std::cout << "delete vector: [";
+    out << "delete vector: [";
     for (int i=0; i< (int)r.delete_vec.size(); i++) {
-        std::cout << (int)r.delete_vec[i];
+        out << (int)r.delete_vec[i];
         if (i != (int)r.delete_vec.size()-1)
-            std::cout <<", ";
+            out <<", ";
     }
-    std::cout << "]" << std::endl;
-    std::cout << "nrows: " << r.nrows << std::endl;
-    std::cout << std::endl;
+    out << "]" << std::endl;
+    out << "nrows: " << r.nrows << std::endl;
+    out << std::endl;
 }
 
-void printSkyRecHeader(sky_rec &r) {
+void printSkyRecHeader(sky_rec &r, std::ostream& out = std::cout) {
 
-    std::cout << "\n\n[SKYHOOKDB ROW HEADER (flatbuf)]" << std::endl;
-    std::cout << "RID: "<< r.RID << std::endl;
+    out << "\n\n[SKYHOOKDB ROW HEADER (flatbuf)]" << std::endl;
+    out << "RID: "<< r.RID << std::endl;
 
     std::string bitstring = "";
     int64_t val = 0;
@@ -858,9 +1727,9 @@ void printSkyRecHeader(sky_rec &r) {
             ((val&mask)>0) ? bit=1 : bit=0;
             bitstring.append(std::to_string(bit));
         }
-        std::cout << "nullbits ["<< j << "]: val=" << val << ": bits="
+        out << "nullbits ["<< j << "]: val=" << val << ": bits="
                   << bitstring;
-        std::cout << std::endl;
+        out << std::endl;
         bitstring.clear();
     }
 }
@@ -868,6 +1737,11 @@ void printSkyRecHeader(sky_rec &r) {
 // parent print function for skyhook flatbuffer data layout
 void printSkyFb(const char* fb, size_t fb_size) {
 
+    if (isSkyFbCol(fb)) {
+        printFlatbufColAsCsv(fb, fb_size, true, true, ROW_LIMIT_DEFAULT);
+        return;
+    }
+
     // get root table ptr
     sky_root skyroot = getSkyRoot(fb, fb_size);
     if (skyroot.nrows == 0) return;  // nothing to see here...
@@ -939,7 +1813,7 @@ void printSkyFb(const char* fb, size_t fb_size) {
                 case SDT_UCHAR: std::cout <<
                     std::string(1, row[j].AsUInt8()); break;
                 case SDT_DATE: std::cout <<
-                    row[j].AsString().str(); break;
+                    flexDateString(row[j]); break;
                 case SDT_STRING: std::cout <<
                     row[j].AsString().str(); break;
                 default: assert (TablesErrCodes::UnknownSkyDataType==0);
@@ -954,7 +1828,12 @@ long long int printFlatbufFlexRowAsCsv(const char* dataptr,
                               const size_t datasz,
                               bool print_header,
                               bool print_verbose,
-                              long long int max_to_print) {
+                              long long int max_to_print,
+                              std::ostream& out) {
+
+    if (isSkyFbCol(dataptr))
+        return printFlatbufColAsCsv(dataptr, datasz, print_header,
+                                    print_verbose, max_to_print, out);
 
     // get root table ptr as sky struct
     sky_root skyroot = getSkyRoot(dataptr, datasz);
@@ -962,40 +1841,41 @@ long long int printFlatbufFlexRowAsCsv(const char* dataptr,
     assert(!sc.empty());
 
     if (print_verbose)
-        printSkyRootHeader(skyroot);
+        printSkyRootHeader(skyroot, out);
 
     // print header row showing schema
     if (print_header) {
         bool first = true;
         for (schema_vec::iterator it = sc.begin(); it != sc.end(); ++it) {
-            if (!first) std::cout << CSV_DELIM;
+            if (!first) out << CSV_DELIM;
             first = false;
-            std::cout << it->name;
-            if (it->is_key) std::cout << "(key)";
-            if (!it->nullable) std::cout << "(NOT NULL)";
+            out << it->name;
+            if (it->is_key) out << "(key)";
+            if (!it->nullable) out << "(NOT NULL)";
 
         }
-        std::cout << std::endl; // newline to start first row.
+        out << std::endl; // newline to start first row.
     }
 
-    long long int counter = 0;
-    for (uint32_t i = 0; i < skyroot.nrows; i++, counter++) {
+    long long int counter = 0;  // rows printed, dead rows do not count
+    for (uint32_t i = 0; i < skyroot.nrows; i++) {
         if (counter >= max_to_print)
             break;
 
         if (skyroot.delete_vec.at(i) == 1) continue;  // skip dead rows.
+        counter++;
 
         // get the record struct, then the row data
         sky_rec skyrec = getSkyRec(skyroot.offs->Get(i));
         auto row = skyrec.data.AsVector();
 
         if (print_verbose)
-            printSkyRecHeader(skyrec);
+            printSkyRecHeader(skyrec, out);
 
         // for each col in the row, print a NULL or the col's value/
         bool first = true;
         for (uint32_t j = 0; j < sc.size(); j++ ) {
-            if (!first) std::cout << CSV_DELIM;
+            if (!first) out << CSV_DELIM;
             first = false;
             col_info col = sc.at(j);
 
@@ -1007,40 +1887,59 @@ long long int printFlatbufFlexRowAsCsv(const char* dataptr,
                     is_null =true;
                 }
                 if (is_null) {
-                    std::cout << "NULL";
+                    out << "NULL";
                     continue;
                 }
             }
             switch (col.type) {
-                case SDT_BOOL: std::cout << row[j].AsBool(); break;
-                case SDT_INT8: std::cout << row[j].AsInt8(); break;
-                case SDT_INT16: std::cout << row[j].AsInt16(); break;
-                case SDT_INT32: std::cout << row[j].AsInt32(); break;
-                case SDT_INT64: std::cout << row[j].AsInt64(); break;
-                case SDT_UINT8: std::cout << row[j].AsUInt8(); break;
-                case SDT_UINT16: std::cout << row[j].AsUInt16(); break;
-                case SDT_UINT32: std::cout << row[j].AsUInt32(); break;
-                case SDT_UINT64: std::cout << row[j].AsUInt64(); break;
-                case SDT_FLOAT: std::cout << row[j].AsFloat(); break;
-                case SDT_DOUBLE: std::cout << row[j].AsDouble(); break;
-                case SDT_CHAR: std::cout <<
+                case SDT_BOOL: out << row[j].AsBool(); break;
+                case SDT_INT8: out << row[j].AsInt8(); break;
+                case SDT_INT16: out << row[j].AsInt16(); break;
+                case SDT_INT32: out << row[j].AsInt32(); break;
+                case SDT_INT64: out << row[j].AsInt64(); break;
+                case SDT_UINT8: out << row[j].AsUInt8(); break;
+                case SDT_UINT16: out << row[j].AsUInt16(); break;
+                case SDT_UINT32: out << row[j].AsUInt32(); break;
+                case SDT_UINT64: out << row[j].AsUInt64(); break;
+                case SDT_FLOAT: out << row[j].AsFloat(); break;
+                case SDT_DOUBLE: out << row[j].AsDouble(); break;
+                case SDT_CHAR: out <<
                     std::string(1, row[j].AsInt8()); break;
-                case SDT_UCHAR: std::cout <<
+                case SDT_UCHAR: out <<
                     std::string(1, row[j].AsUInt8()); break;
-                case SDT_DATE: std::cout <<
-                    row[j].AsString().str(); break;
-                case SDT_STRING: std::cout <<
+                case SDT_DATE: out <<
+                    flexDateString(row[j]); break;
+                case SDT_STRING: out <<
                     row[j].AsString().str(); break;
                 default: assert (TablesErrCodes::UnknownSkyDataType);
             }
         }
-        std::cout << std::endl;  // newline to start next row.
+        out << std::endl;  // newline to start next row.
     }
     return counter;
 }
 
 sky_root getSkyRoot(const char *fb, size_t fb_size) {
 
+    if (isSkyFbCol(fb)) {
+        const Table_COL* root = GetTable_COL(fb);
+        return sky_root(
+            root->data_format_type(),
+            root->skyhook_version(),
+            root->data_structure_version(),
+            root->data_schema_version(),
+            root->data_schema()->str(),
+            root->db_schema()->str(),
+            root->table_name()->str(),
+            delete_vector(root->delete_vector()->begin(),
+                          root->delete_vector()->end()),
+            nullptr,
+            root->nrows(),
+            root->cols(),
+            root->RIDs()
+        );
+    }
+
     const Table* root = GetTable(fb);
 
     return sky_root(
@@ -1126,205 +2025,2606 @@ bool applyPredicates(predicate_vec& pv, sky_rec& rec) {
                 break;
             }
 
-            case SDT_INT16: {
-                TypedPredicate<int16_t>* p = \
-                        dynamic_cast<TypedPredicate<int16_t>*>(*it);
-                int16_t colval = row[p->colIdx()].AsInt16();
-                int16_t predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,
-                                      static_cast<int64_t>(predval),
-                                      p->opType());
-                break;
-            }
+            case SDT_INT16: {
+                TypedPredicate<int16_t>* p = \
+                        dynamic_cast<TypedPredicate<int16_t>*>(*it);
+                int16_t colval = row[p->colIdx()].AsInt16();
+                int16_t predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,
+                                      static_cast<int64_t>(predval),
+                                      p->opType());
+                break;
+            }
+
+            case SDT_INT32: {
+                TypedPredicate<int32_t>* p = \
+                        dynamic_cast<TypedPredicate<int32_t>*>(*it);
+                int32_t colval = row[p->colIdx()].AsInt32();
+                int32_t predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,
+                                      static_cast<int64_t>(predval),
+                                      p->opType());
+                break;
+            }
+
+            case SDT_INT64: {
+                TypedPredicate<int64_t>* p = \
+                        dynamic_cast<TypedPredicate<int64_t>*>(*it);
+                int64_t colval = 0;
+                if ((*it)->colIdx() == RID_COL_INDEX)
+                    colval = rec.RID;  // RID val not in the row
+                else
+                    colval = row[p->colIdx()].AsInt64();
+                int64_t predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,predval,p->opType());
+                break;
+            }
+
+            case SDT_UINT8: {
+                TypedPredicate<uint8_t>* p = \
+                        dynamic_cast<TypedPredicate<uint8_t>*>(*it);
+                uint8_t colval = row[p->colIdx()].AsUInt8();
+                uint8_t predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,
+                                      static_cast<uint64_t>(predval),
+                                      p->opType());
+                break;
+            }
+
+            case SDT_UINT16: {
+                TypedPredicate<uint16_t>* p = \
+                        dynamic_cast<TypedPredicate<uint16_t>*>(*it);
+                uint16_t colval = row[p->colIdx()].AsUInt16();
+                uint16_t predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,
+                                      static_cast<uint64_t>(predval),
+                                      p->opType());
+                break;
+            }
+
+            case SDT_UINT32: {
+                TypedPredicate<uint32_t>* p = \
+                        dynamic_cast<TypedPredicate<uint32_t>*>(*it);
+                uint32_t colval = row[p->colIdx()].AsUInt32();
+                uint32_t predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,
+                                      static_cast<uint64_t>(predval),
+                                      p->opType());
+                break;
+            }
+
+            case SDT_UINT64: {
+                TypedPredicate<uint64_t>* p = \
+                        dynamic_cast<TypedPredicate<uint64_t>*>(*it);
+                uint64_t colval = 0;
+                if ((*it)->colIdx() == RID_COL_INDEX) // RID val not in the row
+                    colval = rec.RID;
+                else
+                    colval = row[p->colIdx()].AsUInt64();
+                uint64_t predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,predval,p->opType());
+                break;
+            }
+
+            case SDT_FLOAT: {
+                TypedPredicate<float>* p = \
+                        dynamic_cast<TypedPredicate<float>*>(*it);
+                float colval = row[p->colIdx()].AsFloat();
+                float predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,
+                                      static_cast<double>(predval),
+                                      p->opType());
+                break;
+            }
+
+            case SDT_DOUBLE: {
+                TypedPredicate<double>* p = \
+                        dynamic_cast<TypedPredicate<double>*>(*it);
+                double colval = row[p->colIdx()].AsDouble();
+                double predval = p->Val();
+                if (p->isGlobalAgg())
+                    p->updateAgg(computeAgg(colval,predval,p->opType()));
+                else
+                    colpass = compare(colval,predval,p->opType());
+                break;
+            }
+
+            case SDT_CHAR: {
+                TypedPredicate<char>* p= \
+                        dynamic_cast<TypedPredicate<char>*>(*it);
+                if (p->opType() == SOT_like) {
+                    // use strings for regex
+                    std::string colval = row[p->colIdx()].AsString().str();
+                    std::string predval = std::to_string(p->Val());
+                    colpass = compare(colval,predval,p->opType(),p->colType());
+                }
+                else {
+                    // use int val comparision method
+                    int8_t colval = row[p->colIdx()].AsInt8();
+                    int8_t predval = p->Val();
+                    if (p->isGlobalAgg())
+                        p->updateAgg(computeAgg(colval,predval,p->opType()));
+                    else
+                        colpass = compare(colval,
+                                          static_cast<int64_t>(predval),
+                                          p->opType());
+                }
+                break;
+            }
+
+            case SDT_UCHAR: {
+                TypedPredicate<unsigned char>* p = \
+                        dynamic_cast<TypedPredicate<unsigned char>*>(*it);
+                if (p->opType() == SOT_like) {
+                    // use strings for regex
+                    std::string colval = row[p->colIdx()].AsString().str();
+                    std::string predval = std::to_string(p->Val());
+                    colpass = compare(colval,predval,p->opType(),p->colType());
+                }
+                else {
+                    // use int val comparision method
+                    uint8_t colval = row[p->colIdx()].AsUInt8();
+                    uint8_t predval = p->Val();
+                    if (p->isGlobalAgg())
+                        p->updateAgg(computeAgg(colval,predval,p->opType()));
+                    else
+                        colpass = compare(colval,
+                                          static_cast<uint64_t>(predval),
+                                          p->opType());
+                }
+                break;
+            }
+
+            case SDT_STRING: {
+                TypedPredicate<std::string>* p = \
+                        dynamic_cast<TypedPredicate<std::string>*>(*it);
+                if (p->opType() == SOT_like) {
+                    flexbuffers::String colval = row[p->colIdx()].AsString();
+                    colpass = p->getLike()->match(colval.c_str(),
+                                                  colval.length());
+                } else {
+                    string colval = row[p->colIdx()].AsString().str();
+                    colpass = compare(colval, p->Val(), p->opType(),
+                                      p->colType());
+                }
+                break;
+            }
+
+            case SDT_DATE: {
+                TypedPredicate<std::string>* p = \
+                        dynamic_cast<TypedPredicate<std::string>*>(*it);
+                int64_t colval = flexDateVal(row[p->colIdx()]);
+                int64_t predval = p->DateVal();
+                colpass = compare(colval, predval, dateCompareOp(p->opType()));
+                break;
+            }
+
+            default: assert (TablesErrCodes::PredicateComparisonNotDefined==0);
+        }
+
+        // incorporate local col passing into the decision to pass row.
+        switch (chain_optype) {
+            case SOT_logical_or:
+                rowpass |= colpass;
+                break;
+            case SOT_logical_and:
+                rowpass &= colpass;
+                break;
+            default: // should not be reachable
+                rowpass &= colpass;
+        }
+    }
+    return rowpass;
+}
+
+// typed read of a col value from a flexbuf row, RID is not in the row.
+template <typename T> static inline T flexGet(const flexbuffers::Vector& row,
+                                              const int idx, const int64_t rid);
+template <> inline bool flexGet<bool>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsBool(); }
+template <> inline int8_t flexGet<int8_t>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsInt8(); }
+template <> inline int16_t flexGet<int16_t>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsInt16(); }
+template <> inline int32_t flexGet<int32_t>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsInt32(); }
+template <> inline int64_t flexGet<int64_t>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) {
+    return idx == RID_COL_INDEX ? rid : row[idx].AsInt64();
+}
+template <> inline uint8_t flexGet<uint8_t>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsUInt8(); }
+template <> inline uint16_t flexGet<uint16_t>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsUInt16(); }
+template <> inline uint32_t flexGet<uint32_t>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsUInt32(); }
+template <> inline uint64_t flexGet<uint64_t>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) {
+    return idx == RID_COL_INDEX ? static_cast<uint64_t>(rid)
+                                : row[idx].AsUInt64();
+}
+template <> inline float flexGet<float>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsFloat(); }
+template <> inline double flexGet<double>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsDouble(); }
+template <> inline char flexGet<char>(const flexbuffers::Vector& row,
+        const int idx, const int64_t rid) { return row[idx].AsInt8(); }
+
+// the widened pred val, matching the compare() overload used for each type
+template <typename W> static inline W predVal(const compiled_pred& c);
+template <> inline int64_t predVal<int64_t>(const compiled_pred& c) {
+    return c.ival;
+}
+template <> inline uint64_t predVal<uint64_t>(const compiled_pred& c) {
+    return c.uval;
+}
+template <> inline double predVal<double>(const compiled_pred& c) {
+    return c.dval;
+}
+
+// comparison evaluator, one instantiation per col type and op.
+template <typename T, typename W, int OP>
+static bool evalCompare(const compiled_pred& c,
+                        const flexbuffers::Vector& row,
+                        const int64_t rid)
+{
+    const W colval = static_cast<W>(flexGet<T>(row, c.col_idx, rid));
+    const W predval = predVal<W>(c);
+    switch (OP) {  // resolved at compile time
+        case SOT_lt: return colval < predval;
+        case SOT_gt: return colval > predval;
+        case SOT_eq: return colval == predval;
+        case SOT_ne: return colval != predval;
+        case SOT_leq: return colval <= predval;
+        case SOT_geq: return colval >= predval;
+    }
+    return false;
+}
+
+template <typename T, int OP>
+static bool evalBitwise(const compiled_pred& c,
+                        const flexbuffers::Vector& row,
+                        const int64_t rid)
+{
+    const uint64_t colval = flexGet<T>(row, c.col_idx, rid);
+    if (OP == SOT_bitwise_and)
+        return colval & c.uval;
+    return colval | c.uval;
+}
+
+// remaining (less common) ops use the generic compare() method.
+template <typename T, typename W>
+static bool evalGeneric(const compiled_pred& c,
+                        const flexbuffers::Vector& row,
+                        const int64_t rid)
+{
+    const W colval = static_cast<W>(flexGet<T>(row, c.col_idx, rid));
+    return compare(colval, predVal<W>(c), c.pb->opType());
+}
+
+static bool evalBool(const compiled_pred& c,
+                     const flexbuffers::Vector& row,
+                     const int64_t rid)
+{
+    TypedPredicate<bool>* p = static_cast<TypedPredicate<bool>*>(c.pb);
+    return compare(row[c.col_idx].AsBool(), p->Val(), p->opType());
+}
+
+static bool evalString(const compiled_pred& c,
+                       const flexbuffers::Vector& row,
+                       const int64_t rid)
+{
+    TypedPredicate<std::string>* p = \
+            static_cast<TypedPredicate<std::string>*>(c.pb);
+    if (p->opType() == SOT_like) {
+        // match in place, the regex or literal was built with the pred
+        flexbuffers::String colval = row[c.col_idx].AsString();
+        return p->getLike()->match(colval.c_str(), colval.length());
+    }
+    std::string colval = row[c.col_idx].AsString().str();
+    return compare(colval, p->Val(), p->opType(), p->colType());
+}
+
+// dates compare as date32 ints, the pred val was converted at creation.
+template <int OP>
+static bool evalDate(const compiled_pred& c,
+                     const flexbuffers::Vector& row,
+                     const int64_t rid)
+{
+    const int64_t colval = flexDateVal(row[c.col_idx]);
+    switch (OP) {  // resolved at compile time
+        case SOT_lt: return colval < c.ival;
+        case SOT_gt: return colval > c.ival;
+        case SOT_eq: return colval == c.ival;
+        case SOT_ne: return colval != c.ival;
+        case SOT_leq: return colval <= c.ival;
+        case SOT_geq: return colval >= c.ival;
+    }
+    return false;
+}
+
+static pred_eval_fn selectDateCompare(const int op)
+{
+    switch (dateCompareOp(op)) {
+        case SOT_lt: return evalDate<SOT_lt>;
+        case SOT_gt: return evalDate<SOT_gt>;
+        case SOT_eq: return evalDate<SOT_eq>;
+        case SOT_ne: return evalDate<SOT_ne>;
+        case SOT_leq: return evalDate<SOT_leq>;
+        case SOT_geq: return evalDate<SOT_geq>;
+        default: assert (TablesErrCodes::PredicateComparisonNotDefined==0);
+    }
+    return nullptr;
+}
+
+// regex on char cols compares the string forms.
+template <typename T>
+static bool evalCharLike(const compiled_pred& c,
+                         const flexbuffers::Vector& row,
+                         const int64_t rid)
+{
+    TypedPredicate<T>* p = static_cast<TypedPredicate<T>*>(c.pb);
+    std::string colval = row[c.col_idx].AsString().str();
+    std::string predval = std::to_string(p->Val());
+    return compare(colval, predval, p->opType(), p->colType());
+}
+
+template <typename T>
+static void evalAgg(const compiled_pred& c,
+                    const flexbuffers::Vector& row,
+                    const int64_t rid)
+{
+    TypedPredicate<T>* p = static_cast<TypedPredicate<T>*>(c.pb);
+    T colval = flexGet<T>(row, c.col_idx, rid);
+    p->updateAgg(computeAgg(colval, p->Val(), p->opType()));
+}
+
+template <typename T, typename W>
+static pred_eval_fn selectCompare(const int op)
+{
+    switch (op) {
+        case SOT_lt: return evalCompare<T, W, SOT_lt>;
+        case SOT_gt: return evalCompare<T, W, SOT_gt>;
+        case SOT_eq: return evalCompare<T, W, SOT_eq>;
+        case SOT_ne: return evalCompare<T, W, SOT_ne>;
+        case SOT_leq: return evalCompare<T, W, SOT_leq>;
+        case SOT_geq: return evalCompare<T, W, SOT_geq>;
+    }
+    return evalGeneric<T, W>;
+}
+
+template <typename T>
+static pred_eval_fn selectUnsigned(const int op)
+{
+    if (op == SOT_bitwise_and) return evalBitwise<T, SOT_bitwise_and>;
+    if (op == SOT_bitwise_or) return evalBitwise<T, SOT_bitwise_or>;
+    return selectCompare<T, uint64_t>(op);
+}
+
+// set the widened pred val and typed evaluators for predicate type T
+template <typename T, typename W>
+static void compileTyped(compiled_pred& c, pred_eval_fn eval)
+{
+    TypedPredicate<T>* p = static_cast<TypedPredicate<T>*>(c.pb);
+    c.ival = static_cast<int64_t>(p->Val());
+    c.uval = static_cast<uint64_t>(p->Val());
+    c.dval = static_cast<double>(p->Val());
+    c.eval = eval;
+    c.agg = evalAgg<T>;
+}
+
+pred_plan compilePredicates(predicate_vec& pv) {
+
+    pred_plan plan;
+    for (auto it = pv.begin(); it != pv.end(); ++it) {
+        PredicateBase* pb = *it;
+        compiled_pred c;
+        c.pb = pb;
+        c.col_idx = pb->colIdx();
+        c.chain_optype = pb->chainOpType();
+        c.is_agg = pb->isGlobalAgg();
+        c.ival = 0;
+        c.uval = 0;
+        c.dval = 0;
+        c.eval = nullptr;
+        c.agg = nullptr;
+        const int op = pb->opType();
+
+        switch (pb->colType()) {
+            case SDT_BOOL:
+                c.eval = evalBool;
+                c.agg = evalAgg<bool>;
+                break;
+            case SDT_INT8:
+                compileTyped<int8_t, int64_t>(c,
+                        selectCompare<int8_t, int64_t>(op));
+                break;
+            case SDT_INT16:
+                compileTyped<int16_t, int64_t>(c,
+                        selectCompare<int16_t, int64_t>(op));
+                break;
+            case SDT_INT32:
+                compileTyped<int32_t, int64_t>(c,
+                        selectCompare<int32_t, int64_t>(op));
+                break;
+            case SDT_INT64:
+                compileTyped<int64_t, int64_t>(c,
+                        selectCompare<int64_t, int64_t>(op));
+                break;
+            case SDT_UINT8:
+                compileTyped<uint8_t, uint64_t>(c, selectUnsigned<uint8_t>(op));
+                break;
+            case SDT_UINT16:
+                compileTyped<uint16_t, uint64_t>(c,
+                        selectUnsigned<uint16_t>(op));
+                break;
+            case SDT_UINT32:
+                compileTyped<uint32_t, uint64_t>(c,
+                        selectUnsigned<uint32_t>(op));
+                break;
+            case SDT_UINT64:
+                compileTyped<uint64_t, uint64_t>(c,
+                        selectUnsigned<uint64_t>(op));
+                break;
+            case SDT_FLOAT:
+                compileTyped<float, double>(c,
+                        selectCompare<float, double>(op));
+                break;
+            case SDT_DOUBLE:
+                compileTyped<double, double>(c,
+                        selectCompare<double, double>(op));
+                break;
+            case SDT_CHAR:
+                compileTyped<char, int64_t>(c, op == SOT_like ?
+                        evalCharLike<char> : selectCompare<char, int64_t>(op));
+                break;
+            case SDT_UCHAR:
+                compileTyped<unsigned char, uint64_t>(c, op == SOT_like ?
+                        evalCharLike<unsigned char> :
+                        selectCompare<unsigned char, uint64_t>(op));
+                break;
+            case SDT_STRING:
+                c.eval = evalString;
+                break;
+            case SDT_DATE:
+                c.ival = static_cast<TypedPredicate<std::string>*>(pb)
+                            ->DateVal();
+                c.eval = selectDateCompare(op);
+                break;
+            default: assert (TablesErrCodes::PredicateComparisonNotDefined==0);
+        }
+        plan.push_back(c);
+    }
+    return plan;
+}
+
+/*
+ * Evaluates each predicate over the whole block before moving to the next,
+ * with the same semantics as applyPredicates(): rows that have already
+ * failed a logical_and chain are masked out (short-circuited) for all
+ * later predicates, and global aggs are accumulated for live rows only.
+ */
+void applyPredicatesBlock(
+        const pred_plan& plan,
+        const std::vector<flexbuffers::Vector>& rows,
+        const std::vector<int64_t>& rids,
+        std::vector<uint8_t>& pass)
+{
+    const size_t nrows = rows.size();
+    pass.assign(nrows, 1);
+    if (plan.empty()) return;
+
+    if (plan[0].chain_optype == SOT_logical_or)
+        std::fill(pass.begin(), pass.end(), 0);
+    std::vector<uint8_t> live(nrows, 1);
+
+    for (auto it = plan.begin(); it != plan.end(); ++it) {
+        const compiled_pred& c = *it;
+        const bool chain_or = (c.chain_optype == SOT_logical_or);
+
+        if (!chain_or) {  // default to logical AND
+            for (size_t i = 0; i < nrows; i++)
+                live[i] &= pass[i];
+        }
+
+        if (c.is_agg) {
+            // aggs never pass a row themselves
+            for (size_t i = 0; i < nrows; i++) {
+                if (!live[i]) continue;
+                c.agg(c, rows[i], rids[i]);
+                if (!chain_or) pass[i] = 0;
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < nrows; i++) {
+            if (!live[i]) continue;
+            bool colpass = c.eval(c, rows[i], rids[i]);
+            if (chain_or) pass[i] |= colpass;
+            else pass[i] = colpass;
+        }
+    }
+}
+
+// GROUP BY partial aggregation.
+// vals are widened into one of these classes for keys and accumulation.
+enum AggValClass {
+    AVC_INT,
+    AVC_UINT,
+    AVC_DOUBLE,
+    AVC_STRING,
+    AVC_UNSUPPORTED
+};
+
+static int aggValClass(int type)
+{
+    switch (type) {
+        case SDT_BOOL:
+        case SDT_CHAR:
+        case SDT_INT8:
+        case SDT_INT16:
+        case SDT_INT32:
+        case SDT_INT64:
+            return AVC_INT;
+        case SDT_UCHAR:
+        case SDT_UINT8:
+        case SDT_UINT16:
+        case SDT_UINT32:
+        case SDT_UINT64:
+            return AVC_UINT;
+        case SDT_FLOAT:
+        case SDT_DOUBLE:
+            return AVC_DOUBLE;
+        case SDT_DATE:  // as date32 days
+            return AVC_INT;
+        case SDT_STRING:
+            return AVC_STRING;
+        default:
+            return AVC_UNSUPPORTED;
+    }
+}
+
+static int aggClassType(int cls)
+{
+    switch (cls) {
+        case AVC_INT: return SDT_INT64;
+        case AVC_UINT: return SDT_UINT64;
+        case AVC_DOUBLE: return SDT_DOUBLE;
+        default: return SDT_STRING;
+    }
+}
+
+// the type of an agg val of a col, dates stay dates for min/max
+static int aggValType(int type)
+{
+    if (type == SDT_DATE) return SDT_DATE;
+    return aggClassType(aggValClass(type));
+}
+
+static inline agg_val aggValFromRef(const flexbuffers::Reference& ref,
+                                    int type)
+{
+    agg_val v = {0, 0, 0, ""};
+    switch (aggValClass(type)) {
+        case AVC_INT:
+            if (type == SDT_DATE) v.i = flexDateVal(ref);
+            else v.i = (type == SDT_BOOL) ? ref.AsBool() : ref.AsInt64();
+            break;
+        case AVC_UINT: v.u = ref.AsUInt64(); break;
+        case AVC_DOUBLE: v.d = ref.AsDouble(); break;
+        case AVC_STRING: v.s = ref.AsString().str(); break;
+    }
+    return v;
+}
+
+static inline void aggKeyAppend(std::string& key, const agg_val& v, int cls)
+{
+    switch (cls) {
+        case AVC_INT:
+            key.append(reinterpret_cast<const char*>(&v.i), sizeof(v.i));
+            break;
+        case AVC_UINT:
+            key.append(reinterpret_cast<const char*>(&v.u), sizeof(v.u));
+            break;
+        case AVC_DOUBLE:
+            key.append(reinterpret_cast<const char*>(&v.d), sizeof(v.d));
+            break;
+        default: {
+            uint32_t len = v.s.size();
+            key.append(reinterpret_cast<const char*>(&len), sizeof(len));
+            key.append(v.s);
+        }
+    }
+}
+
+static inline void aggValAdd(agg_val& a, const agg_val& b, int cls)
+{
+    switch (cls) {
+        case AVC_INT: a.i += b.i; break;
+        case AVC_UINT: a.u += b.u; break;
+        case AVC_DOUBLE: a.d += b.d; break;
+    }
+}
+
+static inline bool aggValLess(const agg_val& a, const agg_val& b, int cls)
+{
+    switch (cls) {
+        case AVC_INT: return a.i < b.i;
+        case AVC_UINT: return a.u < b.u;
+        case AVC_DOUBLE: return a.d < b.d;
+        default: return a.s < b.s;
+    }
+}
+
+// fold a partial state b (cnt rows) into a
+static inline void aggMerge(agg_state& a, const agg_state& b, int cls, int op)
+{
+    if (b.cnt == 0) return;
+    if (a.cnt == 0) {
+        a = b;
+        return;
+    }
+    switch (op) {
+        case SOT_min:
+            if (aggValLess(b.val, a.val, cls)) a.val = b.val;
+            break;
+        case SOT_max:
+            if (aggValLess(a.val, b.val, cls)) a.val = b.val;
+            break;
+        case SOT_sum:
+        case SOT_avg:
+            aggValAdd(a.val, b.val, cls);
+            break;
+    }
+    a.cnt += b.cnt;
+}
+
+static inline void aggAddFlex(flexbuffers::Builder& fbb, const agg_val& v,
+                              int type)
+{
+    switch (aggValClass(type)) {
+        case AVC_INT:
+            if (type == SDT_BOOL) fbb.Add(static_cast<bool>(v.i));
+            else fbb.Add(v.i);
+            break;
+        case AVC_UINT: fbb.Add(v.u); break;
+        case AVC_DOUBLE: fbb.Add(v.d); break;
+        default: fbb.Add(v.s);
+    }
+}
+
+static std::string colNameFromIdx(schema_vec& schema, int idx)
+{
+    if (idx == RID_COL_INDEX) return RID_INDEX;
+    for (auto it = schema.begin(); it != schema.end(); ++it) {
+        if (it->idx == idx) return it->name;
+    }
+    return std::to_string(idx);
+}
+
+bool useGroupBy(schema_vec& groupby_schema, predicate_vec& preds)
+{
+    // avg has no global agg form, so it always uses a single group
+    if (!groupby_schema.empty()) return true;
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if ((*it)->opType() == SOT_avg) return true;
+    }
+    return false;
+}
+
+/*
+ * Partial rows hold the group cols followed by one col per agg pred in pred
+ * order, except avg which holds 2 cols (sum and cnt) so that partials from
+ * different objects can be merged exactly.  The final schema has 1 col per
+ * agg, with avg as a double.
+ */
+static schema_vec groupbySchema(
+        schema_vec& tbl_schema,
+        schema_vec& groupby_schema,
+        predicate_vec& preds,
+        bool final)
+{
+    schema_vec sc;
+    for (auto it = groupby_schema.begin(); it != groupby_schema.end(); ++it)
+        sc.push_back(col_info(it->idx, it->type, true, false, it->name));
+
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if (!(*it)->isGlobalAgg()) continue;
+        const int op = (*it)->opType();
+        const std::string op_str = skyOpTypeToString(op);
+        const std::string name = op_str + "_" +
+                                 colNameFromIdx(tbl_schema, (*it)->colIdx());
+        const int agg_idx = AGG_COL_IDX.at(op_str);
+        const int val_type = aggValType((*it)->colType());
+        if (op == SOT_cnt) {
+            sc.push_back(col_info(agg_idx, SDT_UINT64, false, false, name));
+        } else if (op == SOT_avg and final) {
+            sc.push_back(col_info(agg_idx, SDT_DOUBLE, false, false, name));
+        } else if (op == SOT_avg) {
+            sc.push_back(col_info(agg_idx, val_type, false, false,
+                                  name + "_sum"));
+            sc.push_back(col_info(agg_idx, SDT_UINT64, false, false,
+                                  name + "_cnt"));
+        } else {
+            sc.push_back(col_info(agg_idx, val_type, false, false, name));
+        }
+    }
+    return sc;
+}
+
+schema_vec groupbyPartialSchema(
+        schema_vec& tbl_schema,
+        schema_vec& groupby_schema,
+        predicate_vec& preds)
+{
+    return groupbySchema(tbl_schema, groupby_schema, preds, false);
+}
+
+schema_vec groupbyFinalSchema(
+        schema_vec& tbl_schema,
+        schema_vec& groupby_schema,
+        predicate_vec& preds)
+{
+    return groupbySchema(tbl_schema, groupby_schema, preds, true);
+}
+
+// find or create the group for key
+static agg_group& groupbyFind(
+        agg_groups& groups,
+        const std::string& key,
+        const std::vector<agg_val>& keyvals,
+        size_t naggs)
+{
+    auto it = groups.find(key);
+    if (it == groups.end()) {
+        agg_group g;
+        g.keys = keyvals;
+        g.aggs.assign(naggs, agg_state{agg_val{0, 0, 0, ""}, 0});
+        it = groups.emplace(key, std::move(g)).first;
+    }
+    return it->second;
+}
+
+/*
+ * Accumulate the rows of a row layout fb that pass the (non agg) preds into
+ * the per group partial aggregates.  Aggs start from the first row of each
+ * group, the agg pred vals are not used as initial vals.
+ */
+int groupbyAccumulate(
+        schema_vec& tbl_schema,
+        predicate_vec& preds,
+        schema_vec& groupby_schema,
+        const char* fb,
+        const size_t fb_size,
+        std::string& errmsg,
+        const std::vector<uint32_t>& row_nums,
+        agg_groups& groups)
+{
+    if (isSkyFbCol(fb)) {
+        errmsg.append("ERROR groupbyAccumulate(): columnar layout");
+        return TablesErrCodes::SkyFormatTypeNotImplemented;
+    }
+    sky_root root = getSkyRoot(fb, fb_size);
+
+    predicate_vec filters;
+    predicate_vec aggs;
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if (!(*it)->isGlobalAgg()) {
+            filters.push_back(*it);
+            continue;
+        }
+        const int cls = aggValClass((*it)->colType());
+        const int op = (*it)->opType();
+        const bool ordered_only = (cls == AVC_STRING or
+                                   (*it)->colType() == SDT_DATE);
+        if (cls == AVC_UNSUPPORTED or
+            (ordered_only and op != SOT_min and op != SOT_max and
+             op != SOT_cnt)) {
+            errmsg.append("ERROR groupbyAccumulate(): agg op=" +
+                          skyOpTypeToString(op) + " col.type=" +
+                          std::to_string((*it)->colType()));
+            return TablesErrCodes::UnsupportedAggDataType;
+        }
+        aggs.push_back(*it);
+    }
+
+    int col_idx_max = -1;
+    for (auto it = tbl_schema.begin(); it != tbl_schema.end(); ++it)
+        col_idx_max = std::max(col_idx_max, it->idx);
+    for (auto it = groupby_schema.begin(); it != groupby_schema.end(); ++it) {
+        if (it->idx < 0 or it->idx > col_idx_max) {
+            errmsg.append("ERROR groupbyAccumulate(): group col.idx=" +
+                          std::to_string(it->idx) + " OOB.");
+            return TablesErrCodes::RequestedColIndexOOB;
+        }
+    }
+
+    bool process_all_rows = row_nums.empty();
+    uint32_t nrows = process_all_rows ? root.nrows : row_nums.size();
+
+    pred_plan plan = compilePredicates(filters);
+    std::vector<flexbuffers::Vector> rows;
+    std::vector<int64_t> rids;
+    std::vector<uint8_t> pass;
+    std::string key;
+    std::vector<agg_val> keyvals(groupby_schema.size());
+
+    for (uint32_t blk = 0; blk < nrows; blk += PRED_EVAL_BLOCK_SIZE) {
+        uint32_t blk_end = std::min(nrows, blk + PRED_EVAL_BLOCK_SIZE);
+        rows.clear();
+        rids.clear();
+
+        for (uint32_t i = blk; i < blk_end; i++) {
+            uint32_t rnum = process_all_rows ? i : row_nums[i];
+            if (rnum >= root.nrows) {
+                errmsg += "ERROR: rnum(" + std::to_string(rnum) +
+                          ") >= root.nrows(" + to_string(root.nrows) + ")";
+                return RowIndexOOB;
+            }
+            if (root.delete_vec[rnum] == 1) continue;
+            const Tables::Record* rec = root.offs->Get(rnum);
+            rows.push_back(rec->data_flexbuffer_root().AsVector());
+            rids.push_back(rec->RID());
+        }
+
+        applyPredicatesBlock(plan, rows, rids, pass);
+
+        for (size_t j = 0; j < rows.size(); j++) {
+            if (!pass[j]) continue;
+            const flexbuffers::Vector& row = rows[j];
+
+            key.clear();
+            for (unsigned k = 0; k < groupby_schema.size(); k++) {
+                const col_info& g = groupby_schema[k];
+                keyvals[k] = aggValFromRef(row[g.idx], g.type);
+                aggKeyAppend(key, keyvals[k], aggValClass(g.type));
+            }
+            agg_group& grp = groupbyFind(groups, key, keyvals, aggs.size());
+
+            for (unsigned k = 0; k < aggs.size(); k++) {
+                PredicateBase* pb = aggs[k];
+                agg_state row_state;
+                if (pb->colIdx() == RID_COL_INDEX) {
+                    row_state.val = agg_val{rids[j], static_cast<uint64_t>(
+                                            rids[j]), 0, ""};
+                } else {
+                    row_state.val = aggValFromRef(row[pb->colIdx()],
+                                                  pb->colType());
+                }
+                row_state.cnt = 1;
+                aggMerge(grp.aggs[k], row_state,
+                         aggValClass(pb->colType()), pb->opType());
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Merge the partial rows of a fb built by groupbyBuildFb(final=false) into
+ * groups, see groupbyPartialSchema() for the row layout.
+ */
+int groupbyMerge(
+        schema_vec& groupby_schema,
+        predicate_vec& preds,
+        const char* fb,
+        const size_t fb_size,
+        std::string& errmsg,
+        agg_groups& groups)
+{
+    if (isSkyFbCol(fb)) {
+        errmsg.append("ERROR groupbyMerge(): columnar layout");
+        return TablesErrCodes::SkyFormatTypeNotImplemented;
+    }
+    sky_root root = getSkyRoot(fb, fb_size);
+
+    predicate_vec aggs;
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if ((*it)->isGlobalAgg()) aggs.push_back(*it);
+    }
+
+    std::string key;
+    std::vector<agg_val> keyvals(groupby_schema.size());
+    for (uint32_t i = 0; i < root.nrows; i++) {
+        if (root.delete_vec[i] == 1) continue;
+        auto row = root.offs->Get(i)->data_flexbuffer_root().AsVector();
+        size_t pos = 0;
+
+        key.clear();
+        for (unsigned k = 0; k < groupby_schema.size(); k++, pos++) {
+            const col_info& g = groupby_schema[k];
+            keyvals[k] = aggValFromRef(row[pos], g.type);
+            aggKeyAppend(key, keyvals[k], aggValClass(g.type));
+        }
+        agg_group& grp = groupbyFind(groups, key, keyvals, aggs.size());
+
+        for (unsigned k = 0; k < aggs.size(); k++) {
+            PredicateBase* pb = aggs[k];
+            const int op = pb->opType();
+            const int val_type = aggValType(pb->colType());
+            agg_state part;
+            part.val = agg_val{0, 0, 0, ""};
+            part.cnt = 1;
+            if (op == SOT_cnt) {
+                part.cnt = row[pos++].AsUInt64();
+            } else {
+                part.val = aggValFromRef(row[pos++], val_type);
+                if (op == SOT_avg)
+                    part.cnt = row[pos++].AsUInt64();
+            }
+            if (pos > row.size()) {
+                errmsg.append("ERROR groupbyMerge(): partial row too short");
+                return TablesErrCodes::RequestedColIndexOOB;
+            }
+            aggMerge(grp.aggs[k], part, aggValClass(pb->colType()), op);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Build a row layout fb with one row per group, holding either the partial
+ * aggs (to be merged by the client) or the final agg vals.
+ */
+void groupbyBuildFb(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        schema_vec& tbl_schema,
+        schema_vec& groupby_schema,
+        predicate_vec& preds,
+        agg_groups& groups,
+        bool final,
+        std::string db_schema,
+        std::string table_name)
+{
+    predicate_vec aggs;
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if ((*it)->isGlobalAgg()) aggs.push_back(*it);
+    }
+
+    delete_vector dead_rows;
+    std::vector<flatbuffers::Offset<Tables::Record>> offs;
+    nullbits_vector nb(2, 0);  // no nulls in derived data
+    for (auto it = groups.begin(); it != groups.end(); ++it) {
+        const agg_group& grp = it->second;
+        flexbuffers::Builder flexbldr;
+        flexbldr.Vector([&]() {
+            for (unsigned k = 0; k < groupby_schema.size(); k++)
+                aggAddFlex(flexbldr, grp.keys[k], groupby_schema[k].type);
+
+            for (unsigned k = 0; k < aggs.size(); k++) {
+                const agg_state& a = grp.aggs[k];
+                const int op = aggs[k]->opType();
+                const int val_type = aggValType(aggs[k]->colType());
+                if (op == SOT_cnt) {
+                    flexbldr.Add(a.cnt);
+                } else if (op == SOT_avg and final) {
+                    double sum = (val_type == SDT_INT64) ? a.val.i :
+                                 (val_type == SDT_UINT64) ? a.val.u : a.val.d;
+                    flexbldr.Add(a.cnt ? sum / a.cnt : 0.0);
+                } else {
+                    aggAddFlex(flexbldr, a.val, val_type);
+                    if (op == SOT_avg)
+                        flexbldr.Add(a.cnt);
+                }
+            }
+        });
+        flexbldr.Finish();
+
+        auto row_data = flatbldr.CreateVector(flexbldr.GetBuffer());
+        auto nullbits = flatbldr.CreateVector(nb);
+        int RID = -1;  // agg recs only, since these are derived data
+        offs.push_back(Tables::CreateRecord(flatbldr, RID, nullbits,
+                                            row_data));
+        dead_rows.push_back(0);
+    }
+
+    schema_vec sc = groupbySchema(tbl_schema, groupby_schema, preds, final);
+    auto data_schema = flatbldr.CreateString(schemaToString(sc));
+    auto db_schema_off = flatbldr.CreateString(db_schema);
+    auto table_name_off = flatbldr.CreateString(table_name);
+    auto delete_v = flatbldr.CreateVector(dead_rows);
+    auto rows_v = flatbldr.CreateVector(offs);
+    auto table = CreateTable(
+        flatbldr,
+        SFT_FLATBUF_FLEX_ROW,
+        0,  // versions do not apply to derived data
+        0,
+        0,
+        data_schema,
+        db_schema_off,
+        table_name_off,
+        delete_v,
+        rows_v,
+        offs.size());
+    flatbldr.Finish(table);
+}
+
+// true if row a comes before row b in the order by, i.e., is better
+static inline bool topkBefore(const topk_rows& topk,
+                              const topk_entry& a,
+                              const topk_entry& b)
+{
+    return topk.desc ? a.key > b.key : a.key < b.key;
+}
+
+/*
+ * Offer each row of a row layout fb to the top-k heap, the fb (fb_size
+ * bytes, which must be given) is kept only if some of its rows are.  All
+ * fbs must share the same data schema, such as the result fbs of one query,
+ * and the order col must be one of its cols.
+ */
+int topkAccumulate(
+        topk_rows& topk,
+        const char* fb,
+        const size_t fb_size,
+        std::string& errmsg)
+{
+    if (topk.k == 0) return 0;
+    if (isSkyFbCol(fb)) {
+        errmsg.append("ERROR topkAccumulate(): order by requires row layout");
+        return TablesErrCodes::SkyFormatTypeNotImplemented;
+    }
+    sky_root root = getSkyRoot(fb, fb_size);
+    if (root.nrows == 0) return 0;
+
+    if (root.data_schema != topk.fb_schema) {
+        schema_vec schema = schemaFromString(root.data_schema);
+        topk.col_pos = -1;
+        for (unsigned i = 0; i < schema.size(); i++) {
+            if (schema[i].idx == topk.col_idx) {
+                topk.col_pos = i;
+                break;
+            }
+        }
+        topk.fb_schema = root.data_schema;
+    }
+    if (topk.col_pos < 0) {
+        errmsg.append("ERROR topkAccumulate(): order by col.idx=" +
+                      std::to_string(topk.col_idx) + " not in result");
+        return TablesErrCodes::RequestedColNotPresent;
+    }
+
+    auto before = [&](const topk_entry& a, const topk_entry& b) {
+        return topkBefore(topk, a, b);
+    };
+    const uint32_t fb_num = topk.fbs.size();
+    bool kept = false;
+    for (uint32_t i = 0; i < root.nrows; i++) {
+        if (root.delete_vec[i] == 1) continue;
+        auto row = root.offs->Get(i)->data_flexbuffer_root().AsVector();
+        if (topk.col_pos >= static_cast<int>(row.size())) {
+            errmsg.append("ERROR topkAccumulate(): order by col OOB");
+            return TablesErrCodes::RequestedColIndexOOB;
+        }
+        topk_entry e;
+        int ret = keyEncodeFlexVal(e.key, topk.col_type, row[topk.col_pos]);
+        if (ret != 0) {
+            errmsg.append("ERROR topkAccumulate(): order by col type=" +
+                          std::to_string(topk.col_type));
+            return ret;
+        }
+        if (topk.heap.size() == topk.k) {
+            if (!before(e, topk.heap.front())) continue;
+            std::pop_heap(topk.heap.begin(), topk.heap.end(), before);
+            topk.heap.pop_back();
+        }
+        e.fb = fb_num;
+        e.row = i;
+        topk.heap.push_back(e);
+        std::push_heap(topk.heap.begin(), topk.heap.end(), before);
+        kept = true;
+    }
+    if (!kept) return 0;
+    topk.fbs.push_back(std::string(fb, fb_size));
+
+    // bound the kept fbs, most of their rows may have been evicted
+    if (topk.fbs.size() > TOPK_MAX_FBS) {
+        flatbuffers::FlatBufferBuilder flatbldr(1024);
+        topkBuildFb(flatbldr, topk);
+        std::string compacted(
+                reinterpret_cast<char*>(flatbldr.GetBufferPointer()),
+                flatbldr.GetSize());
+        topk.fbs.clear();
+        topk.heap.clear();
+        return topkAccumulate(topk, compacted.data(), compacted.size(),
+                              errmsg);
+    }
+    return 0;
+}
+
+/*
+ * Build a row layout fb of the kept rows in order by, their records are
+ * copied as is from the kept fbs.  There must be at least 1 kept row.
+ */
+void topkBuildFb(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        topk_rows& topk)
+{
+    std::vector<topk_entry> rows(topk.heap);
+    std::stable_sort(rows.begin(), rows.end(),
+                     [&](const topk_entry& a, const topk_entry& b) {
+                         return topkBefore(topk, a, b);
+                     });
+
+    std::vector<const char*> fbs;
+    for (auto it = topk.fbs.begin(); it != topk.fbs.end(); ++it)
+        fbs.push_back(it->data());
+    buildFbFromRows(flatbldr, fbs, rows.begin(), rows.end());
+}
+
+/*
+ * Build a row layout fb of the rows [begin, end) in that order, each refers
+ * to a row of one of fbs by its position.  Records are copied as is, so all
+ * fbs must share a data schema, the table metadata is taken from the first.
+ */
+void buildFbFromRows(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        const std::vector<const char*>& fbs,
+        std::vector<topk_entry>::const_iterator begin,
+        std::vector<topk_entry>::const_iterator end)
+{
+    delete_vector dead_rows;
+    std::vector<flatbuffers::Offset<Tables::Record>> offs;
+    for (auto it = begin; it != end; ++it) {
+        const Tables::Record* rec = GetTable(fbs[it->fb])->rows()->Get(it->row);
+        auto row_data = flatbldr.CreateVector(rec->data()->data(),
+                                              rec->data()->size());
+        auto nullbits = flatbldr.CreateVector(rec->nullbits()->data(),
+                                              rec->nullbits()->size());
+        offs.push_back(Tables::CreateRecord(flatbldr, rec->RID(), nullbits,
+                                            row_data));
+        dead_rows.push_back(0);
+    }
+
+    assert(!fbs.empty());
+    const Table* root = GetTable(fbs.front());
+    auto data_schema = flatbldr.CreateString(root->data_schema()->str());
+    auto db_schema = flatbldr.CreateString(root->db_schema()->str());
+    auto table_name = flatbldr.CreateString(root->table_name()->str());
+    auto delete_v = flatbldr.CreateVector(dead_rows);
+    auto rows_v = flatbldr.CreateVector(offs);
+    auto table = CreateTable(
+        flatbldr,
+        SFT_FLATBUF_FLEX_ROW,
+        root->skyhook_version(),
+        root->data_structure_version(),
+        root->data_schema_version(),
+        data_schema,
+        db_schema,
+        table_name,
+        delete_v,
+        rows_v,
+        offs.size());
+    flatbldr.Finish(table);
+}
+
+// widen a stored col val into the zone bounds for its col type
+static inline void zoneUpdate(col_zone& z, const flexbuffers::Reference& ref)
+{
+    switch (z.col_type) {
+        case SDT_BOOL:
+        case SDT_CHAR:
+        case SDT_INT8:
+        case SDT_INT16:
+        case SDT_INT32:
+        case SDT_INT64: {
+            int64_t v = (z.col_type == SDT_BOOL) ? ref.AsBool() :
+                                                   ref.AsInt64();
+            z.imin = std::min(z.imin, v);
+            z.imax = std::max(z.imax, v);
+            break;
+        }
+        case SDT_UCHAR:
+        case SDT_UINT8:
+        case SDT_UINT16:
+        case SDT_UINT32:
+        case SDT_UINT64: {
+            uint64_t v = ref.AsUInt64();
+            z.umin = std::min(z.umin, v);
+            z.umax = std::max(z.umax, v);
+            break;
+        }
+        case SDT_FLOAT:
+        case SDT_DOUBLE: {
+            double v = ref.AsDouble();
+            if (std::isnan(v)) z.has_bounds = false;
+            z.dmin = std::min(z.dmin, v);
+            z.dmax = std::max(z.dmax, v);
+            break;
+        }
+        case SDT_DATE: {  // as date32 days
+            try {
+                int64_t v = flexDateVal(ref);
+                z.imin = std::min(z.imin, v);
+                z.imax = std::max(z.imax, v);
+            } catch (...) {
+                z.has_bounds = false;
+            }
+            break;
+        }
+        case SDT_STRING: {
+            std::string v = ref.AsString().str();
+            if (v < z.smin) z.smin = v;
+            if (v > z.smax) z.smax = v;
+            break;
+        }
+        default:
+            z.has_bounds = false;
+    }
+}
+
+// seed the zone bounds from the first stored col val
+static inline void zoneInit(col_zone& z, const flexbuffers::Reference& ref)
+{
+    z.has_bounds = true;
+    z.imin = std::numeric_limits<int64_t>::max();
+    z.imax = std::numeric_limits<int64_t>::min();
+    z.umin = std::numeric_limits<uint64_t>::max();
+    z.umax = 0;
+    z.dmin = std::numeric_limits<double>::infinity();
+    z.dmax = -std::numeric_limits<double>::infinity();
+    if (z.col_type == SDT_STRING)
+        z.smin = z.smax = ref.AsString().str();
+    zoneUpdate(z, ref);  // also validates the first val (NaN, bad dates)
+}
+
+/*
+ * Build the zone maps (min/max/null count) of each col of a row layout fb,
+ * including the RID col.  Bounds cover every stored val, nulls included,
+ * so that pruning agrees exactly with the scan operator's comparisons.
+ */
+void buildZoneMaps(
+        sky_root& root,
+        schema_vec& schema,
+        std::vector<col_zone>& zones)
+{
+    zones.clear();
+    if (!root.offs or root.nrows == 0) return;
+
+    col_zone rid_zone(RID_COL_INDEX, SDT_UINT64);
+    rid_zone.has_bounds = true;
+    rid_zone.umin = std::numeric_limits<uint64_t>::max();
+    rid_zone.umax = 0;
+
+    for (auto it = schema.begin(); it != schema.end(); ++it)
+        zones.push_back(col_zone(it->idx, it->type));
+
+    for (uint32_t i = 0; i < root.nrows; i++) {
+        const Tables::Record* rec = root.offs->Get(i);
+        rid_zone.umin = std::min(rid_zone.umin, rec->RID());
+        rid_zone.umax = std::max(rid_zone.umax, rec->RID());
+
+        auto row = rec->data_flexbuffer_root().AsVector();
+        const auto* nb = rec->nullbits();
+        for (unsigned j = 0; j < schema.size(); j++) {
+            const col_info& col = schema[j];
+            col_zone& z = zones[j];
+            if (col.idx < 0 or col.idx >= static_cast<int>(row.size())) {
+                z.has_bounds = false;
+                continue;
+            }
+
+            // row nullbits are msb first per row, see fbwriter.
+            int pos = col.idx / 64;
+            if (col.nullable and nb and pos < static_cast<int>(nb->size())
+                and ((nb->Get(pos) >> (63 - (col.idx % 64))) & 1))
+                z.null_count++;
+
+            if (i == 0) zoneInit(z, row[col.idx]);
+            else if (z.has_bounds) zoneUpdate(z, row[col.idx]);
+        }
+    }
+    rid_zone.imin = static_cast<int64_t>(rid_zone.umin);
+    rid_zone.imax = static_cast<int64_t>(rid_zone.umax);
+    zones.push_back(rid_zone);
+}
+
+// true unless no val in [lo,hi] can satisfy (val op v)
+template <typename T>
+static inline bool zoneMayPass(const T& lo, const T& hi, const T& v, int op)
+{
+    switch (op) {
+        case SOT_lt:
+        case SOT_before: return lo < v;
+        case SOT_leq: return lo <= v;
+        case SOT_gt:
+        case SOT_after: return hi > v;
+        case SOT_geq: return hi >= v;
+        case SOT_eq: return lo <= v and v <= hi;
+        case SOT_ne: return !(lo == v and hi == v);
+        default: return true;  // not decidable from the val range
+    }
+}
+
+template <typename T>
+static inline T typedPredVal(PredicateBase* pb)
+{
+    return dynamic_cast<TypedPredicate<T>*>(pb)->Val();
+}
+
+static bool zoneMayMatch(const col_zone& z, PredicateBase* pb)
+{
+    if (!z.has_bounds) return true;
+    const int op = pb->opType();
+    const bool rid = (pb->colIdx() == RID_COL_INDEX);
+
+    switch (pb->colType()) {
+        case SDT_BOOL:
+            return zoneMayPass<int64_t>(z.imin, z.imax,
+                                        typedPredVal<bool>(pb), op);
+        case SDT_CHAR:
+            if (op == SOT_like) return true;
+            return zoneMayPass<int64_t>(z.imin, z.imax,
+                                        typedPredVal<char>(pb), op);
+        case SDT_INT8:
+            return zoneMayPass<int64_t>(z.imin, z.imax,
+                                        typedPredVal<int8_t>(pb), op);
+        case SDT_INT16:
+            return zoneMayPass<int64_t>(z.imin, z.imax,
+                                        typedPredVal<int16_t>(pb), op);
+        case SDT_INT32:
+            return zoneMayPass<int64_t>(z.imin, z.imax,
+                                        typedPredVal<int32_t>(pb), op);
+        case SDT_INT64:
+            if (rid and z.umax > static_cast<uint64_t>(
+                                    std::numeric_limits<int64_t>::max()))
+                return true;
+            return zoneMayPass<int64_t>(z.imin, z.imax,
+                                        typedPredVal<int64_t>(pb), op);
+        case SDT_UCHAR:
+            if (op == SOT_like) return true;
+            return zoneMayPass<uint64_t>(z.umin, z.umax,
+                                typedPredVal<unsigned char>(pb), op);
+        case SDT_UINT8:
+            return zoneMayPass<uint64_t>(z.umin, z.umax,
+                                         typedPredVal<uint8_t>(pb), op);
+        case SDT_UINT16:
+            return zoneMayPass<uint64_t>(z.umin, z.umax,
+                                         typedPredVal<uint16_t>(pb), op);
+        case SDT_UINT32:
+            return zoneMayPass<uint64_t>(z.umin, z.umax,
+                                         typedPredVal<uint32_t>(pb), op);
+        case SDT_UINT64:
+            return zoneMayPass<uint64_t>(z.umin, z.umax,
+                                         typedPredVal<uint64_t>(pb), op);
+        case SDT_FLOAT:
+            return zoneMayPass<double>(z.dmin, z.dmax,
+                                       typedPredVal<float>(pb), op);
+        case SDT_DOUBLE:
+            return zoneMayPass<double>(z.dmin, z.dmax,
+                                       typedPredVal<double>(pb), op);
+        case SDT_DATE:
+            return zoneMayPass<int64_t>(z.imin, z.imax,
+                    dynamic_cast<TypedPredicate<std::string>*>(pb)->DateVal(),
+                    op);
+        default:
+            return true;  // strings only support like
+    }
+}
+
+/*
+ * Zone maps can only rule out an fb if every pred must hold for a row to
+ * pass, i.e., a logical_and chain, and there are no global aggs (their
+ * partial results are still returned per fb).
+ */
+bool zoneMapsApplicable(predicate_vec& preds)
+{
+    if (preds.empty() or hasAggPreds(preds)) return false;
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if ((*it)->chainOpType() == SOT_logical_or)
+            return false;
+    }
+    return true;
+}
+
+bool zoneMapsMayMatch(const std::vector<col_zone>& zones, predicate_vec& preds)
+{
+    if (!zoneMapsApplicable(preds)) return true;
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        for (auto z = zones.begin(); z != zones.end(); ++z) {
+            if (z->col_idx == (*it)->colIdx() and !zoneMayMatch(*z, *it))
+                return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Build a bloom filter over the stored vals of each requested col of a row
+ * layout fb.  Vals are inserted by their index key encoding so that the eq
+ * pred vals probed at query time hash identically (e.g., -0.0 and 0.0).
+ */
+int buildBloomFilters(
+        sky_root& root,
+        schema_vec& bloom_schema,
+        std::vector<col_bloom>& blooms)
+{
+    blooms.clear();
+    if (!root.offs or root.nrows == 0) return 0;
+
+    for (auto it = bloom_schema.begin(); it != bloom_schema.end(); ++it)
+        blooms.push_back(col_bloom(it->idx, it->type, root.nrows));
+
+    std::string key;
+    for (uint32_t i = 0; i < root.nrows; i++) {
+        const Tables::Record* rec = root.offs->Get(i);
+        auto row = rec->data_flexbuffer_root().AsVector();
+        for (unsigned j = 0; j < bloom_schema.size(); j++) {
+            const col_info& col = bloom_schema[j];
+            if (col.idx < 0 or col.idx >= static_cast<int>(row.size()))
+                return TablesErrCodes::RequestedColIndexOOB;
+            key.clear();
+            int ret = keyEncodeFlexVal(key, col.type, row[col.idx]);
+            if (ret != 0) return ret;
+            blooms[j].bloom.insert(key.data(), key.size());
+        }
+    }
+    return 0;
+}
+
+/*
+ * Same applicability as zone maps, but only eq preds can be decided: an fb
+ * is skipped if some eq pred val is definitely not in its col's filter.
+ */
+bool bloomFiltersMayMatch(const std::vector<col_bloom>& blooms,
+                          predicate_vec& preds)
+{
+    if (blooms.empty() or !zoneMapsApplicable(preds)) return true;
+    std::string key;
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if ((*it)->opType() != SOT_eq) continue;
+        for (auto b = blooms.begin(); b != blooms.end(); ++b) {
+            if (b->col_idx != (*it)->colIdx() or
+                b->col_type != (*it)->colType())
+                continue;
+            key.clear();
+            if (keyEncodePredVal(key, *it) != 0) continue;
+            if (!b->bloom.contains(key.data(), key.size()))
+                return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Jump consistent hash of key into one of num_buckets, from
+ * A Fast, Minimal Memory, Consistent Hash Algorithm
+ * https://arxiv.org/ftp/arxiv/papers/1406/1406.2294.pdf
+ * note: the multiplier is the one the loader has always used, changing it
+ * would move the rows of existing tables.
+ */
+uint64_t jumpConsistentHash(uint64_t key, uint64_t num_buckets)
+{
+    int64_t b = -1, j = 0;
+    while (j < static_cast<int64_t>(num_buckets)) {
+        b = j;
+        key = key * 286293355588894185ULL + 1;
+        j = (b + 1) * (double(1LL << 31) / double((key >> 33) + 1));
+    }
+    return b;
+}
+
+// the hash key of the (unsigned) key col vals, the first key col is in the
+// upper 32 bits and the second is or'ed into the lower bits.
+uint64_t partitionHashKey(const std::vector<uint64_t>& key_vals)
+{
+    uint64_t key = 0;
+    if (key_vals.size() > 0)
+        key = key_vals[0] << 32;
+    if (key_vals.size() > 1)
+        key |= key_vals[1];
+    return key;
+}
+
+// the val of an integer eq pred as the loader parses the key col text,
+// negative vals do not parse as unsigned and hash as 0.
+static bool partitionPredVal(PredicateBase* pb, uint64_t& v)
+{
+    int64_t i = 0;
+    switch (pb->colType()) {
+        case SDT_INT8: i = typedPredVal<int8_t>(pb); break;
+        case SDT_INT16: i = typedPredVal<int16_t>(pb); break;
+        case SDT_INT32: i = typedPredVal<int32_t>(pb); break;
+        case SDT_INT64: i = typedPredVal<int64_t>(pb); break;
+        case SDT_UINT8: v = typedPredVal<uint8_t>(pb); return true;
+        case SDT_UINT16: v = typedPredVal<uint16_t>(pb); return true;
+        case SDT_UINT32: v = typedPredVal<uint32_t>(pb); return true;
+        case SDT_UINT64: v = typedPredVal<uint64_t>(pb); return true;
+        default: return false;  // text of other types is not canonical
+    }
+    v = (i < 0) ? 0 : i;
+    return true;
+}
+
+/*
+ * Find the only obj that may hold rows passing the preds, that is if the
+ * preds (a logical_and chain) fix each hashed key col to a single val.
+ * Only integer key cols are supported.  Returns false if any obj may hold
+ * passing rows, obj_num is set otherwise.
+ */
+bool partitionTargetObj(partition_info& pi, predicate_vec& preds,
+                        uint64_t& obj_num)
+{
+    if (pi.part_type != SPT_JUMP_HASH_KEY or pi.num_objs == 0)
+        return false;
+    schema_vec key_schema = schemaFromString(pi.key_schema);
+    if (key_schema.empty() or key_schema.size() > PARTITION_KEY_MAX_COLS)
+        return false;
+    for (auto it = preds.begin(); it != preds.end(); ++it) {
+        if ((*it)->chainOpType() == SOT_logical_or)
+            return false;
+    }
+
+    std::vector<uint64_t> key_vals;
+    for (auto k = key_schema.begin(); k != key_schema.end(); ++k) {
+        bool fixed = false;
+        uint64_t v = 0;
+        for (auto it = preds.begin(); it != preds.end() and !fixed; ++it) {
+            PredicateBase* pb = *it;
+            if (pb->isGlobalAgg() or pb->opType() != SOT_eq or
+                pb->colIdx() != k->idx or pb->colType() != k->type)
+                continue;
+            fixed = partitionPredVal(pb, v);
+        }
+        if (!fixed)
+            return false;
+        key_vals.push_back(v);
+    }
+    obj_num = jumpConsistentHash(partitionHashKey(key_vals), pi.num_objs);
+    return true;
+}
+
+std::string buildStatsKey(
+        std::string schema_name,
+        std::string table_name,
+        std::string colname) {
+
+    boost::trim(schema_name);
+    boost::trim(table_name);
+
+    if (schema_name.empty())
+        schema_name = SCHEMA_NAME_DEFAULT;
+
+    if (table_name.empty())
+        table_name = TABLE_NAME_DEFAULT;
+
+    return (
+        STATS_KEY_PREFIX + IDX_KEY_DELIM_OUTER +
+        schema_name + IDX_KEY_DELIM_INNER +
+        table_name + IDX_KEY_DELIM_OUTER +
+        colname
+    );
+}
+
+// numeric histogram key of a stored col val, dates as date32 days.
+// returns false for types without a numeric order (strings).
+static bool statsKey(int col_type, const flexbuffers::Reference& ref,
+                     double& key)
+{
+    switch (col_type) {
+        case SDT_BOOL:
+            key = ref.AsBool();
+            return true;
+        case SDT_CHAR:
+        case SDT_INT8:
+        case SDT_INT16:
+        case SDT_INT32:
+        case SDT_INT64:
+            key = static_cast<double>(ref.AsInt64());
+            return true;
+        case SDT_UCHAR:
+        case SDT_UINT8:
+        case SDT_UINT16:
+        case SDT_UINT32:
+        case SDT_UINT64:
+            key = static_cast<double>(ref.AsUInt64());
+            return true;
+        case SDT_FLOAT:
+        case SDT_DOUBLE:
+            key = ref.AsDouble();
+            return !std::isnan(key);
+        case SDT_DATE:
+            try {
+                key = flexDateVal(ref);
+                return true;
+            } catch (...) {
+                return false;
+            }
+        default:
+            return false;
+    }
+}
+
+static std::string statsKeyToString(int col_type, double key)
+{
+    if (col_type == SDT_DATE)
+        return daysToDate(static_cast<int32_t>(key));
+    if (col_type == SDT_FLOAT or col_type == SDT_DOUBLE)
+        return std::to_string(key);
+    return std::to_string(static_cast<long long int>(key));
+}
+
+/*
+ * Append the histogram keys of each schema col of a row layout fb to vals,
+ * vals[i] holding the keys of schema[i].  Cols without a numeric order
+ * (strings) and invalid vals are skipped.
+ */
+void collectStatsVals(
+        sky_root& root,
+        schema_vec& schema,
+        std::vector<std::vector<double>>& vals)
+{
+    vals.resize(schema.size());
+    if (!root.offs) return;
+
+    for (uint32_t i = 0; i < root.nrows; i++) {
+        auto row = root.offs->Get(i)->data_flexbuffer_root().AsVector();
+        for (unsigned j = 0; j < schema.size(); j++) {
+            const int idx = schema[j].idx;
+            if (idx < 0 or idx >= static_cast<int>(row.size())) continue;
+            double key;
+            if (statsKey(schema[j].type, row[idx], key))
+                vals[j].push_back(key);
+        }
+    }
+}
+
+/*
+ * Build an equi-depth histogram of nbins over the col vals (sorted here).
+ * Bin boundaries are taken at the vals' quantiles so each bin holds about
+ * the same number of rows; a run of duplicate vals may span several bins,
+ * in which case the empty bins collapse to zero width.
+ */
+void buildColStats(
+        std::vector<double>& vals,
+        unsigned nbins,
+        col_stats& cs)
+{
+    cs.nrows = vals.size();
+    cs.ndistinct = 0;
+    cs.bounds.clear();
+    cs.hist.clear();
+    cs.nbins = 0;
+    if (vals.empty() or nbins == 0) return;
+
+    std::sort(vals.begin(), vals.end());
+    for (size_t i = 0; i < vals.size(); i++) {
+        if (i == 0 or vals[i] != vals[i - 1])
+            cs.ndistinct++;
+    }
+    cs.min_val = statsKeyToString(cs.col_type, vals.front());
+    cs.max_val = statsKeyToString(cs.col_type, vals.back());
+
+    const uint64_t n = vals.size();
+    for (unsigned b = 0; b < nbins; b++)
+        cs.bounds.push_back(vals[std::min(n - 1, b * n / nbins)]);
+    cs.bounds.push_back(vals.back());
+
+    // count the vals falling in each bin, consistent with the lower bound
+    // lookups used for estimation.
+    for (unsigned b = 0; b < nbins; b++) {
+        auto lo = std::lower_bound(vals.begin(), vals.end(), cs.bounds[b]);
+        auto hi = (b + 1 < nbins) ?
+            std::lower_bound(vals.begin(), vals.end(), cs.bounds[b + 1]) :
+            vals.end();
+        cs.hist.push_back(static_cast<int>(hi - lo));
+    }
+    cs.nbins = nbins;
+}
+
+// pred val as a histogram key, false if the pred type is not supported.
+static bool predStatsKey(PredicateBase* pb, double& key)
+{
+    switch (pb->colType()) {
+        case SDT_BOOL: key = typedPredVal<bool>(pb); return true;
+        case SDT_CHAR: key = typedPredVal<char>(pb); return true;
+        case SDT_INT8: key = typedPredVal<int8_t>(pb); return true;
+        case SDT_INT16: key = typedPredVal<int16_t>(pb); return true;
+        case SDT_INT32: key = typedPredVal<int32_t>(pb); return true;
+        case SDT_INT64: key = typedPredVal<int64_t>(pb); return true;
+        case SDT_UCHAR: key = typedPredVal<unsigned char>(pb); return true;
+        case SDT_UINT8: key = typedPredVal<uint8_t>(pb); return true;
+        case SDT_UINT16: key = typedPredVal<uint16_t>(pb); return true;
+        case SDT_UINT32: key = typedPredVal<uint32_t>(pb); return true;
+        case SDT_UINT64: key = typedPredVal<uint64_t>(pb); return true;
+        case SDT_FLOAT: key = typedPredVal<float>(pb); return true;
+        case SDT_DOUBLE: key = typedPredVal<double>(pb); return true;
+        case SDT_DATE:
+            key = dynamic_cast<TypedPredicate<std::string>*>(pb)->DateVal();
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Estimate the fraction of rows satisfying the pred from the col's
+ * equi-depth histogram, interpolating linearly within a bin and assuming
+ * uniformly frequent distinct vals for equality.
+ * Returns a negative val if no estimate can be made.
+ */
+double estimateSelectivity(const col_stats& cs, PredicateBase* pb)
+{
+    double v;
+    if (cs.nrows == 0 or cs.nbins == 0 or
+        cs.bounds.size() != cs.nbins + 1 or cs.hist.size() != cs.nbins or
+        !predStatsKey(pb, v))
+        return -1;
+
+    const double n = cs.nrows;
+    const double lo = cs.bounds.front();
+    const double hi = cs.bounds.back();
+
+    // fraction of vals strictly below v
+    double below = 0;
+    if (v > hi) {
+        below = 1;
+    } else if (v > lo) {
+        double cum = 0;
+        for (unsigned b = 0; b < cs.nbins; b++) {
+            const double b_lo = cs.bounds[b];
+            const double b_hi = cs.bounds[b + 1];
+            if (v >= b_hi and b + 1 < cs.nbins) {
+                cum += cs.hist[b];
+                continue;
+            }
+            if (v > b_lo and b_hi > b_lo)
+                cum += cs.hist[b] * std::min(1.0, (v - b_lo) / (b_hi - b_lo));
+            break;
+        }
+        below = cum / n;
+    }
+
+    double eq = 0;
+    if (v >= lo and v <= hi)
+        eq = 1.0 / std::max<uint64_t>(cs.ndistinct, 1);
+
+    double sel = -1;
+    switch (pb->opType()) {
+        case SOT_lt:
+        case SOT_before: sel = below; break;
+        case SOT_leq: sel = below + eq; break;
+        case SOT_gt:
+        case SOT_after: sel = 1 - below - eq; break;
+        case SOT_geq: sel = 1 - below; break;
+        case SOT_eq: sel = eq; break;
+        case SOT_ne: sel = 1 - eq; break;
+        default: return -1;
+    }
+    return std::min(1.0, std::max(0.0, sel));
+}
+
+bool isSkyFbCol(const char *fb) {
+    return Table_COLBufferHasIdentifier(fb);
+}
+
+bool verifySkyFb(const char *fb, size_t fb_size) {
+    flatbuffers::Verifier verifier(reinterpret_cast<const uint8_t*>(fb),
+                                   fb_size);
+    const size_t id_size = sizeof(flatbuffers::uoffset_t) +
+        flatbuffers::FlatBufferBuilder::kFileIdentifierLength;
+    if (fb_size >= id_size and isSkyFbCol(fb))
+        return VerifyTable_COLBuffer(verifier);
+    return VerifyTableBuffer(verifier);
+}
+
+// columnar layout null bitmaps: bit (i % 64) of word (i / 64) is set if
+// row i is null.
+static inline bool colIsNull(const flatbuffers::Vector<uint64_t>* nullbits,
+                             const uint32_t i)
+{
+    if (!nullbits or (i >> 6) >= nullbits->size()) return false;
+    return (nullbits->Get(i >> 6) >> (i & 63)) & 1;
+}
+
+// all col data tables share the same layout, a single typed data vector.
+template <typename ColT, typename T>
+static flatbuffers::Offset<void> createColData(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        const std::vector<T>& vals)
+{
+    auto data = flatbldr.CreateVector(vals);
+    flatbuffers::uoffset_t start = flatbldr.StartTable();
+    flatbldr.AddOffset(ColT::VT_DATA, data);
+    return flatbuffers::Offset<void>(flatbldr.EndTable(start));
+}
+
+// copy the selected rows of a typed col into the builder
+template <typename ColT, typename T>
+static flatbuffers::Offset<void> takeColData(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        const Tables::Column* col,
+        const std::vector<uint8_t>& sel,
+        const uint32_t nselected)
+{
+    const auto* vals = col->data_as<ColT>()->data();
+    std::vector<T> out;
+    out.reserve(nselected);
+    for (uint32_t i = 0; i < sel.size(); i++)
+        if (sel[i]) out.push_back(vals->Get(i));
+    return createColData<ColT>(flatbldr, out);
+}
+
+static flatbuffers::Offset<void> takeColStringData(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        const Tables::Column* col,
+        const std::vector<uint8_t>& sel,
+        const uint32_t nselected)
+{
+    const auto* vals = col->data_as_ColString()->data();
+    std::vector<flatbuffers::Offset<flatbuffers::String>> out;
+    out.reserve(nselected);
+    for (uint32_t i = 0; i < sel.size(); i++)
+        if (sel[i]) out.push_back(flatbldr.CreateString(vals->Get(i)));
+    return createColData<ColString>(flatbldr, out);
+}
+
+// evaluate a typed predicate over the typed vector of a column
+template <typename ColT, typename T>
+static int colPredicate(const Tables::Column* col,
+                        PredicateBase* pb,
+                        const uint32_t nrows,
+                        uint8_t* out)
+{
+    TypedPredicate<T>* p = static_cast<TypedPredicate<T>*>(pb);
+    const auto* vals = col->data_as<ColT>()->data();
+    if (!vals or vals->size() < nrows)
+        return TablesErrCodes::RequestedColIndexOOB;
+    return predicateKernel(vals->data(), nrows, p->Val(), p->opType(), out);
+}
+
+// accumulate a global agg over the live rows of a column, skipping nulls
+template <typename ColT, typename T>
+static void colAgg(const Tables::Column* col,
+                   PredicateBase* pb,
+                   const std::vector<uint8_t>& live)
+{
+    TypedPredicate<T>* p = static_cast<TypedPredicate<T>*>(pb);
+    const auto* vals = col->data_as<ColT>()->data();
+    const auto* nullbits = col->nullbits();
+    for (uint32_t i = 0; i < live.size(); i++) {
+        if (!live[i] or colIsNull(nullbits, i)) continue;
+        p->updateAgg(computeAgg(static_cast<T>(vals->Get(i)), p->Val(),
+                                p->opType()));
+    }
+}
+
+/*
+ * Evaluate one predicate over all rows of the columnar fb, one byte per row
+ * in out.  Agg preds are not handled here.
+ */
+static int colEvalPredicate(const Tables::Table_COL* root,
+                            const std::vector<const Tables::Column*>& colmap,
+                            PredicateBase* pb,
+                            std::vector<uint8_t>& out)
+{
+    const uint32_t nrows = root->nrows();
+    const int idx = pb->colIdx();
+    int errcode = 0;
+
+    // RID is stored apart from the data cols
+    if (idx == RID_COL_INDEX) {
+        const uint64_t* rids = root->RIDs()->data();
+        if (pb->colType() == SDT_INT64) {
+            TypedPredicate<int64_t>* p = \
+                    static_cast<TypedPredicate<int64_t>*>(pb);
+            return compareKernel(rids, nrows,
+                                 static_cast<uint64_t>(p->Val()),
+                                 p->opType(), out.data());
+        }
+        TypedPredicate<uint64_t>* p = \
+                static_cast<TypedPredicate<uint64_t>*>(pb);
+        return predicateKernel(rids, nrows, p->Val(), p->opType(),
+                               out.data());
+    }
+
+    if (idx < 0 or idx >= static_cast<int>(colmap.size()) or !colmap[idx])
+        return TablesErrCodes::RequestedColIndexOOB;
+    const Tables::Column* col = colmap[idx];
+
+    switch (pb->colType()) {
+        case SDT_INT8:
+            errcode = colPredicate<ColInt8, int8_t>(col, pb, nrows, out.data());
+            break;
+        case SDT_INT16:
+            errcode = colPredicate<ColInt16, int16_t>(col, pb, nrows,
+                                                      out.data());
+            break;
+        case SDT_INT32:
+            errcode = colPredicate<ColInt32, int32_t>(col, pb, nrows,
+                                                      out.data());
+            break;
+        case SDT_INT64:
+            errcode = colPredicate<ColInt64, int64_t>(col, pb, nrows,
+                                                      out.data());
+            break;
+        case SDT_UINT8:
+            errcode = colPredicate<ColUInt8, uint8_t>(col, pb, nrows,
+                                                      out.data());
+            break;
+        case SDT_UINT16:
+            errcode = colPredicate<ColUInt16, uint16_t>(col, pb, nrows,
+                                                        out.data());
+            break;
+        case SDT_UINT32:
+            errcode = colPredicate<ColUInt32, uint32_t>(col, pb, nrows,
+                                                        out.data());
+            break;
+        case SDT_UINT64:
+            errcode = colPredicate<ColUInt64, uint64_t>(col, pb, nrows,
+                                                        out.data());
+            break;
+        case SDT_FLOAT:
+            errcode = colPredicate<ColFloat, float>(col, pb, nrows,
+                                                    out.data());
+            break;
+        case SDT_DOUBLE:
+            errcode = colPredicate<ColDouble, double>(col, pb, nrows,
+                                                      out.data());
+            break;
+        case SDT_CHAR:
+        case SDT_UCHAR: {
+            if (pb->opType() == SOT_like) {
+                // regex on the single char string
+                const re2::RE2* regx = (pb->colType() == SDT_CHAR) ?
+                    static_cast<TypedPredicate<char>*>(pb)->getRegex() :
+                    static_cast<TypedPredicate<unsigned char>*>(pb)->getRegex();
+                for (uint32_t i = 0; i < nrows; i++) {
+                    char c = (pb->colType() == SDT_CHAR) ?
+                        col->data_as_ColInt8()->data()->Get(i) :
+                        col->data_as_ColUInt8()->data()->Get(i);
+                    out[i] = RE2::PartialMatch(re2::StringPiece(&c, 1), *regx);
+                }
+            } else if (pb->colType() == SDT_CHAR) {
+                errcode = colPredicate<ColInt8, char>(col, pb, nrows,
+                                                      out.data());
+            } else {
+                errcode = colPredicate<ColUInt8, unsigned char>(col, pb,
+                                                                nrows,
+                                                                out.data());
+            }
+            break;
+        }
+        case SDT_BOOL: {
+            TypedPredicate<bool>* p = static_cast<TypedPredicate<bool>*>(pb);
+            const auto* vals = col->data_as_ColBool()->data();
+            for (uint32_t i = 0; i < nrows; i++)
+                out[i] = compare(static_cast<bool>(vals->Get(i)), p->Val(),
+                                 p->opType());
+            break;
+        }
+        case SDT_DATE: {
+            TypedPredicate<std::string>* p = \
+                    static_cast<TypedPredicate<std::string>*>(pb);
+            const int op = dateCompareOp(p->opType());
+            if (col->data_type() == ColData_ColInt32) {  // date32
+                const auto* vals = col->data_as_ColInt32()->data();
+                if (!vals or vals->size() < nrows)
+                    return TablesErrCodes::RequestedColIndexOOB;
+                errcode = predicateKernel(vals->data(), nrows, p->DateVal(),
+                                          op, out.data());
+            } else {
+                const auto* vals = col->data_as_ColString()->data();
+                const int64_t predval = p->DateVal();
+                for (uint32_t i = 0; i < nrows; i++) {
+                    const int64_t colval = dateToDays(vals->Get(i)->c_str(),
+                                                      vals->Get(i)->size());
+                    out[i] = compare(colval, predval, op);
+                }
+            }
+            break;
+        }
+        case SDT_STRING: {
+            TypedPredicate<std::string>* p = \
+                    static_cast<TypedPredicate<std::string>*>(pb);
+            const auto* vals = col->data_as_ColString()->data();
+            if (p->opType() == SOT_like) {
+                const LikeMatcher* like = p->getLike();
+                for (uint32_t i = 0; i < nrows; i++)
+                    out[i] = like->match(vals->Get(i)->c_str(),
+                                         vals->Get(i)->size());
+                break;
+            }
+            const std::string predval = p->Val();
+            for (uint32_t i = 0; i < nrows; i++)
+                out[i] = compare(vals->Get(i)->str(), predval, p->opType(),
+                                 p->colType());
+            break;
+        }
+        default:
+            errcode = TablesErrCodes::PredicateComparisonNotDefined;
+    }
+    if (errcode) return errcode;
+
+    // null values never pass a predicate
+    const auto* nullbits = col->nullbits();
+    if (nullbits) {
+        for (uint32_t i = 0; i < nrows; i++)
+            if (colIsNull(nullbits, i)) out[i] = 0;
+    }
+    return 0;
+}
+
+static int colAccumulateAgg(const std::vector<const Tables::Column*>& colmap,
+                            PredicateBase* pb,
+                            const std::vector<uint8_t>& live)
+{
+    const int idx = pb->colIdx();
+    if (idx < 0 or idx >= static_cast<int>(colmap.size()) or !colmap[idx])
+        return TablesErrCodes::RequestedColIndexOOB;
+    const Tables::Column* col = colmap[idx];
+
+    switch (pb->colType()) {
+        case SDT_INT8: colAgg<ColInt8, int8_t>(col, pb, live); break;
+        case SDT_INT16: colAgg<ColInt16, int16_t>(col, pb, live); break;
+        case SDT_INT32: colAgg<ColInt32, int32_t>(col, pb, live); break;
+        case SDT_INT64: colAgg<ColInt64, int64_t>(col, pb, live); break;
+        case SDT_UINT8: colAgg<ColUInt8, uint8_t>(col, pb, live); break;
+        case SDT_UINT16: colAgg<ColUInt16, uint16_t>(col, pb, live); break;
+        case SDT_UINT32: colAgg<ColUInt32, uint32_t>(col, pb, live); break;
+        case SDT_UINT64: colAgg<ColUInt64, uint64_t>(col, pb, live); break;
+        case SDT_FLOAT: colAgg<ColFloat, float>(col, pb, live); break;
+        case SDT_DOUBLE: colAgg<ColDouble, double>(col, pb, live); break;
+        default: return TablesErrCodes::UnsupportedAggDataType;
+    }
+    return 0;
+}
+
+// build a result col from the selected rows of a data col
+static int colTake(flatbuffers::FlatBufferBuilder& flatbldr,
+                   const Tables::Column* col,
+                   const std::vector<uint8_t>& sel,
+                   const uint32_t nselected,
+                   flatbuffers::Offset<Tables::Column>* result)
+{
+    flatbuffers::Offset<void> data;
+    switch (col->data_type()) {
+        case ColData_ColInt8:
+            data = takeColData<ColInt8, int8_t>(flatbldr, col, sel, nselected);
+            break;
+        case ColData_ColInt16:
+            data = takeColData<ColInt16, int16_t>(flatbldr, col, sel,
+                                                  nselected);
+            break;
+        case ColData_ColInt32:
+            data = takeColData<ColInt32, int32_t>(flatbldr, col, sel,
+                                                  nselected);
+            break;
+        case ColData_ColInt64:
+            data = takeColData<ColInt64, int64_t>(flatbldr, col, sel,
+                                                  nselected);
+            break;
+        case ColData_ColUInt8:
+            data = takeColData<ColUInt8, uint8_t>(flatbldr, col, sel,
+                                                  nselected);
+            break;
+        case ColData_ColUInt16:
+            data = takeColData<ColUInt16, uint16_t>(flatbldr, col, sel,
+                                                    nselected);
+            break;
+        case ColData_ColUInt32:
+            data = takeColData<ColUInt32, uint32_t>(flatbldr, col, sel,
+                                                    nselected);
+            break;
+        case ColData_ColUInt64:
+            data = takeColData<ColUInt64, uint64_t>(flatbldr, col, sel,
+                                                    nselected);
+            break;
+        case ColData_ColFloat:
+            data = takeColData<ColFloat, float>(flatbldr, col, sel, nselected);
+            break;
+        case ColData_ColDouble:
+            data = takeColData<ColDouble, double>(flatbldr, col, sel,
+                                                  nselected);
+            break;
+        case ColData_ColBool:
+            data = takeColData<ColBool, uint8_t>(flatbldr, col, sel,
+                                                 nselected);
+            break;
+        case ColData_ColString:
+            data = takeColStringData(flatbldr, col, sel, nselected);
+            break;
+        default:
+            return TablesErrCodes::UnsupportedSkyDataType;
+    }
+
+    // compact the null bitmap to the selected rows
+    nullbits_vector nullbits((nselected + 63) / 64, 0);
+    const auto* nb = col->nullbits();
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < sel.size(); i++) {
+        if (!sel[i]) continue;
+        if (colIsNull(nb, i))
+            nullbits[j >> 6] |= (1ull << (j & 63));
+        j++;
+    }
+    *result = CreateColumn(flatbldr,
+                           col->col_idx(),
+                           flatbldr.CreateVector(nullbits),
+                           col->data_type(),
+                           data);
+    return 0;
+}
+
+int processSkyFbCol(
+    flatbuffers::FlatBufferBuilder& flatbldr,
+    schema_vec& tbl_schema,
+    schema_vec& query_schema,
+    predicate_vec& preds,
+    const char* fb,
+    const size_t fb_size,
+    std::string& errmsg,
+    const std::vector<uint32_t>& row_nums)
+{
+    int errcode = 0;
+    const Table_COL* root = GetTable_COL(fb);
+    const uint32_t nrows = root->nrows();
+
+    // identify the max col idx, and locate each data col within the fb
+    int col_idx_max = -1;
+    for (auto it = tbl_schema.begin(); it != tbl_schema.end(); ++it) {
+        if (it->idx > col_idx_max)
+            col_idx_max = it->idx;
+    }
+    std::vector<const Tables::Column*> colmap(col_idx_max + 1, nullptr);
+    for (auto it = root->cols()->begin(); it != root->cols()->end(); ++it) {
+        if (it->col_idx() >= 0 and it->col_idx() <= col_idx_max)
+            colmap[it->col_idx()] = *it;
+    }
+
+    // 1. initialize the row selection: specified row numbers or all rows,
+    //    skipping dead rows.
+    std::vector<uint8_t> sel(nrows, 0);
+    if (row_nums.empty()) {
+        std::fill(sel.begin(), sel.end(), 1);
+    } else {
+        for (auto it = row_nums.begin(); it != row_nums.end(); ++it) {
+            if (*it >= nrows) {
+                errmsg += "ERROR: rnum(" + std::to_string(*it) +
+                          ") > root.nrows(" + to_string(nrows) + ")";
+                return RowIndexOOB;
+            }
+            sel[*it] = 1;
+        }
+    }
+    const auto* delvec = root->delete_vector();
+    for (uint32_t i = 0; i < nrows && i < delvec->size(); i++)
+        if (delvec->Get(i) == 1) sel[i] = 0;
+
+    // 2. apply predicates one col at a time, with the same chaining
+    //    semantics as applyPredicates().
+    bool encode_aggs = hasAggPreds(preds);
+    if (!preds.empty()) {
+        std::vector<uint8_t> pass(nrows, 1);
+        std::vector<uint8_t> live(sel);
+        std::vector<uint8_t> colpass(nrows, 0);
+        if (preds[0]->chainOpType() == SOT_logical_or)
+            std::fill(pass.begin(), pass.end(), 0);
+
+        for (auto it = preds.begin(); it != preds.end(); ++it) {
+            PredicateBase* pb = *it;
+            const bool chain_or = (pb->chainOpType() == SOT_logical_or);
+            if (!chain_or) {
+                for (uint32_t i = 0; i < nrows; i++)
+                    live[i] &= pass[i];
+            }
+
+            if (pb->isGlobalAgg()) {
+                errcode = colAccumulateAgg(colmap, pb, live);
+                if (!chain_or) {
+                    for (uint32_t i = 0; i < nrows; i++)
+                        if (live[i]) pass[i] = 0;
+                }
+            } else {
+                errcode = colEvalPredicate(root, colmap, pb, colpass);
+                for (uint32_t i = 0; i < nrows && !errcode; i++) {
+                    if (!live[i]) continue;
+                    if (chain_or) pass[i] |= colpass[i];
+                    else pass[i] = colpass[i];
+                }
+            }
+            if (errcode) {
+                errmsg.append("ERROR processSkyFbCol(): table=" +
+                              root->table_name()->str() + " col.idx=" +
+                              std::to_string(pb->colIdx()) + " op=" +
+                              skyOpTypeToString(pb->opType()) +
+                              " not supported.");
+                return errcode;
+            }
+        }
+        for (uint32_t i = 0; i < nrows; i++)
+            sel[i] &= pass[i];
+    }
+
+    uint32_t nselected = 0;
+    for (uint32_t i = 0; i < nrows; i++)
+        nselected += sel[i];
+
+    // 3a. encode each agg as a single row col, or
+    // 3b. take the selected rows of each projected col
+    std::vector<flatbuffers::Offset<Tables::Column>> cols;
+    std::vector<uint64_t> rids;
+    if (encode_aggs) {
+        nselected = 1;
+        rids.push_back(-1);  // agg recs only, since these are derived data
+        for (auto it = preds.begin(); it != preds.end(); ++it) {
+
+            // assumes preds appear in same order as return schema
+            if (!(*it)->isGlobalAgg()) continue;
+            PredicateBase* pb = *it;
+            int col_idx = cols.size();
+            if (col_idx < static_cast<int>(query_schema.size()))
+                col_idx = query_schema[col_idx].idx;
+            flatbuffers::Offset<void> data;
+            ColData data_type = ColData_NONE;
+            switch (pb->colType()) {
+                case SDT_INT64:
+                    data = createColData<ColInt64>(flatbldr,
+                        std::vector<int64_t>(1,
+                            static_cast<TypedPredicate<int64_t>*>(pb)->Val()));
+                    data_type = ColData_ColInt64;
+                    break;
+                case SDT_UINT64:
+                    data = createColData<ColUInt64>(flatbldr,
+                        std::vector<uint64_t>(1,
+                            static_cast<TypedPredicate<uint64_t>*>(pb)->Val()));
+                    data_type = ColData_ColUInt64;
+                    break;
+                case SDT_FLOAT:
+                    data = createColData<ColFloat>(flatbldr,
+                        std::vector<float>(1,
+                            static_cast<TypedPredicate<float>*>(pb)->Val()));
+                    data_type = ColData_ColFloat;
+                    break;
+                case SDT_DOUBLE:
+                    data = createColData<ColDouble>(flatbldr,
+                        std::vector<double>(1,
+                            static_cast<TypedPredicate<double>*>(pb)->Val()));
+                    data_type = ColData_ColDouble;
+                    break;
+                default:
+                    errmsg.append("ERROR processSkyFbCol(): col.type=" +
+                                  std::to_string(pb->colType()) +
+                                  " UnsupportedAggDataType.");
+                    return TablesErrCodes::UnsupportedAggDataType;
+            }
+            nullbits_vector nb(1, 0);
+            cols.push_back(CreateColumn(flatbldr, col_idx,
+                                        flatbldr.CreateVector(nb),
+                                        data_type, data));
+        }
+    } else {
+        for (auto it = query_schema.begin(); it != query_schema.end(); ++it) {
+            if (it->idx < 0 or it->idx > col_idx_max or !colmap[it->idx]) {
+                errmsg.append("ERROR processSkyFbCol(): table=" +
+                              root->table_name()->str() + " col.idx=" +
+                              std::to_string(it->idx) + " OOB.");
+                return TablesErrCodes::RequestedColIndexOOB;
+            }
+            flatbuffers::Offset<Tables::Column> col;
+            errcode = colTake(flatbldr, colmap[it->idx], sel, nselected, &col);
+            if (errcode) {
+                errmsg.append("ERROR processSkyFbCol(): table=" +
+                              root->table_name()->str() + " col.idx=" +
+                              std::to_string(it->idx) +
+                              " UnsupportedSkyDataType.");
+                return errcode;
+            }
+            cols.push_back(col);
+        }
+        rids.reserve(nselected);
+        const auto* data_rids = root->RIDs();
+        for (uint32_t i = 0; i < nrows; i++)
+            if (sel[i]) rids.push_back(data_rids->Get(i));
+    }
+
+    // now build the return ROOT flatbuf wrapper
+    std::string query_schema_str;
+    for (auto it = query_schema.begin(); it != query_schema.end(); ++it) {
+        query_schema_str.append(it->toString() + "\n");
+    }
+    delete_vector dead_rows(nselected, 0);
+    auto table = CreateTable_COL(
+        flatbldr,
+        root->data_format_type(),
+        root->skyhook_version(),
+        root->data_structure_version(),
+        root->data_schema_version(),
+        flatbldr.CreateString(query_schema_str),
+        flatbldr.CreateString(root->db_schema()->str()),
+        flatbldr.CreateString(root->table_name()->str()),
+        flatbldr.CreateVector(dead_rows),
+        flatbldr.CreateVector(rids),
+        flatbldr.CreateVector(cols),
+        nselected);
+
+    // NOTE: the fb may be incomplete/empty, but must finish() else internal
+    // fb lib assert finished() fails, hence we must always return a valid fb
+    // and catch any ret error code upstream
+    FinishTable_COLBuffer(flatbldr, table);
+
+    return errcode;
+}
+
+long long int printFlatbufColAsCsv(const char* dataptr,
+                                   const size_t datasz,
+                                   bool print_header,
+                                   bool print_verbose,
+                                   long long int max_to_print,
+                                   std::ostream& out)
+{
+    sky_root skyroot = getSkyRoot(dataptr, datasz);
+    schema_vec sc = schemaFromString(skyroot.data_schema);
+    assert(!sc.empty());
+
+    if (print_verbose)
+        printSkyRootHeader(skyroot, out);
+
+    // print header row showing schema
+    if (print_header) {
+        bool first = true;
+        for (schema_vec::iterator it = sc.begin(); it != sc.end(); ++it) {
+            if (!first) out << CSV_DELIM;
+            first = false;
+            out << it->name;
+            if (it->is_key) out << "(key)";
+            if (!it->nullable) out << "(NOT NULL)";
+
+        }
+        out << std::endl; // newline to start first row.
+    }
+
+    long long int counter = 0;  // rows printed, dead rows do not count
+    for (uint32_t i = 0; i < skyroot.nrows; i++) {
+        if (counter >= max_to_print)
+            break;
+
+        if (skyroot.delete_vec.at(i) == 1) continue;  // skip dead rows.
+        counter++;
+
+        if (print_verbose)
+            out << "RID=" << skyroot.rids->Get(i) << CSV_DELIM;
+
+        // for each col, print a NULL or the col's value for row i
+        bool first = true;
+        for (uint32_t j = 0; j < sc.size(); j++ ) {
+            if (!first) out << CSV_DELIM;
+            first = false;
+            const Tables::Column* col = skyroot.cols->Get(j);
+
+            if (colIsNull(col->nullbits(), i)) {
+                out << "NULL";
+                continue;
+            }
+            switch (sc.at(j).type) {
+                case SDT_BOOL: out <<
+                    static_cast<bool>(col->data_as_ColBool()->data()->Get(i));
+                    break;
+                case SDT_INT8: out <<
+                    col->data_as_ColInt8()->data()->Get(i); break;
+                case SDT_INT16: out <<
+                    col->data_as_ColInt16()->data()->Get(i); break;
+                case SDT_INT32: out <<
+                    col->data_as_ColInt32()->data()->Get(i); break;
+                case SDT_INT64: out <<
+                    col->data_as_ColInt64()->data()->Get(i); break;
+                case SDT_UINT8: out <<
+                    col->data_as_ColUInt8()->data()->Get(i); break;
+                case SDT_UINT16: out <<
+                    col->data_as_ColUInt16()->data()->Get(i); break;
+                case SDT_UINT32: out <<
+                    col->data_as_ColUInt32()->data()->Get(i); break;
+                case SDT_UINT64: out <<
+                    col->data_as_ColUInt64()->data()->Get(i); break;
+                case SDT_FLOAT: out <<
+                    col->data_as_ColFloat()->data()->Get(i); break;
+                case SDT_DOUBLE: out <<
+                    col->data_as_ColDouble()->data()->Get(i); break;
+                case SDT_CHAR: out << std::string(1,
+                    col->data_as_ColInt8()->data()->Get(i)); break;
+                case SDT_UCHAR: out << std::string(1,
+                    col->data_as_ColUInt8()->data()->Get(i)); break;
+                case SDT_DATE:
+                    if (col->data_type() == ColData_ColInt32)
+                        out << daysToDate(
+                            col->data_as_ColInt32()->data()->Get(i));
+                    else
+                        out << col->data_as_ColString()->data()->Get(i)->str();
+                    break;
+                case SDT_STRING: out <<
+                    col->data_as_ColString()->data()->Get(i)->str(); break;
+                default: assert (TablesErrCodes::UnknownSkyDataType);
+            }
+        }
+        out << std::endl;  // newline to start next row.
+    }
+    return counter;
+}
+
+// transpose one data col of a row layout fb into a typed col vector
+template <typename ColT, typename T, typename F>
+static flatbuffers::Offset<void> transposeCol(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        const std::vector<flexbuffers::Vector>& rows,
+        const int idx)
+{
+    std::vector<T> vals;
+    vals.reserve(rows.size());
+    for (auto it = rows.begin(); it != rows.end(); ++it)
+        vals.push_back(static_cast<T>(flexGet<F>(*it, idx, 0)));
+    return createColData<ColT>(flatbldr, vals);
+}
 
-            case SDT_INT32: {
-                TypedPredicate<int32_t>* p = \
-                        dynamic_cast<TypedPredicate<int32_t>*>(*it);
-                int32_t colval = row[p->colIdx()].AsInt32();
-                int32_t predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,
-                                      static_cast<int64_t>(predval),
-                                      p->opType());
-                break;
-            }
+/*
+ * Transform a row layout (SFT_FLATBUF_FLEX_ROW) flatbuf into the columnar
+ * layout (SFT_FLATBUF_UNION_COL), one typed vector per data col.
+ */
+int transform_fb_to_col(const char* fb,
+                        const size_t fb_size,
+                        std::string& errmsg,
+                        flatbuffers::FlatBufferBuilder& flatbldr)
+{
+    sky_root root = getSkyRoot(fb, fb_size);
+    schema_vec sc = schemaFromString(root.data_schema);
+    if (!root.offs) {
+        errmsg.append("ERROR transform_fb_to_col(): not a row layout fb");
+        return TablesErrCodes::SkyFormatTypeNotImplemented;
+    }
 
-            case SDT_INT64: {
-                TypedPredicate<int64_t>* p = \
-                        dynamic_cast<TypedPredicate<int64_t>*>(*it);
-                int64_t colval = 0;
-                if ((*it)->colIdx() == RID_COL_INDEX)
-                    colval = rec.RID;  // RID val not in the row
-                else
-                    colval = row[p->colIdx()].AsInt64();
-                int64_t predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,predval,p->opType());
-                break;
-            }
+    std::vector<flexbuffers::Vector> rows;
+    std::vector<uint64_t> rids;
+    rows.reserve(root.nrows);
+    rids.reserve(root.nrows);
+    for (uint32_t i = 0; i < root.nrows; i++) {
+        const Tables::Record* rec = root.offs->Get(i);
+        rows.push_back(rec->data_flexbuffer_root().AsVector());
+        rids.push_back(rec->RID());
+    }
 
-            case SDT_UINT8: {
-                TypedPredicate<uint8_t>* p = \
-                        dynamic_cast<TypedPredicate<uint8_t>*>(*it);
-                uint8_t colval = row[p->colIdx()].AsUInt8();
-                uint8_t predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,
-                                      static_cast<uint64_t>(predval),
-                                      p->opType());
+    std::vector<flatbuffers::Offset<Tables::Column>> cols;
+    for (auto it = sc.begin(); it != sc.end(); ++it) {
+        const int idx = it->idx;
+        flatbuffers::Offset<void> data;
+        ColData data_type = ColData_NONE;
+        switch (it->type) {
+            case SDT_INT8:
+            case SDT_CHAR:
+                data = transposeCol<ColInt8, int8_t, int8_t>(flatbldr, rows,
+                                                             idx);
+                data_type = ColData_ColInt8;
                 break;
-            }
-
-            case SDT_UINT16: {
-                TypedPredicate<uint16_t>* p = \
-                        dynamic_cast<TypedPredicate<uint16_t>*>(*it);
-                uint16_t colval = row[p->colIdx()].AsUInt16();
-                uint16_t predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,
-                                      static_cast<uint64_t>(predval),
-                                      p->opType());
+            case SDT_INT16:
+                data = transposeCol<ColInt16, int16_t, int16_t>(flatbldr,
+                                                                rows, idx);
+                data_type = ColData_ColInt16;
                 break;
-            }
-
-            case SDT_UINT32: {
-                TypedPredicate<uint32_t>* p = \
-                        dynamic_cast<TypedPredicate<uint32_t>*>(*it);
-                uint32_t colval = row[p->colIdx()].AsUInt32();
-                uint32_t predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,
-                                      static_cast<uint64_t>(predval),
-                                      p->opType());
+            case SDT_INT32:
+                data = transposeCol<ColInt32, int32_t, int32_t>(flatbldr,
+                                                                rows, idx);
+                data_type = ColData_ColInt32;
                 break;
-            }
-
-            case SDT_UINT64: {
-                TypedPredicate<uint64_t>* p = \
-                        dynamic_cast<TypedPredicate<uint64_t>*>(*it);
-                uint64_t colval = 0;
-                if ((*it)->colIdx() == RID_COL_INDEX) // RID val not in the row
-                    colval = rec.RID;
-                else
-                    colval = row[p->colIdx()].AsUInt64();
-                uint64_t predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,predval,p->opType());
+            case SDT_INT64:
+                data = transposeCol<ColInt64, int64_t, int64_t>(flatbldr,
+                                                                rows, idx);
+                data_type = ColData_ColInt64;
                 break;
-            }
-
-            case SDT_FLOAT: {
-                TypedPredicate<float>* p = \
-                        dynamic_cast<TypedPredicate<float>*>(*it);
-                float colval = row[p->colIdx()].AsFloat();
-                float predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,
-                                      static_cast<double>(predval),
-                                      p->opType());
+            case SDT_UINT8:
+            case SDT_UCHAR:
+                data = transposeCol<ColUInt8, uint8_t, uint8_t>(flatbldr,
+                                                                rows, idx);
+                data_type = ColData_ColUInt8;
                 break;
-            }
-
-            case SDT_DOUBLE: {
-                TypedPredicate<double>* p = \
-                        dynamic_cast<TypedPredicate<double>*>(*it);
-                double colval = row[p->colIdx()].AsDouble();
-                double predval = p->Val();
-                if (p->isGlobalAgg())
-                    p->updateAgg(computeAgg(colval,predval,p->opType()));
-                else
-                    colpass = compare(colval,predval,p->opType());
+            case SDT_UINT16:
+                data = transposeCol<ColUInt16, uint16_t, uint16_t>(flatbldr,
+                                                                   rows, idx);
+                data_type = ColData_ColUInt16;
                 break;
-            }
-
-            case SDT_CHAR: {
-                TypedPredicate<char>* p= \
-                        dynamic_cast<TypedPredicate<char>*>(*it);
-                if (p->opType() == SOT_like) {
-                    // use strings for regex
-                    std::string colval = row[p->colIdx()].AsString().str();
-                    std::string predval = std::to_string(p->Val());
-                    colpass = compare(colval,predval,p->opType(),p->colType());
-                }
-                else {
-                    // use int val comparision method
-                    int8_t colval = row[p->colIdx()].AsInt8();
-                    int8_t predval = p->Val();
-                    if (p->isGlobalAgg())
-                        p->updateAgg(computeAgg(colval,predval,p->opType()));
-                    else
-                        colpass = compare(colval,
-                                          static_cast<int64_t>(predval),
-                                          p->opType());
-                }
+            case SDT_UINT32:
+                data = transposeCol<ColUInt32, uint32_t, uint32_t>(flatbldr,
+                                                                   rows, idx);
+                data_type = ColData_ColUInt32;
                 break;
-            }
-
-            case SDT_UCHAR: {
-                TypedPredicate<unsigned char>* p = \
-                        dynamic_cast<TypedPredicate<unsigned char>*>(*it);
-                if (p->opType() == SOT_like) {
-                    // use strings for regex
-                    std::string colval = row[p->colIdx()].AsString().str();
-                    std::string predval = std::to_string(p->Val());
-                    colpass = compare(colval,predval,p->opType(),p->colType());
-                }
-                else {
-                    // use int val comparision method
-                    uint8_t colval = row[p->colIdx()].AsUInt8();
-                    uint8_t predval = p->Val();
-                    if (p->isGlobalAgg())
-                        p->updateAgg(computeAgg(colval,predval,p->opType()));
-                    else
-                        colpass = compare(colval,
-                                          static_cast<uint64_t>(predval),
-                                          p->opType());
-                }
+            case SDT_UINT64:
+                data = transposeCol<ColUInt64, uint64_t, uint64_t>(flatbldr,
+                                                                   rows, idx);
+                data_type = ColData_ColUInt64;
+                break;
+            case SDT_FLOAT:
+                data = transposeCol<ColFloat, float, float>(flatbldr, rows,
+                                                            idx);
+                data_type = ColData_ColFloat;
+                break;
+            case SDT_DOUBLE:
+                data = transposeCol<ColDouble, double, double>(flatbldr, rows,
+                                                               idx);
+                data_type = ColData_ColDouble;
+                break;
+            case SDT_BOOL:
+                data = transposeCol<ColBool, uint8_t, bool>(flatbldr, rows,
+                                                            idx);
+                data_type = ColData_ColBool;
+                break;
+            case SDT_DATE: {  // date32
+                std::vector<int32_t> vals;
+                vals.reserve(rows.size());
+                for (auto r = rows.begin(); r != rows.end(); ++r)
+                    vals.push_back(flexDateVal((*r)[idx]));
+                data = createColData<ColInt32>(flatbldr, vals);
+                data_type = ColData_ColInt32;
                 break;
             }
-
-            case SDT_STRING:
-            case SDT_DATE: {
-                TypedPredicate<std::string>* p = \
-                        dynamic_cast<TypedPredicate<std::string>*>(*it);
-                string colval = row[p->colIdx()].AsString().str();
-                colpass = compare(colval,p->Val(),p->opType(),p->colType());
+            case SDT_STRING: {
+                std::vector<flatbuffers::Offset<flatbuffers::String>> vals;
+                vals.reserve(rows.size());
+                for (auto r = rows.begin(); r != rows.end(); ++r)
+                    vals.push_back(flatbldr.CreateString(
+                            (*r)[idx].AsString().str()));
+                data = createColData<ColString>(flatbldr, vals);
+                data_type = ColData_ColString;
                 break;
             }
-
-            default: assert (TablesErrCodes::PredicateComparisonNotDefined==0);
+            default:
+                errmsg.append("ERROR transform_fb_to_col(): col.type=" +
+                              std::to_string(it->type) +
+                              " UnsupportedSkyDataType.");
+                return TablesErrCodes::UnsupportedSkyDataType;
         }
 
-        // incorporate local col passing into the decision to pass row.
-        switch (chain_optype) {
-            case SOT_logical_or:
-                rowpass |= colpass;
-                break;
-            case SOT_logical_and:
-                rowpass &= colpass;
-                break;
-            default: // should not be reachable
-                rowpass &= colpass;
+        // row nullbits are msb first per row, see fbwriter.
+        nullbits_vector nullbits((root.nrows + 63) / 64, 0);
+        if (it->nullable) {
+            for (uint32_t i = 0; i < root.nrows; i++) {
+                const auto* nb = root.offs->Get(i)->nullbits();
+                int pos = idx / 64;
+                if (pos < static_cast<int>(nb->size()) and
+                    ((nb->Get(pos) >> (63 - (idx % 64))) & 1))
+                    nullbits[i >> 6] |= (1ull << (i & 63));
+            }
         }
+        cols.push_back(CreateColumn(flatbldr, idx,
+                                    flatbldr.CreateVector(nullbits),
+                                    data_type, data));
     }
-    return rowpass;
+
+    auto table = CreateTable_COL(
+        flatbldr,
+        root.data_format_type,
+        root.skyhook_version,
+        root.data_structure_version,
+        root.data_schema_version,
+        flatbldr.CreateString(root.data_schema),
+        flatbldr.CreateString(root.db_schema),
+        flatbldr.CreateString(root.table_name),
+        flatbldr.CreateVector(root.delete_vec),
+        flatbldr.CreateVector(rids),
+        flatbldr.CreateVector(cols),
+        root.nrows);
+    FinishTable_COLBuffer(flatbldr, table);
+    return 0;
 }
 
 bool compare(const int64_t& val1, const int64_t& val2, const int& op) {
@@ -1364,40 +4664,216 @@ bool compare(const uint64_t& val1, const uint64_t& val2, const int& op) {
         case SOT_bitwise_or: return val1 | val2;
         default: assert (TablesErrCodes::PredicateComparisonNotDefined==0);
     }
-    return false;  // should be unreachable
+    return false;  // should be unreachable
+}
+
+bool compare(const double& val1, const double& val2, const int& op) {
+    switch (op) {
+        case SOT_lt: return val1 < val2;
+        case SOT_gt: return val1 > val2;
+        case SOT_eq: return val1 == val2;
+        case SOT_ne: return val1 != val2;
+        case SOT_leq: return val1 <= val2;
+        case SOT_geq: return val1 >= val2;
+        default: assert (TablesErrCodes::PredicateComparisonNotDefined==0);
+    }
+    return false;  // should be unreachable
+}
+
+// days since the epoch of a proleptic gregorian y/m/d (H. Hinnant's
+// days_from_civil), exact for all dates boost accepts.
+static inline int32_t daysFromCivil(int y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int32_t>(doe) - 719468;
+}
+
+/*
+ * Parse a date string into days since the epoch.  The common "YYYY-MM-DD"
+ * form is parsed directly, anything else falls back to boost, which throws
+ * on invalid dates as before.
+ */
+int32_t dateToDays(const char* s, size_t len)
+{
+    static const unsigned mdays[] = {31, 29, 31, 30, 31, 30,
+                                     31, 31, 30, 31, 30, 31};
+    if (len == 10 and s[4] == '-' and s[7] == '-') {
+        unsigned v[8];
+        const int pos[] = {0, 1, 2, 3, 5, 6, 8, 9};
+        bool digits = true;
+        for (int i = 0; i < 8; i++) {
+            v[i] = static_cast<unsigned char>(s[pos[i]]) - '0';
+            digits &= v[i] <= 9;
+        }
+        if (digits) {
+            const int y = v[0] * 1000 + v[1] * 100 + v[2] * 10 + v[3];
+            const unsigned m = v[4] * 10 + v[5];
+            const unsigned d = v[6] * 10 + v[7];
+            const bool leap = (y % 4 == 0 and y % 100 != 0) or y % 400 == 0;
+            if (y >= 1400 and m >= 1 and m <= 12 and d >= 1 and
+                d <= mdays[m - 1] and (m != 2 or d <= 28 or leap))
+                return daysFromCivil(y, m, d);
+        }
+    }
+    boost::gregorian::date d = boost::gregorian::from_string(
+                                    std::string(s, len));
+    return (d - boost::gregorian::date(1970, 1, 1)).days();
+}
+
+bool parseDate(const char* s, size_t len, int32_t& days)
+{
+    try {
+        days = dateToDays(s, len);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+bool parseUInt(const char* s, size_t len, uint64_t& v, uint64_t max)
+{
+    size_t i = (len > 0 and s[0] == '+') ? 1 : 0;
+    if (i == len)
+        return false;
+    v = 0;
+    for (; i < len; i++) {
+        unsigned d = static_cast<unsigned char>(s[i]) - '0';
+        if (d > 9 or v > (UINT64_MAX - d) / 10)
+            return false;
+        v = v * 10 + d;
+    }
+    return v <= max;
+}
+
+bool parseInt(const char* s, size_t len, int64_t& v, int64_t min, int64_t max)
+{
+    uint64_t u;
+    if (len > 0 and s[0] == '-') {
+        // the magnitude of min is one more than max, so negate u - 1
+        if (len == 1 or s[1] == '+' or
+            !parseUInt(s + 1, len - 1, u,
+                       static_cast<uint64_t>(INT64_MAX) + 1))
+            return false;
+        v = (u == 0) ? 0 : -static_cast<int64_t>(u - 1) - 1;
+    } else {
+        if (!parseUInt(s, len, u, INT64_MAX))
+            return false;
+        v = static_cast<int64_t>(u);
+    }
+    return v >= min and v <= max;
+}
+
+bool parseDouble(const char* s, size_t len, double& v)
+{
+    char *e = NULL;
+    v = strtod(s, &e);
+    return len > 0 and e == s + len;
+}
+
+std::string daysToDate(int32_t days)
+{
+    // H. Hinnant's civil_from_days
+    int64_t z = static_cast<int64_t>(days) + 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+    const unsigned doy = doe - (365*yoe + yoe/4 - yoe/100);
+    const unsigned mp = (5*doy + 2) / 153;
+    const unsigned d = doy - (153*mp + 2)/5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%04lld-%02u-%02u",
+             static_cast<long long>(y), m, d);
+    return std::string(buf);
+}
+
+LikeMatcher::LikeMatcher(const std::string& pattern, const re2::RE2* re) :
+    k(LIKE_REGEX),
+    regx(re)
+{
+    // find the literal, bailing out to the regex on any metachar
+    size_t begin = 0;
+    size_t end = pattern.size();
+    bool anchor_front = false;
+    bool anchor_back = false;
+    if (begin < end && pattern[begin] == '^') {
+        anchor_front = true;
+        begin++;
+    }
+    std::string s;
+    for (size_t i = begin; i < end; i++) {
+        const char c = pattern[i];
+        if (c == '\\') {
+            // escaped punctuation is literal, \d \w etc. are classes
+            if (i + 1 == end || isalnum(static_cast<unsigned char>(
+                                        pattern[i + 1])))
+                return;
+            s += pattern[++i];
+            continue;
+        }
+        if (c == '$' && i + 1 == end) {
+            anchor_back = true;
+            break;
+        }
+        if (strchr(".[]()*+?{}|^$", c))
+            return;
+        s += c;
+    }
+    lit = s;
+    if (anchor_front && anchor_back)
+        k = LIKE_EXACT;
+    else if (anchor_front)
+        k = LIKE_PREFIX;
+    else if (anchor_back)
+        k = LIKE_SUFFIX;
+    else
+        k = LIKE_CONTAINS;
 }
 
-bool compare(const double& val1, const double& val2, const int& op) {
-    switch (op) {
-        case SOT_lt: return val1 < val2;
-        case SOT_gt: return val1 > val2;
-        case SOT_eq: return val1 == val2;
-        case SOT_ne: return val1 != val2;
-        case SOT_leq: return val1 <= val2;
-        case SOT_geq: return val1 >= val2;
-        default: assert (TablesErrCodes::PredicateComparisonNotDefined==0);
+bool LikeMatcher::match(const char* s, size_t len) const
+{
+    const size_t n = lit.size();
+    switch (k) {
+        case LIKE_EXACT:
+            return len == n && memcmp(s, lit.data(), n) == 0;
+        case LIKE_PREFIX:
+            return len >= n && memcmp(s, lit.data(), n) == 0;
+        case LIKE_SUFFIX:
+            return len >= n && memcmp(s + len - n, lit.data(), n) == 0;
+        case LIKE_CONTAINS: {
+            if (n == 0) return true;
+            if (len < n) return false;
+            // scan for the first byte, then confirm the rest
+            const char first = lit[0];
+            const char* p = s;
+            const char* last = s + len - n;
+            while (p <= last) {
+                p = static_cast<const char*>(memchr(p, first, last - p + 1));
+                if (!p) return false;
+                if (memcmp(p + 1, lit.data() + 1, n - 1) == 0)
+                    return true;
+                p++;
+            }
+            return false;
+        }
+        case LIKE_REGEX:
+        default:
+            return RE2::PartialMatch(re2::StringPiece(s, len), *regx);
     }
-    return false;  // should be unreachable
 }
 
 // used for date types or regex on alphanumeric types
 bool compare(const std::string& val1, const std::string& val2, const int& op, const int& data_type) {
 switch(data_type){
     case SDT_DATE:{
-        boost::gregorian::date d1 = boost::gregorian::from_string(val1);
-        boost::gregorian::date d2 = boost::gregorian::from_string(val2);
-        switch (op) {
-            case SOT_before: return d1 < d2;
-            case SOT_after: return d1 > d2;
-            case SOT_leq: return d1 <= d2;
-            case SOT_lt: return d1 < d2;
-            case SOT_geq: return d1 >= d2;
-            case SOT_gt: return d1 > d2;
-            case SOT_eq: return d1 == d2;
-            case SOT_ne: return d1 != d2;
-            default: assert (TablesErrCodes::PredicateComparisonNotDefined==0);
-        }
-        break;
+        const int64_t d1 = dateToDays(val1);
+        const int64_t d2 = dateToDays(val2);
+        return compare(d1, d2, dateCompareOp(op));
     }
     case SDT_CHAR:
     case SDT_UCHAR:
@@ -1430,34 +4906,400 @@ bool compare(const bool& val1, const bool& val2, const int& op) {
     return false;  // should be unreachable
 }
 
-std::string buildKeyData(int data_type, uint64_t new_data) {
-    std::string data_str = u64tostr(new_data);
-    int len = data_str.length();
-    int pos = 0;  // pos in u64string to get the minimum keychars for type
-    switch (data_type) {
+std::string buildIndexKeyPrefix(uint32_t idx_id)
+{
+    std::string key(1, IDX_KEY_TAG);
+    keyEncodeUInt(key, idx_id, sizeof(idx_id));
+    return key;
+}
+
+void keyEncodeUInt(std::string& key, uint64_t val, int nbytes)
+{
+    for (int i = nbytes - 1; i >= 0; i--)
+        key.push_back(static_cast<char>((val >> (8 * i)) & 0xff));
+}
+
+// flipping the sign bit orders negative before positive vals
+void keyEncodeInt(std::string& key, int64_t val, int nbytes)
+{
+    const uint64_t sign = 1ULL << (8 * nbytes - 1);
+    keyEncodeUInt(key, static_cast<uint64_t>(val) ^ sign, nbytes);
+}
+
+// IEEE order: flip all bits of negative vals, only the sign bit otherwise
+void keyEncodeFloat(std::string& key, float val)
+{
+    if (val == 0) val = 0;  // -0 == 0
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    keyEncodeUInt(key, bits, sizeof(bits));
+}
+
+void keyEncodeDouble(std::string& key, double val)
+{
+    if (val == 0) val = 0;  // -0 == 0
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    bits = (bits & 0x8000000000000000ull) ? ~bits :
+                                            (bits | 0x8000000000000000ull);
+    keyEncodeUInt(key, bits, sizeof(bits));
+}
+
+// 0x00 is escaped as 0x00 0xff and the string ends with 0x00 0x01, so no
+// encoded string is a prefix of another and byte order is string order.
+void keyEncodeString(std::string& key, const char* s, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        key.push_back(s[i]);
+        if (s[i] == '\0')
+            key.push_back('\xff');
+    }
+    key.push_back('\0');
+    key.push_back('\x01');
+}
+
+int keyEncodeFlexVal(std::string& key,
+                     int col_type,
+                     const flexbuffers::Reference& ref)
+{
+    switch (col_type) {
         case SDT_BOOL:
-            pos = len-1;
+            keyEncodeUInt(key, ref.AsBool(), 1);
             break;
         case SDT_CHAR:
-        case SDT_UCHAR:
         case SDT_INT8:
-        case SDT_UINT8:
-            pos = len-3;
+            keyEncodeInt(key, ref.AsInt64(), 1);
             break;
         case SDT_INT16:
+            keyEncodeInt(key, ref.AsInt64(), 2);
+            break;
+        case SDT_INT32:
+            keyEncodeInt(key, ref.AsInt64(), 4);
+            break;
+        case SDT_INT64:
+            keyEncodeInt(key, ref.AsInt64(), 8);
+            break;
+        case SDT_UCHAR:
+        case SDT_UINT8:
+            keyEncodeUInt(key, ref.AsUInt64(), 1);
+            break;
         case SDT_UINT16:
-            pos = len-5;
+            keyEncodeUInt(key, ref.AsUInt64(), 2);
+            break;
+        case SDT_UINT32:
+            keyEncodeUInt(key, ref.AsUInt64(), 4);
+            break;
+        case SDT_UINT64:
+            keyEncodeUInt(key, ref.AsUInt64(), 8);
+            break;
+        case SDT_FLOAT:
+            keyEncodeFloat(key, ref.AsFloat());
+            break;
+        case SDT_DOUBLE:
+            keyEncodeDouble(key, ref.AsDouble());
+            break;
+        case SDT_DATE:
+            keyEncodeInt(key, flexDateVal(ref), 4);
+            break;
+        case SDT_STRING: {
+            flexbuffers::String str = ref.AsString();
+            keyEncodeString(key, str.c_str(), str.length());
+            break;
+        }
+        default:
+            return TablesErrCodes::BuildSkyIndexUnsupportedColType;
+    }
+    return 0;
+}
+
+int keyEncodePredVal(std::string& key, PredicateBase* pb)
+{
+    switch (pb->colType()) {
+        case SDT_BOOL:
+            keyEncodeUInt(key, typedPredVal<bool>(pb), 1);
+            break;
+        case SDT_CHAR:
+            keyEncodeInt(key, typedPredVal<char>(pb), 1);
+            break;
+        case SDT_INT8:
+            keyEncodeInt(key, typedPredVal<int8_t>(pb), 1);
+            break;
+        case SDT_INT16:
+            keyEncodeInt(key, typedPredVal<int16_t>(pb), 2);
             break;
         case SDT_INT32:
+            keyEncodeInt(key, typedPredVal<int32_t>(pb), 4);
+            break;
+        case SDT_INT64:
+            keyEncodeInt(key, typedPredVal<int64_t>(pb), 8);
+            break;
+        case SDT_UCHAR:
+            keyEncodeUInt(key, typedPredVal<unsigned char>(pb), 1);
+            break;
+        case SDT_UINT8:
+            keyEncodeUInt(key, typedPredVal<uint8_t>(pb), 1);
+            break;
+        case SDT_UINT16:
+            keyEncodeUInt(key, typedPredVal<uint16_t>(pb), 2);
+            break;
         case SDT_UINT32:
-            pos = len-10;
+            keyEncodeUInt(key, typedPredVal<uint32_t>(pb), 4);
+            break;
+        case SDT_UINT64:
+            keyEncodeUInt(key, typedPredVal<uint64_t>(pb), 8);
+            break;
+        case SDT_FLOAT:
+            keyEncodeFloat(key, typedPredVal<float>(pb));
+            break;
+        case SDT_DOUBLE:
+            keyEncodeDouble(key, typedPredVal<double>(pb));
+            break;
+        case SDT_DATE:
+            keyEncodeInt(key,
+                dynamic_cast<TypedPredicate<std::string>*>(pb)->DateVal(), 4);
+            break;
+        case SDT_STRING: {
+            const std::string val = typedPredVal<std::string>(pb);
+            keyEncodeString(key, val.data(), val.size());
+            break;
+        }
+        default:
+            return TablesErrCodes::SkyIndexUnsupportedOpType;
+    }
+    return 0;
+}
+
+bool keyHasPrefix(const std::string& key, const std::string& prefix)
+{
+    return key.compare(0, prefix.size(), prefix) == 0;
+}
+
+static bool keyDecodeUInt(const std::string& key, size_t& pos, int nbytes,
+                          uint64_t& val)
+{
+    if (pos + nbytes > key.size())
+        return false;
+    val = 0;
+    for (int i = 0; i < nbytes; i++)
+        val = (val << 8) | static_cast<unsigned char>(key[pos++]);
+    return true;
+}
+
+static bool keyDecodeInt(const std::string& key, size_t& pos, int nbytes,
+                         int64_t& val)
+{
+    uint64_t u = 0;
+    if (!keyDecodeUInt(key, pos, nbytes, u))
+        return false;
+    const int shift = 64 - 8 * nbytes;
+    u ^= 1ULL << (8 * nbytes - 1);
+    val = static_cast<int64_t>(u << shift) >> shift;  // sign extend
+    return true;
+}
+
+int keyDecodeFlexVal(const std::string& key,
+                     size_t& pos,
+                     int col_type,
+                     flexbuffers::Builder& flexbldr)
+{
+    int64_t i = 0;
+    uint64_t u = 0;
+    bool ok = true;
+    switch (col_type) {
+        case SDT_BOOL:
+            if ((ok = keyDecodeUInt(key, pos, 1, u))) flexbldr.Add(u != 0);
+            break;
+        case SDT_CHAR:
+        case SDT_INT8:
+            if ((ok = keyDecodeInt(key, pos, 1, i)))
+                flexbldr.Add(static_cast<int8_t>(i));
+            break;
+        case SDT_INT16:
+            if ((ok = keyDecodeInt(key, pos, 2, i)))
+                flexbldr.Add(static_cast<int16_t>(i));
+            break;
+        case SDT_INT32:
+        case SDT_DATE:  // as date32 days
+            if ((ok = keyDecodeInt(key, pos, 4, i)))
+                flexbldr.Add(static_cast<int32_t>(i));
             break;
         case SDT_INT64:
+            if ((ok = keyDecodeInt(key, pos, 8, i))) flexbldr.Add(i);
+            break;
+        case SDT_UCHAR:
+        case SDT_UINT8:
+            if ((ok = keyDecodeUInt(key, pos, 1, u)))
+                flexbldr.Add(static_cast<uint8_t>(u));
+            break;
+        case SDT_UINT16:
+            if ((ok = keyDecodeUInt(key, pos, 2, u)))
+                flexbldr.Add(static_cast<uint16_t>(u));
+            break;
+        case SDT_UINT32:
+            if ((ok = keyDecodeUInt(key, pos, 4, u)))
+                flexbldr.Add(static_cast<uint32_t>(u));
+            break;
         case SDT_UINT64:
-            pos = 0;
+            if ((ok = keyDecodeUInt(key, pos, 8, u))) flexbldr.Add(u);
+            break;
+        case SDT_FLOAT: {
+            if ((ok = keyDecodeUInt(key, pos, 4, u))) {
+                uint32_t bits = static_cast<uint32_t>(u);
+                bits = (bits & 0x80000000u) ? (bits & ~0x80000000u) : ~bits;
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                flexbldr.Add(f);
+            }
+            break;
+        }
+        case SDT_DOUBLE: {
+            if ((ok = keyDecodeUInt(key, pos, 8, u))) {
+                u = (u & 0x8000000000000000ull) ?
+                    (u & ~0x8000000000000000ull) : ~u;
+                double d;
+                memcpy(&d, &u, sizeof(d));
+                flexbldr.Add(d);
+            }
+            break;
+        }
+        case SDT_STRING: {
+            std::string str;
+            ok = false;
+            while (pos + 1 < key.size()) {
+                char c = key[pos++];
+                if (c != '\0') {
+                    str.push_back(c);
+                    continue;
+                }
+                c = key[pos++];
+                if (c == '\x01') {  // terminator
+                    ok = true;
+                    break;
+                }
+                str.push_back('\0');  // escaped 0x00
+            }
+            if (ok) flexbldr.Add(str);
+            break;
+        }
+        default:
+            return TablesErrCodes::UnsupportedSkyDataType;
+    }
+    return ok ? 0 : TablesErrCodes::SkyIndexKeyDecodeErr;
+}
+
+/*
+ * Build a row layout fb from index keys, for index only query plans, so the
+ * usual fb processing (preds, projection, aggs) applies to the key cols.
+ * Each key holds the key cols of one row after its prefix, in key schema
+ * order, and the other cols of the table schema are null.
+ */
+int indexKeysBuildFb(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        schema_vec& tbl_schema,
+        schema_vec& key_schema,
+        const index_key_vec& keys,
+        size_t key_prefix_len,
+        std::string db_schema,
+        std::string table_name,
+        std::string& errmsg)
+{
+    int col_idx_max = -1;
+    for (auto it = tbl_schema.begin(); it != tbl_schema.end(); ++it)
+        col_idx_max = std::max(col_idx_max, it->idx);
+
+    // key col order of each table col, if any
+    std::vector<int> key_col(col_idx_max + 1, -1);
+    for (unsigned k = 0; k < key_schema.size(); k++) {
+        if (key_schema[k].idx >= 0 and key_schema[k].idx <= col_idx_max)
+            key_col[key_schema[k].idx] = k;
+    }
+
+    int errcode = 0;
+    delete_vector dead_rows;
+    std::vector<flatbuffers::Offset<Tables::Record>> offs;
+    nullbits_vector nb(2, 0);
+    std::vector<size_t> starts(key_schema.size());
+    for (auto it = keys.begin(); it != keys.end() and !errcode; ++it) {
+        const std::string& key = it->first;
+
+        // locate each key col val, since cols are in key order not row order
+        flexbuffers::Builder skip;
+        size_t pos = key_prefix_len;
+        for (unsigned k = 0; k < key_schema.size() and !errcode; k++) {
+            starts[k] = pos;
+            errcode = keyDecodeFlexVal(key, pos, key_schema[k].type, skip);
+        }
+        if (errcode) {
+            errmsg.append("ERROR indexKeysBuildFb(): bad key for rid=" +
+                          std::to_string(it->second));
             break;
+        }
+
+        flexbuffers::Builder flexbldr;
+        flexbldr.Vector([&]() {
+            for (int i = 0; i <= col_idx_max; i++) {
+                if (key_col[i] < 0) {
+                    flexbldr.Null();
+                    continue;
+                }
+                size_t p = starts[key_col[i]];
+                keyDecodeFlexVal(key, p, key_schema[key_col[i]].type,
+                                 flexbldr);
+            }
+        });
+        flexbldr.Finish();
+
+        auto row_data = flatbldr.CreateVector(flexbldr.GetBuffer());
+        auto nullbits = flatbldr.CreateVector(nb);
+        offs.push_back(Tables::CreateRecord(flatbldr, it->second, nullbits,
+                                            row_data));
+        dead_rows.push_back(0);
+    }
+
+    auto data_schema = flatbldr.CreateString(schemaToString(tbl_schema));
+    auto db_schema_off = flatbldr.CreateString(db_schema);
+    auto table_name_off = flatbldr.CreateString(table_name);
+    auto delete_v = flatbldr.CreateVector(dead_rows);
+    auto rows_v = flatbldr.CreateVector(offs);
+    auto table = CreateTable(
+        flatbldr,
+        SFT_FLATBUF_FLEX_ROW,
+        0,  // versions do not apply to derived data
+        0,
+        0,
+        data_schema,
+        db_schema_off,
+        table_name_off,
+        delete_v,
+        rows_v,
+        offs.size());
+    flatbldr.Finish(table);
+    return errcode;
+}
+
+template <typename T>
+static inline void typedAddCount(PredicateBase* pb, uint64_t n)
+{
+    TypedPredicate<T>* p = dynamic_cast<TypedPredicate<T>*>(pb);
+    p->updateAgg(p->Val() + n);
+}
+
+void aggAddCount(PredicateBase* pb, uint64_t n)
+{
+    switch (pb->colType()) {
+        case SDT_INT8: typedAddCount<int8_t>(pb, n); break;
+        case SDT_INT16: typedAddCount<int16_t>(pb, n); break;
+        case SDT_INT32: typedAddCount<int32_t>(pb, n); break;
+        case SDT_INT64: typedAddCount<int64_t>(pb, n); break;
+        case SDT_UINT8: typedAddCount<uint8_t>(pb, n); break;
+        case SDT_UINT16: typedAddCount<uint16_t>(pb, n); break;
+        case SDT_UINT32: typedAddCount<uint32_t>(pb, n); break;
+        case SDT_UINT64: typedAddCount<uint64_t>(pb, n); break;
+        case SDT_FLOAT: typedAddCount<float>(pb, n); break;
+        case SDT_DOUBLE: typedAddCount<double>(pb, n); break;
+        default: assert(UnsupportedAggDataType==0);
     }
-    return data_str.substr(pos, len);
 }
 
 std::string buildKeyPrefix(
@@ -1507,8 +5349,7 @@ std::string buildKeyPrefix(
         idx_type_str = "IDX_UNK";
     }
 
-    // TODO: this prefix should be encoded as a unique index number
-    // to minimize key length/redundancy across keys
+    // this names the index, its keys use the short id stored under the name
     return (
         idx_type_str + IDX_KEY_DELIM_OUTER +
         schema_name + IDX_KEY_DELIM_INNER +
@@ -1558,42 +5399,6 @@ bool check_predicate_ops_all_equality(predicate_vec index_preds)
     return true;
 }
 
-// used for index prefix matching during index range queries
-bool compare_keys(std::string key1, std::string key2)
-{
-
-    // Format of keys is like IDX_REC:*-LINEITEM:LINENUMBER-ORDERKEY:00000000000000000001-00000000000000000006
-    // First splitting both the string on the basis of ':' delimiter
-    vector<std::string> elems1;
-    boost::split(elems1, key1, boost::is_any_of(IDX_KEY_DELIM_OUTER),
-                                                boost::token_compress_on);
-
-    vector<std::string> elems2;
-    boost::split(elems2, key2, boost::is_any_of(IDX_KEY_DELIM_OUTER),
-                                                boost::token_compress_on);
-
-    // 4th entry in vector represents the value vector i.e after prefix
-    vector<std::string> value1;
-    vector<std::string> value2;
-
-    // Now splitting value field on the basis of '-' delimiter
-    boost::split(value1,
-                 elems1[IDX_FIELD_Value],
-                 boost::is_any_of(IDX_KEY_DELIM_INNER),
-                 boost::token_compress_on);
-    boost::split(value2,
-                 elems2[IDX_FIELD_Value],
-                 boost::is_any_of(IDX_KEY_DELIM_INNER),
-                 boost::token_compress_on);
-
-   // Compare first token of both field value
-    if (!value1.empty() and !value2.empty()) {
-        if(value1[0] == value2[0])
-            return true;
-    }
-    return false;
-}
-
 void extract_typedpred_val(Tables::PredicateBase* pb, int64_t& val) {
 
     switch(pb->colType()) {
@@ -1660,15 +5465,6 @@ void extract_typedpred_val(Tables::PredicateBase* pb, uint64_t& val) {
     }
 }
 
-#define RETURN_ON_FAILURE(expr)                                 \
-    do {                                                        \
-        arrow::Status status_ = (expr);                         \
-        if (!status_.ok()) {                                    \
-            return TablesErrCodes::ArrowStatusErr;              \
-        }                                                       \
-    } while (0);
-
-
 /* @todo: This is a temporary function to demonstrate buffer is read from the file.
  * In reality, Ceph will return a bufferlist containing a buffer.
  */
@@ -1861,6 +5657,95 @@ int split_arrow_table(std::shared_ptr<arrow::Table> &table, int max_rows,
     return 0;
 }
 
+/*
+ * Function: convert_arrow_to_parquet
+ * Description: Write the given arrow tables as a single parquet file, one row
+ * group per table, so row group stats keep the granularity of the source fbs.
+ * Dictionary and RLE encodings are left to the writer defaults, parquet 2.0
+ * logical types are used so unsigned cols read back as their arrow type.
+ * @param[in] table_vec : Tables to be written, all with the same schema.
+ * @param[out] buffer   : Output buffer holding the parquet file.
+ * Return Value: error code
+ */
+int convert_arrow_to_parquet(std::vector<std::shared_ptr<arrow::Table>>& table_vec,
+                             std::shared_ptr<arrow::Buffer>* buffer)
+{
+    if (table_vec.empty())
+        return TablesErrCodes::ParquetErr;
+
+    // the file carries the skyhook metadata of the first table, with the
+    // total num rows.
+    int64_t nrows = 0;
+    for (auto it = table_vec.begin(); it != table_vec.end(); ++it)
+        nrows += (*it)->num_rows();
+    auto metadata = arrowMetadataWithRows(
+                        table_vec[0]->schema()->metadata(), nrows);
+    auto schema = std::make_shared<arrow::Schema>(
+                        table_vec[0]->schema()->fields(), metadata);
+
+    std::shared_ptr<arrow::io::BufferOutputStream> out;
+    RETURN_ON_FAILURE(arrow::io::BufferOutputStream::Create(STREAM_CAPACITY,
+                            arrow::default_memory_pool(), &out));
+    std::shared_ptr<parquet::WriterProperties> props = \
+            parquet::WriterProperties::Builder()
+            .version(parquet::ParquetVersion::PARQUET_2_0)->build();
+    try {
+        std::unique_ptr<parquet::arrow::FileWriter> writer;
+        RETURN_ON_FAILURE(parquet::arrow::FileWriter::Open(*schema,
+                                arrow::default_memory_pool(), out, props,
+                                &writer));
+        for (auto it = table_vec.begin(); it != table_vec.end(); ++it) {
+            auto table = (*it)->ReplaceSchemaMetadata(metadata);
+            if (table->num_rows() == 0)
+                continue;
+            RETURN_ON_FAILURE(writer->WriteTable(*table, table->num_rows()));
+        }
+        RETURN_ON_FAILURE(writer->Close());
+    } catch (const parquet::ParquetException& e) {
+        return TablesErrCodes::ParquetErr;
+    }
+    RETURN_ON_FAILURE(out->Finish(buffer));
+    return 0;
+}
+
+/*
+ * Function: extract_arrow_from_parquet
+ * Description: Read all row groups of a parquet file into one arrow table,
+ * with the skyhook metadata stored in the file.
+ * @param[out] table  : Output arrow table
+ * @param[in] buffer  : Input buffer holding the parquet file.
+ * Return Value: error code
+ */
+int extract_arrow_from_parquet(std::shared_ptr<arrow::Table>* table,
+                               const std::shared_ptr<arrow::Buffer>& buffer)
+{
+    auto file = std::make_shared<arrow::io::BufferReader>(buffer);
+    try {
+        std::unique_ptr<parquet::ParquetFileReader> pq = \
+                parquet::ParquetFileReader::Open(file);
+        auto metadata = pq->metadata()->key_value_metadata();
+        parquet::arrow::FileReader reader(arrow::default_memory_pool(),
+                                          std::move(pq));
+        std::shared_ptr<arrow::Table> t;
+        RETURN_ON_FAILURE(reader.ReadTable(&t));
+        if (!metadata or metadata->size() <= METADATA_NUM_ROWS)
+            return TablesErrCodes::ParquetErr;
+        *table = t->ReplaceSchemaMetadata(
+                        arrowMetadataWithRows(metadata, t->num_rows()));
+    } catch (const parquet::ParquetException& e) {
+        return TablesErrCodes::ParquetErr;
+    }
+    return 0;
+}
+
+bool isParquet(const char* data, size_t len)
+{
+    return (len >= 2 * PARQUET_FILE_MAGIC_LEN and
+            memcmp(data, PARQUET_FILE_MAGIC, PARQUET_FILE_MAGIC_LEN) == 0 and
+            memcmp(data + len - PARQUET_FILE_MAGIC_LEN, PARQUET_FILE_MAGIC,
+                   PARQUET_FILE_MAGIC_LEN) == 0);
+}
+
 int print_arrowbuf_colwise(std::shared_ptr<arrow::Table>& table)
 {
     std::vector<std::shared_ptr<arrow::Array>> array_list;
@@ -2013,7 +5898,10 @@ int print_arrowbuf_colwise(std::shared_ptr<arrow::Table>& table)
                 for (auto it = array_list.begin(); it != array_list.end(); ++it) {
                     auto array = *it;
                     for (int j = 0; j < array->length(); j++) {
-                        std::cout << std::static_pointer_cast<arrow::StringArray>(array)->GetString(j);
+                        if (array->type_id() == arrow::Type::DATE32)
+                            std::cout << daysToDate(std::static_pointer_cast<arrow::Date32Array>(array)->Value(j));
+                        else
+                            std::cout << std::static_pointer_cast<arrow::StringArray>(array)->GetString(j);
                         std::cout << CSV_DELIM;
                     }
                 }
@@ -2027,18 +5915,19 @@ int print_arrowbuf_colwise(std::shared_ptr<arrow::Table>& table)
     return 0;
 }
 
-void printArrowHeader(std::shared_ptr<const arrow::KeyValueMetadata> &metadata)
+void printArrowHeader(std::shared_ptr<const arrow::KeyValueMetadata> &metadata,
+                      std::ostream& out)
 {
-    std::cout << "\n\n\n[SKYHOOKDB ROOT HEADER (arrow)]" << std::endl;
-    std::cout << metadata->key(METADATA_SKYHOOK_VERSION).c_str() << ": "
+    out << "\n\n\n[SKYHOOKDB ROOT HEADER (arrow)]" << std::endl;
+    out << metadata->key(METADATA_SKYHOOK_VERSION).c_str() << ": "
               << metadata->value(METADATA_SKYHOOK_VERSION).c_str() << std::endl;
-    std::cout << metadata->key(METADATA_DATA_SCHEMA_VERSION).c_str() << ": "
+    out << metadata->key(METADATA_DATA_SCHEMA_VERSION).c_str() << ": "
               << metadata->value(METADATA_DATA_SCHEMA_VERSION).c_str() << std::endl;
-    std::cout << metadata->key(METADATA_DATA_STRUCTURE_VERSION).c_str() << ": "
+    out << metadata->key(METADATA_DATA_STRUCTURE_VERSION).c_str() << ": "
               << metadata->value(METADATA_DATA_STRUCTURE_VERSION).c_str() << std::endl;
-    std::cout << metadata->key(METADATA_DATA_FORMAT_TYPE).c_str() << ": "
+    out << metadata->key(METADATA_DATA_FORMAT_TYPE).c_str() << ": "
               << metadata->value(METADATA_DATA_FORMAT_TYPE).c_str() << std::endl;
-    std::cout << metadata->key(METADATA_NUM_ROWS).c_str() << ": "
+    out << metadata->key(METADATA_NUM_ROWS).c_str() << ": "
               << metadata->value(METADATA_NUM_ROWS).c_str() << std::endl;
 }
 
@@ -2046,7 +5935,8 @@ long long int printArrowbufRowAsCsv(const char* dataptr,
                                     const size_t datasz,
                                     bool print_header,
                                     bool print_verbose,
-                                    long long int max_to_print)
+                                    long long int max_to_print,
+                                    std::ostream& out)
 {
     // Each column in arrow is represented using Chunked Array. A chunked array is
     // a vector of chunks i.e. arrays which holds actual data.
@@ -2069,27 +5959,29 @@ long long int printArrowbufRowAsCsv(const char* dataptr,
     int num_cols = 0;
 
     if (print_verbose)
-        printArrowHeader(metadata);
+        printArrowHeader(metadata, out);
 
-    // Get the names of each column and get the vector of chunks
+    // Get the names of each column and get the vector of chunks.
+    // Note the schema col.idx refers to the original data schema, which may
+    // differ from the arrow column position for projected tables.
     for (auto it = sc.begin(); it != sc.end(); ++it) {
-        col_info col = *it;
+        int pos = std::distance(sc.begin(), it);
         if (print_header) {
-            std::cout << table->column(col.idx)->name();
-            if (it->is_key) std::cout << "(key)";
-            if (!it->nullable) std::cout << "(NOT NULL)";
-            std::cout << CSV_DELIM;
+            out << table->column(pos)->name();
+            if (it->is_key) out << "(key)";
+            if (!it->nullable) out << "(NOT NULL)";
+            out << CSV_DELIM;
         }
-        chunked_array_vec.emplace_back(table->column(col.idx)->data()->chunks());
+        chunked_array_vec.emplace_back(table->column(pos)->data()->chunks());
     }
 
     if (print_verbose) {
         num_cols = std::distance(sc.begin(), sc.end());
 
         if (print_header) {
-            std::cout << table->column(ARROW_RID_INDEX(num_cols))->name()
+            out << table->column(ARROW_RID_INDEX(num_cols))->name()
                       << CSV_DELIM;
-            std::cout << table->column(ARROW_DELVEC_INDEX(num_cols))->name()
+            out << table->column(ARROW_DELVEC_INDEX(num_cols))->name()
                       << CSV_DELIM;
         }
 
@@ -2099,7 +5991,7 @@ long long int printArrowbufRowAsCsv(const char* dataptr,
     }
 
     if (print_header)
-        std::cout << std::endl;
+        out << std::endl;
 
     // As number of elements in all the columns are equal use chunked_array 0 to get number of
     // elements.
@@ -2110,7 +6002,10 @@ long long int printArrowbufRowAsCsv(const char* dataptr,
     auto array = array_it[array_index];
     int array_num_elements = array->length();
     int array_element_it = 0;
-    for (int i = 0; i < num_rows; i++, array_element_it++) {
+    long long int counter = 0;
+    for (int i = 0; i < num_rows; i++, counter++, array_element_it++) {
+        if (counter >= max_to_print)
+            break;
 
         // Check if we have exhausted the current array. If yes,
         // go to next array inside the chunked array to get the number of
@@ -2129,88 +6024,94 @@ long long int printArrowbufRowAsCsv(const char* dataptr,
             auto print_array = print_array_it[array_index];
 
             if (print_array->IsNull(array_element_it)) {
-                std::cout << "NULL" << CSV_DELIM;
+                out << "NULL" << CSV_DELIM;
                 continue;
             }
 
             switch(col.type) {
                 case SDT_BOOL: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::BooleanArray>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::BooleanArray>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_INT8: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::Int8Array>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::Int8Array>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_INT16: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::Int16Array>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::Int16Array>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_INT32: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::Int32Array>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::Int32Array>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_INT64: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::Int64Array>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::Int64Array>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_UINT8: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::UInt8Array>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::UInt8Array>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_UINT16: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::UInt16Array>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::UInt16Array>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_UINT32: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::UInt32Array>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::UInt32Array>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_UINT64: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::UInt64Array>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::UInt64Array>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_CHAR: {
-                    std::cout << (char)std::static_pointer_cast<arrow::Int8Array>(print_array)->Value(array_element_it);
+                    out << (char)std::static_pointer_cast<arrow::Int8Array>(print_array)->Value(array_element_it);
                     break;
                 }
                 case SDT_UCHAR: {
-                    std::cout << (char)std::static_pointer_cast<arrow::UInt8Array>(print_array)->Value(array_element_it);
+                    out << (char)std::static_pointer_cast<arrow::UInt8Array>(print_array)->Value(array_element_it);
                     break;
                 }
                 case SDT_FLOAT: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::FloatArray>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::FloatArray>(print_array)->Value(array_element_it));
                     break;
                 }
                 case SDT_DOUBLE: {
-                    std::cout << std::to_string(std::static_pointer_cast<arrow::DoubleArray>(print_array)->Value(array_element_it));
+                    out << std::to_string(std::static_pointer_cast<arrow::DoubleArray>(print_array)->Value(array_element_it));
+                    break;
+                }
+                case SDT_DATE: {
+                    if (print_array->type_id() == arrow::Type::DATE32)
+                        out << daysToDate(std::static_pointer_cast<arrow::Date32Array>(print_array)->Value(array_element_it));
+                    else
+                        out << std::static_pointer_cast<arrow::StringArray>(print_array)->GetString(array_element_it);
                     break;
                 }
-                case SDT_DATE:
                 case SDT_STRING: {
-                    std::cout << std::static_pointer_cast<arrow::StringArray>(print_array)->GetString(array_element_it);
+                    out << std::static_pointer_cast<arrow::StringArray>(print_array)->GetString(array_element_it);
                     break;
                 }
                 default: {
                     return TablesErrCodes::UnsupportedSkyDataType;
                 }
             }
-            std::cout << CSV_DELIM;
+            out << CSV_DELIM;
         }
         if (print_verbose) {
             // Print RID
             auto print_array_it = chunked_array_vec[ARROW_RID_INDEX(num_cols)];
             auto print_array = print_array_it[array_index];
-            std::cout << std::to_string(std::static_pointer_cast<arrow::Int64Array>(print_array)->Value(array_element_it)) << CSV_DELIM;
+            out << std::to_string(std::static_pointer_cast<arrow::Int64Array>(print_array)->Value(array_element_it)) << CSV_DELIM;
 
             // Print Deleted Vector
             print_array_it = chunked_array_vec[ARROW_DELVEC_INDEX(num_cols)];
             print_array = print_array_it[array_index];
-            std::cout << std::to_string(std::static_pointer_cast<arrow::UInt8Array>(print_array)->Value(array_element_it)) << CSV_DELIM;
+            out << std::to_string(std::static_pointer_cast<arrow::UInt8Array>(print_array)->Value(array_element_it)) << CSV_DELIM;
         }
-        std::cout << std::endl;  // newline to start next row.
+        out << std::endl;  // newline to start next row.
     }
-    return 0;
+    return counter;
 }
 
 
@@ -2234,6 +6135,10 @@ int transform_fb_to_arrow(const char* fb,
 {
     int errcode = 0;
     sky_root root = getSkyRoot(fb, fb_size);
+    if (!root.offs) {
+        errmsg.append("ERROR transform_fb_to_arrow(): not a row layout fb");
+        return TablesErrCodes::SkyFormatTypeNotImplemented;
+    }
     schema_vec sc = schemaFromString(root.data_schema);
     delete_vector del_vec = root.delete_vec;
     uint32_t nrows = root.nrows;
@@ -2360,7 +6265,13 @@ int transform_fb_to_arrow(const char* fb,
                 schema_vector.push_back(arrow::field(col.name, arrow::uint8()));
                 break;
             }
-            case SDT_DATE:
+            case SDT_DATE: {
+                auto ptr = std::unique_ptr<arrow::ArrayBuilder>(new arrow::Date32Builder(pool));
+                builder_list.emplace_back(ptr.get());
+                ptr.release();
+                schema_vector.push_back(arrow::field(col.name, arrow::date32()));
+                break;
+            }
             case SDT_STRING: {
                 auto ptr = std::unique_ptr<arrow::ArrayBuilder>(new arrow::StringBuilder(pool));
                 builder_list.emplace_back(ptr.get());
@@ -2386,10 +6297,10 @@ int transform_fb_to_arrow(const char* fb,
     schema_vector.push_back(arrow::field("RID", arrow::int64()));
 
     // Add deleted vector column
-    auto dv_ptr = std::unique_ptr<arrow::ArrayBuilder>(new arrow::BooleanBuilder(pool));
+    auto dv_ptr = std::unique_ptr<arrow::ArrayBuilder>(new arrow::UInt8Builder(pool));
     builder_list.emplace_back(dv_ptr.get());
     dv_ptr.release();
-    schema_vector.push_back(arrow::field("DELETED_VECTOR", arrow::boolean()));
+    schema_vector.push_back(arrow::field("DELETED_VECTOR", arrow::uint8()));
 
     // Iterate through rows and store data in each row in respective columns.
     for (uint32_t i = 0; i < nrows; i++) {
@@ -2462,6 +6373,8 @@ int transform_fb_to_arrow(const char* fb,
                     static_cast<arrow::UInt8Builder *>(builder)->Append(row[col.idx].AsUInt8());
                     break;
                 case SDT_DATE:
+                    static_cast<arrow::Date32Builder *>(builder)->Append(flexDateVal(row[col.idx]));
+                    break;
                 case SDT_STRING:
                     static_cast<arrow::StringBuilder *>(builder)->Append(row[col.idx].AsString().str());
                     break;
@@ -14,7 +14,11 @@
 
 #include <string>
 #include <sstream>
+#include <iostream>
 #include <type_traits>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
 
 #include "include/types.h"
 #include <errno.h>
@@ -36,6 +40,7 @@
 #include "cls_tabular.h"
 #include "flatbuffers/flexbuffers.h"
 #include "skyhookv2_generated.h"
+#include "skyhookv2_col_generated.h"
 
 namespace Tables {
 
@@ -64,7 +69,10 @@ enum TablesErrCodes {
     SkyIndexColNotPresent,
     RowIndexOOB,
     SkyFormatTypeNotImplemented,
-    ArrowStatusErr
+    ArrowStatusErr,
+    ParquetErr,
+    SkyIndexKeyDecodeErr,
+    PredicateValueInvalid
 };
 
 // skyhook data types, as supported by underlying data format
@@ -114,6 +122,7 @@ enum SkyOpType {
     SOT_max,
     SOT_sum,
     SOT_cnt,
+    SOT_avg,  // partial agg (sum+cnt), group by only
     // LEXICAL (regex)
     SOT_like,
     // MEMBERSHIP (collections) (TODO)
@@ -181,15 +190,17 @@ enum AggColIdx {
     AGG_COL_MAX = -2,
     AGG_COL_SUM = -3,
     AGG_COL_CNT = -4,
+    AGG_COL_AVG = -5,
     AGG_COL_FIRST = AGG_COL_MIN,
-    AGG_COL_LAST = AGG_COL_CNT,
+    AGG_COL_LAST = AGG_COL_AVG,
 };
 
 const std::map<std::string, int> AGG_COL_IDX = {
     {"min", AGG_COL_MIN},
     {"max", AGG_COL_MAX},
     {"sum", AGG_COL_SUM},
-    {"cnt", AGG_COL_CNT}
+    {"cnt", AGG_COL_CNT},
+    {"avg", AGG_COL_AVG}
 };
 
 const std::unordered_map<std::string, bool> IDX_STOPWORDS= {
@@ -227,9 +238,13 @@ const std::string IDX_KEY_DELIM_INNER = "-";
 const std::string IDX_KEY_DELIM_OUTER = ":";
 const std::string IDX_KEY_DELIM_UNIQUE = "ENFORCEUNIQ";
 const std::string IDX_KEY_COLS_DEFAULT = "*";
+const char IDX_KEY_TAG = '\x01';  // first byte of binary index keys
 const std::string SCHEMA_NAME_DEFAULT = "*";
 const std::string TABLE_NAME_DEFAULT = "*";
 const std::string RID_INDEX = "_RID_INDEX_";
+const std::string STATS_KEY_PREFIX = "STATS";
+const std::string PARTITION_OID_PREFIX = "skyhook.partitioning.";
+const unsigned PARTITION_KEY_MAX_COLS = 2;  // key cols hashed by the loader
 const int RID_COL_INDEX = -99; // magic number...
 const long long int ROW_LIMIT_DEFAULT = LLONG_MAX;
 
@@ -261,6 +276,86 @@ static inline int strtou64(const std::string value, uint64_t *out)
   return 0;
 }
 
+// SDT_DATE vals are stored as date32, i.e., days since the unix epoch.
+// Older data stores dates as "YYYY-MM-DD" strings, readers accept both.
+// dateToDays throws on an invalid date, parseDate returns false instead.
+int32_t dateToDays(const char* s, size_t len);
+inline int32_t dateToDays(const std::string& s) {
+    return dateToDays(s.data(), s.size());
+}
+bool parseDate(const char* s, size_t len, int32_t& days);
+
+// decimal ints are parsed directly from s, no copy or stream, false if not
+// a number or out of the range of [min, max].
+bool parseUInt(const char* s, size_t len, uint64_t& v,
+               uint64_t max = UINT64_MAX);
+bool parseInt(const char* s, size_t len, int64_t& v,
+              int64_t min = INT64_MIN, int64_t max = INT64_MAX);
+// s must end at a delimiter, newline or nul after len, which also ends strtod
+bool parseDouble(const char* s, size_t len, double& v);
+std::string daysToDate(int32_t days);
+
+// a stored date val of either encoding, as days since the epoch
+inline int32_t flexDateVal(const flexbuffers::Reference& ref) {
+    if (ref.IsString()) {
+        flexbuffers::String s = ref.AsString();
+        return dateToDays(s.c_str(), s.length());
+    }
+    return ref.AsInt32();
+}
+
+// a stored date val of either encoding, as "YYYY-MM-DD"
+inline std::string flexDateString(const flexbuffers::Reference& ref) {
+    if (ref.IsString())
+        return ref.AsString().str();
+    return daysToDate(ref.AsInt32());
+}
+
+// date ops compare as the equivalent integer ops
+inline int dateCompareOp(int op) {
+    if (op == SOT_before) return SOT_lt;
+    if (op == SOT_after) return SOT_gt;
+    return op;
+}
+
+// date pred vals are converted once, when the predicate is created,
+// predsFromString has already checked that they are valid dates.
+template <typename T> inline int32_t predDateDays(const T& v) { return 0; }
+template <> inline int32_t predDateDays<std::string>(const std::string& v) {
+    int32_t days = 0;
+    parseDate(v.data(), v.size(), days);
+    return days;
+}
+
+/*
+ * LIKE (regex) matching.  Patterns that are plain literals, optionally
+ * anchored by ^ and/or $, are matched by a substring search rather than
+ * by RE2, everything else uses the given precompiled regex.
+ */
+class LikeMatcher
+{
+public:
+    enum Kind {
+        LIKE_REGEX,
+        LIKE_CONTAINS,
+        LIKE_PREFIX,
+        LIKE_SUFFIX,
+        LIKE_EXACT
+    };
+
+    LikeMatcher(const std::string& pattern, const re2::RE2* re);
+    bool match(const char* s, size_t len) const;
+    bool match(const re2::StringPiece& sp) const {
+        return match(sp.data(), sp.size());
+    }
+    Kind kind() const {return k;}
+
+private:
+    Kind k;
+    std::string lit;        // the literal, for all kinds except LIKE_REGEX
+    const re2::RE2* regx;   // not owned
+};
+
 // contains the value of a predicate to be applied
 template <class T>
 class PredicateValue
@@ -295,8 +390,10 @@ private:
     const int op_type;
     const bool is_global_agg;
     const re2::RE2* regx;
+    const LikeMatcher* like;  // for like ops only
     PredicateValue<T> value;
     const int chain_op_type;
+    int32_t date_days;  // value as date32, for date cols only
 
 public:
     TypedPredicate(int idx, int type, int op, const T& val, const int ch_op=SOT_logical_and) :
@@ -304,9 +401,12 @@ public:
         col_type(type),
         op_type(op),
         is_global_agg(op==SOT_min || op==SOT_max ||
-                      op==SOT_sum || op==SOT_cnt),
+                      op==SOT_sum || op==SOT_cnt || op==SOT_avg),
+        like(nullptr),
         value(val),
-        chain_op_type(ch_op) {
+        chain_op_type(ch_op),
+        date_days((type == SDT_DATE and !is_global_agg) ?
+                  predDateDays(val) : 0) {
 
             // ONLY VERIFY op type is valid for specified col type and value
             // type T, and compile regex if needed.
@@ -326,6 +426,7 @@ public:
                 case SOT_max:
                 case SOT_sum:
                 case SOT_cnt:
+                case SOT_avg:
                     assert (
                             (col_type==SDT_DATE) or
                             (std::is_arithmetic<T>::value and
@@ -412,6 +513,7 @@ public:
                 pattern = this->Val();  // force str type for regex
                 regx = new re2::RE2(pattern);
                 assert (regx->ok());
+                like = new LikeMatcher(pattern, regx);
             }
         }
 
@@ -420,8 +522,12 @@ public:
         col_type(p.col_type),
         op_type(p.op_type),
         is_global_agg(p.is_global_agg),
-        value(p.value.val) {
+        like(nullptr),
+        value(p.value.val),
+        date_days(p.date_days) {
             regx = new re2::RE2(p.regx->pattern());
+            if (p.like)
+                like = new LikeMatcher(regx->pattern(), regx);
         }
 
     ~TypedPredicate() { }
@@ -433,7 +539,9 @@ public:
     virtual int chainOpType() {return chain_op_type;}
     virtual bool isGlobalAgg() {return is_global_agg;}
     T Val() {return value.val;}
+    int32_t DateVal() {return date_days;}
     const re2::RE2* getRegex() {return regx;}
+    const LikeMatcher* getLike() {return like;}
     void updateAgg(T newval) {value.val = newval;}
 };
 
@@ -510,6 +618,10 @@ bool compareColInfo(const struct col_info& l, const struct col_info& r) {
 typedef vector<uint8_t> delete_vector;
 typedef const flatbuffers::Vector<flatbuffers::Offset<Record>>* row_offs;
 
+// the below are used in our columnar (SFT_FLATBUF_UNION_COL) root table
+typedef const flatbuffers::Vector<flatbuffers::Offset<Column>>* col_offs;
+typedef const flatbuffers::Vector<uint64_t>* rid_vec;
+
 // the below are used in our row table
 typedef vector<uint64_t> nullbits_vector;
 typedef flexbuffers::Reference row_data_ref;
@@ -526,8 +638,10 @@ struct root_table {
     std::string db_schema;
     std::string table_name;
     delete_vector delete_vec;
-    row_offs offs;
+    row_offs offs;      // row layout only, else nullptr
     uint32_t nrows;
+    col_offs cols;      // col layout only, else nullptr
+    rid_vec rids;       // col layout only, else nullptr
 
     root_table(
         int32_t _data_format_type,
@@ -539,7 +653,9 @@ struct root_table {
         std::string _table_name,
         delete_vector _delete_vec,
         row_offs _offs,
-        uint32_t _nrows) :  skyhook_version(_skyhook_version),
+        uint32_t _nrows,
+        col_offs _cols=nullptr,
+        rid_vec _rids=nullptr) :  skyhook_version(_skyhook_version),
                             data_format_type(_data_format_type),
                             data_structure_version(_data_structure_version),
                             data_schema_version(_data_schema_version),
@@ -548,7 +664,9 @@ struct root_table {
                             table_name(_table_name),
                             delete_vec(_delete_vec),
                             offs(_offs),
-                            nrows(_nrows) {};
+                            nrows(_nrows),
+                            cols(_cols),
+                            rids(_rids) {};
 };
 typedef struct root_table sky_root;
 
@@ -656,7 +774,15 @@ const std::string TPCH_LINEITEM_TEST_SCHEMA_STRING_PROJECT = " \
 sky_root getSkyRoot(const char *fb, size_t fb_size);
 sky_rec getSkyRec(const Tables::Record *rec);
 
+// true if the flatbuf uses the columnar layout (SFT_FLATBUF_UNION_COL)
+bool isSkyFbCol(const char *fb);
+
+// true if the bytes are a well formed skyhook flatbuf of either layout,
+// to check fbs from clients before reading them
+bool verifySkyFb(const char *fb, size_t fb_size);
+
 // print functions (debug only)
+// the csv printers write to out, which lets callers format into a buffer
 void printSkyRoot(sky_root *r);
 void printSkyRec(sky_rec *r);
 void printSkyFb(const char* fb, size_t fb_size);
@@ -664,14 +790,23 @@ long long int printFlatbufFlexRowAsCsv(const char* dataptr,
                                        const size_t datasz,
                                        bool print_header,
                                        bool print_verbose,
-                                       long long int max_to_print);
-void printArrowHeader(std::shared_ptr<const arrow::KeyValueMetadata> &metadata);
+                                       long long int max_to_print,
+                                       std::ostream& out = std::cout);
+long long int printFlatbufColAsCsv(const char* dataptr,
+                                   const size_t datasz,
+                                   bool print_header,
+                                   bool print_verbose,
+                                   long long int max_to_print,
+                                   std::ostream& out = std::cout);
+void printArrowHeader(std::shared_ptr<const arrow::KeyValueMetadata> &metadata,
+                      std::ostream& out = std::cout);
 int print_arrowbuf_colwise(std::shared_ptr<arrow::Table>& table);
 long long int printArrowbufRowAsCsv(const char* dataptr,
                                     const size_t datasz,
                                     bool print_header,
                                     bool print_verbose,
-                                    long long int max_to_print);
+                                    long long int max_to_print,
+                                    std::ostream& out = std::cout);
 
 // Transform functions
 int transform_fb_to_arrow(const char* fb,
@@ -682,6 +817,10 @@ int transform_arrow_to_fb(const char* data,
                           const size_t data_size,
                           std::string& errmsg,
                           flatbuffers::FlatBufferBuilder& flatbldr);
+int transform_fb_to_col(const char* fb,
+                        const size_t fb_size,
+                        std::string& errmsg,
+                        flatbuffers::FlatBufferBuilder& flatbldr);
 
 
 // convert provided schema to/from skyhook internal representation
@@ -692,6 +831,8 @@ std::string schemaToString(schema_vec schema);
 
 // convert provided predicates to/from skyhook internal representation
 predicate_vec predsFromString(schema_vec &schema, std::string preds_string);
+int predsFromString(schema_vec &schema, std::string preds_string,
+                    predicate_vec &preds);
 std::string predsToString(predicate_vec &preds,  schema_vec &schema);
 std::vector<std::string> colnamesFromPreds(predicate_vec &preds,
                                            schema_vec &schema);
@@ -714,6 +855,17 @@ int processSkyFb(
         std::string& errmsg,
         const std::vector<uint32_t>& row_nums=std::vector<uint32_t>());
 
+// as processSkyFb, for the columnar flatbuf layout, returns a columnar fb
+int processSkyFbCol(
+        flatbuffers::FlatBufferBuilder& flatb,
+        schema_vec& data_schema,
+        schema_vec& query_schema,
+        predicate_vec& preds,
+        const char* fb,
+        const size_t fb_size,
+        std::string& errmsg,
+        const std::vector<uint32_t>& row_nums=std::vector<uint32_t>());
+
 int processArrow(
         std::shared_ptr<arrow::Table>* table,
         schema_vec& tbl_schema,
@@ -722,11 +874,207 @@ int processArrow(
         const char* dataptr,
         const size_t datasz,
         std::string& errmsg,
-        const std::vector<uint32_t>& row_nums=std::vector<uint32_t>());
+        const std::vector<uint32_t>& row_nums=std::vector<uint32_t>(),
+        uint64_t* nrows=nullptr);  // if given, set to the input rows
+
+// as processArrow, for each row group of a parquet file that its min/max
+// stats cannot rule out, reading only the needed col chunks from file.
+// nrows counts the rows of the row groups read.
+int processParquet(
+        std::vector<std::shared_ptr<arrow::Table>>& tables,
+        schema_vec& tbl_schema,
+        schema_vec& query_schema,
+        predicate_vec& preds,
+        const std::shared_ptr<arrow::io::RandomAccessFile>& file,
+        std::string& errmsg,
+        uint64_t& nrows,
+        int& rgs_skipped);
+
+// columnar predicate evaluation into a selection vector (1 byte per row)
+int applyPredicatesArrow(
+        predicate_vec& pv,
+        std::shared_ptr<arrow::Table>& table,
+        int num_cols,
+        std::vector<uint8_t>& sel,
+        std::string& errmsg);
+
+// compact a column to the rows selected in sel
+int takeArrowColumn(
+        const std::shared_ptr<arrow::Column>& col,
+        const std::vector<uint8_t>& sel,
+        std::shared_ptr<arrow::Array>* out);
 
 inline
 bool applyPredicates(predicate_vec& pv, sky_rec& rec);
 
+// A predicate compiled once per query into a type-specialized evaluator,
+// so per-row evaluation needs no dynamic_cast or switch on col/op type.
+struct compiled_pred;
+typedef bool (*pred_eval_fn)(const compiled_pred&,
+                             const flexbuffers::Vector&,
+                             const int64_t);
+typedef void (*pred_agg_fn)(const compiled_pred&,
+                            const flexbuffers::Vector&,
+                            const int64_t);
+struct compiled_pred {
+    PredicateBase* pb;
+    int col_idx;
+    int chain_optype;
+    bool is_agg;
+    int64_t ival;    // pred val widened per col type, as used by compare()
+    uint64_t uval;
+    double dval;
+    pred_eval_fn eval;
+    pred_agg_fn agg;
+};
+typedef std::vector<compiled_pred> pred_plan;
+
+// rows are evaluated in blocks of this size against each predicate in turn
+const int PRED_EVAL_BLOCK_SIZE = 1024;
+
+pred_plan compilePredicates(predicate_vec& pv);
+
+// evaluate the plan over a block of rows, setting pass[i] for each row
+void applyPredicatesBlock(
+        const pred_plan& plan,
+        const std::vector<flexbuffers::Vector>& rows,
+        const std::vector<int64_t>& rids,
+        std::vector<uint8_t>& pass);
+
+// GROUP BY: partial aggregates are kept per group in a hash table keyed by
+// the group col vals.  each agg accumulates in the widened type of its col
+// (int64, uint64 or double), avg is kept as sum and cnt.
+struct agg_val {
+    int64_t i;
+    uint64_t u;
+    double d;
+    std::string s;
+};
+
+struct agg_state {
+    agg_val val;    // min/max/sum, or the sum of an avg
+    uint64_t cnt;   // rows accumulated, also the cnt of an avg
+};
+
+struct agg_group {
+    std::vector<agg_val> keys;  // group col vals
+    std::vector<agg_state> aggs;  // one per agg pred, in pred order
+};
+typedef std::unordered_map<std::string, agg_group> agg_groups;
+
+bool useGroupBy(schema_vec& groupby_schema, predicate_vec& preds);
+schema_vec groupbyPartialSchema(
+        schema_vec& tbl_schema,
+        schema_vec& groupby_schema,
+        predicate_vec& preds);
+schema_vec groupbyFinalSchema(
+        schema_vec& tbl_schema,
+        schema_vec& groupby_schema,
+        predicate_vec& preds);
+int groupbyAccumulate(
+        schema_vec& tbl_schema,
+        predicate_vec& preds,
+        schema_vec& groupby_schema,
+        const char* fb,
+        const size_t fb_size,
+        std::string& errmsg,
+        const std::vector<uint32_t>& row_nums,
+        agg_groups& groups);
+int groupbyMerge(
+        schema_vec& groupby_schema,
+        predicate_vec& preds,
+        const char* fb,
+        const size_t fb_size,
+        std::string& errmsg,
+        agg_groups& groups);
+void groupbyBuildFb(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        schema_vec& tbl_schema,
+        schema_vec& groupby_schema,
+        predicate_vec& preds,
+        agg_groups& groups,
+        bool final,
+        std::string db_schema,
+        std::string table_name);
+
+// ORDER BY col LIMIT k: the k best rows seen so far are kept in a bounded
+// heap (worst row at the front), each refers to a row of a kept row layout
+// fb.  order col vals are compared by their index key encoding (memcmp).
+struct topk_entry {
+    std::string key;  // order col val
+    uint32_t fb;      // into topk_rows.fbs
+    uint32_t row;
+};
+
+struct topk_rows {
+    size_t k;
+    int col_idx;   // order col, as in the table schema
+    int col_type;
+    bool desc;
+    std::vector<std::string> fbs;  // fbs holding at least 1 kept row
+    std::vector<topk_entry> heap;
+    std::string fb_schema;  // data schema of the last fb seen
+    int col_pos;            // order col position in its rows
+
+    topk_rows() : k(0), col_idx(0), col_type(0), desc(false), col_pos(-1) {}
+    topk_rows(size_t _k, int idx, int type, bool _desc) :
+        k(_k), col_idx(idx), col_type(type), desc(_desc), col_pos(-1) {}
+};
+
+// kept fbs are compacted into a single fb beyond this many
+const size_t TOPK_MAX_FBS = 32;
+
+int topkAccumulate(
+        topk_rows& topk,
+        const char* fb,
+        const size_t fb_size,
+        std::string& errmsg);
+void topkBuildFb(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        topk_rows& topk);
+void buildFbFromRows(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        const std::vector<const char*>& fbs,
+        std::vector<topk_entry>::const_iterator begin,
+        std::vector<topk_entry>::const_iterator end);
+
+// per fb zone maps (min/max/null count per col) used to skip fbs in scans
+void buildZoneMaps(
+        sky_root& root,
+        schema_vec& schema,
+        std::vector<col_zone>& zones);
+bool zoneMapsApplicable(predicate_vec& preds);
+bool zoneMapsMayMatch(const std::vector<col_zone>& zones, predicate_vec& preds);
+
+// per fb bloom filters over selected cols used to skip fbs for eq preds
+int buildBloomFilters(
+        sky_root& root,
+        schema_vec& bloom_schema,
+        std::vector<col_bloom>& blooms);
+bool bloomFiltersMayMatch(const std::vector<col_bloom>& blooms,
+                          predicate_vec& preds);
+
+// placement of rows into objs by the loader, see partition_info
+uint64_t jumpConsistentHash(uint64_t key, uint64_t num_buckets);
+uint64_t partitionHashKey(const std::vector<uint64_t>& key_vals);
+bool partitionTargetObj(partition_info& pi, predicate_vec& preds,
+                        uint64_t& obj_num);
+
+// col statistics (equi-depth histograms) persisted in omap by runstats
+std::string buildStatsKey(
+        std::string schema_name,
+        std::string table_name,
+        std::string colname);
+void collectStatsVals(
+        sky_root& root,
+        schema_vec& schema,
+        std::vector<std::vector<double>>& vals);
+void buildColStats(
+        std::vector<double>& vals,
+        unsigned nbins,
+        col_stats& cs);
+double estimateSelectivity(const col_stats& cs, PredicateBase* pb);
+
 inline
 bool compare(const int64_t& val1, const int64_t& val2, const int& op);
 
@@ -760,10 +1108,51 @@ std::string buildKeyPrefix(
         std::string schema_name,
         std::string table_name,
         std::vector<string> colnames=std::vector<string>());
-std::string buildKeyData(int data_type, uint64_t new_data);
 
-// used for index prefix matching during index range queries
-bool compare_keys(std::string key1, std::string key2);
+/*
+ * Index keys are binary and memcmp ordered, so omap range scans follow value
+ * order: the tag and big endian index id (see buildIndexKeyPrefix), then
+ * each key col val as encoded below, then the RID (and word pos for text
+ * indexes) if not unique.  Ints are big endian of their type width with
+ * the sign bit flipped, floats/doubles flip the sign bit (all bits if
+ * negative), dates are int32 days, strings are escaped and terminated.
+ */
+std::string buildIndexKeyPrefix(uint32_t idx_id);
+void keyEncodeUInt(std::string& key, uint64_t val, int nbytes);
+void keyEncodeInt(std::string& key, int64_t val, int nbytes);
+void keyEncodeFloat(std::string& key, float val);
+void keyEncodeDouble(std::string& key, double val);
+void keyEncodeString(std::string& key, const char* s, size_t len);
+int keyEncodeFlexVal(std::string& key,
+                     int col_type,
+                     const flexbuffers::Reference& ref);
+int keyEncodePredVal(std::string& key, PredicateBase* pb);
+bool keyHasPrefix(const std::string& key, const std::string& prefix);
+
+// the inverse of keyEncodeFlexVal, adds the val at key[pos] to the flexbuf
+// as stored in a row and advances pos past it.
+int keyDecodeFlexVal(const std::string& key,
+                     size_t& pos,
+                     int col_type,
+                     flexbuffers::Builder& flexbldr);
+
+// a key and the RID of its row, for index only plans
+typedef std::vector<std::pair<std::string, int64_t>> index_key_vec;
+
+// build a row layout fb holding the key cols of each index key, other cols
+// of the table schema are null.
+int indexKeysBuildFb(
+        flatbuffers::FlatBufferBuilder& flatbldr,
+        schema_vec& tbl_schema,
+        schema_vec& key_schema,
+        const index_key_vec& keys,
+        size_t key_prefix_len,
+        std::string db_schema,
+        std::string table_name,
+        std::string& errmsg);
+
+// add n rows to the count of a count agg pred
+void aggAddCount(PredicateBase* pb, uint64_t n);
 
 // used for matching lt/leq index predicates
 bool check_predicate_ops(predicate_vec index_preds, int opType);
@@ -792,6 +1181,13 @@ int compress_arrow_tables(std::vector<std::shared_ptr<arrow::Table>> &table_vec,
 int split_arrow_table(std::shared_ptr<arrow::Table> &table, int max_rows,
                       std::vector<std::shared_ptr<arrow::Table>>* table_vec);
 
+/* Apache Parquet related functions */
+int convert_arrow_to_parquet(std::vector<std::shared_ptr<arrow::Table>>& table_vec,
+                             std::shared_ptr<arrow::Buffer>* buffer);
+int extract_arrow_from_parquet(std::shared_ptr<arrow::Table>* table,
+                               const std::shared_ptr<arrow::Buffer>& buffer);
+bool isParquet(const char* data, size_t len);
+
 
 
 
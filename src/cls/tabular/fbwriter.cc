@@ -11,12 +11,18 @@
 /*
  * The program starts in the main function. The function takes in a data file, 
  * schema file, number of objects (aka buckets), number of rows till object 
- * flushes, and total number of rows to be read. The main function then enters 
- * a while loop till the specified number of lines are read from the data file. 
- * In the while loop, each data row is parsed, processed, and hashed into a 
- * bucket. If the number of rows till the bucket flushes is reached or all the 
- * data rows have been read, then the contents of the bucket are "finished", 
- * writen to disk, and the bucket is deleted. 
+ * flushes, and total number of rows to be read. The main function then reads
+ * the specified number of lines from the data file in chunks, which are
+ * handed to a pool of worker threads.  Each worker parses, processes, and
+ * hashes the rows of a chunk into its own buckets.  If the number of rows
+ * till the bucket flushes is reached or all the data rows have been read,
+ * then the contents of the bucket are "finished" into an fb, written to disk
+ * or appended to its object in the pool, and the bucket is deleted.
+ *
+ * When writing to a pool (-P), finished fbs are streamed to their objects
+ * with at most -q writes in flight.  The first fb of an object replaces it,
+ * later fbs are appended, and each write also sets the fb_seq_num (fbs in
+ * the object) and sky_format_type xattrs in the same op.
 */
 
 #include <fcntl.h>     // system call open
@@ -24,8 +30,13 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <unistd.h>    // for getOpt
 #include <limits.h>
+#include "include/rados/librados.hpp"
 //#include "skyhookv2_generated.h"
 
 #include "cls_tabular_utils.h"
@@ -37,6 +48,15 @@ const uint8_t SKYHOOK_VERSION = 1;
 const uint8_t SCHEMA_VERSION = 1;
 string SCHEMA = "";
 uint64_t RID = 1;
+bool COLUMNAR = false;	// write the columnar flatbuf layout (SFT_FLATBUF_UNION_COL)
+bool PARQUET = false;	// write a parquet file per object (SFT_PARQUET)
+string POOL = "";	// write objects directly to this pool, else to files
+bool APPEND = false;	// append fbs to existing objects, maintaining their indexes
+uint32_t NTHREADS = 1;	// parse/build worker threads
+uint32_t QDEPTH = 16;	// max object writes in flight to the pool
+const size_t CHUNK_BYTES = 4 << 20;	// input read and handed to a worker at once
+const string OBJ_PREFIX = "obj.";	// pool object names, as run-query expects
+const string TABLE_NAME = "LINEITEM";
 typedef flatbuffers::FlatBufferBuilder fbBuilder;
 typedef flatbuffers::FlatBufferBuilder* fbb;
 typedef flexbuffers::Builder flxBuilder;
@@ -52,6 +72,46 @@ typedef struct {
 	rows_vector *rowsv;
 } bucket_t;
 
+// a chunk of whole input rows, its first row gets RID rid
+typedef struct {
+	uint64_t rid;
+	uint32_t nrows;	// non-empty rows in data
+	string data;
+} chunk_t;
+
+// a field of an input row, parsed in place within its chunk
+typedef struct {
+	const char *ptr;
+	size_t len;
+} field_t;
+
+// bounded queue of chunks from the reader to the workers
+typedef struct {
+	std::mutex lock;
+	std::condition_variable cond;
+	std::deque<chunk_t *> chunks;
+	size_t max_chunks;
+	bool done;
+	bool failed;	// a worker hit an error, stop loading
+} chunk_queue_t;
+
+// streams finished objects to the pool, see writeToCeph()
+typedef struct {
+	librados::IoCtx *ioctx;
+	int format_type;
+	std::mutex lock;
+	std::condition_variable cond;
+	uint32_t inflight;
+	int err;
+	map<uint64_t, unsigned int> nfbs;	// fbs written so far per object
+} obj_writer_t;
+
+typedef struct {
+	obj_writer_t *writer;
+	librados::AioCompletion *c;
+	uint64_t oid;
+} obj_write_t;
+
 //----------------- check inputs ------------------
 std::vector<std::string> split(const std::string &s, char delim);
 void promptDataFile(ifstream&, string&);
@@ -59,21 +119,31 @@ uint32_t promptIntVariable(string, string);
 void helpMenu();
 //-------------------------------------------------
 Tables::schema_vec getSchema(vector<int>&, string&);
-uint64_t getNextRID();
-vector<string> getNextRow(ifstream& inFile);
-void getFlxBuffer(flexbuffers::Builder *, vector<string>, Tables::schema_vec, vector<uint64_t> *);
-uint64_t hashCompositeKey(vector<int>, vector<string>);
-uint64_t jumpConsistentHash(uint64_t, uint64_t);
+bool pushChunk(chunk_queue_t *, chunk_t *);
+chunk_t *popChunk(chunk_queue_t *);
+void finishChunks(chunk_queue_t *);
+void failChunks(chunk_queue_t *);
+bool chunksFailed(chunk_queue_t *);
+void loadRows(chunk_queue_t *, vector<int>, Tables::schema_vec, uint64_t, uint32_t, obj_writer_t *);
+uint32_t countRows(string&, uint32_t);
+bool nextRow(const char *&, const char *, field_t&);
+void splitFields(const field_t&, vector<field_t>&);
+bool getFlxBuffer(flexbuffers::Builder *, const vector<field_t>&, Tables::schema_vec&, vector<uint64_t> *);
+uint64_t hashCompositeKey(const vector<int>&, const vector<field_t>&);
 bucket_t *retrieveBucketFromOID(map<uint64_t, bucket_t *> &, uint64_t);
-void insertRowIntoBucket(fbb, uint64_t, vector<uint64_t> *, vector<uint8_t>, delete_vector *, rows_vector *);
+void insertRowIntoBucket(fbb, uint64_t, vector<uint64_t> *, const vector<uint8_t>&, delete_vector *, rows_vector *);
 //------------- Finishing flatbuffer --------------
-void flushFlatBuffer(uint8_t skyhook_v, uint8_t schema_v, bucket_t *bucketPtr, string schema, uint64_t numOfObjs);
+int flushFlatBuffer(uint8_t skyhook_v, uint8_t schema_v, bucket_t *bucketPtr, string schema, uint64_t numOfObjs, obj_writer_t *writer);
 void finishFlatBuffer(fbb, uint8_t, uint8_t, string, string, delete_vector *, rows_vector *, uint32_t);
+int buildObjectBl(bucket_t*, bufferlist&);
 int writeToDisk(uint64_t, uint8_t, bucket_t*, uint64_t);
+int writeToCeph(uint64_t, bucket_t*, obj_writer_t*);
+void objectWritten(librados::completion_t, void *);
+int drainWrites(obj_writer_t *);
+int writePartitionInfo(librados::IoCtx&, const vector<int>&, Tables::schema_vec&, uint64_t);
 void deleteBucket(bucket_t *bucketPtr, fbb fbPtr, delete_vector *deletePtr, rows_vector *rowsPtr);
 //-------------------------------------------------
-vector<uint8_t> initializeFlexBuffer(vector<string> parsedRow, Tables::schema_vec schema,vector<uint64_t> *nullbits);
-bucket_t *GetAndInitializeBucket(map<uint64_t, bucket_t *> &FBmap,uint64_t oid,vector<uint64_t> *nullbits,vector<uint8_t> flxPtr);
+bucket_t *GetAndInitializeBucket(map<uint64_t, bucket_t *> &FBmap,uint64_t oid,uint64_t RID,vector<uint64_t> *nullbits,const vector<uint8_t>& flxPtr);
 
 int main(int argc, char *argv[])
 {
@@ -87,7 +157,7 @@ int main(int argc, char *argv[])
 	uint32_t read_rows = UINT_MAX;
 // -------------- Verify Configurable Variables or Prompt For Them ---------------
 	int opt;
-	while( (opt = getopt(argc, argv, "hf:s:o:r:n:i:")) != -1) {
+	while( (opt = getopt(argc, argv, "hcpaf:s:o:r:n:i:P:t:q:")) != -1) {
 		switch(opt) {
 			case 'f':
 				// Open .csv file
@@ -115,6 +185,24 @@ int main(int argc, char *argv[])
 				// Set # of Total Rows to Read
 				read_rows = promptIntVariable("rows to read", optarg);
 				break;
+			case 'c':
+				COLUMNAR = true;
+				break;
+			case 'p':
+				PARQUET = true;
+				break;
+			case 'P':
+				POOL = optarg;
+				break;
+			case 'a':
+				APPEND = true;
+				break;
+			case 't':
+				NTHREADS = std::max(1u, promptIntVariable("worker threads", optarg));
+				break;
+			case 'q':
+				QDEPTH = std::max(1u, promptIntVariable("writes in flight", optarg));
+				break;
 			case 'h':
 				helpMenu();
 				exit(0);
@@ -123,64 +211,222 @@ int main(int argc, char *argv[])
 				std::cout<<"Opt "<<opt<<" not valid"<<endl;
 		}
 	}
-// ----------- Read Rows and Load into Corresponding FlatBuffer -----------
-	map<uint64_t, bucket_t *> FBmap;
-	bucket_t *bucketPtr;
-	
-	uint32_t rows_loaded_into_fb = 0;
-	vector<string> parsedRow = getNextRow(inFile);
-	
-	while( (rows_loaded_into_fb < read_rows) && (!inFile.eof()) ) {
-		
-		vector<uint64_t> *nullbits = new vector<uint64_t>(2,0);
-		
-		// --------- Get Row and Load into FlexBuffer ---------
-		vector<uint8_t> flxPtr = initializeFlexBuffer(parsedRow,schema,nullbits);
-		
-		// --------- Hash Composite Key ----------
-		uint64_t hashKey = hashCompositeKey(composite_key_indexes, parsedRow);
-
-		// --------- Get Oid Using HashKey ----------
- 		uint64_t oid = jumpConsistentHash(hashKey, num_objs);
-		
-		// --------- Get FB and insert ----------
-		printf("Inserting Row %d into Bucket %ld\n", rows_loaded_into_fb, oid);
-
-		bucketPtr = GetAndInitializeBucket(FBmap,oid,nullbits,flxPtr);
-
-		rows_loaded_into_fb++;
-		delete nullbits;
-
-		// ----------- Flush if rows_flush was met -----------
-		if( bucketPtr->rowsv->size() >= flush_rows) {
-			printf("\tFlushing bucket %ld to Ceph with %d rows\n", oid, bucketPtr->nrows);
-			// Flush FlatBuffer to Ceph (currently writes to a file on disk)
-			flushFlatBuffer(SKYHOOK_VERSION, SCHEMA_VERSION, bucketPtr, SCHEMA, num_objs);
-			FBmap.erase(oid);
+	// a parquet object is written by a single flush, so all of its rows must
+	// be in a single bucket, i.e., one worker and no flush row limit
+	if (PARQUET && (NTHREADS > 1 || flush_rows != UINT_MAX || APPEND)) {
+		cerr << "ERROR: -p requires -t 1 and cannot be used with -r or -a" << endl;
+		return 1;
+	}
+// ----------- Connect to the pool, if writing objects directly -----------
+	librados::Rados cluster;
+	librados::IoCtx ioctx;
+	obj_writer_t *writer = NULL;
+	if (!POOL.empty()) {
+		cluster.init(NULL);
+		cluster.conf_read_file(NULL);
+		int ret = cluster.connect();
+		if (ret == 0)
+			ret = cluster.ioctx_create(POOL.c_str(), ioctx);
+		if (ret < 0) {
+			cerr << "ERROR: connecting to pool " << POOL << ": " << ret << endl;
+			return 1;
 		}
-		// Get next row
-		parsedRow = getNextRow(inFile);
+		writer = new obj_writer_t();
+		writer->ioctx = &ioctx;
+		writer->format_type = PARQUET ? SFT_PARQUET :
+				      COLUMNAR ? SFT_FLATBUF_UNION_COL :
+						 SFT_FLATBUF_FLEX_ROW;
+		writer->inflight = 0;
+		writer->err = 0;
 	}
 
-// ------------- Iterate over map and flush each bucket --------------
-	printf("\nFlush the remaining buckets in map\n");
+// ----------- Read Rows in Chunks and Load them on the Workers -----------
+	chunk_queue_t *chunks = new chunk_queue_t();
+	chunks->max_chunks = 2 * NTHREADS;
+	chunks->done = false;
+	chunks->failed = false;
 
-	for (auto& x: FBmap) {
-		bucket_t *b = x.second;
-                printf("\tFlushing bucket %ld to Ceph with %d rows\n", b->oid, b->nrows);
+	vector<thread> workers;
+	for (uint32_t i = 0; i < NTHREADS; i++)
+		workers.push_back(thread(loadRows, chunks, composite_key_indexes,
+					 schema, num_objs, flush_rows, writer));
+
+	// read the input a block at a time, the partial last row of a block is
+	// carried over into the next chunk.
+	uint32_t rows_read = 0;
+	string carry;
+	vector<char> block(CHUNK_BYTES);
+	while (rows_read < read_rows) {
+		inFile.read(&block[0], block.size());
+		size_t n = inFile.gcount();
+		bool eof = n < block.size();
 
-		flushFlatBuffer(SKYHOOK_VERSION, SCHEMA_VERSION, b, SCHEMA, num_objs);
+		chunk_t *chunk = new chunk_t();
+		chunk->rid = RID + rows_read;	// RIDs follow the input order
+		chunk->data.swap(carry);
+		chunk->data.append(&block[0], n);
+		if (!eof) {
+			size_t last = chunk->data.rfind('\n');
+			size_t keep = (last == string::npos) ? 0 : last + 1;
+			carry.assign(chunk->data, keep, string::npos);
+			chunk->data.resize(keep);
+		}
+		chunk->nrows = countRows(chunk->data, read_rows - rows_read);
+		rows_read += chunk->nrows;
+		if (chunk->nrows == 0)
+			delete chunk;
+		else if (!pushChunk(chunks, chunk)) {
+			delete chunk;	// a worker failed, stop reading
+			break;
+		}
+		if (eof)
+			break;
 	}
+	finishChunks(chunks);
+
+	// each worker flushes its remaining buckets once the input is done
+	for (auto& t : workers)
+		t.join();
+	int ret = chunks->failed ? -EINVAL : 0;
+	for (auto c : chunks->chunks)
+		delete c;
+	delete chunks;
+
+	// wait for the writes in flight even after an error, the partition
+	// info is only written for a complete load
+	if (writer) {
+		int r = drainWrites(writer);
+		if (ret == 0)
+			ret = r;
+		if (ret == 0)
+			ret = writePartitionInfo(ioctx, composite_key_indexes, schema, num_objs);
+		delete writer;
+		ioctx.close();
+		cluster.shutdown();
+	}
+
+	if (ret == 0)
+		printf("Done flushing all the objects, %u rows\n", rows_read);
 
-	FBmap.clear();
-        
-        printf("Done flushing all the objects\n");
-        
 	// Close .csv file
 	if( inFile.is_open() )
 		inFile.close();
 
-	return 0;
+	return ret < 0 ? 1 : 0;
+}
+
+// queue a chunk for the workers, false if a worker has failed
+bool pushChunk(chunk_queue_t *q, chunk_t *chunk) {
+	std::unique_lock<std::mutex> l(q->lock);
+	while (q->chunks.size() >= q->max_chunks && !q->failed)
+		q->cond.wait(l);
+	if (q->failed)
+		return false;
+	q->chunks.push_back(chunk);
+	q->cond.notify_all();
+	return true;
+}
+
+// next chunk to load, NULL once the input is done or a worker has failed
+chunk_t *popChunk(chunk_queue_t *q) {
+	std::unique_lock<std::mutex> l(q->lock);
+	while (q->chunks.empty() && !q->done && !q->failed)
+		q->cond.wait(l);
+	if (q->chunks.empty() || q->failed)
+		return NULL;
+	chunk_t *chunk = q->chunks.front();
+	q->chunks.pop_front();
+	q->cond.notify_all();
+	return chunk;
+}
+
+void finishChunks(chunk_queue_t *q) {
+	std::lock_guard<std::mutex> l(q->lock);
+	q->done = true;
+	q->cond.notify_all();
+}
+
+// stop the reader and all workers, the error was already reported
+void failChunks(chunk_queue_t *q) {
+	std::lock_guard<std::mutex> l(q->lock);
+	q->failed = true;
+	q->cond.notify_all();
+}
+
+bool chunksFailed(chunk_queue_t *q) {
+	std::lock_guard<std::mutex> l(q->lock);
+	return q->failed;
+}
+
+// worker: parse and load the rows of each chunk into this worker's own
+// buckets, so builders are never shared, flushing full buckets as they go.
+// on a bad row or failed flush all workers stop, without exiting while
+// writes are in flight, and unflushed buckets are dropped.
+void loadRows(chunk_queue_t *chunks, vector<int> composite_key_indexes, Tables::schema_vec schema, uint64_t num_objs, uint32_t flush_rows, obj_writer_t *writer) {
+	map<uint64_t, bucket_t *> FBmap;
+	flxBuilder flx;
+	vector<field_t> fields;
+	vector<uint64_t> nullbits(2,0);
+	int col_idx_max = -1;
+	for (auto& col : schema)
+		col_idx_max = std::max(col_idx_max, col.idx);
+	size_t min_fields = std::max<size_t>(col_idx_max + 1, schema.size());
+
+	bool ok = true;
+	chunk_t *chunk;
+	while( ok && (chunk = popChunk(chunks)) != NULL ) {
+		uint64_t rid = chunk->rid;
+		const char *pos = chunk->data.data();
+		const char *end = pos + chunk->data.size();
+		field_t row;
+		while (ok && nextRow(pos, end, row)) {
+			splitFields(row, fields);
+			if (fields.size() < min_fields) {
+				cerr << "ERROR: row " << rid << " has " << fields.size()
+				     << " fields, the schema needs " << min_fields << endl;
+				ok = false;
+				break;
+			}
+
+			// --------- Get Row and Load into FlexBuffer ---------
+			nullbits[0] = nullbits[1] = 0;
+			flx.Clear();
+			if (!getFlxBuffer(&flx, fields, schema, &nullbits)) {
+				ok = false;
+				break;
+			}
+
+			// --------- Hash Composite Key and Get Oid ----------
+			uint64_t hashKey = hashCompositeKey(composite_key_indexes, fields);
+			uint64_t oid = Tables::jumpConsistentHash(hashKey, num_objs);
+
+			// --------- Get FB and insert ----------
+			bucket_t *bucketPtr = GetAndInitializeBucket(FBmap,oid,rid++,&nullbits,flx.GetBuffer());
+
+			// ----------- Flush if rows_flush was met -----------
+			if( bucketPtr->rowsv->size() >= flush_rows) {
+				ok = flushFlatBuffer(SKYHOOK_VERSION, SCHEMA_VERSION, bucketPtr, SCHEMA, num_objs, writer) == 0;
+				FBmap.erase(oid);
+			}
+		}
+		delete chunk;
+	}
+	if (!ok)
+		failChunks(chunks);
+	else
+		ok = !chunksFailed(chunks);
+
+	// ------------- Iterate over map and flush each bucket --------------
+	for (auto& x: FBmap) {
+		bucket_t *b = x.second;
+		if (ok)
+			ok = flushFlatBuffer(SKYHOOK_VERSION, SCHEMA_VERSION, b, SCHEMA, num_objs, writer) == 0;
+		else
+			deleteBucket(b, b->fb, b->deletev, b->rowsv);
+	}
+	FBmap.clear();
+	if (!ok)
+		failChunks(chunks);
 }
 
 std::vector<std::string> split(const std::string &s, char delim) {
@@ -201,6 +447,12 @@ void helpMenu() {
 	printf("\t-r [number_of_rows_until_flush]\n");
 	printf("\t-i [rid_start_value]\n");
 	printf("\t-n [number_of_rows_to_read]\n");
+	printf("\t-P [pool_name] (write objects directly to the pool)\n");
+	printf("\t-t [number_of_worker_threads]\n");
+	printf("\t-q [max_object_writes_in_flight]\n");
+	printf("\t-c (write columnar flatbuffer layout)\n");
+	printf("\t-p (write parquet format, one flush per object: requires -t 1, no -r and no -a)\n");
+	printf("\t-a (append to existing objects in the pool, updating their indexes)\n");
 }
 
 void promptDataFile(ifstream& inFile, string& file_name) {
@@ -234,14 +486,6 @@ uint32_t promptIntVariable(string variable, string num_string) {
 	return n;
 }
 
-vector<string> getNextRow(ifstream& inFile) {
-        // Get a row
-        string row;
-        getline(inFile, row);
-        // Split by '|' deliminator
-        return split(row, '|');
-}
-
 Tables::schema_vec getSchema(vector<int>& compositeKey, string& schema_file_name) {
 	ifstream schemaFile;
 
@@ -290,27 +534,91 @@ Tables::schema_vec getSchema(vector<int>& compositeKey, string& schema_file_name
 
 }
 
-vector<uint8_t> initializeFlexBuffer(vector<string> parsedRow, Tables::schema_vec schema,vector<uint64_t> *nullbits){
-	flexbuffers::Builder *flx = new flexbuffers::Builder();
-	getFlxBuffer(flx, parsedRow, schema, nullbits); // load parsed row into our flxBuilder and update nullbits
-	vector<uint8_t> flxPtr = flx->GetBuffer();      // get pointer to FlexBuffer
-	delete flx;
-	return flxPtr;
+// count the non-empty rows of a chunk, dropping any rows beyond max_rows
+uint32_t countRows(string& data, uint32_t max_rows) {
+	const char *pos = data.data();
+	const char *end = pos + data.size();
+	field_t row;
+	uint32_t nrows = 0;
+	while (nrows < max_rows && nextRow(pos, end, row))
+		nrows++;
+	data.resize(pos - data.data());
+	return nrows;
 }
 
+/*
+ * Set row to the next non-empty row at or after pos, and advance pos past
+ * it.  Delimiters are located with memchr, which libc implements with
+ * vector instructions, rather than a char at a time.
+ */
+bool nextRow(const char *&pos, const char *end, field_t& row) {
+	while (pos < end) {
+		const char *nl = static_cast<const char *>(memchr(pos, '\n', end - pos));
+		if (!nl)
+			nl = end;
+		row.ptr = pos;
+		row.len = nl - pos;
+		pos = (nl < end) ? nl + 1 : end;
+		if (row.len > 0 && row.ptr[row.len - 1] == '\r')
+			row.len--;
+		if (row.len > 0)
+			return true;
+	}
+	return false;
+}
+
+// split a row on '|' in place, the trailing '|' of tbl rows adds no field
+void splitFields(const field_t& row, vector<field_t>& fields) {
+	fields.clear();
+	const char *pos = row.ptr;
+	const char *end = row.ptr + row.len;
+	while (pos < end) {
+		const char *d = static_cast<const char *>(memchr(pos, '|', end - pos));
+		if (!d)
+			d = end;
+		field_t f = {pos, static_cast<size_t>(d - pos)};
+		fields.push_back(f);
+		pos = d + 1;
+	}
+}
+
+static inline bool isNullField(const field_t& f) {
+	return f.len == 4 && memcmp(f.ptr, "NULL", 4) == 0;
+}
+
+// fields are parsed in place by the Tables parsers, false if not a valid
+// value of the type
+static inline bool parseUInt(const field_t& f, uint64_t& v, uint64_t max = UINT64_MAX) {
+	return Tables::parseUInt(f.ptr, f.len, v, max);
+}
+
+static inline bool parseInt(const field_t& f, int64_t& v, int64_t min = INT64_MIN, int64_t max = INT64_MAX) {
+	return Tables::parseInt(f.ptr, f.len, v, min, max);
+}
+
+// fields end at a delimiter or newline, which also ends strtod
+static inline bool parseDouble(const field_t& f, double& v) {
+	return Tables::parseDouble(f.ptr, f.len, v);
+}
+
+static inline bool parseDate(const field_t& f, int32_t& v) {
+	return Tables::parseDate(f.ptr, f.len, v);
+}
+
+static bool parseBool(const field_t& f) {
+	return f.len > 0 && strchr("1tTyY", f.ptr[0]) != NULL;
+}
 
-void getFlxBuffer(flxBuilder *flx, vector<string> parsedRow, Tables::schema_vec schema, vector<uint64_t> *nullbits) {
-	bool nullFlag = false;
-	string nullcmp = "NULL";
+// build the flexbuf of a row straight from its fields, by col type,
+// false if a field is not a valid value of its col type
+bool getFlxBuffer(flxBuilder *flx, const vector<field_t>& fields, Tables::schema_vec& schema, vector<uint64_t> *nullbits) {
+	bool valid = true;
 
 	// Create Flexbuffer from Parsed Row and Schema
 	flx->Vector([&]() {
 		for(int i=0;i<(int)schema.size();i++) { 
-			Tables::col_info col = schema[i];
-			nullFlag = false;
-			if(strcmp(parsedRow[i].c_str(), nullcmp.c_str() ) == 0)
-				nullFlag = true;
-			if(nullFlag) {
+			const Tables::col_info& col = schema[i];
+			if(isNullField(fields[i])) {
 				// Mark nullbit
 				uint64_t nullMask = 0x00;
 				if(i<64) {
@@ -321,7 +629,6 @@ void getFlxBuffer(flxBuilder *flx, vector<string> parsedRow, Tables::schema_vec
 					nullMask = 1lu << (63- (i-64));
 					nullbits[0][1] |= nullMask;
 				}
-				printf("NULL CASE SWITCHES \n");
 				// Put a dummy variable to hold the index for future updates
 				switch(col.type) {
 					case Tables::SDT_INT8: {
@@ -377,7 +684,7 @@ void getFlxBuffer(flxBuilder *flx, vector<string> parsedRow, Tables::schema_vec
 						break;
 					}
 					case Tables::SDT_DATE: {
-                                                flx->Add("0000-00-00");
+                                                flx->Add(static_cast<int32_t>(0));
 						break;
 					}
 					case Tables::SDT_STRING: {
@@ -391,105 +698,98 @@ void getFlxBuffer(flxBuilder *flx, vector<string> parsedRow, Tables::schema_vec
 				}
 			}
 			else {
+				const field_t& f = fields[col.idx];
+				int64_t iv = 0;
+				uint64_t uv = 0;
+				double dv = 0;
+				int32_t days = 0;
+				bool ok = true;
 				switch(col.type) {
-					case Tables::SDT_INT8: {
-						flx->Add(static_cast<int8_t>(stoi(parsedRow[col.idx].c_str())));
+					case Tables::SDT_INT8:
+						ok = parseInt(f, iv, INT8_MIN, INT8_MAX);
+						flx->Add(static_cast<int8_t>(iv));
 						break;
-					}
-					case Tables::SDT_INT16: {
-						flx->Add(static_cast<int16_t>(stoi(parsedRow[col.idx].c_str())));
+					case Tables::SDT_INT16:
+						ok = parseInt(f, iv, INT16_MIN, INT16_MAX);
+						flx->Add(static_cast<int16_t>(iv));
 						break;
-					}
-					case Tables::SDT_INT32: {
-						flx->Add(static_cast<int32_t>(stoi(parsedRow[col.idx].c_str())));
+					case Tables::SDT_INT32:
+						ok = parseInt(f, iv, INT32_MIN, INT32_MAX);
+						flx->Add(static_cast<int32_t>(iv));
 						break;
-					}
-                                        case Tables::SDT_INT64:{
-                                                flx->Add(static_cast<int64_t>(stoi(parsedRow[col.idx].c_str())));
+					case Tables::SDT_INT64:
+						ok = parseInt(f, iv);
+						flx->Add(iv);
 						break;
-                                        } 
-					case Tables::SDT_UINT8: {
-                                                flx->Add(static_cast<uint8_t>(stoul(parsedRow[col.idx].c_str())));
+					case Tables::SDT_UINT8:
+						ok = parseUInt(f, uv, UINT8_MAX);
+						flx->Add(static_cast<uint8_t>(uv));
 						break;
-                                        }
-					case Tables::SDT_UINT16: {
-                                                flx->Add(static_cast<uint16_t>(stoul(parsedRow[col.idx].c_str())));
+					case Tables::SDT_UINT16:
+						ok = parseUInt(f, uv, UINT16_MAX);
+						flx->Add(static_cast<uint16_t>(uv));
 						break;
-                                        }
-					case Tables::SDT_UINT32: {
-                                                flx->Add(static_cast<uint32_t>(stoul(parsedRow[col.idx].c_str())));
+					case Tables::SDT_UINT32:
+						ok = parseUInt(f, uv, UINT32_MAX);
+						flx->Add(static_cast<uint32_t>(uv));
 						break;
-                                        }
-                                        case Tables::SDT_UINT64: {
-                                                flx->Add(static_cast<uint64_t>(stoul(parsedRow[col.idx].c_str())));
+					case Tables::SDT_UINT64:
+						ok = parseUInt(f, uv);
+						flx->Add(uv);
 						break;
-                                        }
- 					case Tables::SDT_CHAR: {
-                                                flx->Add(static_cast<char>(parsedRow[col.idx][0]));
+					case Tables::SDT_CHAR:
+						flx->Add(static_cast<char>(f.len ? f.ptr[0] : 0));
 						break;
-					}
- 					case Tables::SDT_UCHAR: {
-                                                flx->Add(static_cast<unsigned char>(parsedRow[col.idx][0]));
+					case Tables::SDT_UCHAR:
+						flx->Add(static_cast<unsigned char>(f.len ? f.ptr[0] : 0));
 						break;
-					}
-					case Tables::SDT_BOOL: {
-                                                flx->Add(static_cast<bool>(parsedRow[col.idx].c_str()));
+					case Tables::SDT_BOOL:
+						flx->Add(parseBool(f));
 						break;
-					}
-					case Tables::SDT_FLOAT: {
-                                                flx->Add(static_cast<float>(stof(parsedRow[col.idx].c_str())));
+					case Tables::SDT_FLOAT:
+						ok = parseDouble(f, dv);
+						flx->Add(static_cast<float>(dv));
 						break;
-					}
-					case Tables::SDT_DOUBLE: {
-                                                flx->Add(static_cast<double>(stod(parsedRow[col.idx].c_str())));
+					case Tables::SDT_DOUBLE:
+						ok = parseDouble(f, dv);
+						flx->Add(dv);
 						break;
-					}
-					case Tables::SDT_DATE: {
-                                                flx->Add(parsedRow[col.idx].c_str());
+					case Tables::SDT_DATE:  // stored as date32 days
+						ok = parseDate(f, days);
+						flx->Add(days);
 						break;
-					}
-					case Tables::SDT_STRING: {
-                                                flx->Add(parsedRow[col.idx].c_str());
+					case Tables::SDT_STRING:
+						flx->String(f.ptr, f.len);
+						break;
+					default:
+						flx->Add("EMPTY");
 						break;
-					}
-					default: {
-                                                flx->Add("EMPTY");
-                                                break;
-                                        }
+				}
+				if (!ok && valid) {
+					cerr << "ERROR: invalid value '" << string(f.ptr, f.len)
+					     << "' for col " << col.name << endl;
+					valid = false;
 				}
 			}
 		}
 	}); 
 	flx->Finish();
+	return valid;
 }
 
-uint64_t hashCompositeKey(vector<int> compositeKeyIndexes, vector<string> parsedRow) {
-	// Hash the Composite Key
-	uint64_t hashKey=0, upper=0, lower=0;
-	stringstream(parsedRow[compositeKeyIndexes[0]]) >> upper;
-	hashKey = upper << 32;
-	if( compositeKeyIndexes.size() > 1) {
-		stringstream(parsedRow[compositeKeyIndexes[1]]) >> lower;
-		hashKey = hashKey | lower;
-	}
-	return hashKey;
-}
-
-uint64_t jumpConsistentHash(uint64_t key, uint64_t num_buckets) {
-	// Source:
-	// A Fast, Minimal Memory, Consistent Hash Algorithm
-	// https://arxiv.org/ftp/arxiv/papers/1406/1406.2294.pdf
-	
-	int64_t b=-1l, j=0l;
-	while(j < (int64_t)num_buckets) {
-		b = j;
-		key = key * 286293355588894185ULL + 1;
-		j = (b+1) * (double(1LL << 31) / double((key>>33) + 1));
+uint64_t hashCompositeKey(const vector<int>& compositeKeyIndexes, const vector<field_t>& fields) {
+	// Hash the Composite Key, non-numeric key vals hash as 0
+	vector<uint64_t> key_vals;
+	for (size_t i = 0; i < compositeKeyIndexes.size() && i < Tables::PARTITION_KEY_MAX_COLS; i++) {
+		uint64_t v = 0;
+		if (!parseUInt(fields[compositeKeyIndexes[i]], v))
+			v = 0;
+		key_vals.push_back(v);
 	}
-	return b;
+	return Tables::partitionHashKey(key_vals);
 }
 
-bucket_t *GetAndInitializeBucket(map<uint64_t, bucket_t *> &FBmap,uint64_t oid,vector<uint64_t> *nullbits,vector<uint8_t> flxPtr){
+bucket_t *GetAndInitializeBucket(map<uint64_t, bucket_t *> &FBmap,uint64_t oid,uint64_t RID,vector<uint64_t> *nullbits,const vector<uint8_t>& flxPtr){
 	bucket_t *bucketPtr;
 	bucketPtr = retrieveBucketFromOID(FBmap, oid);
 
@@ -499,8 +799,6 @@ bucket_t *GetAndInitializeBucket(map<uint64_t, bucket_t *> &FBmap,uint64_t oid,v
 	deletePtr = bucketPtr->deletev;
 	rowsPtr = bucketPtr->rowsv;
 
-	uint64_t RID = getNextRID();
-
 	insertRowIntoBucket(fbPtr, RID, nullbits, flxPtr, deletePtr, rowsPtr);
 	bucketPtr->nrows++;
 	return bucketPtr;
@@ -519,7 +817,7 @@ bucket_t *retrieveBucketFromOID(map<uint64_t, bucket_t *> &FBmap, uint64_t oid)
 		bucketPtr = new bucket_t();
 		bucketPtr->oid = oid;
 		bucketPtr->nrows = 0;
-		bucketPtr->table_name = "LINEITEM";
+		bucketPtr->table_name = TABLE_NAME;
 		bucketPtr->fb = new fbBuilder();
 		bucketPtr->deletev = new delete_vector();
 		bucketPtr->rowsv = new rows_vector();
@@ -528,7 +826,7 @@ bucket_t *retrieveBucketFromOID(map<uint64_t, bucket_t *> &FBmap, uint64_t oid)
 	return bucketPtr;
 }
 
-void insertRowIntoBucket(fbb fbPtr, uint64_t RID, vector<uint64_t> *nullbits, vector<uint8_t> flxPtr, delete_vector *deletePtr, rows_vector *rowsPtr) {
+void insertRowIntoBucket(fbb fbPtr, uint64_t RID, vector<uint64_t> *nullbits, const vector<uint8_t>& flxPtr, delete_vector *deletePtr, rows_vector *rowsPtr) {
 
         // Serialize FlexBuffer row into FlatBufferBuilder
         auto flxSerial = fbPtr->CreateVector(flxPtr);
@@ -538,11 +836,7 @@ void insertRowIntoBucket(fbb fbPtr, uint64_t RID, vector<uint64_t> *nullbits, ve
         rowsPtr->push_back(rowOffset);
 }
 
-uint64_t getNextRID() {
-	return RID++;
-}
-
-void flushFlatBuffer(uint8_t skyhook_v, uint8_t schema_v, bucket_t *bucketPtr, string schema, uint64_t numOfObjs) {
+int flushFlatBuffer(uint8_t skyhook_v, uint8_t schema_v, bucket_t *bucketPtr, string schema, uint64_t numOfObjs, obj_writer_t *writer) {
         fbb fbPtr = bucketPtr->fb;
 	delete_vector *deletePtr;
         rows_vector *rowsPtr;
@@ -553,11 +847,12 @@ void flushFlatBuffer(uint8_t skyhook_v, uint8_t schema_v, bucket_t *bucketPtr, s
 	// Finish FlatBuffer
         finishFlatBuffer(fbPtr, skyhook_v, schema_v, bucketPtr->table_name, schema, deletePtr, rowsPtr, bucketPtr->nrows);
         uint64_t oid = bucketPtr->oid;
-        // Flush to Ceph Here TO OID bucket with n Rows or Crash if Failed
-        if(writeToDisk(oid, schema_v, bucketPtr, numOfObjs) < 0)
-                exit(0);
+        // Flush to Ceph Here TO OID bucket with n Rows
+        int ret = writer ? writeToCeph(oid, bucketPtr, writer) :
+                           writeToDisk(oid, schema_v, bucketPtr, numOfObjs);
         // Deallocate pointers
         deleteBucket(bucketPtr, fbPtr, deletePtr, rowsPtr);
+        return ret;
 }
 
 
@@ -579,28 +874,191 @@ void finishFlatBuffer(fbb fbPtr, uint8_t skyhook_v, uint8_t schema_v, string tab
 }
 
 
-/* TODO: instead of writing objects to disk, write directly to ceph. */
-int writeToDisk(uint64_t oid, uint8_t schema_v, bucket_t *bucketPtr, uint64_t numOfObjs) {
+/* Wrap the finished fb of a bucket in the requested format into an encoded bl. */
+int buildObjectBl(bucket_t *bucketPtr, bufferlist& wrapper_bl) {
 
-	string table_name = bucketPtr->table_name;
 	fbb fbPtr = bucketPtr->fb;
 
         int buff_size = fbPtr->GetSize();
         const char *fb_ptr_char = reinterpret_cast<char*>(fbPtr->GetBufferPointer());
         bufferlist bl;
-        bl.append(fb_ptr_char,buff_size);
-        bufferlist wrapper_bl;
+        if (PARQUET) {
+		// one row group per flush, with the fb's arrow schema and metadata
+		vector<shared_ptr<arrow::Table>> tables(1);
+		shared_ptr<arrow::Buffer> buffer;
+		string errmsg;
+		int ret = Tables::transform_fb_to_arrow(fb_ptr_char, buff_size, errmsg, &tables[0]);
+		if (ret == 0)
+			ret = Tables::convert_arrow_to_parquet(tables, &buffer);
+		if (ret != 0) {
+			cerr << "ERROR: writing parquet: " << errmsg << " TablesErrCodes::" << ret << endl;
+			return -1;
+		}
+		buff_size = buffer->size();
+		bl.append(reinterpret_cast<const char*>(buffer->data()), buff_size);
+	}
+	else if (COLUMNAR) {
+		// transpose the finished row layout into the columnar layout
+		fbBuilder colBuilder(1024);
+		string errmsg;
+		int ret = Tables::transform_fb_to_col(fb_ptr_char, buff_size, errmsg, colBuilder);
+		if (ret != 0) {
+			cerr << errmsg << endl;
+			return -1;
+		}
+		buff_size = colBuilder.GetSize();
+		bl.append(reinterpret_cast<char*>(colBuilder.GetBufferPointer()), buff_size);
+	}
+	else
+		bl.append(fb_ptr_char,buff_size);
         ::encode(bl, wrapper_bl);
+	return 0;
+}
+
+int writeToDisk(uint64_t oid, uint8_t schema_v, bucket_t *bucketPtr, uint64_t numOfObjs) {
+
+	static std::mutex disk_lock;	// workers flush concurrently
+	static map<uint64_t, unsigned int> disk_nfbs;	// fbs written so far per file
+	string table_name = bucketPtr->table_name;
+        bufferlist wrapper_bl;
+	if (buildObjectBl(bucketPtr, wrapper_bl) < 0)
+		return -1;
+
+	std::lock_guard<std::mutex> l(disk_lock);
+	unsigned int nfbs = ++disk_nfbs[oid];
+	if (PARQUET && nfbs > 1) {
+		cerr << "ERROR: parquet object " << oid << " needs a single flush, "
+		     << "raise -r or use 1 worker thread" << endl;
+		return -EINVAL;
+	}
         int mode = 0600;
         string fname = "Skyhook.v2."+ table_name + "." + to_string(oid) + ".1-" + to_string(numOfObjs);
-        wrapper_bl.write_file(fname.c_str(), mode);
-	printf("buff size: %d, bl size: %d, wrapper_bl size: %d\n", buff_size, bl.length(), wrapper_bl.length());
-	
-        return 0;
+	// the first flush of an oid replaces its file, later flushes from any
+	// worker are appended, as with the objects in a pool
+	int flags = O_WRONLY | O_CREAT | (nfbs == 1 ? O_TRUNC : O_APPEND);
+	int fd = ::open(fname.c_str(), flags, mode);
+	if (fd < 0) {
+		int ret = -errno;
+		cerr << "ERROR: opening " << fname << ": " << ret << endl;
+		return ret;
+	}
+	int ret = wrapper_bl.write_fd(fd);
+	::close(fd);
+	if (ret < 0)
+		cerr << "ERROR: writing " << fname << ": " << ret << endl;
+        return ret;
+}
+
+/*
+ * Stream a finished bucket to its object in the pool, waiting while QDEPTH
+ * writes are in flight.  Submissions are serialized so that the writes of an
+ * object, and its fb_seq_num, follow the order of its fbs.
+ */
+int writeToCeph(uint64_t oid, bucket_t *bucketPtr, obj_writer_t *writer) {
+
+	bufferlist wrapper_bl;
+	if (buildObjectBl(bucketPtr, wrapper_bl) < 0)
+		return -1;
+
+	std::unique_lock<std::mutex> l(writer->lock);
+	while (writer->inflight >= QDEPTH && writer->err == 0)
+		writer->cond.wait(l);
+	if (writer->err < 0)
+		return writer->err;
+
+	unsigned int nfbs = ++writer->nfbs[oid];
+	if (PARQUET && APPEND) {
+		cerr << "ERROR: parquet objects cannot be appended to" << endl;
+		return -EINVAL;
+	}
+	if (PARQUET && nfbs > 1) {
+		cerr << "ERROR: parquet object " << oid << " needs a single flush, "
+		     << "raise -r or use 1 worker thread" << endl;
+		return -EINVAL;
+	}
+	bufferlist seq_bl, format_bl;
+	::encode(nfbs, seq_bl);
+	::encode(writer->format_type, format_bl);
+
+	// appends go through the tabular cls, which adds the fb's entries to
+	// any indexes of the object
+	librados::ObjectWriteOperation op;
+	if (APPEND)
+		op.exec("tabular", "append_fb", wrapper_bl);
+	else {
+		if (nfbs == 1)
+			op.write_full(wrapper_bl);
+		else
+			op.append(wrapper_bl);
+		op.setxattr("fb_seq_num", seq_bl);
+		op.setxattr("sky_format_type", format_bl);
+	}
+
+	obj_write_t *w = new obj_write_t();
+	w->writer = writer;
+	w->oid = oid;
+	w->c = librados::Rados::aio_create_completion(w, NULL, objectWritten);
+	int ret = writer->ioctx->aio_operate(OBJ_PREFIX + to_string(oid), w->c, &op);
+	if (ret < 0) {
+		cerr << "ERROR: writing object " << oid << ": " << ret << endl;
+		w->c->release();
+		delete w;
+		return ret;
+	}
+	writer->inflight++;
+	return 0;
+}
+
+/*
+ * Record how the rows were placed into the objects, so that clients can
+ * target only the object holding the rows of a given key.
+ */
+int writePartitionInfo(librados::IoCtx& ioctx, const vector<int>& compositeKeyIndexes, Tables::schema_vec& schema, uint64_t num_objs) {
+	if (compositeKeyIndexes.empty())
+		return 0;
+
+	Tables::schema_vec key_schema;
+	for (size_t i = 0; i < compositeKeyIndexes.size() && i < Tables::PARTITION_KEY_MAX_COLS; i++) {
+		for (auto it = schema.begin(); it != schema.end(); ++it) {
+			if (it->idx == compositeKeyIndexes[i])
+				key_schema.push_back(*it);
+		}
+	}
+	partition_info pi(SPT_JUMP_HASH_KEY, TABLE_NAME, Tables::schemaToString(key_schema), num_objs, OBJ_PREFIX);
+	bufferlist bl;
+	::encode(pi, bl);
+	int ret = ioctx.write_full(Tables::PARTITION_OID_PREFIX + TABLE_NAME, bl);
+	if (ret < 0)
+		cerr << "ERROR: writing partition info: " << ret << endl;
+	return ret;
+}
+
+void objectWritten(librados::completion_t cb, void *arg) {
+	obj_write_t *w = (obj_write_t *)arg;
+	obj_writer_t *writer = w->writer;
+	int ret = w->c->get_return_value();
+	w->c->release();
+	if (ret < 0)
+		cerr << "ERROR: writing object " << w->oid << ": " << ret << endl;
+	{
+		std::lock_guard<std::mutex> l(writer->lock);
+		if (ret < 0 && writer->err == 0)
+			writer->err = ret;
+		writer->inflight--;
+	}
+	writer->cond.notify_all();
+	delete w;
+}
+
+// wait for the writes in flight, returns the first write error if any
+int drainWrites(obj_writer_t *writer) {
+	std::unique_lock<std::mutex> l(writer->lock);
+	while (writer->inflight > 0)
+		writer->cond.wait(l);
+	return writer->err;
 }
 
 void deleteBucket(bucket_t *bucketPtr, fbb fbPtr, delete_vector *deletePtr, rows_vector *rowsPtr) {
-                printf("Clearing FB Ptr and RowsVector Ptr, Delete Bucket from Map\n\n");
                 fbPtr->Reset();
                 delete fbPtr;
                 deletePtr->clear();
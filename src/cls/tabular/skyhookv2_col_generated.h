@@ -0,0 +1,1221 @@
+// automatically generated by the FlatBuffers compiler, do not modify
+
+
+#ifndef FLATBUFFERS_GENERATED_SKYHOOKV2COL_TABLES_H_
+#define FLATBUFFERS_GENERATED_SKYHOOKV2COL_TABLES_H_
+
+#include "flatbuffers/flatbuffers.h"
+
+namespace Tables {
+
+struct ColInt8;
+
+struct ColInt16;
+
+struct ColInt32;
+
+struct ColInt64;
+
+struct ColUInt8;
+
+struct ColUInt16;
+
+struct ColUInt32;
+
+struct ColUInt64;
+
+struct ColFloat;
+
+struct ColDouble;
+
+struct ColBool;
+
+struct ColString;
+
+struct Column;
+
+struct Table_COL;
+
+enum ColData {
+  ColData_NONE = 0,
+  ColData_ColInt8 = 1,
+  ColData_ColInt16 = 2,
+  ColData_ColInt32 = 3,
+  ColData_ColInt64 = 4,
+  ColData_ColUInt8 = 5,
+  ColData_ColUInt16 = 6,
+  ColData_ColUInt32 = 7,
+  ColData_ColUInt64 = 8,
+  ColData_ColFloat = 9,
+  ColData_ColDouble = 10,
+  ColData_ColBool = 11,
+  ColData_ColString = 12,
+  ColData_MIN = ColData_NONE,
+  ColData_MAX = ColData_ColString
+};
+
+inline const ColData (&EnumValuesColData())[13] {
+  static const ColData values[] = {
+    ColData_NONE,
+    ColData_ColInt8,
+    ColData_ColInt16,
+    ColData_ColInt32,
+    ColData_ColInt64,
+    ColData_ColUInt8,
+    ColData_ColUInt16,
+    ColData_ColUInt32,
+    ColData_ColUInt64,
+    ColData_ColFloat,
+    ColData_ColDouble,
+    ColData_ColBool,
+    ColData_ColString
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesColData() {
+  static const char * const names[] = {
+    "NONE",
+    "ColInt8",
+    "ColInt16",
+    "ColInt32",
+    "ColInt64",
+    "ColUInt8",
+    "ColUInt16",
+    "ColUInt32",
+    "ColUInt64",
+    "ColFloat",
+    "ColDouble",
+    "ColBool",
+    "ColString",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameColData(ColData e) {
+  if (e < ColData_NONE || e > ColData_ColString) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesColData()[index];
+}
+
+template<typename T> struct ColDataTraits {
+  static const ColData enum_value = ColData_NONE;
+};
+
+template<> struct ColDataTraits<ColInt8> {
+  static const ColData enum_value = ColData_ColInt8;
+};
+
+template<> struct ColDataTraits<ColInt16> {
+  static const ColData enum_value = ColData_ColInt16;
+};
+
+template<> struct ColDataTraits<ColInt32> {
+  static const ColData enum_value = ColData_ColInt32;
+};
+
+template<> struct ColDataTraits<ColInt64> {
+  static const ColData enum_value = ColData_ColInt64;
+};
+
+template<> struct ColDataTraits<ColUInt8> {
+  static const ColData enum_value = ColData_ColUInt8;
+};
+
+template<> struct ColDataTraits<ColUInt16> {
+  static const ColData enum_value = ColData_ColUInt16;
+};
+
+template<> struct ColDataTraits<ColUInt32> {
+  static const ColData enum_value = ColData_ColUInt32;
+};
+
+template<> struct ColDataTraits<ColUInt64> {
+  static const ColData enum_value = ColData_ColUInt64;
+};
+
+template<> struct ColDataTraits<ColFloat> {
+  static const ColData enum_value = ColData_ColFloat;
+};
+
+template<> struct ColDataTraits<ColDouble> {
+  static const ColData enum_value = ColData_ColDouble;
+};
+
+template<> struct ColDataTraits<ColBool> {
+  static const ColData enum_value = ColData_ColBool;
+};
+
+template<> struct ColDataTraits<ColString> {
+  static const ColData enum_value = ColData_ColString;
+};
+
+bool VerifyColData(flatbuffers::Verifier &verifier, const void *obj, ColData type);
+bool VerifyColDataVector(flatbuffers::Verifier &verifier, const flatbuffers::Vector<flatbuffers::Offset<void>> *values, const flatbuffers::Vector<uint8_t> *types);
+
+struct ColInt8 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<int8_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColInt8Builder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<int8_t>> data) {
+    fbb_.AddOffset(ColInt8::VT_DATA, data);
+  }
+  explicit ColInt8Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColInt8Builder &operator=(const ColInt8Builder &);
+  flatbuffers::Offset<ColInt8> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColInt8>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColInt8> CreateColInt8(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> data = 0) {
+  ColInt8Builder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColInt8> CreateColInt8Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<int8_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<int8_t>(*data) : 0;
+  return Tables::CreateColInt8(
+      _fbb,
+      data__);
+}
+
+struct ColInt16 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<int16_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<int16_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColInt16Builder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<int16_t>> data) {
+    fbb_.AddOffset(ColInt16::VT_DATA, data);
+  }
+  explicit ColInt16Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColInt16Builder &operator=(const ColInt16Builder &);
+  flatbuffers::Offset<ColInt16> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColInt16>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColInt16> CreateColInt16(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<int16_t>> data = 0) {
+  ColInt16Builder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColInt16> CreateColInt16Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<int16_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<int16_t>(*data) : 0;
+  return Tables::CreateColInt16(
+      _fbb,
+      data__);
+}
+
+struct ColInt32 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<int32_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColInt32Builder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<int32_t>> data) {
+    fbb_.AddOffset(ColInt32::VT_DATA, data);
+  }
+  explicit ColInt32Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColInt32Builder &operator=(const ColInt32Builder &);
+  flatbuffers::Offset<ColInt32> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColInt32>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColInt32> CreateColInt32(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> data = 0) {
+  ColInt32Builder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColInt32> CreateColInt32Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<int32_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<int32_t>(*data) : 0;
+  return Tables::CreateColInt32(
+      _fbb,
+      data__);
+}
+
+struct ColInt64 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<int64_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<int64_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColInt64Builder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<int64_t>> data) {
+    fbb_.AddOffset(ColInt64::VT_DATA, data);
+  }
+  explicit ColInt64Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColInt64Builder &operator=(const ColInt64Builder &);
+  flatbuffers::Offset<ColInt64> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColInt64>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColInt64> CreateColInt64(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<int64_t>> data = 0) {
+  ColInt64Builder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColInt64> CreateColInt64Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<int64_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<int64_t>(*data) : 0;
+  return Tables::CreateColInt64(
+      _fbb,
+      data__);
+}
+
+struct ColUInt8 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<uint8_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColUInt8Builder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> data) {
+    fbb_.AddOffset(ColUInt8::VT_DATA, data);
+  }
+  explicit ColUInt8Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColUInt8Builder &operator=(const ColUInt8Builder &);
+  flatbuffers::Offset<ColUInt8> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColUInt8>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColUInt8> CreateColUInt8(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> data = 0) {
+  ColUInt8Builder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColUInt8> CreateColUInt8Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<uint8_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<uint8_t>(*data) : 0;
+  return Tables::CreateColUInt8(
+      _fbb,
+      data__);
+}
+
+struct ColUInt16 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<uint16_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<uint16_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColUInt16Builder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<uint16_t>> data) {
+    fbb_.AddOffset(ColUInt16::VT_DATA, data);
+  }
+  explicit ColUInt16Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColUInt16Builder &operator=(const ColUInt16Builder &);
+  flatbuffers::Offset<ColUInt16> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColUInt16>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColUInt16> CreateColUInt16(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<uint16_t>> data = 0) {
+  ColUInt16Builder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColUInt16> CreateColUInt16Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<uint16_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<uint16_t>(*data) : 0;
+  return Tables::CreateColUInt16(
+      _fbb,
+      data__);
+}
+
+struct ColUInt32 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<uint32_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColUInt32Builder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> data) {
+    fbb_.AddOffset(ColUInt32::VT_DATA, data);
+  }
+  explicit ColUInt32Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColUInt32Builder &operator=(const ColUInt32Builder &);
+  flatbuffers::Offset<ColUInt32> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColUInt32>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColUInt32> CreateColUInt32(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> data = 0) {
+  ColUInt32Builder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColUInt32> CreateColUInt32Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<uint32_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<uint32_t>(*data) : 0;
+  return Tables::CreateColUInt32(
+      _fbb,
+      data__);
+}
+
+struct ColUInt64 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<uint64_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<uint64_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColUInt64Builder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<uint64_t>> data) {
+    fbb_.AddOffset(ColUInt64::VT_DATA, data);
+  }
+  explicit ColUInt64Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColUInt64Builder &operator=(const ColUInt64Builder &);
+  flatbuffers::Offset<ColUInt64> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColUInt64>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColUInt64> CreateColUInt64(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<uint64_t>> data = 0) {
+  ColUInt64Builder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColUInt64> CreateColUInt64Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<uint64_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<uint64_t>(*data) : 0;
+  return Tables::CreateColUInt64(
+      _fbb,
+      data__);
+}
+
+struct ColFloat FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<float> *data() const {
+    return GetPointer<const flatbuffers::Vector<float> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColFloatBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<float>> data) {
+    fbb_.AddOffset(ColFloat::VT_DATA, data);
+  }
+  explicit ColFloatBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColFloatBuilder &operator=(const ColFloatBuilder &);
+  flatbuffers::Offset<ColFloat> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColFloat>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColFloat> CreateColFloat(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<float>> data = 0) {
+  ColFloatBuilder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColFloat> CreateColFloatDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<float> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<float>(*data) : 0;
+  return Tables::CreateColFloat(
+      _fbb,
+      data__);
+}
+
+struct ColDouble FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<double> *data() const {
+    return GetPointer<const flatbuffers::Vector<double> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColDoubleBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<double>> data) {
+    fbb_.AddOffset(ColDouble::VT_DATA, data);
+  }
+  explicit ColDoubleBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColDoubleBuilder &operator=(const ColDoubleBuilder &);
+  flatbuffers::Offset<ColDouble> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColDouble>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColDouble> CreateColDouble(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<double>> data = 0) {
+  ColDoubleBuilder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColDouble> CreateColDoubleDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<double> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<double>(*data) : 0;
+  return Tables::CreateColDouble(
+      _fbb,
+      data__);
+}
+
+struct ColBool FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<uint8_t> *data() const {
+    return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColBoolBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> data) {
+    fbb_.AddOffset(ColBool::VT_DATA, data);
+  }
+  explicit ColBoolBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColBoolBuilder &operator=(const ColBoolBuilder &);
+  flatbuffers::Offset<ColBool> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColBool>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColBool> CreateColBool(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> data = 0) {
+  ColBoolBuilder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColBool> CreateColBoolDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<uint8_t> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<uint8_t>(*data) : 0;
+  return Tables::CreateColBool(
+      _fbb,
+      data__);
+}
+
+struct ColString FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA = 4
+  };
+  const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *data() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *>(VT_DATA);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           verifier.VerifyVector(data()) &&
+           verifier.VerifyVectorOfStrings(data()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ColStringBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> data) {
+    fbb_.AddOffset(ColString::VT_DATA, data);
+  }
+  explicit ColStringBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColStringBuilder &operator=(const ColStringBuilder &);
+  flatbuffers::Offset<ColString> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<ColString>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<ColString> CreateColString(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> data = 0) {
+  ColStringBuilder builder_(_fbb);
+  builder_.add_data(data);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<ColString> CreateColStringDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<flatbuffers::Offset<flatbuffers::String>> *data = nullptr) {
+  auto data__ = data ? _fbb.CreateVector<flatbuffers::Offset<flatbuffers::String>>(*data) : 0;
+  return Tables::CreateColString(
+      _fbb,
+      data__);
+}
+
+struct Column FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_COL_IDX = 4,
+    VT_NULLBITS = 6,
+    VT_DATA_TYPE = 8,
+    VT_DATA = 10
+  };
+  int32_t col_idx() const {
+    return GetField<int32_t>(VT_COL_IDX, 0);
+  }
+  const flatbuffers::Vector<uint64_t> *nullbits() const {
+    return GetPointer<const flatbuffers::Vector<uint64_t> *>(VT_NULLBITS);
+  }
+  ColData data_type() const {
+    return static_cast<ColData>(GetField<uint8_t>(VT_DATA_TYPE, 0));
+  }
+  const void *data() const {
+    return GetPointer<const void *>(VT_DATA);
+  }
+  template<typename T> const T *data_as() const;
+  const ColInt8 *data_as_ColInt8() const {
+    return data_type() == ColData_ColInt8 ? static_cast<const ColInt8 *>(data()) : nullptr;
+  }
+  const ColInt16 *data_as_ColInt16() const {
+    return data_type() == ColData_ColInt16 ? static_cast<const ColInt16 *>(data()) : nullptr;
+  }
+  const ColInt32 *data_as_ColInt32() const {
+    return data_type() == ColData_ColInt32 ? static_cast<const ColInt32 *>(data()) : nullptr;
+  }
+  const ColInt64 *data_as_ColInt64() const {
+    return data_type() == ColData_ColInt64 ? static_cast<const ColInt64 *>(data()) : nullptr;
+  }
+  const ColUInt8 *data_as_ColUInt8() const {
+    return data_type() == ColData_ColUInt8 ? static_cast<const ColUInt8 *>(data()) : nullptr;
+  }
+  const ColUInt16 *data_as_ColUInt16() const {
+    return data_type() == ColData_ColUInt16 ? static_cast<const ColUInt16 *>(data()) : nullptr;
+  }
+  const ColUInt32 *data_as_ColUInt32() const {
+    return data_type() == ColData_ColUInt32 ? static_cast<const ColUInt32 *>(data()) : nullptr;
+  }
+  const ColUInt64 *data_as_ColUInt64() const {
+    return data_type() == ColData_ColUInt64 ? static_cast<const ColUInt64 *>(data()) : nullptr;
+  }
+  const ColFloat *data_as_ColFloat() const {
+    return data_type() == ColData_ColFloat ? static_cast<const ColFloat *>(data()) : nullptr;
+  }
+  const ColDouble *data_as_ColDouble() const {
+    return data_type() == ColData_ColDouble ? static_cast<const ColDouble *>(data()) : nullptr;
+  }
+  const ColBool *data_as_ColBool() const {
+    return data_type() == ColData_ColBool ? static_cast<const ColBool *>(data()) : nullptr;
+  }
+  const ColString *data_as_ColString() const {
+    return data_type() == ColData_ColString ? static_cast<const ColString *>(data()) : nullptr;
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<int32_t>(verifier, VT_COL_IDX) &&
+           VerifyOffset(verifier, VT_NULLBITS) &&
+           verifier.VerifyVector(nullbits()) &&
+           VerifyField<uint8_t>(verifier, VT_DATA_TYPE) &&
+           VerifyOffset(verifier, VT_DATA) &&
+           VerifyColData(verifier, data(), data_type()) &&
+           verifier.EndTable();
+  }
+};
+
+template<> inline const ColInt8 *Column::data_as<ColInt8>() const {
+  return data_as_ColInt8();
+}
+
+template<> inline const ColInt16 *Column::data_as<ColInt16>() const {
+  return data_as_ColInt16();
+}
+
+template<> inline const ColInt32 *Column::data_as<ColInt32>() const {
+  return data_as_ColInt32();
+}
+
+template<> inline const ColInt64 *Column::data_as<ColInt64>() const {
+  return data_as_ColInt64();
+}
+
+template<> inline const ColUInt8 *Column::data_as<ColUInt8>() const {
+  return data_as_ColUInt8();
+}
+
+template<> inline const ColUInt16 *Column::data_as<ColUInt16>() const {
+  return data_as_ColUInt16();
+}
+
+template<> inline const ColUInt32 *Column::data_as<ColUInt32>() const {
+  return data_as_ColUInt32();
+}
+
+template<> inline const ColUInt64 *Column::data_as<ColUInt64>() const {
+  return data_as_ColUInt64();
+}
+
+template<> inline const ColFloat *Column::data_as<ColFloat>() const {
+  return data_as_ColFloat();
+}
+
+template<> inline const ColDouble *Column::data_as<ColDouble>() const {
+  return data_as_ColDouble();
+}
+
+template<> inline const ColBool *Column::data_as<ColBool>() const {
+  return data_as_ColBool();
+}
+
+template<> inline const ColString *Column::data_as<ColString>() const {
+  return data_as_ColString();
+}
+
+struct ColumnBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_col_idx(int32_t col_idx) {
+    fbb_.AddElement<int32_t>(Column::VT_COL_IDX, col_idx, 0);
+  }
+  void add_nullbits(flatbuffers::Offset<flatbuffers::Vector<uint64_t>> nullbits) {
+    fbb_.AddOffset(Column::VT_NULLBITS, nullbits);
+  }
+  void add_data_type(ColData data_type) {
+    fbb_.AddElement<uint8_t>(Column::VT_DATA_TYPE, static_cast<uint8_t>(data_type), 0);
+  }
+  void add_data(flatbuffers::Offset<void> data) {
+    fbb_.AddOffset(Column::VT_DATA, data);
+  }
+  explicit ColumnBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ColumnBuilder &operator=(const ColumnBuilder &);
+  flatbuffers::Offset<Column> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Column>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Column> CreateColumn(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    int32_t col_idx = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint64_t>> nullbits = 0,
+    ColData data_type = ColData_NONE,
+    flatbuffers::Offset<void> data = 0) {
+  ColumnBuilder builder_(_fbb);
+  builder_.add_data(data);
+  builder_.add_nullbits(nullbits);
+  builder_.add_col_idx(col_idx);
+  builder_.add_data_type(data_type);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<Column> CreateColumnDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    int32_t col_idx = 0,
+    const std::vector<uint64_t> *nullbits = nullptr,
+    ColData data_type = ColData_NONE,
+    flatbuffers::Offset<void> data = 0) {
+  auto nullbits__ = nullbits ? _fbb.CreateVector<uint64_t>(*nullbits) : 0;
+  return Tables::CreateColumn(
+      _fbb,
+      col_idx,
+      nullbits__,
+      data_type,
+      data);
+}
+
+struct Table_COL FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_DATA_FORMAT_TYPE = 4,
+    VT_SKYHOOK_VERSION = 6,
+    VT_DATA_STRUCTURE_VERSION = 8,
+    VT_DATA_SCHEMA_VERSION = 10,
+    VT_DATA_SCHEMA = 12,
+    VT_DB_SCHEMA = 14,
+    VT_TABLE_NAME = 16,
+    VT_DELETE_VECTOR = 18,
+    VT_RIDS = 20,
+    VT_COLS = 22,
+    VT_NROWS = 24
+  };
+  int32_t data_format_type() const {
+    return GetField<int32_t>(VT_DATA_FORMAT_TYPE, 0);
+  }
+  int32_t skyhook_version() const {
+    return GetField<int32_t>(VT_SKYHOOK_VERSION, 0);
+  }
+  int32_t data_structure_version() const {
+    return GetField<int32_t>(VT_DATA_STRUCTURE_VERSION, 0);
+  }
+  int32_t data_schema_version() const {
+    return GetField<int32_t>(VT_DATA_SCHEMA_VERSION, 0);
+  }
+  const flatbuffers::String *data_schema() const {
+    return GetPointer<const flatbuffers::String *>(VT_DATA_SCHEMA);
+  }
+  const flatbuffers::String *db_schema() const {
+    return GetPointer<const flatbuffers::String *>(VT_DB_SCHEMA);
+  }
+  const flatbuffers::String *table_name() const {
+    return GetPointer<const flatbuffers::String *>(VT_TABLE_NAME);
+  }
+  const flatbuffers::Vector<uint8_t> *delete_vector() const {
+    return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_DELETE_VECTOR);
+  }
+  const flatbuffers::Vector<uint64_t> *RIDs() const {
+    return GetPointer<const flatbuffers::Vector<uint64_t> *>(VT_RIDS);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<Tables::Column>> *cols() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Tables::Column>> *>(VT_COLS);
+  }
+  uint32_t nrows() const {
+    return GetField<uint32_t>(VT_NROWS, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<int32_t>(verifier, VT_DATA_FORMAT_TYPE) &&
+           VerifyField<int32_t>(verifier, VT_SKYHOOK_VERSION) &&
+           VerifyField<int32_t>(verifier, VT_DATA_STRUCTURE_VERSION) &&
+           VerifyField<int32_t>(verifier, VT_DATA_SCHEMA_VERSION) &&
+           VerifyOffset(verifier, VT_DATA_SCHEMA) &&
+           verifier.VerifyString(data_schema()) &&
+           VerifyOffset(verifier, VT_DB_SCHEMA) &&
+           verifier.VerifyString(db_schema()) &&
+           VerifyOffset(verifier, VT_TABLE_NAME) &&
+           verifier.VerifyString(table_name()) &&
+           VerifyOffset(verifier, VT_DELETE_VECTOR) &&
+           verifier.VerifyVector(delete_vector()) &&
+           VerifyOffset(verifier, VT_RIDS) &&
+           verifier.VerifyVector(RIDs()) &&
+           VerifyOffset(verifier, VT_COLS) &&
+           verifier.VerifyVector(cols()) &&
+           verifier.VerifyVectorOfTables(cols()) &&
+           VerifyField<uint32_t>(verifier, VT_NROWS) &&
+           verifier.EndTable();
+  }
+};
+
+struct Table_COLBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_data_format_type(int32_t data_format_type) {
+    fbb_.AddElement<int32_t>(Table_COL::VT_DATA_FORMAT_TYPE, data_format_type, 0);
+  }
+  void add_skyhook_version(int32_t skyhook_version) {
+    fbb_.AddElement<int32_t>(Table_COL::VT_SKYHOOK_VERSION, skyhook_version, 0);
+  }
+  void add_data_structure_version(int32_t data_structure_version) {
+    fbb_.AddElement<int32_t>(Table_COL::VT_DATA_STRUCTURE_VERSION, data_structure_version, 0);
+  }
+  void add_data_schema_version(int32_t data_schema_version) {
+    fbb_.AddElement<int32_t>(Table_COL::VT_DATA_SCHEMA_VERSION, data_schema_version, 0);
+  }
+  void add_data_schema(flatbuffers::Offset<flatbuffers::String> data_schema) {
+    fbb_.AddOffset(Table_COL::VT_DATA_SCHEMA, data_schema);
+  }
+  void add_db_schema(flatbuffers::Offset<flatbuffers::String> db_schema) {
+    fbb_.AddOffset(Table_COL::VT_DB_SCHEMA, db_schema);
+  }
+  void add_table_name(flatbuffers::Offset<flatbuffers::String> table_name) {
+    fbb_.AddOffset(Table_COL::VT_TABLE_NAME, table_name);
+  }
+  void add_delete_vector(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> delete_vector) {
+    fbb_.AddOffset(Table_COL::VT_DELETE_VECTOR, delete_vector);
+  }
+  void add_RIDs(flatbuffers::Offset<flatbuffers::Vector<uint64_t>> RIDs) {
+    fbb_.AddOffset(Table_COL::VT_RIDS, RIDs);
+  }
+  void add_cols(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Tables::Column>>> cols) {
+    fbb_.AddOffset(Table_COL::VT_COLS, cols);
+  }
+  void add_nrows(uint32_t nrows) {
+    fbb_.AddElement<uint32_t>(Table_COL::VT_NROWS, nrows, 0);
+  }
+  explicit Table_COLBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  Table_COLBuilder &operator=(const Table_COLBuilder &);
+  flatbuffers::Offset<Table_COL> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Table_COL>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Table_COL> CreateTable_COL(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    int32_t data_format_type = 0,
+    int32_t skyhook_version = 0,
+    int32_t data_structure_version = 0,
+    int32_t data_schema_version = 0,
+    flatbuffers::Offset<flatbuffers::String> data_schema = 0,
+    flatbuffers::Offset<flatbuffers::String> db_schema = 0,
+    flatbuffers::Offset<flatbuffers::String> table_name = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> delete_vector = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint64_t>> RIDs = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Tables::Column>>> cols = 0,
+    uint32_t nrows = 0) {
+  Table_COLBuilder builder_(_fbb);
+  builder_.add_nrows(nrows);
+  builder_.add_cols(cols);
+  builder_.add_RIDs(RIDs);
+  builder_.add_delete_vector(delete_vector);
+  builder_.add_table_name(table_name);
+  builder_.add_db_schema(db_schema);
+  builder_.add_data_schema(data_schema);
+  builder_.add_data_schema_version(data_schema_version);
+  builder_.add_data_structure_version(data_structure_version);
+  builder_.add_skyhook_version(skyhook_version);
+  builder_.add_data_format_type(data_format_type);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<Table_COL> CreateTable_COLDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    int32_t data_format_type = 0,
+    int32_t skyhook_version = 0,
+    int32_t data_structure_version = 0,
+    int32_t data_schema_version = 0,
+    const char *data_schema = nullptr,
+    const char *db_schema = nullptr,
+    const char *table_name = nullptr,
+    const std::vector<uint8_t> *delete_vector = nullptr,
+    const std::vector<uint64_t> *RIDs = nullptr,
+    const std::vector<flatbuffers::Offset<Tables::Column>> *cols = nullptr,
+    uint32_t nrows = 0) {
+  auto data_schema__ = data_schema ? _fbb.CreateString(data_schema) : 0;
+  auto db_schema__ = db_schema ? _fbb.CreateString(db_schema) : 0;
+  auto table_name__ = table_name ? _fbb.CreateString(table_name) : 0;
+  auto delete_vector__ = delete_vector ? _fbb.CreateVector<uint8_t>(*delete_vector) : 0;
+  auto RIDs__ = RIDs ? _fbb.CreateVector<uint64_t>(*RIDs) : 0;
+  auto cols__ = cols ? _fbb.CreateVector<flatbuffers::Offset<Tables::Column>>(*cols) : 0;
+  return Tables::CreateTable_COL(
+      _fbb,
+      data_format_type,
+      skyhook_version,
+      data_structure_version,
+      data_schema_version,
+      data_schema__,
+      db_schema__,
+      table_name__,
+      delete_vector__,
+      RIDs__,
+      cols__,
+      nrows);
+}
+
+inline bool VerifyColData(flatbuffers::Verifier &verifier, const void *obj, ColData type) {
+  switch (type) {
+    case ColData_NONE: {
+      return true;
+    }
+    case ColData_ColInt8: {
+      auto ptr = reinterpret_cast<const Tables::ColInt8 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColInt16: {
+      auto ptr = reinterpret_cast<const Tables::ColInt16 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColInt32: {
+      auto ptr = reinterpret_cast<const Tables::ColInt32 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColInt64: {
+      auto ptr = reinterpret_cast<const Tables::ColInt64 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColUInt8: {
+      auto ptr = reinterpret_cast<const Tables::ColUInt8 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColUInt16: {
+      auto ptr = reinterpret_cast<const Tables::ColUInt16 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColUInt32: {
+      auto ptr = reinterpret_cast<const Tables::ColUInt32 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColUInt64: {
+      auto ptr = reinterpret_cast<const Tables::ColUInt64 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColFloat: {
+      auto ptr = reinterpret_cast<const Tables::ColFloat *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColDouble: {
+      auto ptr = reinterpret_cast<const Tables::ColDouble *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColBool: {
+      auto ptr = reinterpret_cast<const Tables::ColBool *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ColData_ColString: {
+      auto ptr = reinterpret_cast<const Tables::ColString *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    default: return false;
+  }
+}
+
+inline bool VerifyColDataVector(flatbuffers::Verifier &verifier, const flatbuffers::Vector<flatbuffers::Offset<void>> *values, const flatbuffers::Vector<uint8_t> *types) {
+  if (!values || !types) return !values && !types;
+  if (values->size() != types->size()) return false;
+  for (flatbuffers::uoffset_t i = 0; i < values->size(); ++i) {
+    if (!VerifyColData(
+        verifier,  values->Get(i), types->GetEnum<ColData>(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline const Tables::Table_COL *GetTable_COL(const void *buf) {
+  return flatbuffers::GetRoot<Tables::Table_COL>(buf);
+}
+
+inline const Tables::Table_COL *GetSizePrefixedTable_COL(const void *buf) {
+  return flatbuffers::GetSizePrefixedRoot<Tables::Table_COL>(buf);
+}
+
+inline const char *Table_COLIdentifier() {
+  return "SKYC";
+}
+
+inline bool Table_COLBufferHasIdentifier(const void *buf) {
+  return flatbuffers::BufferHasIdentifier(
+      buf, Table_COLIdentifier());
+}
+
+inline bool VerifyTable_COLBuffer(
+    flatbuffers::Verifier &verifier) {
+  return verifier.VerifyBuffer<Tables::Table_COL>(Table_COLIdentifier());
+}
+
+inline bool VerifySizePrefixedTable_COLBuffer(
+    flatbuffers::Verifier &verifier) {
+  return verifier.VerifySizePrefixedBuffer<Tables::Table_COL>(Table_COLIdentifier());
+}
+
+inline void FinishTable_COLBuffer(
+    flatbuffers::FlatBufferBuilder &fbb,
+    flatbuffers::Offset<Tables::Table_COL> root) {
+  fbb.Finish(root, Table_COLIdentifier());
+}
+
+inline void FinishSizePrefixedTable_COLBuffer(
+    flatbuffers::FlatBufferBuilder &fbb,
+    flatbuffers::Offset<Tables::Table_COL> root) {
+  fbb.FinishSizePrefixed(root, Table_COLIdentifier());
+}
+
+}  // namespace Tables
+
+#endif  // FLATBUFFERS_GENERATED_SKYHOOKV2COL_TABLES_H_
@@ -10,6 +10,8 @@
 
 
 #include <fstream>
+#include <deque>
+#include <arrow/io/file.h>
 #include "query.h"
 #include "../cls/tabular/cls_tabular_utils.h"
 static std::string string_ncopy(const char* buffer, std::size_t buffer_size) {
@@ -17,6 +19,10 @@ static std::string string_ncopy(const char* buffer, std::size_t buffer_size) {
   return std::string(buffer, copyupto);
 }
 
+static std::size_t string_nlen(const char* buffer, std::size_t buffer_size) {
+  return std::find(buffer, buffer + buffer_size, 0) - buffer;
+}
+
 static std::mutex print_lock;
 
 bool quiet;
@@ -44,6 +50,8 @@ std::string comment_regex;
 bool qop_fastpath;
 bool qop_index_read;
 bool qop_mem_constrain;
+uint64_t qop_scan_mem_cap;
+uint32_t qop_nthreads;
 int qop_index_type;
 int qop_index2_type;
 int qop_index_plan_type;
@@ -57,6 +65,14 @@ std::string qop_index2_schema;
 std::string qop_query_preds;
 std::string qop_index_preds;
 std::string qop_index2_preds;
+std::string qop_groupby_schema;
+uint64_t qop_limit;
+std::string qop_orderby_schema;
+bool qop_orderby_desc;
+
+// result output
+std::string output_format;
+std::string output_file;
 
 // build index op params for flatbufs
 bool idx_op_idx_unique;
@@ -65,6 +81,7 @@ int idx_op_batch_size;
 int idx_op_idx_type;
 std::string idx_op_idx_schema;
 std::string idx_op_text_delims;
+std::string idx_op_bloom_schema;
 
 // transform op params
 int trans_op_format_type;
@@ -83,6 +100,14 @@ Tables::schema_vec sky_idx2_schema;
 Tables::predicate_vec sky_qry_preds;
 Tables::predicate_vec sky_idx_preds;
 Tables::predicate_vec sky_idx2_preds;
+Tables::schema_vec sky_grp_schema;
+Tables::schema_vec sky_ord_schema;
+
+Tables::agg_groups sky_grp_aggs;
+static std::mutex grp_lock;
+
+Tables::topk_rows sky_topk;
+static std::mutex topk_lock;
 
  // these are all intialized in run-query
 std::atomic<unsigned> result_count;
@@ -154,9 +179,175 @@ static void print_row(const char *row)
   print_lock.unlock();
 }
 
+/*
+ * Output pipeline.
+ * Workers format their results into a thread local buffer, which is handed
+ * to a single writer thread once it is large, so workers do not serialize on
+ * every row written.  The writer writes the csv header once before any rows,
+ * or for the arrow output format writes each result table to a single arrow
+ * ipc stream in output_file.
+ */
+struct out_buf {
+  std::string header;  // csv header, used only if not yet written
+  std::string rows;
+  std::vector<std::shared_ptr<arrow::Table>> tables;
+};
+
+static const size_t OUTPUT_BUF_SIZE = 1 << 20;  // bytes per worker buffer
+
+static thread_local out_buf tl_out;
+static std::deque<out_buf> out_queue;
+static std::mutex out_lock;
+static std::condition_variable out_cond;
+static bool out_stop;
+static std::thread out_writer;
+
+// hand this thread's buffer to the writer if full, or any data if force
+static void output_push(bool force)
+{
+    if (tl_out.header.empty() and tl_out.rows.empty() and
+        tl_out.tables.empty())
+        return;
+    if (!force and tl_out.rows.size() < OUTPUT_BUF_SIZE and
+        tl_out.tables.empty())
+        return;
+
+    out_buf b;
+    std::swap(b, tl_out);
+    tl_out.rows.reserve(OUTPUT_BUF_SIZE);
+    out_lock.lock();
+    out_queue.push_back(std::move(b));
+    out_lock.unlock();
+    out_cond.notify_one();
+}
+
+static void output_writer()
+{
+    std::shared_ptr<arrow::io::FileOutputStream> file;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> ipc_writer;
+    std::deque<out_buf> bufs;
+
+    std::unique_lock<std::mutex> lock(out_lock);
+    while (true) {
+        if (out_queue.empty()) {
+            if (out_stop)
+                break;
+            out_cond.wait(lock);
+            continue;
+        }
+        bufs.swap(out_queue);
+        lock.unlock();
+
+        for (auto it = bufs.begin(); it != bufs.end(); ++it) {
+            if (print_header and !it->header.empty()) {
+                std::cout.write(it->header.data(), it->header.size());
+                print_header = false;
+            }
+            std::cout.write(it->rows.data(), it->rows.size());
+
+            for (auto t = it->tables.begin(); t != it->tables.end(); ++t) {
+                arrow::Status st;
+                if (!ipc_writer) {
+                    st = arrow::io::FileOutputStream::Open(output_file, &file);
+                    if (st.ok())
+                        st = arrow::ipc::RecordBatchStreamWriter::Open(
+                                file.get(), (*t)->schema(), &ipc_writer);
+                    if (!st.ok()) {
+                        std::cerr << "ERROR: query.cc: opening arrow output "
+                                  << output_file << ": " << st.ToString()
+                                  << std::endl;
+                        exit(1);
+                    }
+                }
+                st = ipc_writer->WriteTable(**t);
+                if (!st.ok()) {
+                    std::cerr << "ERROR: query.cc: writing arrow output: "
+                              << st.ToString() << std::endl;
+                    exit(1);
+                }
+            }
+        }
+        bufs.clear();
+        lock.lock();
+    }
+    lock.unlock();
+
+    std::cout.flush();
+    if (ipc_writer)
+        ipc_writer->Close();
+}
+
+void output_start()
+{
+    out_stop = false;
+    out_writer = std::thread(output_writer);
+}
+
+// flush the calling thread's buffer and wait for the writer to finish
+void output_finish()
+{
+    output_push(true);
+    out_lock.lock();
+    out_stop = true;
+    out_lock.unlock();
+    out_cond.notify_all();
+    if (out_writer.joinable())
+        out_writer.join();
+}
+
+static long long int format_csv(const char *dataptr,
+                                const size_t datasz,
+                                const SkyFormatType format,
+                                bool header,
+                                bool verbose,
+                                long long int max_rows,
+                                std::ostream& out)
+{
+    switch (format) {
+        case SFT_FLATBUF_FLEX_ROW:
+            return Tables::printFlatbufFlexRowAsCsv(dataptr, datasz, header,
+                                                    verbose, max_rows, out);
+        case SFT_ARROW:
+            return Tables::printArrowbufRowAsCsv(dataptr, datasz, header,
+                                                 verbose, max_rows, out);
+        default:
+            assert (Tables::TablesErrCodes::SkyFormatTypeNotImplemented==0);
+    }
+    return 0;
+}
+
+// rows of a result the csv formatter will emit, i.e., its live rows
+static long long int live_rows(const char *dataptr,
+                               const size_t datasz,
+                               const long long int nrows,
+                               const SkyFormatType format)
+{
+    if (format != SFT_FLATBUF_FLEX_ROW)
+        return nrows;
+    Tables::sky_root root = Tables::getSkyRoot(dataptr, datasz);
+    long long int n = 0;
+    for (uint32_t i = 0; i < root.nrows; i++) {
+        if (root.delete_vec.at(i) == 0)
+            n++;
+    }
+    return n;
+}
+
+// reserve up to want rows of the result limit, returns the num reserved
+static long long int reserve_rows(long long int want)
+{
+    long long int cur = row_counter;
+    long long int n = 0;
+    do {
+        n = std::max(0LL, std::min(want, row_limit - cur));
+    } while (!row_counter.compare_exchange_weak(cur, cur + n));
+    return n;
+}
+
 // TODO: change to generic name, printData
 static void print_data(const char *dataptr,
                        const size_t datasz,
+                       const long long int nrows,
                        const SkyFormatType format=SFT_FLATBUF_FLEX_ROW)
 {
 
@@ -165,33 +356,60 @@ static void print_data(const char *dataptr,
         return;
 
     // NOTE: print_header is atomic, and declared in query.h
-    // used here to prevent duplicate printing of csv header at runtime
-    // row_counter used to limit num rows returned in result (csv output)
-    // print_lock prevents multiple worker threads from concurrent write output
+    // it is cleared by the writer once the csv header has been written.
+    // row_counter used to limit num rows returned in result (csv output),
+    // rows are reserved before formatting so concurrent workers cannot
+    // exceed the limit, and only the rows that will be emitted are
+    // reserved, so no other worker is refused rows that go unused.
+    if (output_format == "arrow") {
+        if (row_counter >= row_limit and !print_header)
+            return;
+        std::shared_ptr<arrow::Table> table;
+        std::string errmsg;
+        int ret = 0;
+        if (format == SFT_ARROW) {
+            std::shared_ptr<arrow::Buffer> buffer;
+            arrow::Buffer::FromString(std::string(dataptr, datasz), &buffer);
+            ret = Tables::extract_arrow_from_buffer(&table, buffer);
+        } else {
+            ret = Tables::transform_fb_to_arrow(dataptr, datasz, errmsg,
+                                                &table);
+        }
+        if (ret != 0) {
+            std::cerr << "ERROR: query.cc: converting result to arrow: "
+                      << errmsg << "\n Tables::ErrCodes=" << ret << endl;
+            exit(1);
+        }
+        long long int max_rows = reserve_rows(table->num_rows());
+        if (max_rows == 0 and !print_header)
+            return;
+        if (max_rows < table->num_rows()) {
+            std::vector<std::shared_ptr<arrow::Column>> cols;
+            for (int i = 0; i < table->num_columns(); i++)
+                cols.push_back(table->column(i)->Slice(0, max_rows));
+            table = arrow::Table::Make(table->schema(), cols, max_rows);
+        }
+        tl_out.tables.push_back(table);
+        output_push(true);
+        return;
+    }
 
-    print_lock.lock();
-    switch (format) {
-        case SFT_FLATBUF_FLEX_ROW:
-            row_counter += \
-                Tables::printFlatbufFlexRowAsCsv(dataptr,
-                                                 datasz,
-                                                 print_header,
-                                                 print_verbose,
-                                                 row_limit - row_counter);
-            break;
-        case SFT_ARROW:
-            row_counter += \
-                Tables::printArrowbufRowAsCsv(dataptr,
-                                              datasz,
-                                              print_header,
-                                              print_verbose,
-                                              row_limit - row_counter);
-            break;
-        default:
-            assert (Tables::TablesErrCodes::SkyFormatTypeNotImplemented==0);
+    long long int max_rows = reserve_rows(live_rows(dataptr, datasz, nrows,
+                                                    format));
+    if (max_rows == 0 and !print_header)
+        return;
+
+    std::ostringstream out;
+    if (print_header and tl_out.header.empty()) {
+        format_csv(dataptr, datasz, format, true, false, 0, out);
+        tl_out.header = out.str();
+        out.str("");
     }
-    print_header = false;
-    print_lock.unlock();
+    long long int n = format_csv(dataptr, datasz, format, false,
+                                 print_verbose, max_rows, out);
+    row_counter -= max_rows - n;  // return any unused reservation
+    tl_out.rows.append(out.str());
+    output_push(false);
 }
 
 static const size_t order_key_field_offset = 0;
@@ -288,6 +506,27 @@ void worker_transform_db_op(librados::IoCtx *ioctx, transform_op op)
   ioctx->close();
 }
 
+void worker_compact_op(librados::IoCtx *ioctx, compact_op op)
+{
+  while (true) {
+    work_lock.lock();
+    if (target_objects.empty()) {
+      work_lock.unlock();
+      break;
+    }
+    std::string oid = target_objects.back();
+    target_objects.pop_back();
+    std::cout << "compacting object...oid:" << oid << std::endl;
+    work_lock.unlock();
+
+    ceph::bufferlist inbl, outbl;
+    ::encode(op, inbl);
+    int ret = ioctx->exec(oid, "tabular", "compact", inbl, outbl);
+    checkret(ret, 0);
+  }
+  ioctx->close();
+}
+
 
 void worker_exec_runstats_op(librados::IoCtx *ioctx, stats_op op)
 {
@@ -321,6 +560,52 @@ static void add_extra_row_cost(uint64_t cost)
   }
 }
 
+// build the final agg row of each group and print them
+void print_groupby_result()
+{
+    using namespace Tables;
+
+    if (!useGroupBy(sky_grp_schema, sky_qry_preds))
+        return;
+
+    flatbuffers::FlatBufferBuilder flatbldr(1024);
+    groupbyBuildFb(flatbldr, sky_tbl_schema, sky_grp_schema, sky_qry_preds,
+                   sky_grp_aggs, true, qop_db_schema, qop_table_name);
+    const char* fb = reinterpret_cast<char*>(flatbldr.GetBufferPointer());
+    result_count += sky_grp_aggs.size();
+    print_data(fb, flatbldr.GetSize(), sky_grp_aggs.size());
+}
+
+// merge the rows of a result fb into the top-k, i.e., a k-way merge of the
+// ordered results of each obj, printed once all objs are done.
+static void topk_merge(const char *fb, const size_t fb_size)
+{
+    std::string errmsg;
+    std::lock_guard<std::mutex> l(topk_lock);
+    int ret = Tables::topkAccumulate(sky_topk, fb, fb_size, errmsg);
+    if (ret != 0) {
+        int topk_failure = true;
+        std::cerr << "ERROR: query.cc: order by: " << errmsg
+                  << "\n Tables::ErrCodes=" << ret << endl;
+        assert(topk_failure);
+    }
+}
+
+// print the final top-k rows in order
+void print_topk_result()
+{
+    using namespace Tables;
+
+    if (sky_topk.k == 0 or sky_topk.heap.empty())
+        return;
+
+    flatbuffers::FlatBufferBuilder flatbldr(1024);
+    topkBuildFb(flatbldr, sky_topk);
+    const char* fb = reinterpret_cast<char*>(flatbldr.GetBufferPointer());
+    result_count += sky_topk.heap.size();
+    print_data(fb, flatbldr.GetSize(), sky_topk.heap.size());
+}
+
 void worker()
 {
   std::unique_lock<std::mutex> lock(work_lock);
@@ -391,6 +676,26 @@ void worker()
                 assert(decode_runquery_noncls);
             }
 
+            // raw parquet objs are read back as a single arrow table
+            if (!use_cls and query == "arrow" and
+                isParquet(bl.c_str(), bl.length())) {
+                std::shared_ptr<arrow::Buffer> buffer;
+                std::shared_ptr<arrow::Table> table;
+                arrow::Buffer::FromString(std::string(bl.c_str(), bl.length()),
+                                          &buffer);
+                int ret = extract_arrow_from_parquet(&table, buffer);
+                if (ret != 0) {
+                    int parquet_failure = true;
+                    std::cerr << "ERROR: query.cc: reading parquet obj"
+                              << "\n Tables::ErrCodes=" << ret << endl;
+                    assert(parquet_failure);
+                }
+                convert_arrow_to_buffer(table, &buffer);
+                bl.clear();
+                bl.append(reinterpret_cast<const char*>(buffer->data()),
+                          buffer->size());
+            }
+
             // get our data as contiguous bytes before accessing
             const char* char_data_ptr = bl.c_str();
             if (query == "flatbuf") {
@@ -408,6 +713,41 @@ void worker()
                 rows_returned += std::stoi(metadata->value(METADATA_NUM_ROWS));
             }
 
+            // group by results are merged here and printed once all objs
+            // are done, see print_groupby_result()
+            if (query == "flatbuf" and
+                useGroupBy(sky_grp_schema, sky_qry_preds)) {
+                std::string errmsg;
+                int ret = 0;
+                std::lock_guard<std::mutex> l(grp_lock);
+                if (use_cls) {
+                    ret = groupbyMerge(sky_grp_schema,
+                                       sky_qry_preds,
+                                       char_data_ptr,
+                                       bl.length(),
+                                       errmsg,
+                                       sky_grp_aggs);
+                } else {
+                    std::vector<uint32_t> row_nums;  // all rows
+                    ret = groupbyAccumulate(sky_tbl_schema,
+                                            sky_qry_preds,
+                                            sky_grp_schema,
+                                            char_data_ptr,
+                                            bl.length(),
+                                            errmsg,
+                                            row_nums,
+                                            sky_grp_aggs);
+                }
+                if (ret != 0) {
+                    int groupby_failure = true;
+                    std::cerr << "ERROR: query.cc: group by: "
+                              << errmsg << "\n Tables::ErrCodes=" << ret
+                              << endl;
+                    assert(groupby_failure);
+                }
+                continue;
+            }
+
             // check if we need to do any more processing: project/select/agg
             // TODO: check for/add global aggs here.
             bool more_processing = false;
@@ -418,10 +758,13 @@ void worker()
             }
 
             if (!more_processing) {  // nothing left to do here.
-                if (query == "flatbuf") {
+                if (query == "flatbuf" and sky_topk.k > 0) {
+                    topk_merge(char_data_ptr, bl.length());
+                }
+                else if (query == "flatbuf") {
                     sky_root root = Tables::getSkyRoot(char_data_ptr, 0);
                     result_count += root.nrows;
-                    print_data(char_data_ptr, 0);
+                    print_data(char_data_ptr, 0, root.nrows);
                 }
                 else if (query == "arrow") {
                     // TODO Add nrow to rows_returned
@@ -432,8 +775,10 @@ void worker()
                     extract_arrow_from_buffer(&table, buffer);
                     auto schema = table->schema();
                     auto metadata = schema->metadata();
-                    result_count += std::stoi(metadata->value(METADATA_NUM_ROWS));
-                    print_data(buffer->ToString().c_str(), buffer->size(), SFT_ARROW);
+                    int nrows = std::stoi(metadata->value(METADATA_NUM_ROWS));
+                    result_count += nrows;
+                    print_data(buffer->ToString().c_str(), buffer->size(),
+                               nrows, SFT_ARROW);
                 }
             }
             else {
@@ -454,12 +799,17 @@ void worker()
                                   << endl;
                         assert(more_processing_failure);
                     }
+                    else if (sky_topk.k > 0) {
+                        topk_merge(reinterpret_cast<char*>(
+                                        flatbldr.GetBufferPointer()),
+                                   flatbldr.GetSize());
+                    }
                     else {
                         char_data_ptr =                                 \
                             reinterpret_cast<char*>(flatbldr.GetBufferPointer());
                         sky_root root = getSkyRoot(char_data_ptr, 0);
                         result_count += root.nrows;
-                        print_data(char_data_ptr, 0);
+                        print_data(char_data_ptr, 0, root.nrows);
                     }
                 }
                 else if (query == "arrow") {
@@ -483,9 +833,11 @@ void worker()
                         std::shared_ptr<arrow::Buffer> buffer;
                         auto schema = table->schema();
                         auto metadata = schema->metadata();
-                        result_count += std::stoi(metadata->value(METADATA_NUM_ROWS));
+                        int nrows = std::stoi(metadata->value(METADATA_NUM_ROWS));
+                        result_count += nrows;
                         convert_arrow_to_buffer(table, &buffer);
-                        print_data(buffer->ToString().c_str(), buffer->size(), SFT_ARROW);
+                        print_data(buffer->ToString().c_str(), buffer->size(),
+                                   nrows, SFT_ARROW);
                     }
                 }
             }
@@ -649,12 +1001,11 @@ void worker()
             }
           } else {
             RE2 re(comment_regex);
+            Tables::LikeMatcher like(comment_regex, &re);
             for (size_t rid = 0; rid < num_rows; rid++) {
               const char *row = rows + rid * row_size;
               const char *cptr = row + comment_field_offset;
-              const std::string comment_val = string_ncopy(cptr,
-                  comment_field_length);
-              if (RE2::PartialMatch(comment_val, re)) {
+              if (like.match(cptr, string_nlen(cptr, comment_field_length))) {
                 print_row(row);
                 result_count++;
                 add_extra_row_cost(extra_row_cost);
@@ -677,6 +1028,10 @@ void worker()
     lock.lock();
     timings.push_back(times);
   }
+  lock.unlock();
+
+  // hand any remaining results to the writer before exiting
+  output_push(true);
 }
 
 /*
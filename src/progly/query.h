@@ -77,6 +77,8 @@ extern std::string comment_regex;
 extern bool qop_fastpath;
 extern bool qop_index_read;
 extern bool qop_mem_constrain;
+extern uint64_t qop_scan_mem_cap;
+extern uint32_t qop_nthreads;
 extern int qop_index_type;
 extern int qop_index2_type;
 extern int qop_index_plan_type;
@@ -90,6 +92,14 @@ extern std::string qop_index2_schema;
 extern std::string qop_query_preds;
 extern std::string qop_index_preds;
 extern std::string qop_index2_preds;
+extern std::string qop_groupby_schema;
+extern uint64_t qop_limit;
+extern std::string qop_orderby_schema;
+extern bool qop_orderby_desc;
+
+// result output, csv to stdout or an arrow ipc stream to output_file
+extern std::string output_format;
+extern std::string output_file;
 
 // build index op params for flatbufs
 extern bool idx_op_idx_unique;
@@ -98,6 +108,7 @@ extern int idx_op_batch_size;
 extern int idx_op_idx_type;
 extern std::string idx_op_idx_schema;
 extern std::string idx_op_text_delims;
+extern std::string idx_op_bloom_schema;
 
 // Transform op params
 extern int trans_op_format_type;
@@ -114,6 +125,14 @@ extern Tables::schema_vec sky_idx2_schema;
 extern Tables::predicate_vec sky_qry_preds;
 extern Tables::predicate_vec sky_idx_preds;
 extern Tables::predicate_vec sky_idx2_preds;
+extern Tables::schema_vec sky_grp_schema;
+extern Tables::schema_vec sky_ord_schema;
+
+// group by partial aggs, merged across objs by the workers
+extern Tables::agg_groups sky_grp_aggs;
+
+// order by ... limit k, the top-k rows of each obj merged by the workers
+extern Tables::topk_rows sky_topk;
 
 extern std::atomic<unsigned> result_count;
 extern std::atomic<unsigned> rows_returned;
@@ -141,5 +160,10 @@ void worker_build_index(librados::IoCtx *ioctx);
 void worker_exec_build_sky_index_op(librados::IoCtx *ioctx, idx_op op);
 void worker_exec_runstats_op(librados::IoCtx *ioctx, stats_op op);
 void worker_transform_db_op(librados::IoCtx *ioctx, transform_op op);
+void worker_compact_op(librados::IoCtx *ioctx, compact_op op);
 void worker();
+void print_groupby_result();
+void print_topk_result();
+void output_start();
+void output_finish();
 void handle_cb(librados::completion_t cb, void *arg);
@@ -22,6 +22,11 @@ int main(int argc, char **argv)
   int wthreads;
   bool build_index;
   bool transform_db;
+  bool compact_db;
+  uint32_t compact_rows;
+  uint64_t compact_bytes;
+  std::string cluster_col;
+  std::string compact_cluster_schema;
   std::string logfile;
   int qdepth;
   std::string dir;
@@ -31,9 +36,12 @@ int main(int argc, char **argv)
   bool index_read;
   bool index_create;
   bool mem_constrain;
+  uint64_t scan_mem_cap;
+  uint32_t cls_threads;
   bool text_index_ignore_stopwords;
   int index_plan_type;
   int trans_format_type;
+  unsigned stats_nbins;
   std::string trans_format_str;
   std::string text_index_delims;
   std::string db_schema;
@@ -47,7 +55,12 @@ int main(int argc, char **argv)
   std::string index2_preds;
   std::string index_cols;
   std::string index2_cols;
+  std::string index_bloom_cols;
   std::string project_cols;
+  std::string groupby_cols;
+  std::string orderby_col;
+  bool orderby_desc;
+  bool no_partition_prune;
 
   // set based upon program_options
   int index_type = Tables::SIT_IDX_UNK;
@@ -104,6 +117,10 @@ int main(int argc, char **argv)
     ("log-file", po::value<std::string>(&logfile)->default_value(""), "log file")
     ("dir", po::value<std::string>(&dir)->default_value("fwd"), "direction")
     ("transform-db", po::bool_switch(&transform_db)->default_value(false), "transform DB")
+    ("compact", po::bool_switch(&compact_db)->default_value(false), "Compact the objects: merge their fbs, drop deleted rows and rebuild their indexes")
+    ("compact-rows", po::value<uint32_t>(&compact_rows)->default_value(0), "With compact, target rows per fb (0=no limit)")
+    ("compact-bytes", po::value<uint64_t>(&compact_bytes)->default_value(8388608), "With compact, target bytes per fb (0=no limit)")
+    ("cluster-col", po::value<std::string>(&cluster_col)->default_value(""), "With compact, order the rows of each object by this col")
     // query parameters (old)
     ("extended-price", po::value<double>(&extended_price)->default_value(0.0), "extended price")
     ("order-key", po::value<int>(&order_key)->default_value(0.0), "order key")
@@ -121,9 +138,13 @@ int main(int argc, char **argv)
     ("index-create", po::bool_switch(&index_create)->default_value(false), create_index_help_msg.c_str())
     ("index-read", po::bool_switch(&index_read)->default_value(false), "Use the index for query")
     ("mem-constrain", po::bool_switch(&mem_constrain)->default_value(false), "Read/process data structs one at a time within object")
+    ("scan-mem-cap", po::value<uint64_t>(&scan_mem_cap)->default_value(0), "Stream object scans in chunks of at most this many bytes (0=read whole object)")
+    ("cls-threads", po::value<uint32_t>(&cls_threads)->default_value(1), "Num threads processing the data structs of an object within cls")
     ("index-cols", po::value<std::string>(&index_cols)->default_value(""), project_help_msg.c_str())
     ("index2-cols", po::value<std::string>(&index2_cols)->default_value(""), project_help_msg.c_str())
+    ("index-bloom-cols", po::value<std::string>(&index_bloom_cols)->default_value(""), "With index-create, also build per fb bloom filters on these cols (csv), used to skip fbs for equality preds")
     ("project-cols", po::value<std::string>(&project_cols)->default_value(Tables::PROJECT_DEFAULT), project_help_msg.c_str())
+    ("groupby-cols", po::value<std::string>(&groupby_cols)->default_value(""), "Group the agg preds (select-preds) by these cols, provide column names as csv list")
     ("index-preds", po::value<std::string>(&index_preds)->default_value(""), select_help_msg.c_str())
     ("index2-preds", po::value<std::string>(&index2_preds)->default_value(""), select_help_msg.c_str())
     ("select-preds", po::value<std::string>(&query_preds)->default_value(Tables::SELECT_DEFAULT), select_help_msg.c_str())
@@ -131,10 +152,16 @@ int main(int argc, char **argv)
     ("index-ignore-stopwords", po::bool_switch(&text_index_ignore_stopwords)->default_value(false), "Ignore stopwords when building text index. (def=false)")
     ("index-plan-type", po::value<int>(&index_plan_type)->default_value(Tables::SIP_IDX_STANDARD), "If 2 indexes, for intersection plan use '2', for union plan use '3' (def='1')")
     ("runstats", po::bool_switch(&runstats)->default_value(false), "Run statistics on the specified table name")
-    ("transform-format-type", po::value<std::string>(&trans_format_str)->default_value("flatbuffer"), "Destination format type ")
+    ("stats-nbins", po::value<unsigned>(&stats_nbins)->default_value(STATS_DEFAULT_NBINS), "Number of histogram bins per col for runstats")
+    ("transform-format-type", po::value<std::string>(&trans_format_str)->default_value("flatbuffer"), "Destination format type (flatbuffer, flatbuffer_col, arrow, parquet)")
     ("verbose", po::bool_switch(&print_verbose)->default_value(false), "Print detailed record metadata.")
     ("header", po::bool_switch(&header)->default_value(true), "Print csv row header.")
     ("limit", po::value<long long int>(&row_limit)->default_value(Tables::ROW_LIMIT_DEFAULT), "SQL limit option, limit num_rows of result set")
+    ("order-by", po::value<std::string>(&orderby_col)->default_value(""), "Order the result by this (projected) col, requires --limit")
+    ("order-desc", po::bool_switch(&orderby_desc)->default_value(false), "Use descending order for --order-by")
+    ("no-partition-prune", po::bool_switch(&no_partition_prune)->default_value(false), "Query all objects, even if the table's partitioning would target fewer")
+    ("output-format", po::value<std::string>(&output_format)->default_value("csv"), "Result output format (csv to stdout, arrow ipc stream to --output-file)")
+    ("output-file", po::value<std::string>(&output_file)->default_value(""), "Result output file for the arrow output format")
   ;
 
   po::options_description all_opts("Allowed options");
@@ -216,8 +243,12 @@ int main(int argc, char **argv)
   // Get the destination object type for the transform operation
   if (trans_format_str == "flatbuffer") {
     trans_format_type = SFT_FLATBUF_FLEX_ROW;
+  } else if (trans_format_str == "flatbuffer_col") {
+    trans_format_type = SFT_FLATBUF_UNION_COL;
   } else if (trans_format_str == "arrow") {
     trans_format_type = SFT_ARROW;
+  } else if (trans_format_str == "parquet") {
+    trans_format_type = SFT_PARQUET;
   } else {
     assert(0);
   }
@@ -293,7 +324,10 @@ int main(int argc, char **argv)
     boost::trim(data_schema);
     boost::trim(index_cols);
     boost::trim(index2_cols);
+    boost::trim(index_bloom_cols);
     boost::trim(project_cols);
+    boost::trim(orderby_col);
+    boost::trim(cluster_col);
     boost::trim(query_preds);
     boost::trim(index_preds);
     boost::trim(index2_preds);
@@ -303,7 +337,10 @@ int main(int argc, char **argv)
     boost::to_upper(table_name);
     boost::to_upper(index_cols);
     boost::to_upper(index2_cols);
+    boost::to_upper(index_bloom_cols);
     boost::to_upper(project_cols);
+    boost::to_upper(orderby_col);
+    boost::to_upper(cluster_col);
 
     // current minimum required info for formulating IO requests.
     assert (!db_schema.empty());
@@ -314,7 +351,12 @@ int main(int argc, char **argv)
         assert (!index_cols.empty());
         assert (use_cls);
     }
-    if (runstats) {
+    if (output_format == "arrow") {
+        assert (!output_file.empty());
+    } else {
+        assert (output_format == "csv");
+    }
+    if (runstats or compact_db) {
         assert (use_cls);
     }
 
@@ -327,10 +369,15 @@ int main(int argc, char **argv)
     // verify and set the index schema
     sky_idx_schema = schemaFromColNames(sky_tbl_schema, index_cols);
     sky_idx2_schema = schemaFromColNames(sky_tbl_schema, index2_cols);
+    schema_vec sky_bloom_schema = schemaFromColNames(sky_tbl_schema,
+                                                     index_bloom_cols);
 
     // verify and set the query predicates
     sky_qry_preds = predsFromString(sky_tbl_schema, query_preds);
 
+    // verify and set the group by cols
+    sky_grp_schema = schemaFromColNames(sky_tbl_schema, groupby_cols);
+
     // verify and set the index predicates
     sky_idx_preds = predsFromString(sky_tbl_schema, index_preds);
     sky_idx2_preds = predsFromString(sky_tbl_schema, index2_preds);
@@ -345,7 +392,9 @@ int main(int argc, char **argv)
         // if project all cols and there are no selection preds, set fastpath
         if (sky_qry_preds.size() == 0 and
             sky_idx_preds.size() == 0 and
-            sky_idx2_preds.size() == 0) {
+            sky_idx2_preds.size() == 0 and
+            sky_grp_schema.empty() and
+            row_limit == ROW_LIMIT_DEFAULT) {
                 fastpath = true;
         }
 
@@ -373,6 +422,41 @@ int main(int argc, char **argv)
         }
     }
 
+    // verify the order by col, only rows (not aggs) are ordered, and it
+    // must be projected for the client to merge the results of each obj
+    if (!orderby_col.empty()) {
+        assert (row_limit != ROW_LIMIT_DEFAULT);
+        assert (!hasAggPreds(sky_qry_preds) and sky_grp_schema.empty());
+        sky_ord_schema = schemaFromColNames(sky_tbl_schema, orderby_col);
+        if (sky_ord_schema.size() != 1) {
+            cerr << "Error: order by col=" << orderby_col
+                 << " must be a single col of the table." << std::endl;
+            assert (RequestedColNotPresent == 0);
+        }
+        bool projected = false;
+        for (auto it = sky_qry_schema.begin(); it != sky_qry_schema.end(); ++it)
+            projected |= (it->idx == sky_ord_schema[0].idx);
+        if (!projected) {
+            cerr << "Error: order by col=" << orderby_col
+                 << " not present in project-cols." << std::endl;
+            assert (RequestedColNotPresent == 0);
+        }
+        sky_topk = topk_rows(row_limit, sky_ord_schema[0].idx,
+                             sky_ord_schema[0].type, orderby_desc);
+    }
+
+    // verify the clustering col for compaction
+    if (!cluster_col.empty()) {
+        schema_vec sky_cluster_schema = schemaFromColNames(sky_tbl_schema,
+                                                           cluster_col);
+        if (sky_cluster_schema.size() != 1) {
+            cerr << "Error: cluster col=" << cluster_col
+                 << " must be a single col of the table." << std::endl;
+            assert (RequestedColNotPresent == 0);
+        }
+        compact_cluster_schema = schemaToString(sky_cluster_schema);
+    }
+
     // set the index type
     if (!index_cols.empty()) {
         if (index_cols == RID_INDEX) { // const value for colname=RID
@@ -426,6 +510,14 @@ int main(int argc, char **argv)
                          << "supported for Skyhook indexes" << std::endl;
                     assert (SkyIndexUnsupportedOpType == 0);
             }
+            // text index preds are search exprs, e.g., "comment,eq,a b|c"
+            // matches rows with the phrase "a b" or the word "c"
+            if (index_type == SIT_IDX_TXT and
+                sky_idx_preds[i]->opType() != SOT_eq) {
+                cerr << "Only = predicates (search terms) supported for "
+                     << "Skyhook text indexes" << std::endl;
+                assert (SkyIndexUnsupportedOpType == 0);
+            }
             // verify index pred cols are all in the index schema
             bool found = false;
             for (unsigned j = 0; j < sky_idx_schema.size() and !found; j++) {
@@ -452,6 +544,12 @@ int main(int argc, char **argv)
                          << "supported for Skyhook indexes" << std::endl;
                     assert (SkyIndexUnsupportedOpType == 0);
             }
+            if (index2_type == SIT_IDX_TXT and
+                sky_idx2_preds[i]->opType() != SOT_eq) {
+                cerr << "Only = predicates (search terms) supported for "
+                     << "Skyhook text indexes" << std::endl;
+                assert (SkyIndexUnsupportedOpType == 0);
+            }
             // verify index pred cols are all in the index schema
             bool found = false;
             for (unsigned j = 0; j < sky_idx2_schema.size() and !found; j++) {
@@ -466,7 +564,7 @@ int main(int argc, char **argv)
 
     }
 
-    // verify index types are integral/string and check col idx bounds
+    // verify index col types are supported and check col idx bounds
     if (index_create) {
         if (index_type == SIT_IDX_TXT) {
             if (sky_idx_schema.size() > 1)  // enforce TXT indexes are 1 column
@@ -482,7 +580,7 @@ int main(int argc, char **argv)
                     assert (BuildSkyIndexUnsupportedColType == 0);
             }
             else if (index_type == SIT_IDX_REC or index_type == SIT_IDX_RID) {
-                if (ci.type < SDT_INT8 or ci.type > SDT_BOOL)
+                if (ci.type < SDT_FIRST or ci.type > SDT_LAST)
                     assert (BuildSkyIndexUnsupportedColType == 0);
             }
             if (ci.idx <= AGG_COL_LAST and ci.idx != RID_COL_INDEX)
@@ -515,6 +613,8 @@ int main(int argc, char **argv)
     qop_fastpath = fastpath;
     qop_index_read = index_read;
     qop_mem_constrain = mem_constrain;
+    qop_scan_mem_cap = scan_mem_cap;
+    qop_nthreads = cls_threads;
     qop_index_type = index_type;
     qop_index2_type = index2_type;
     qop_index_plan_type = index_plan_type;
@@ -528,12 +628,18 @@ int main(int argc, char **argv)
     qop_query_preds = predsToString(sky_qry_preds, sky_tbl_schema);
     qop_index_preds = predsToString(sky_idx_preds, sky_tbl_schema);
     qop_index2_preds = predsToString(sky_idx2_preds, sky_tbl_schema);
+    qop_groupby_schema = schemaToString(sky_grp_schema);
+    qop_limit = (row_limit == ROW_LIMIT_DEFAULT or row_limit < 0) ?
+                0 : row_limit;
+    qop_orderby_schema = schemaToString(sky_ord_schema);
+    qop_orderby_desc = orderby_desc;
     idx_op_idx_unique = idx_unique;
     idx_op_batch_size = index_batch_size;
     idx_op_idx_type = index_type;
     idx_op_idx_schema = schemaToString(sky_idx_schema);
     idx_op_ignore_stopwords = text_index_ignore_stopwords;
     idx_op_text_delims = text_index_delims;
+    idx_op_bloom_schema = schemaToString(sky_bloom_schema);
     trans_op_format_type = trans_format_type;
 
   } else {  // query type unknown.
@@ -550,7 +656,8 @@ int main(int argc, char **argv)
               idx_op_batch_size,
               idx_op_idx_type,
               idx_op_idx_schema,
-              idx_op_text_delims);
+              idx_op_text_delims,
+              idx_op_bloom_schema);
 
     // kick off the workers
     std::vector<std::thread> threads;
@@ -573,7 +680,8 @@ int main(int argc, char **argv)
   if (query == "flatbuf" && runstats) {
 
     // create idx_op for workers
-    stats_op op(qop_db_schema, qop_table_name, qop_data_schema);
+    stats_op op(qop_db_schema, qop_table_name, qop_data_schema,
+                stats_nbins);
 
     // kick off the workers
     std::vector<std::thread> threads;
@@ -591,6 +699,27 @@ int main(int argc, char **argv)
     return 0;
   }
 
+  // launch compaction of the objects here.
+  if (query == "flatbuf" && compact_db) {
+
+    compact_op op(compact_rows, compact_bytes, compact_cluster_schema);
+
+    // kick off the workers
+    std::vector<std::thread> threads;
+    for (int i = 0; i < wthreads; i++) {
+      auto ioctx = new librados::IoCtx;
+      int ret = cluster.ioctx_create(pool.c_str(), *ioctx);
+      checkret(ret, 0);
+      threads.push_back(std::thread(worker_compact_op, ioctx, op));
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    return 0;
+  }
+
   // launch transform operation here.
   if (transform_db) {
 
@@ -613,6 +742,46 @@ int main(int argc, char **argv)
     return 0;
   }
 
+  // target only the obj that may hold the rows of the query, if the table's
+  // partitioning is recorded (e.g., by fbwriter) and the query preds fix
+  // each of its key cols.  the partitioning must describe the queried objs,
+  // else it is stale or for other objs and the query is not pruned.
+  if ((query == "flatbuf" || query == "arrow") && !no_partition_prune) {
+    ceph::bufferlist bl;
+    ret = ioctx.read(Tables::PARTITION_OID_PREFIX + qop_table_name, bl, 0, 0);
+    if (ret >= 0) {
+      partition_info pi;
+      uint64_t obj_num = 0;
+      try {
+        ceph::bufferlist::iterator it = bl.begin();
+        ::decode(pi, it);
+      } catch (const buffer::error &err) {
+        std::cerr << "ERROR: decoding partition info" << std::endl;
+        exit(1);
+      }
+      if (pi.num_objs != num_objs || pi.obj_prefix != "obj.") {
+        std::cerr << "WARNING: not partition pruning, the partitioning of "
+                  << qop_table_name << " (" << pi.num_objs << " objects "
+                  << pi.obj_prefix << "*) does not match the queried "
+                  << num_objs << " objects obj.*" << std::endl;
+      }
+      else if (Tables::partitionTargetObj(pi, sky_qry_preds, obj_num)) {
+        const std::string oid = pi.obj_prefix + std::to_string(obj_num);
+        bool present = std::find(target_objects.begin(), target_objects.end(),
+                                 oid) != target_objects.end();
+        target_objects.clear();
+        if (present)
+          target_objects.push_back(oid);
+        if (!quiet)
+          std::cout << "partition pruning, target object: " << oid
+                    << (present ? "" : " (not in range)") << std::endl;
+      }
+    }
+    else if (ret != -ENOENT) {
+      checkret(ret, 0);
+    }
+  }
+
   result_count = 0;
   rows_returned = 0;
   nrows_processed = 0;
@@ -622,7 +791,8 @@ int main(int argc, char **argv)
   outstanding_ios = 0;
   stop = false;
 
-  // start worker threads
+  // start the result writer, then the worker threads
+  output_start();
   std::vector<std::thread> threads;
   for (int i = 0; i < wthreads; i++) {
     threads.push_back(std::thread(worker));
@@ -665,6 +835,8 @@ int main(int argc, char **argv)
         op.fastpath = qop_fastpath;
         op.index_read = qop_index_read;
         op.mem_constrain = qop_mem_constrain;
+        op.scan_mem_cap = qop_scan_mem_cap;
+        op.nthreads = qop_nthreads;
         op.index_type = qop_index_type;
         op.index2_type = qop_index2_type;
         op.index_plan_type = qop_index_plan_type;
@@ -678,6 +850,10 @@ int main(int argc, char **argv)
         op.query_preds = qop_query_preds;
         op.index_preds = qop_index_preds;
         op.index2_preds = qop_index2_preds;
+        op.groupby_schema = qop_groupby_schema;
+        op.limit = qop_limit;
+        op.orderby_schema = qop_orderby_schema;
+        op.orderby_desc = qop_orderby_desc;
         ceph::bufferlist inbl;
         ::encode(op, inbl);
         int ret = ioctx.aio_exec(oid, s->c,
@@ -724,6 +900,13 @@ int main(int argc, char **argv)
     thread.join();
   }
 
+  // group by results are only complete once all objs are merged
+  if (query == "flatbuf") {
+    print_groupby_result();
+    print_topk_result();
+  }
+  output_finish();
+
   ioctx.close();
 
   // only report status messages during quiet operation
@@ -1,4 +1,8 @@
+#include <cfloat>
+#include <climits>
+#include <cmath>
 #include <iostream>
+#include <set>
 #include "query.h"
 #include "test/librados/test.h"
 #include "gtest/gtest.h"
@@ -315,3 +319,1213 @@ TEST_F(SkyhookQuery, QueryFastpathCLS)
   ASSERT_EQ((unsigned) 1000000, result_count);
   ASSERT_EQ((unsigned) 1000000, rows_returned);
 }
+
+/*
+ * Flatbuf objects written and indexed through the tabular cls methods,
+ * independent of the ingested test data.  Rows are (ORDERKEY, LINENUMBER)
+ * with unique order keys, which are also the RIDs.
+ */
+static const std::string FB_TEST_SCHEMA = " \
+    0 " + std::to_string(Tables::SDT_INT64) + " 1 0 ORDERKEY \n\
+    1 " + std::to_string(Tables::SDT_INT32) + " 0 0 LINENUMBER \n\
+    ";
+
+class SkyhookFlatbuf : public ::testing::Test {
+  protected:
+    static void SetUpTestCase() {
+      pool_name = get_temp_pool_name();
+      ASSERT_EQ("", create_one_pool_pp(pool_name, rados));
+      ASSERT_EQ(0, rados.ioctx_create(pool_name.c_str(), ioctx));
+    }
+
+    static void TearDownTestCase() {
+      ioctx.close();
+      ASSERT_EQ(0, destroy_one_pool_pp(pool_name, rados));
+    }
+
+    // a row layout fb of keys with the rows of the dead keys marked
+    // deleted, as one encoded bl like fbwriter writes it
+    static bufferlist build_fb(const std::vector<int64_t>& keys,
+                               const std::set<int64_t>& dead,
+                               const std::string& table = "LINEITEM") {
+      flatbuffers::FlatBufferBuilder fbb(1024);
+      std::vector<flatbuffers::Offset<Tables::Record>> rows;
+      std::vector<uint8_t> deletes;
+      std::vector<uint64_t> nullbits(2, 0);
+      for (size_t i = 0; i < keys.size(); i++) {
+        flexbuffers::Builder flx;
+        flx.Vector([&]() {
+          flx.Add(keys[i]);
+          flx.Add(static_cast<int32_t>(i + 1));
+        });
+        flx.Finish();
+        auto data = fbb.CreateVector(flx.GetBuffer());
+        auto nulls = fbb.CreateVector(nullbits);
+        rows.push_back(Tables::CreateRecord(fbb, keys[i], nulls, data));
+        deletes.push_back(dead.count(keys[i]) ? 1 : 0);
+      }
+      auto data_schema = fbb.CreateString(FB_TEST_SCHEMA);
+      auto db_schema = fbb.CreateString("*");
+      auto table_name = fbb.CreateString(table);
+      auto delete_vector = fbb.CreateVector(deletes);
+      auto rows_vector = fbb.CreateVector(rows);
+      fbb.Finish(Tables::CreateTable(fbb, SFT_FLATBUF_FLEX_ROW, 2, 1, 1,
+                                     data_schema, db_schema, table_name,
+                                     delete_vector, rows_vector,
+                                     keys.size()));
+      bufferlist bl, wrapped;
+      bl.append(reinterpret_cast<const char*>(fbb.GetBufferPointer()),
+                fbb.GetSize());
+      ::encode(bl, wrapped);
+      return wrapped;
+    }
+
+    static void append_fb(const std::string& oid, bufferlist fb) {
+      bufferlist out;
+      ASSERT_EQ(0, ioctx.exec(oid, "tabular", "append_fb", fb, out));
+    }
+
+    // an IDX_REC index over the order keys, as run-query --index-create,
+    // with fb bloom filters over the bloom cols if any
+    static void build_index(const std::string& oid,
+                            const std::string& bloom_cols = "") {
+      Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+      Tables::schema_vec idx_schema = Tables::schemaFromColNames(schema, "ORDERKEY");
+      Tables::schema_vec bloom_schema;
+      if (!bloom_cols.empty())
+        bloom_schema = Tables::schemaFromColNames(schema, bloom_cols);
+      idx_op op(true, false, 1000, Tables::SIT_IDX_REC,
+                Tables::schemaToString(idx_schema), "",
+                Tables::schemaToString(bloom_schema));
+      bufferlist inbl, out;
+      ::encode(op, inbl);
+      ASSERT_EQ(0, ioctx.exec(oid, "tabular", "exec_build_sky_index_op",
+                              inbl, out));
+    }
+
+    // a flatbuf query op as run-query builds it, reading through the order
+    // key index if there are index preds.  aggs replace the projection, and
+    // are grouped by the group by cols if any.
+    static query_op make_query_op(const std::string& project_cols,
+                                  const std::string& query_preds,
+                                  const std::string& index_preds = "",
+                                  const std::string& groupby_cols = "") {
+      Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+      Tables::schema_vec empty_schema;
+      Tables::predicate_vec empty_preds;
+      Tables::predicate_vec preds = \
+          Tables::predsFromString(schema, query_preds);
+      Tables::predicate_vec idx_preds = \
+          Tables::predsFromString(schema, index_preds);
+      Tables::schema_vec idx_schema = \
+          Tables::schemaFromColNames(schema, "ORDERKEY");
+      Tables::schema_vec qry_schema;
+      if (Tables::hasAggPreds(preds)) {
+        for (auto it = preds.begin(); it != preds.end(); ++it) {
+          if (!(*it)->isGlobalAgg())
+            continue;
+          std::string op_str = Tables::skyOpTypeToString((*it)->opType());
+          qry_schema.push_back(Tables::col_info(
+              Tables::AGG_COL_IDX.at(op_str), (*it)->colType(), false, false,
+              op_str));
+        }
+      } else {
+        qry_schema = Tables::schemaFromColNames(schema, project_cols);
+      }
+
+      query_op op;
+      op.query = "flatbuf";
+      op.extended_price = 0;
+      op.order_key = 0;
+      op.line_number = 0;
+      op.ship_date_low = 0;
+      op.ship_date_high = 0;
+      op.discount_low = 0;
+      op.discount_high = 0;
+      op.quantity = 0;
+      op.use_index = false;
+      op.projection = (project_cols != Tables::PROJECT_DEFAULT);
+      op.extra_row_cost = 0;
+      op.fastpath = false;
+      op.index_read = !idx_preds.empty();
+      op.mem_constrain = false;
+      op.index_type = op.index_read ? Tables::SIT_IDX_REC :
+                                      Tables::SIT_IDX_UNK;
+      op.index2_type = Tables::SIT_IDX_UNK;
+      op.index_plan_type = Tables::SIP_IDX_STANDARD;
+      op.index_batch_size = 1000;
+      op.db_schema = "*";
+      op.table_name = "LINEITEM";
+      op.data_schema = Tables::schemaToString(schema);
+      op.query_schema = Tables::schemaToString(qry_schema);
+      op.index_schema = Tables::schemaToString(op.index_read ? idx_schema :
+                                                               empty_schema);
+      op.index2_schema = Tables::schemaToString(empty_schema);
+      op.query_preds = Tables::predsToString(preds, schema);
+      op.index_preds = Tables::predsToString(idx_preds, schema);
+      op.index2_preds = Tables::predsToString(empty_preds, schema);
+      op.groupby_schema = Tables::schemaToString(groupby_cols.empty() ?
+          empty_schema : Tables::schemaFromColNames(schema, groupby_cols));
+      op.orderby_schema = Tables::schemaToString(empty_schema);
+      return op;
+    }
+
+    // run a query op on the obj, returns the seq of result fbs and the
+    // rows the cls processed
+    static void run_query(const std::string& oid,
+                          const query_op& op,
+                          bufferlist *results,
+                          uint64_t *nprocessed) {
+      bufferlist inbl, out;
+      ::encode(op, inbl);
+      ASSERT_EQ(0, ioctx.exec(oid, "tabular", "exec_query_op", inbl, out));
+
+      uint64_t read_ns, eval_ns;
+      bufferlist::iterator it = out.begin();
+      ::decode(read_ns, it);
+      ::decode(eval_ns, it);
+      ::decode(*nprocessed, it);
+      ::decode(*results, it);
+    }
+
+    // query the obj through the order key index, as run-query --index-read,
+    // returns the live result rows and the rows the cls processed
+    static void query_index(const std::string& oid,
+                            const std::string& index_preds,
+                            uint64_t *nrows,
+                            uint64_t *nprocessed) {
+      bufferlist results;
+      run_query(oid, make_query_op(Tables::PROJECT_DEFAULT, "", index_preds),
+                &results, nprocessed);
+      *nrows = count_live_rows(results);
+    }
+
+    // the first col of each live row of a seq of result fbs, as int64
+    static std::vector<int64_t> first_col_vals(bufferlist& wrapped_bls) {
+      std::vector<int64_t> vals;
+      bufferlist::iterator it = wrapped_bls.begin();
+      while (it.get_remaining() > 0) {
+        bufferlist bl;
+        ::decode(bl, it);
+        Tables::sky_root root = Tables::getSkyRoot(bl.c_str(), bl.length());
+        for (uint32_t i = 0; i < root.nrows; i++) {
+          if (root.delete_vec.at(i) == 1)
+            continue;
+          Tables::sky_rec rec = Tables::getSkyRec(root.offs->Get(i));
+          vals.push_back(rec.data.AsVector()[0].AsInt64());
+        }
+      }
+      return vals;
+    }
+
+    // live rows of a seq of encoded fbs
+    static uint64_t count_live_rows(bufferlist& wrapped_bls) {
+      uint64_t n = 0;
+      bufferlist::iterator it = wrapped_bls.begin();
+      while (it.get_remaining() > 0) {
+        bufferlist bl;
+        ::decode(bl, it);
+        Tables::sky_root root = Tables::getSkyRoot(bl.c_str(), bl.length());
+        for (uint32_t i = 0; i < root.nrows; i++)
+          n += (root.delete_vec.at(i) == 0);
+      }
+      return n;
+    }
+
+    // the order keys of all rows of the obj in stored order, and its fbs
+    static void read_keys(const std::string& oid,
+                          std::vector<int64_t> *keys,
+                          std::vector<int64_t> *dead_keys,
+                          unsigned *nfbs) {
+      bufferlist wrapped_bls;
+      ASSERT_LT(0, ioctx.read(oid, wrapped_bls, 0, 0));
+      *nfbs = 0;
+      bufferlist::iterator it = wrapped_bls.begin();
+      while (it.get_remaining() > 0) {
+        bufferlist bl;
+        ::decode(bl, it);
+        (*nfbs)++;
+        Tables::sky_root root = Tables::getSkyRoot(bl.c_str(), bl.length());
+        for (uint32_t i = 0; i < root.nrows; i++) {
+          Tables::sky_rec rec = Tables::getSkyRec(root.offs->Get(i));
+          int64_t key = rec.data.AsVector()[0].AsInt64();
+          if (root.delete_vec.at(i) == 0)
+            keys->push_back(key);
+          else
+            dead_keys->push_back(key);
+        }
+      }
+    }
+
+    static Rados rados;
+    static IoCtx ioctx;
+    static std::string pool_name;
+};
+
+Rados SkyhookFlatbuf::rados;
+IoCtx SkyhookFlatbuf::ioctx;
+std::string SkyhookFlatbuf::pool_name;
+
+/*
+ * TEST APPEND FB TO AN INDEXED OBJ
+ * the appended fb's rows are found through the existing index, and only
+ * the matching row is processed.
+ *
+ * fbwriter -a ... (append_fb), then
+ * run-query --index-read --index-cols orderkey --index-preds "orderkey,eq,15"
+ */
+TEST_F(SkyhookFlatbuf, AppendThenIndexRead)
+{
+  const std::string oid = "fb.append";
+  append_fb(oid, build_fb({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}, {}));
+  build_index(oid);
+  append_fb(oid, build_fb({11, 12, 13, 14, 15, 16, 17, 18, 19, 20}, {}));
+
+  uint64_t nrows = 0, nprocessed = 0;
+  query_index(oid, "orderkey,eq,15", &nrows, &nprocessed);
+  ASSERT_EQ((uint64_t) 1, nrows);
+  ASSERT_EQ((uint64_t) 1, nprocessed);
+
+  // rows of the fb indexed by the build are still found
+  query_index(oid, "orderkey,eq,5", &nrows, &nprocessed);
+  ASSERT_EQ((uint64_t) 1, nrows);
+  ASSERT_EQ((uint64_t) 1, nprocessed);
+
+  // an fb of another table is rejected, it would not be indexed
+  bufferlist fb = build_fb({21}, {}, "ORDERS");
+  bufferlist out;
+  ASSERT_EQ(-EINVAL, ioctx.exec(oid, "tabular", "append_fb", fb, out));
+
+  // as is an fb that is not a valid flatbuf
+  bufferlist junk;
+  fb.clear();
+  junk.append("not a flatbuf");
+  ::encode(junk, fb);
+  ASSERT_EQ(-EINVAL, ioctx.exec(oid, "tabular", "append_fb", fb, out));
+}
+
+/*
+ * TEST COMPACT AN INDEXED OBJ
+ * deleted rows are dropped, the live rows are clustered by order key into
+ * fbs of target_rows rows, and the index is rebuilt for the new fbs.
+ *
+ * run-query --compact --compact-rows 3 --cluster-col orderkey, then
+ * run-query --index-read --index-cols orderkey --index-preds "orderkey,eq,6"
+ */
+TEST_F(SkyhookFlatbuf, CompactThenIndexRead)
+{
+  const std::string oid = "fb.compact";
+  append_fb(oid, build_fb({5, 3, 9, 1}, {3}));
+  append_fb(oid, build_fb({8, -2, 7, 4, 6}, {7}));
+  build_index(oid);
+
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  Tables::schema_vec cluster_schema = \
+      Tables::schemaFromColNames(schema, "ORDERKEY");
+  compact_op op(3, 0, Tables::schemaToString(cluster_schema));
+  bufferlist inbl, out;
+  ::encode(op, inbl);
+  ASSERT_EQ(0, ioctx.exec(oid, "tabular", "compact", inbl, out));
+
+  std::vector<int64_t> keys, dead_keys;
+  unsigned nfbs = 0;
+  read_keys(oid, &keys, &dead_keys, &nfbs);
+  std::vector<int64_t> expected = {-2, 1, 4, 5, 6, 8, 9};
+  ASSERT_EQ(expected, keys);
+  ASSERT_TRUE(dead_keys.empty());
+  ASSERT_EQ(3u, nfbs);
+
+  // live rows are found through the rebuilt index, dropped rows are not
+  uint64_t nrows = 0, nprocessed = 0;
+  query_index(oid, "orderkey,eq,6", &nrows, &nprocessed);
+  ASSERT_EQ((uint64_t) 1, nrows);
+  ASSERT_EQ((uint64_t) 1, nprocessed);
+
+  query_index(oid, "orderkey,eq,-2", &nrows, &nprocessed);
+  ASSERT_EQ((uint64_t) 1, nrows);
+
+  query_index(oid, "orderkey,eq,3", &nrows, &nprocessed);
+  ASSERT_EQ((uint64_t) 0, nrows);
+}
+
+/*
+ * TEST ORDER PRESERVING INDEX KEY ENCODINGS
+ * the keys of ascending vals must compare ascending as bytes (memcmp), so
+ * that index range scans visit the vals in order.
+ */
+static void expect_ascending_keys(const std::vector<std::string>& keys)
+{
+  for (size_t i = 1; i < keys.size(); i++)
+    EXPECT_LT(keys[i - 1], keys[i]) << "keys of vals " << i - 1
+                                    << " and " << i;
+}
+
+TEST(SkyhookKeyEncode, IntOrder)
+{
+  std::vector<int64_t> vals = {INT64_MIN, INT32_MIN, -256, -255, -1, 0, 1,
+                               255, 256, INT32_MAX, INT64_MAX};
+  std::vector<std::string> keys;
+  for (int64_t v : vals) {
+    std::string key;
+    Tables::keyEncodeInt(key, v, sizeof(int64_t));
+    keys.push_back(key);
+  }
+  expect_ascending_keys(keys);
+
+  // narrower cols flip their own sign bit
+  std::vector<int16_t> vals16 = {INT16_MIN, -1, 0, 1, INT16_MAX};
+  keys.clear();
+  for (int16_t v : vals16) {
+    std::string key;
+    Tables::keyEncodeInt(key, v, sizeof(int16_t));
+    ASSERT_EQ(sizeof(int16_t), key.size());
+    keys.push_back(key);
+  }
+  expect_ascending_keys(keys);
+}
+
+TEST(SkyhookKeyEncode, FloatOrder)
+{
+  std::vector<float> vals = {-INFINITY, -FLT_MAX, -1.5f, -1.0f, -FLT_MIN,
+                             0.0f, FLT_MIN, 1.0f, 1.5f, FLT_MAX, INFINITY};
+  std::vector<std::string> keys;
+  for (float v : vals) {
+    std::string key;
+    Tables::keyEncodeFloat(key, v);
+    keys.push_back(key);
+  }
+  expect_ascending_keys(keys);
+
+  std::string neg_zero, zero;
+  Tables::keyEncodeFloat(neg_zero, -0.0f);
+  Tables::keyEncodeFloat(zero, 0.0f);
+  ASSERT_EQ(zero, neg_zero);
+}
+
+TEST(SkyhookKeyEncode, DoubleOrder)
+{
+  std::vector<double> vals = {-INFINITY, -DBL_MAX, -1e10, -1.5, -DBL_MIN,
+                              0.0, DBL_MIN, 1.5, 1e10, DBL_MAX, INFINITY};
+  std::vector<std::string> keys;
+  for (double v : vals) {
+    std::string key;
+    Tables::keyEncodeDouble(key, v);
+    keys.push_back(key);
+  }
+  expect_ascending_keys(keys);
+
+  std::string neg_zero, zero;
+  Tables::keyEncodeDouble(neg_zero, -0.0);
+  Tables::keyEncodeDouble(zero, 0.0);
+  ASSERT_EQ(zero, neg_zero);
+}
+
+TEST(SkyhookKeyEncode, StringOrder)
+{
+  std::vector<std::string> vals = {std::string(""),
+                                   std::string("a"),
+                                   std::string("a\0", 2),
+                                   std::string("a\0b", 3),
+                                   std::string("ab"),
+                                   std::string("b")};
+  std::vector<std::string> keys;
+  for (auto& v : vals) {
+    std::string key;
+    Tables::keyEncodeString(key, v.data(), v.size());
+    keys.push_back(key);
+  }
+  expect_ascending_keys(keys);
+
+  // a string col is terminated, so in a composite key it orders before
+  // any longer string it is a prefix of, whatever the next col holds
+  std::string k1, k2;
+  Tables::keyEncodeString(k1, "a", 1);
+  Tables::keyEncodeString(k1, "z", 1);
+  Tables::keyEncodeString(k2, "ab", 2);
+  Tables::keyEncodeString(k2, "", 0);
+  ASSERT_LT(k1, k2);
+}
+
+/*
+ * TEST INDEX ONLY PLAN SKIPS DELETED ROWS
+ * deleted rows get no index entries, so a covered query and a count
+ * answered from the index keys match a full scan.
+ *
+ * run-query --project orderkey --index-read --index-cols orderkey
+ *           --index-preds "orderkey,geq,1"
+ * run-query --select "orderkey,cnt,0" --index-read ...
+ */
+TEST_F(SkyhookFlatbuf, IndexOnlySkipsDeletedRows)
+{
+  const std::string oid = "fb.index_only";
+  append_fb(oid, build_fb({1, 2, 3, 4, 5, 6}, {3}));
+  build_index(oid);
+
+  bufferlist results;
+  uint64_t nprocessed = 0;
+  run_query(oid, make_query_op("ORDERKEY", "", "orderkey,geq,1"),
+            &results, &nprocessed);
+  std::vector<int64_t> expected = {1, 2, 4, 5, 6};
+  ASSERT_EQ(expected, first_col_vals(results));
+
+  results.clear();
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,cnt,0",
+                               "orderkey,geq,1"),
+            &results, &nprocessed);
+  ASSERT_EQ(std::vector<int64_t>({5}), first_col_vals(results));
+
+  // the same count by a full scan
+  results.clear();
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,cnt,0"),
+            &results, &nprocessed);
+  ASSERT_EQ(std::vector<int64_t>({5}), first_col_vals(results));
+}
+
+/*
+ * Pred vals are decoded from the request within the cls, an invalid val
+ * must be rejected rather than throw, and an agg op ignores its val.
+ *
+ * run-query --select "shipdate,lt,1998-13-45"
+ * run-query --select "shipdate,max,"
+ */
+TEST(SkyhookPreds, InvalidValues)
+{
+  const std::string schema_str = " \
+      0 " + std::to_string(Tables::SDT_INT64) + " 1 0 ORDERKEY \n\
+      1 " + std::to_string(Tables::SDT_DATE) + " 0 0 SHIPDATE \n\
+      ";
+  Tables::schema_vec schema = Tables::schemaFromString(schema_str);
+
+  const std::vector<std::string> invalid = {
+      ";shipdate,lt,1998-13-45;",
+      ";shipdate,eq,notadate;",
+      ";shipdate,lt,1998-09-02;orderkey,eq,abc;",
+      ";orderkey,lt,99999999999999999999999;",
+  };
+  for (auto it = invalid.begin(); it != invalid.end(); ++it) {
+    Tables::predicate_vec preds;
+    ASSERT_EQ(Tables::TablesErrCodes::PredicateValueInvalid,
+              Tables::predsFromString(schema, *it, preds)) << *it;
+    ASSERT_TRUE(preds.empty()) << *it;
+  }
+
+  Tables::predicate_vec preds;
+  ASSERT_EQ(0, Tables::predsFromString(schema, ";shipdate,lt,1998-09-02;",
+                                       preds));
+  ASSERT_EQ(1u, preds.size());
+
+  preds.clear();
+  ASSERT_EQ(0, Tables::predsFromString(schema, ";shipdate,max,;", preds));
+  ASSERT_EQ(1u, preds.size());
+  ASSERT_TRUE(preds[0]->isGlobalAgg());
+}
+
+TEST_F(SkyhookFlatbuf, QueryRejectsInvalidPreds)
+{
+  const std::string oid = "fb.invalid_preds";
+  append_fb(oid, build_fb({1, 2, 3}, {}));
+
+  query_op op = make_query_op("ORDERKEY", "");
+  op.query_preds = ";ORDERKEY,eq,abc;";
+  bufferlist inbl, out;
+  ::encode(op, inbl);
+  ASSERT_EQ(-EINVAL, ioctx.exec(oid, "tabular", "exec_query_op", inbl, out));
+}
+
+/*
+ * fbwriter parses fields in place with these, an invalid or out of range
+ * field must be rejected, not wrapped or thrown.
+ */
+static bool parse_int(const std::string& s, int64_t& v,
+                      int64_t min = INT64_MIN, int64_t max = INT64_MAX) {
+  return Tables::parseInt(s.data(), s.size(), v, min, max);
+}
+
+static bool parse_uint(const std::string& s, uint64_t& v,
+                       uint64_t max = UINT64_MAX) {
+  return Tables::parseUInt(s.data(), s.size(), v, max);
+}
+
+TEST(SkyhookParse, Ints)
+{
+  int64_t v;
+  ASSERT_TRUE(parse_int("0", v));
+  ASSERT_EQ(0, v);
+  ASSERT_TRUE(parse_int("-0", v));
+  ASSERT_EQ(0, v);
+  ASSERT_TRUE(parse_int("+42", v));
+  ASSERT_EQ(42, v);
+  ASSERT_TRUE(parse_int("9223372036854775807", v));
+  ASSERT_EQ(INT64_MAX, v);
+  ASSERT_TRUE(parse_int("-9223372036854775808", v));
+  ASSERT_EQ(INT64_MIN, v);
+  ASSERT_FALSE(parse_int("9223372036854775808", v));
+  ASSERT_FALSE(parse_int("-9223372036854775809", v));
+  ASSERT_FALSE(parse_int("99999999999999999999", v));
+  ASSERT_FALSE(parse_int("", v));
+  ASSERT_FALSE(parse_int("-", v));
+  ASSERT_FALSE(parse_int("+", v));
+  ASSERT_FALSE(parse_int("-+1", v));
+  ASSERT_FALSE(parse_int("1.5", v));
+  ASSERT_FALSE(parse_int("12a", v));
+  ASSERT_FALSE(parse_int("NULL", v));
+
+  // range of the col type
+  ASSERT_TRUE(parse_int("127", v, INT8_MIN, INT8_MAX));
+  ASSERT_TRUE(parse_int("-128", v, INT8_MIN, INT8_MAX));
+  ASSERT_FALSE(parse_int("128", v, INT8_MIN, INT8_MAX));
+  ASSERT_FALSE(parse_int("-129", v, INT8_MIN, INT8_MAX));
+  ASSERT_FALSE(parse_int("2147483648", v, INT32_MIN, INT32_MAX));
+
+  uint64_t u;
+  ASSERT_TRUE(parse_uint("18446744073709551615", u));
+  ASSERT_EQ(UINT64_MAX, u);
+  ASSERT_FALSE(parse_uint("18446744073709551616", u));
+  ASSERT_FALSE(parse_uint("-1", u));
+  ASSERT_FALSE(parse_uint("256", u, UINT8_MAX));
+  ASSERT_FALSE(parse_uint("NULL", u));
+}
+
+TEST(SkyhookParse, Doubles)
+{
+  double v;
+  const std::string row = "1.25|-3e2|abc|";
+  ASSERT_TRUE(Tables::parseDouble(row.data(), 4, v));
+  ASSERT_EQ(1.25, v);
+  ASSERT_TRUE(Tables::parseDouble(row.data() + 5, 4, v));
+  ASSERT_EQ(-300.0, v);
+  ASSERT_FALSE(Tables::parseDouble(row.data() + 10, 3, v));
+  ASSERT_FALSE(Tables::parseDouble(row.data() + 14, 0, v));
+  const std::string null_field = "NULL";
+  ASSERT_FALSE(Tables::parseDouble(null_field.data(), null_field.size(), v));
+}
+
+TEST(SkyhookParse, Dates)
+{
+  int32_t days;
+  const std::vector<std::string> valid = {"1970-01-01", "1998-09-02",
+                                          "2000-02-29", "1969-12-31"};
+  const std::vector<int32_t> expected = {0, 10471, 11016, -1};
+  for (size_t i = 0; i < valid.size(); i++) {
+    ASSERT_TRUE(Tables::parseDate(valid[i].data(), valid[i].size(), days))
+        << valid[i];
+    ASSERT_EQ(expected[i], days) << valid[i];
+  }
+
+  const std::vector<std::string> invalid = {"", "NULL", "1998-13-01",
+                                            "1998-00-10", "1998-02-30",
+                                            "1900-02-29", "1998-1a-01",
+                                            "notadate"};
+  for (auto it = invalid.begin(); it != invalid.end(); ++it)
+    ASSERT_FALSE(Tables::parseDate(it->data(), it->size(), days)) << *it;
+}
+
+/*
+ * Rows are placed by a jump consistent hash of their key cols, each obj
+ * num is in range and growing the num of objs only moves keys to the new
+ * obj.
+ */
+TEST(SkyhookPartition, JumpConsistentHash)
+{
+  for (uint64_t key = 0; key < 10000; key += 7) {
+    ASSERT_EQ(0u, Tables::jumpConsistentHash(key, 1));
+    uint64_t prev = 0;
+    for (uint64_t n = 1; n <= 32; n++) {
+      uint64_t b = Tables::jumpConsistentHash(key, n);
+      ASSERT_LT(b, n);
+      ASSERT_EQ(b, Tables::jumpConsistentHash(key, n));
+      ASSERT_TRUE(b == prev || b == n - 1) << key << " " << n;
+      prev = b;
+    }
+  }
+  ASSERT_EQ(uint64_t(5) << 32, Tables::partitionHashKey({5}));
+  ASSERT_EQ((uint64_t(5) << 32) | 2, Tables::partitionHashKey({5, 2}));
+}
+
+/*
+ * A query targets a single obj only if its preds fix each hashed key col,
+ * as run-query --select "orderkey,eq,5" over a table loaded by fbwriter.
+ */
+TEST(SkyhookPartition, TargetObj)
+{
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  const uint64_t nobjs = 8;
+  partition_info pi(SPT_JUMP_HASH_KEY, "LINEITEM",
+                    Tables::schemaToString(
+                        Tables::schemaFromColNames(schema, "ORDERKEY")),
+                    nobjs, "obj.");
+  uint64_t obj_num = nobjs;
+
+  // the key is fixed by an eq pred, other preds do not matter
+  Tables::predicate_vec preds = Tables::predsFromString(schema,
+      ";orderkey,eq,5;linenumber,lt,3;");
+  ASSERT_TRUE(Tables::partitionTargetObj(pi, preds, obj_num));
+  ASSERT_EQ(Tables::jumpConsistentHash(Tables::partitionHashKey({5}), nobjs),
+            obj_num);
+
+  // a range of keys may be in any obj
+  preds = Tables::predsFromString(schema, ";orderkey,geq,5;orderkey,leq,5;");
+  ASSERT_FALSE(Tables::partitionTargetObj(pi, preds, obj_num));
+
+  // an or chain may pass rows with other keys
+  preds = Tables::predsFromString(schema, ";orderkey,eq,5;");
+  preds.push_back(new Tables::TypedPredicate<int32_t>(1, Tables::SDT_INT32,
+      Tables::SOT_eq, 1, Tables::SOT_logical_or));
+  ASSERT_FALSE(Tables::partitionTargetObj(pi, preds, obj_num));
+
+  // negative keys do not parse as unsigned in the loader and hash as 0
+  preds = Tables::predsFromString(schema, ";orderkey,eq,-5;");
+  ASSERT_TRUE(Tables::partitionTargetObj(pi, preds, obj_num));
+  ASSERT_EQ(Tables::jumpConsistentHash(Tables::partitionHashKey({0}), nobjs),
+            obj_num);
+
+  // a composite key needs every key col fixed
+  partition_info pi2(SPT_JUMP_HASH_KEY, "LINEITEM",
+                     Tables::schemaToString(schema), nobjs, "obj.");
+  preds = Tables::predsFromString(schema, ";orderkey,eq,5;");
+  ASSERT_FALSE(Tables::partitionTargetObj(pi2, preds, obj_num));
+  preds = Tables::predsFromString(schema, ";orderkey,eq,5;linenumber,eq,2;");
+  ASSERT_TRUE(Tables::partitionTargetObj(pi2, preds, obj_num));
+  ASSERT_EQ(Tables::jumpConsistentHash(Tables::partitionHashKey({5, 2}),
+                                       nobjs),
+            obj_num);
+
+  // no recorded objs
+  partition_info empty;
+  preds = Tables::predsFromString(schema, ";orderkey,eq,5;");
+  ASSERT_FALSE(Tables::partitionTargetObj(empty, preds, obj_num));
+}
+
+/*
+ * RID preds over an arrow table are applied to its RID col, which follows
+ * the data cols, as run-query --select "_RID_INDEX_,geq,102" on arrow objs.
+ */
+TEST(SkyhookArrow, RidPreds)
+{
+  const int64_t nrows = 6;
+  arrow::Int64Builder key_bldr, rid_bldr;
+  arrow::UInt8Builder del_bldr;
+  for (int64_t i = 0; i < nrows; i++) {
+    ASSERT_TRUE(key_bldr.Append(i * 10).ok());
+    ASSERT_TRUE(rid_bldr.Append(100 + i).ok());
+    ASSERT_TRUE(del_bldr.Append(0).ok());
+  }
+  std::shared_ptr<arrow::Array> key_arr, rid_arr, del_arr;
+  ASSERT_TRUE(key_bldr.Finish(&key_arr).ok());
+  ASSERT_TRUE(rid_bldr.Finish(&rid_arr).ok());
+  ASSERT_TRUE(del_bldr.Finish(&del_arr).ok());
+  std::vector<std::shared_ptr<arrow::Field>> fields = {
+      arrow::field("ORDERKEY", arrow::int64()),
+      arrow::field("RID", arrow::int64()),
+      arrow::field("DELETED_VECTOR", arrow::uint8())};
+  auto arrow_schema = std::make_shared<arrow::Schema>(fields);
+  std::shared_ptr<arrow::Table> table = \
+      arrow::Table::Make(arrow_schema, {key_arr, rid_arr, del_arr});
+
+  // the table has the single data col ORDERKEY
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  Tables::predicate_vec preds = Tables::predsFromString(schema,
+      ";" + Tables::RID_INDEX + ",geq,102;orderkey,lt,50;");
+  std::vector<uint8_t> sel(nrows, 1);
+  std::string errmsg;
+  ASSERT_EQ(0, Tables::applyPredicatesArrow(preds, table, 1, sel, errmsg))
+      << errmsg;
+  ASSERT_EQ(std::vector<uint8_t>({0, 0, 1, 1, 1, 0}), sel);
+
+  Tables::predicate_vec rid_eq = {new Tables::TypedPredicate<int64_t>(
+      Tables::RID_COL_INDEX, Tables::SDT_INT64, Tables::SOT_eq, 103)};
+  std::fill(sel.begin(), sel.end(), 1);
+  ASSERT_EQ(0, Tables::applyPredicatesArrow(rid_eq, table, 1, sel, errmsg))
+      << errmsg;
+  ASSERT_EQ(std::vector<uint8_t>({0, 0, 0, 1, 0, 0}), sel);
+}
+
+/*
+ * Compiled preds evaluated over a block of rows pass the same rows as
+ * applyPredicates row at a time, incl. logical_or chains, and accumulate
+ * the same aggs.
+ */
+static std::vector<std::vector<uint8_t>> build_flx_rows(int64_t nrows)
+{
+  std::vector<std::vector<uint8_t>> bufs;
+  for (int64_t i = 0; i < nrows; i++) {
+    flexbuffers::Builder flx;
+    flx.Vector([&]() {
+      flx.Add(i - 50);
+      flx.Add(static_cast<int32_t>(i % 7));
+    });
+    flx.Finish();
+    bufs.push_back(flx.GetBuffer());
+  }
+  return bufs;
+}
+
+TEST(SkyhookPreds, BlockMatchesRowAtATime)
+{
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  auto bufs = build_flx_rows(300);
+  std::vector<flexbuffers::Vector> rows;
+  std::vector<int64_t> rids;
+  for (size_t i = 0; i < bufs.size(); i++) {
+    rows.push_back(flexbuffers::GetRoot(bufs[i]).AsVector());
+    rids.push_back(i + 1);
+  }
+
+  std::vector<Tables::predicate_vec> pred_sets = {
+      Tables::predsFromString(schema, ";orderkey,geq,10;linenumber,lt,3;"),
+      Tables::predsFromString(schema, ";orderkey,ne,20;linenumber,geq,6;"),
+      Tables::predsFromString(schema, ";orderkey,lt,0;"),
+      Tables::predicate_vec(),
+  };
+  // orderkey < 0 or linenumber == 5
+  pred_sets[2].push_back(new Tables::TypedPredicate<int32_t>(1,
+      Tables::SDT_INT32, Tables::SOT_eq, 5, Tables::SOT_logical_or));
+  // orderkey == 7 or orderkey == 9
+  pred_sets[3].push_back(new Tables::TypedPredicate<int64_t>(0,
+      Tables::SDT_INT64, Tables::SOT_eq, 7, Tables::SOT_logical_or));
+  pred_sets[3].push_back(new Tables::TypedPredicate<int64_t>(0,
+      Tables::SDT_INT64, Tables::SOT_eq, 9, Tables::SOT_logical_or));
+  const std::vector<size_t> expected_npass = {102, 42, 86, 2};
+
+  for (size_t s = 0; s < pred_sets.size(); s++) {
+    Tables::pred_plan plan = Tables::compilePredicates(pred_sets[s]);
+    std::vector<uint8_t> pass;
+    Tables::applyPredicatesBlock(plan, rows, rids, pass);
+    ASSERT_EQ(rows.size(), pass.size());
+    size_t npass = 0;
+    for (size_t i = 0; i < rows.size(); i++) {
+      Tables::sky_rec rec(rids[i], Tables::nullbits_vector(2, 0),
+                          flexbuffers::GetRoot(bufs[i]));
+      ASSERT_EQ(Tables::applyPredicates(pred_sets[s], rec), pass[i] != 0)
+          << "pred set " << s << " row " << i;
+      npass += pass[i];
+    }
+    ASSERT_EQ(expected_npass[s], npass) << "pred set " << s;
+  }
+
+  // aggs over the rows passing the other preds
+  Tables::predicate_vec block_aggs = Tables::predsFromString(schema,
+      ";linenumber,eq,3;orderkey,max,0;");
+  Tables::predicate_vec row_aggs = Tables::predsFromString(schema,
+      ";linenumber,eq,3;orderkey,max,0;");
+  std::vector<uint8_t> pass;
+  Tables::applyPredicatesBlock(Tables::compilePredicates(block_aggs), rows,
+                               rids, pass);
+  for (size_t i = 0; i < rows.size(); i++) {
+    Tables::sky_rec rec(rids[i], Tables::nullbits_vector(2, 0),
+                        flexbuffers::GetRoot(bufs[i]));
+    Tables::applyPredicates(row_aggs, rec);
+  }
+  int64_t block_max = \
+      dynamic_cast<Tables::TypedPredicate<int64_t>*>(block_aggs[1])->Val();
+  int64_t row_max = \
+      dynamic_cast<Tables::TypedPredicate<int64_t>*>(row_aggs[1])->Val();
+  ASSERT_EQ(247, block_max);  // row 297 is the last with linenumber 3
+  ASSERT_EQ(row_max, block_max);
+}
+
+/*
+ * A scan of an fb larger than a row block passes the same rows in every
+ * block, and skips deleted rows.
+ *
+ * run-query --select "orderkey,geq,1000;orderkey,lt,2100" --use-cls
+ */
+TEST_F(SkyhookFlatbuf, ScanAcrossRowBlocks)
+{
+  const std::string oid = "fb.row_blocks";
+  const int64_t nrows = 2 * Tables::PRED_EVAL_BLOCK_SIZE + 500;
+  std::vector<int64_t> keys;
+  for (int64_t k = 1; k <= nrows; k++)
+    keys.push_back(k);
+  append_fb(oid, build_fb(keys, {1500, 2050}));
+
+  bufferlist results;
+  uint64_t nprocessed = 0;
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,geq,1000;orderkey,lt,2100"),
+            &results, &nprocessed);
+  std::vector<int64_t> expected;
+  for (int64_t k = 1000; k < 2100; k++)
+    if (k != 1500 and k != 2050)
+      expected.push_back(k);
+  ASSERT_EQ(expected, first_col_vals(results));
+  ASSERT_EQ((uint64_t) nrows, nprocessed);
+}
+
+/*
+ * TEST ZONE MAP PRUNING
+ * the zone maps of an fb hold the range of each col (and the RID), and an
+ * and chain of preds rules out fbs whose ranges it cannot match.  A scan of
+ * an indexed obj only processes the fbs that may match.
+ *
+ * run-query --index-create --index-cols orderkey, then
+ * run-query --select "orderkey,geq,150;orderkey,lt,160" --use-cls
+ */
+TEST_F(SkyhookFlatbuf, ZoneMapsPruneScans)
+{
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  bufferlist wrapped = build_fb({10, 20, 30, 5}, {30});
+  bufferlist bl;
+  bufferlist::iterator bit = wrapped.begin();
+  ::decode(bl, bit);
+  Tables::sky_root root = Tables::getSkyRoot(bl.c_str(), bl.length());
+  std::vector<col_zone> zones;
+  Tables::buildZoneMaps(root, schema, zones);
+  ASSERT_EQ(3u, zones.size());
+  ASSERT_EQ(0, zones[0].col_idx);
+  ASSERT_EQ(5, zones[0].imin);
+  ASSERT_EQ(30, zones[0].imax);  // deleted rows are still in the fb
+  ASSERT_EQ(1, zones[1].imin);
+  ASSERT_EQ(4, zones[1].imax);
+  ASSERT_EQ(Tables::RID_COL_INDEX, zones[2].col_idx);
+  ASSERT_EQ(5u, zones[2].umin);
+  ASSERT_EQ(30u, zones[2].umax);
+
+  const std::vector<std::pair<std::string, bool>> cases = {
+      {";orderkey,gt,30;", false},
+      {";orderkey,geq,30;", true},
+      {";orderkey,lt,5;", false},
+      {";orderkey,eq,15;", true},  // in range, though no row has it
+      {";orderkey,geq,10;linenumber,eq,9;", false},
+      {";" + Tables::RID_INDEX + ",gt,30;", false},
+      {";orderkey,max,0;orderkey,gt,30;", true},  // aggs are per fb
+  };
+  for (auto it = cases.begin(); it != cases.end(); ++it) {
+    Tables::predicate_vec preds = Tables::predsFromString(schema, it->first);
+    ASSERT_EQ(it->second, Tables::zoneMapsMayMatch(zones, preds))
+        << it->first;
+  }
+
+  const std::string oid = "fb.zone_maps";
+  for (int64_t f = 0; f < 3; f++) {
+    std::vector<int64_t> keys;
+    for (int64_t k = f * 100 + 1; k <= (f + 1) * 100; k++)
+      keys.push_back(k);
+    append_fb(oid, build_fb(keys, {}));
+  }
+  build_index(oid);
+
+  bufferlist results;
+  uint64_t nprocessed = 0;
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,geq,150;orderkey,lt,160"),
+            &results, &nprocessed);
+  std::vector<int64_t> expected;
+  for (int64_t k = 150; k < 160; k++)
+    expected.push_back(k);
+  ASSERT_EQ(expected, first_col_vals(results));
+  ASSERT_EQ((uint64_t) 100, nprocessed);
+
+  results.clear();
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,gt,1000"),
+            &results, &nprocessed);
+  ASSERT_TRUE(first_col_vals(results).empty());
+  ASSERT_EQ((uint64_t) 0, nprocessed);
+
+  // an fb appended to the indexed obj gets its zone maps too
+  append_fb(oid, build_fb({301, 302, 303}, {}));
+  results.clear();
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,eq,302"),
+            &results, &nprocessed);
+  ASSERT_EQ(std::vector<int64_t>({302}), first_col_vals(results));
+  ASSERT_EQ((uint64_t) 3, nprocessed);
+}
+
+/*
+ * TEST GROUP BY PARTIAL AGGS
+ * each obj returns the partial aggs of its groups, avg as sum and cnt, and
+ * the client merges the partials of all objs into the final aggs.
+ *
+ * run-query --select "orderkey,sum,0;orderkey,cnt,0;orderkey,avg,0;
+ *                     orderkey,max,0" --groupby-cols linenumber --use-cls
+ */
+TEST_F(SkyhookFlatbuf, GroupByMergesPartials)
+{
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  Tables::schema_vec grp_schema = \
+      Tables::schemaFromColNames(schema, "LINENUMBER");
+  const std::string aggs = \
+      "orderkey,sum,0;orderkey,cnt,0;orderkey,avg,0;orderkey,max,0";
+  Tables::predicate_vec preds = Tables::predsFromString(schema, aggs);
+
+  // linenumbers are the row positions in each fb
+  append_fb("fb.groupby.0", build_fb({1, 2, 3}, {}));
+  append_fb("fb.groupby.1", build_fb({10, 20}, {20}));
+
+  Tables::agg_groups groups;
+  for (auto oid : {"fb.groupby.0", "fb.groupby.1"}) {
+    bufferlist results;
+    uint64_t nprocessed = 0;
+    run_query(oid, make_query_op("ORDERKEY", aggs, "", "LINENUMBER"),
+              &results, &nprocessed);
+    bufferlist::iterator it = results.begin();
+    unsigned nfbs = 0;
+    while (it.get_remaining() > 0) {
+      bufferlist bl;
+      ::decode(bl, it);
+      std::string errmsg;
+      ASSERT_EQ(0, Tables::groupbyMerge(grp_schema, preds, bl.c_str(),
+                                        bl.length(), errmsg, groups))
+          << errmsg;
+      nfbs++;
+    }
+    ASSERT_EQ(1u, nfbs);  // one fb of partials per obj
+  }
+  ASSERT_EQ(3u, groups.size());
+
+  flatbuffers::FlatBufferBuilder flatbldr(1024);
+  Tables::groupbyBuildFb(flatbldr, schema, grp_schema, preds, groups, true,
+                         "*", "LINEITEM");
+  Tables::sky_root root = Tables::getSkyRoot(
+      reinterpret_cast<const char*>(flatbldr.GetBufferPointer()),
+      flatbldr.GetSize());
+  ASSERT_EQ(3u, root.nrows);
+
+  // linenumber -> sum, cnt, avg, max of the live order keys
+  std::map<int64_t, std::vector<double>> rows;
+  for (uint32_t i = 0; i < root.nrows; i++) {
+    auto row = Tables::getSkyRec(root.offs->Get(i)).data.AsVector();
+    rows[row[0].AsInt64()] = {static_cast<double>(row[1].AsInt64()),
+                              static_cast<double>(row[2].AsUInt64()),
+                              row[3].AsDouble(),
+                              static_cast<double>(row[4].AsInt64())};
+  }
+  std::map<int64_t, std::vector<double>> expected = {
+      {1, {11, 2, 5.5, 10}},
+      {2, {2, 1, 2, 2}},  // the row of key 20 is deleted
+      {3, {3, 1, 3, 3}},
+  };
+  ASSERT_EQ(expected, rows);
+}
+
+/*
+ * TEST PARQUET ROW GROUP PRUNING
+ * an obj transformed to parquet holds a row group per fb, and a scan only
+ * reads the row groups whose min/max stats may match the preds.  Results
+ * are returned as arrow tables.
+ *
+ * run-query --transform-db --transform-format-type parquet, then
+ * run-query --select "orderkey,geq,150;orderkey,lt,160" --use-cls
+ */
+static std::vector<int64_t> arrow_first_col_vals(bufferlist& wrapped_bls)
+{
+  std::vector<int64_t> vals;
+  bufferlist::iterator it = wrapped_bls.begin();
+  while (it.get_remaining() > 0) {
+    bufferlist bl;
+    ::decode(bl, it);
+    auto buffer = std::make_shared<arrow::Buffer>(
+        reinterpret_cast<const uint8_t*>(bl.c_str()), bl.length());
+    std::shared_ptr<arrow::Table> table;
+    EXPECT_EQ(0, Tables::extract_arrow_from_buffer(&table, buffer));
+    if (!table)
+      continue;
+    auto chunks = table->column(0)->data()->chunks();
+    for (auto c = chunks.begin(); c != chunks.end(); ++c) {
+      auto arr = std::static_pointer_cast<arrow::Int64Array>(*c);
+      for (int64_t i = 0; i < arr->length(); i++)
+        vals.push_back(arr->Value(i));
+    }
+  }
+  return vals;
+}
+
+TEST_F(SkyhookFlatbuf, ParquetRowGroupPruning)
+{
+  const std::string oid = "fb.parquet";
+  for (int64_t f = 0; f < 3; f++) {
+    std::vector<int64_t> keys;
+    for (int64_t k = f * 100 + 1; k <= (f + 1) * 100; k++)
+      keys.push_back(k);
+    append_fb(oid, build_fb(keys, {150}));
+  }
+
+  transform_op top("LINEITEM", FB_TEST_SCHEMA, SFT_PARQUET);
+  bufferlist inbl, out;
+  ::encode(top, inbl);
+  ASSERT_EQ(0, ioctx.exec(oid, "tabular", "transform_db_op", inbl, out));
+
+  bufferlist results;
+  uint64_t nprocessed = 0;
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,geq,150;orderkey,lt,160"),
+            &results, &nprocessed);
+  std::vector<int64_t> expected;
+  for (int64_t k = 151; k < 160; k++)  // the row of key 150 is deleted
+    expected.push_back(k);
+  ASSERT_EQ(expected, arrow_first_col_vals(results));
+  ASSERT_EQ((uint64_t) 100, nprocessed);  // 1 of 3 row groups
+
+  results.clear();
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,gt,1000"),
+            &results, &nprocessed);
+  ASSERT_TRUE(arrow_first_col_vals(results).empty());
+  ASSERT_EQ((uint64_t) 0, nprocessed);
+
+  // every row group has rows with linenumber 42
+  results.clear();
+  run_query(oid, make_query_op("ORDERKEY", "linenumber,eq,42"),
+            &results, &nprocessed);
+  ASSERT_EQ(std::vector<int64_t>({42, 142, 242}),
+            arrow_first_col_vals(results));
+  ASSERT_EQ((uint64_t) 300, nprocessed);
+}
+
+/*
+ * TEST BLOOM FILTER PRUNING
+ * the bloom filter of an fb col holds all of its vals, so an eq pred on a
+ * val of the fb is never ruled out, and most other vals are.  A scan of an
+ * indexed obj skips the fbs whose filters rule out an eq pred, even when
+ * their zone maps cannot.
+ *
+ * run-query --index-create --index-cols orderkey --index-bloom-cols orderkey
+ * run-query --select "orderkey,eq,50" --use-cls
+ */
+static Tables::sky_root decode_root(bufferlist& wrapped, bufferlist& bl)
+{
+  bufferlist::iterator it = wrapped.begin();
+  ::decode(bl, it);
+  return Tables::getSkyRoot(bl.c_str(), bl.length());
+}
+
+TEST_F(SkyhookFlatbuf, BloomFiltersPruneScans)
+{
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  Tables::schema_vec bloom_schema = \
+      Tables::schemaFromColNames(schema, "ORDERKEY");
+
+  // one fb of the odd keys and one of the even keys, with the same ranges
+  std::vector<int64_t> odd, even;
+  for (int64_t k = 1; k <= 200; k++)
+    (k % 2 ? odd : even).push_back(k);
+  bufferlist odd_fb = build_fb(odd, {}), even_fb = build_fb(even, {});
+
+  bufferlist bl;
+  Tables::sky_root root = decode_root(even_fb, bl);
+  std::vector<col_bloom> blooms;
+  ASSERT_EQ(0, Tables::buildBloomFilters(root, bloom_schema, blooms));
+  ASSERT_EQ(1u, blooms.size());
+  unsigned false_pos = 0;
+  for (int64_t k = 1; k <= 200; k++) {
+    Tables::predicate_vec preds = Tables::predsFromString(schema,
+        ";orderkey,eq," + std::to_string(k) + ";");
+    bool may_match = Tables::bloomFiltersMayMatch(blooms, preds);
+    if (k % 2 == 0)
+      ASSERT_TRUE(may_match) << k;
+    else
+      false_pos += may_match;
+  }
+  ASSERT_LE(false_pos, 10u);  // 1% expected
+
+  // only eq preds are decided
+  Tables::predicate_vec range = Tables::predsFromString(schema,
+                                                        ";orderkey,gt,1000;");
+  ASSERT_TRUE(Tables::bloomFiltersMayMatch(blooms, range));
+
+  const std::string oid = "fb.bloom";
+  append_fb(oid, odd_fb);
+  append_fb(oid, even_fb);
+  build_index(oid, "ORDERKEY");
+
+  // the odd fb is read only on a false positive of its filter
+  bufferlist odd_bl;
+  Tables::sky_root odd_root = decode_root(odd_fb, odd_bl);
+  std::vector<col_bloom> odd_blooms;
+  ASSERT_EQ(0, Tables::buildBloomFilters(odd_root, bloom_schema, odd_blooms));
+  Tables::predicate_vec eq50 = Tables::predsFromString(schema,
+                                                       ";orderkey,eq,50;");
+  uint64_t expected_processed = 100;
+  if (Tables::bloomFiltersMayMatch(odd_blooms, eq50))
+    expected_processed += 100;
+
+  bufferlist results;
+  uint64_t nprocessed = 0;
+  run_query(oid, make_query_op("ORDERKEY", "orderkey,eq,50"),
+            &results, &nprocessed);
+  ASSERT_EQ(std::vector<int64_t>({50}), first_col_vals(results));
+  ASSERT_EQ(expected_processed, nprocessed);
+}
+
+/*
+ * TEST LIMIT AND ORDER BY PUSHDOWN
+ * with a limit the scan of an obj stops once enough rows are produced, and
+ * with order by each obj returns its top-k live rows in order, which the
+ * client merges into the top-k of all objs.
+ *
+ * run-query --project orderkey --limit 5 --use-cls
+ * run-query --project orderkey --order-by orderkey --order-desc --limit 5
+ */
+static query_op make_limit_op(query_op op, uint64_t limit,
+                              const std::string& orderby_col = "",
+                              bool desc = false)
+{
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  op.limit = limit;
+  op.orderby_desc = desc;
+  if (!orderby_col.empty())
+    op.orderby_schema = Tables::schemaToString(
+        Tables::schemaFromColNames(schema, orderby_col));
+  return op;
+}
+
+TEST_F(SkyhookFlatbuf, LimitAndOrderByPushdown)
+{
+  const std::string oid = "fb.limit";
+  for (int64_t f = 0; f < 3; f++) {
+    std::vector<int64_t> keys;
+    for (int64_t k = f * 100 + 1; k <= (f + 1) * 100; k++)
+      keys.push_back(k);
+    append_fb(oid, build_fb(keys, {}));
+  }
+
+  // the scan stops after the first fb produced enough rows
+  bufferlist results;
+  uint64_t nprocessed = 0;
+  run_query(oid, make_limit_op(make_query_op("ORDERKEY", ""), 5),
+            &results, &nprocessed);
+  ASSERT_LE(5u, first_col_vals(results).size());
+  ASSERT_EQ((uint64_t) 100, nprocessed);
+
+  // local top-k of each obj, deleted rows are never returned
+  std::vector<std::string> oids = {"fb.topk.0", "fb.topk.1"};
+  append_fb(oids[0], build_fb({5, 300, 17, 250}, {}));
+  append_fb(oids[0], build_fb({299, 1, 260, 298}, {}));
+  append_fb(oids[0], build_fb({300}, {300}));
+  append_fb(oids[1], build_fb({280, 290, 2, 297}, {}));
+  const std::vector<std::vector<int64_t>> expected_local = {
+      {300, 299, 298, 260, 250},
+      {297, 290, 280, 2},
+  };
+
+  Tables::schema_vec schema = Tables::schemaFromString(FB_TEST_SCHEMA);
+  Tables::topk_rows topk(5, 0, Tables::SDT_INT64, true);
+  for (size_t i = 0; i < oids.size(); i++) {
+    results.clear();
+    run_query(oids[i], make_limit_op(make_query_op("ORDERKEY", ""), 5,
+                                     "ORDERKEY", true),
+              &results, &nprocessed);
+    ASSERT_EQ(expected_local[i], first_col_vals(results));
+
+    // merge the obj's top-k into the client's, as query.cc
+    bufferlist::iterator it = results.begin();
+    while (it.get_remaining() > 0) {
+      bufferlist bl;
+      ::decode(bl, it);
+      std::string errmsg;
+      ASSERT_EQ(0, Tables::topkAccumulate(topk, bl.c_str(), bl.length(),
+                                          errmsg)) << errmsg;
+    }
+  }
+  flatbuffers::FlatBufferBuilder flatbldr(1024);
+  Tables::topkBuildFb(flatbldr, topk);
+  bufferlist merged, wrapped;
+  merged.append(reinterpret_cast<const char*>(flatbldr.GetBufferPointer()),
+                flatbldr.GetSize());
+  ::encode(merged, wrapped);
+  ASSERT_EQ(std::vector<int64_t>({300, 299, 298, 297, 290}),
+            first_col_vals(wrapped));
+
+  // ascending, with preds
+  results.clear();
+  run_query(oids[1], make_limit_op(make_query_op("ORDERKEY", "orderkey,gt,2"),
+                                   2, "ORDERKEY"),
+            &results, &nprocessed);
+  ASSERT_EQ(std::vector<int64_t>({280, 290}), first_col_vals(results));
+}